@@ -0,0 +1,295 @@
+/*********************************************************************
+*
+* ANSI C Example program:
+*    Acq-IntClk-Batch.c
+*
+* Example Category:
+*    AI
+*
+* Description:
+*    This example demonstrates how to run many finite acquisitions
+*    back to back. Acq-IntClk.c creates, configures, starts, reads
+*    and clears a task for every acquisition, and any processing of
+*    the data then delays the next acquisition.
+*
+*    Here the task is configured once and committed with
+*    DAQmxTaskControl. Stopping a committed task returns it to the
+*    committed state, so each further shot only needs DAQmxStartTask,
+*    a read and DAQmxStopTask. Two result buffers are used: while a
+*    worker thread processes shot k, shot k+1 is already being
+*    acquired into the other buffer.
+*
+*    Both approaches are run and the throughput in shots/s and the
+*    mean dead time between the end of one shot and the start of the
+*    next are printed for each.
+*
+* Instructions for Running:
+*    1. Select the physical channel to correspond to where your
+*       signal is input on the DAQ device.
+*    2. Enter the minimum and maximum voltages.
+*    3. Select the number of samples per shot and the number of shots.
+*    4. Set the rate of the acquisition.
+*
+* Steps:
+*    1. Create a task.
+*    2. Create an analog input voltage channel.
+*    3. Set the rate for the sample clock and define the sample mode
+*       to be finite.
+*    4. Commit the task.
+*    5. For every shot wait until the buffer is free, start the task,
+*       read all samples, stop the task and pass the buffer to the
+*       worker thread.
+*    6. Call the Clear Task function to clear the task.
+*    7. Display an error if any.
+*
+* I/O Connections Overview:
+*    Make sure your signal input terminal matches the Physical
+*    Channel I/O Control. For further connection information, refer
+*    to your hardware reference manual.
+*
+*********************************************************************/
+
+#include <stdio.h>
+#include <math.h>
+#include <NIDAQmx.h>
+#include "../Processing/StreamTime.h"
+#include "../Processing/StreamThread.h"
+
+#define DAQmxErrChk(functionCall) if( DAQmxFailed(error=(functionCall)) ) goto Error; else
+
+#define NUM_SHOTS       100
+#define SAMPS_PER_SHOT  1000
+#define RATE            10000.0
+
+typedef struct ShotQueue {
+    StreamMutex lock;
+    StreamCond  changed;
+    float64     data[2][SAMPS_PER_SHOT];
+    int32       numRead[2];
+    int         full[2];
+    int         nextToProcess;
+    int         stop;
+} ShotQueue;
+
+static ShotQueue    queue;
+static double       shotMean[NUM_SHOTS],shotRMS[NUM_SHOTS];
+
+static int32 RunCreatePerShot(int numShots, double *shotsPerSec, double *meanDeadTime);
+static int32 RunCommittedBatch(int numShots, double *shotsPerSec, double *meanDeadTime);
+static void  ProcessShot(int shot, const float64 data[], int32 numRead);
+static STREAM_THREAD_PROC(ProcessThread,arg);
+
+int main(void)
+{
+    int32       error=0;
+    char        errBuff[2048]={'\0'};
+    double      rate[2]={0.0,0.0},deadTime[2]={0.0,0.0};
+
+    /*********************************************/
+    // Create-per-shot flow, as in Acq-IntClk.c
+    /*********************************************/
+    DAQmxErrChk (RunCreatePerShot(NUM_SHOTS,&rate[0],&deadTime[0]));
+
+    /*********************************************/
+    // Committed, double-buffered flow
+    /*********************************************/
+    DAQmxErrChk (RunCommittedBatch(NUM_SHOTS,&rate[1],&deadTime[1]));
+
+    printf("%d shots of %d samples at %.0f Hz (%.1f ms each)\n",NUM_SHOTS,SAMPS_PER_SHOT,RATE,1e3*SAMPS_PER_SHOT/RATE);
+    printf("Mode\t\t\tShots/s\tMean dead time (ms)\n");
+    printf("Create per shot\t\t%.2f\t%.3f\n",rate[0],1e3*deadTime[0]);
+    printf("Committed batch\t\t%.2f\t%.3f\n",rate[1],1e3*deadTime[1]);
+    printf("Last shot: mean %.4f V, RMS %.4f V\n",shotMean[NUM_SHOTS-1],shotRMS[NUM_SHOTS-1]);
+
+Error:
+    if( DAQmxFailed(error) ) {
+        DAQmxGetExtendedErrorInfo(errBuff,2048);
+        printf("DAQmx Error: %s\n",errBuff);
+    }
+    printf("End of program, press Enter key to quit\n");
+    getchar();
+    return 0;
+}
+
+static int32 RunCreatePerShot(int numShots, double *shotsPerSec, double *meanDeadTime)
+{
+    int32       error=0;
+    TaskHandle  taskHandle=0;
+    int32       read;
+    float64     data[SAMPS_PER_SHOT];
+    double      t0,shotDone=0.0,deadSum=0.0;
+    int         k;
+
+    t0 = StreamTimeNow();
+    for(k=0;k<numShots;++k) {
+        /*********************************************/
+        // DAQmx Configure Code
+        /*********************************************/
+        DAQmxErrChk (DAQmxCreateTask("",&taskHandle));
+        DAQmxErrChk (DAQmxCreateAIVoltageChan(taskHandle,"Dev1/ai0","",DAQmx_Val_Cfg_Default,-10.0,10.0,DAQmx_Val_Volts,NULL));
+        DAQmxErrChk (DAQmxCfgSampClkTiming(taskHandle,"",RATE,DAQmx_Val_Rising,DAQmx_Val_FiniteSamps,SAMPS_PER_SHOT));
+
+        /*********************************************/
+        // DAQmx Start Code
+        /*********************************************/
+        DAQmxErrChk (DAQmxStartTask(taskHandle));
+        if( k>0 )
+            deadSum += StreamTimeNow()-shotDone;
+
+        /*********************************************/
+        // DAQmx Read Code
+        /*********************************************/
+        DAQmxErrChk (DAQmxReadAnalogF64(taskHandle,SAMPS_PER_SHOT,10.0,DAQmx_Val_GroupByChannel,data,SAMPS_PER_SHOT,&read,NULL));
+        shotDone = StreamTimeNow();
+
+        /*********************************************/
+        // DAQmx Stop Code
+        /*********************************************/
+        DAQmxStopTask(taskHandle);
+        DAQmxClearTask(taskHandle);
+        taskHandle = 0;
+
+        ProcessShot(k,data,read);
+    }
+    *shotsPerSec = numShots/(StreamTimeNow()-t0);
+    *meanDeadTime = numShots>1 ? deadSum/(numShots-1) : 0.0;
+
+Error:
+    if( taskHandle!=0 ) {
+        DAQmxStopTask(taskHandle);
+        DAQmxClearTask(taskHandle);
+    }
+    return error;
+}
+
+static int32 RunCommittedBatch(int numShots, double *shotsPerSec, double *meanDeadTime)
+{
+    int32           error=0;
+    TaskHandle      taskHandle=0;
+    StreamThread    worker;
+    int             workerRunning=0;
+    double          t0,shotDone=0.0,deadSum=0.0;
+    int             k;
+
+    StreamMutexInit(&queue.lock);
+    StreamCondInit(&queue.changed);
+    queue.full[0] = queue.full[1] = 0;
+    queue.nextToProcess = 0;
+    queue.stop = 0;
+
+    /*********************************************/
+    // DAQmx Configure Code
+    /*********************************************/
+    DAQmxErrChk (DAQmxCreateTask("",&taskHandle));
+    DAQmxErrChk (DAQmxCreateAIVoltageChan(taskHandle,"Dev1/ai0","",DAQmx_Val_Cfg_Default,-10.0,10.0,DAQmx_Val_Volts,NULL));
+    DAQmxErrChk (DAQmxCfgSampClkTiming(taskHandle,"",RATE,DAQmx_Val_Rising,DAQmx_Val_FiniteSamps,SAMPS_PER_SHOT));
+
+    // Verify, reserve and program the hardware once. DAQmxStopTask will
+    // from now on return the task to this state rather than unreserving it.
+    DAQmxErrChk (DAQmxTaskControl(taskHandle,DAQmx_Val_Task_Commit));
+
+    if( StreamThreadCreate(&worker,ProcessThread,NULL)!=0 ) {
+        printf("Could not start the processing thread\n");
+        goto Error;
+    }
+    workerRunning = 1;
+
+    t0 = StreamTimeNow();
+    for(k=0;k<numShots;++k) {
+        int buf=k&1;
+
+        // Wait until the worker has finished with shot k-2.
+        StreamMutexLock(&queue.lock);
+        while( queue.full[buf] )
+            StreamCondWait(&queue.changed,&queue.lock);
+        StreamMutexUnlock(&queue.lock);
+
+        /*********************************************/
+        // DAQmx Start Code
+        /*********************************************/
+        DAQmxErrChk (DAQmxStartTask(taskHandle));
+        if( k>0 )
+            deadSum += StreamTimeNow()-shotDone;
+
+        /*********************************************/
+        // DAQmx Read Code
+        /*********************************************/
+        DAQmxErrChk (DAQmxReadAnalogF64(taskHandle,SAMPS_PER_SHOT,10.0,DAQmx_Val_GroupByChannel,queue.data[buf],SAMPS_PER_SHOT,&queue.numRead[buf],NULL));
+        shotDone = StreamTimeNow();
+
+        /*********************************************/
+        // DAQmx Stop Code
+        /*********************************************/
+        DAQmxErrChk (DAQmxStopTask(taskHandle));
+
+        StreamMutexLock(&queue.lock);
+        queue.full[buf] = 1;
+        StreamCondBroadcast(&queue.changed);
+        StreamMutexUnlock(&queue.lock);
+    }
+
+Error:
+    if( workerRunning ) {
+        // The worker drains any shot still queued before it exits.
+        StreamMutexLock(&queue.lock);
+        queue.stop = 1;
+        StreamCondBroadcast(&queue.changed);
+        StreamMutexUnlock(&queue.lock);
+        StreamThreadJoin(worker);
+    }
+    if( !DAQmxFailed(error) && workerRunning ) {
+        *shotsPerSec = numShots/(StreamTimeNow()-t0);
+        *meanDeadTime = numShots>1 ? deadSum/(numShots-1) : 0.0;
+    }
+    if( taskHandle!=0 ) {
+        DAQmxStopTask(taskHandle);
+        DAQmxClearTask(taskHandle);
+    }
+    StreamCondDestroy(&queue.changed);
+    StreamMutexDestroy(&queue.lock);
+    return error;
+}
+
+static STREAM_THREAD_PROC(ProcessThread,arg)
+{
+    int shot=0;
+
+    for(;;) {
+        int buf;
+
+        StreamMutexLock(&queue.lock);
+        while( !queue.full[queue.nextToProcess] && !queue.stop )
+            StreamCondWait(&queue.changed,&queue.lock);
+        buf = queue.nextToProcess;
+        if( !queue.full[buf] ) {
+            StreamMutexUnlock(&queue.lock);
+            break;
+        }
+        StreamMutexUnlock(&queue.lock);
+
+        ProcessShot(shot++,queue.data[buf],queue.numRead[buf]);
+
+        StreamMutexLock(&queue.lock);
+        queue.full[buf] = 0;
+        queue.nextToProcess = buf^1;
+        StreamCondBroadcast(&queue.changed);
+        StreamMutexUnlock(&queue.lock);
+    }
+    return 0;
+}
+
+// Stand-in for the real analysis of one shot.
+static void ProcessShot(int shot, const float64 data[], int32 numRead)
+{
+    double  sum=0.0,sumSq=0.0;
+    int     i;
+
+    for(i=0;i<numRead;++i) {
+        sum += data[i];
+        sumSq += data[i]*data[i];
+    }
+    if( shot<NUM_SHOTS && numRead>0 ) {
+        shotMean[shot] = sum/numRead;
+        shotRMS[shot] = sqrt(sumSq/numRead);
+    }
+}
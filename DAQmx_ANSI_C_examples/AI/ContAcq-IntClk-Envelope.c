@@ -0,0 +1,190 @@
+/*********************************************************************
+*
+* ANSI C Example program:
+*    ContAcq-IntClk-Envelope.c
+*
+* Example Category:
+*    AI
+*
+* Description:
+*    This example extends ContAcq-IntClk.c. Every block that is read
+*    is appended to a raw data file and added to a min/max/mean
+*    envelope pyramid. When the acquisition ends the pyramid is saved
+*    next to the raw data, so that a viewer can draw any time range of
+*    the recording at screen resolution without reading the raw file.
+*    Each level of the pyramid keeps its newest MAX_BINS bins, so its
+*    memory is bounded: at 10 kS/s the finest level reaches back
+*    about 3.5 minutes and each level above twice as far.
+*    While the acquisition runs the example prints a coarse live view
+*    of the last second taken from the pyramid, and the mean update
+*    cost per sample.
+*
+* Instructions for Running:
+*    1. Select the physical channel to correspond to where your
+*       signal is input on the DAQ device.
+*    2. Enter the minimum and maximum voltage range.
+*    3. Set the rate of the acquisition and the Samples per Channel
+*       control.
+*    4. Build this file together with ../Processing/Envelope.c.
+*
+* Steps:
+*    1. Create a task.
+*    2. Create an analog input voltage channel.
+*    3. Set the rate for the sample clock. Additionally, define the
+*       sample mode to be continuous.
+*    4. Create the envelope pyramid and open the raw data file.
+*    5. Call the Start function to start the acquistion.
+*    6. Read the data in the EveryNCallback function, write it to
+*       disk and add it to the pyramid.
+*    7. Call the Clear Task function to clear the task.
+*    8. Save the pyramid and display an error if any.
+*
+* I/O Connections Overview:
+*    Make sure your signal input terminal matches the Physical
+*    Channel I/O Control. For further connection information, refer
+*    to your hardware reference manual.
+*
+*********************************************************************/
+
+#include <stdio.h>
+#include <NIDAQmx.h>
+#include "../Processing/Envelope.h"
+#include "../Processing/StreamTime.h"
+
+#define DAQmxErrChk(functionCall) if( DAQmxFailed(error=(functionCall)) ) goto Error; else
+
+#define RATE            10000.0
+#define BLOCK_SIZE      1000
+#define NUM_PIXELS      8
+#define MAX_BINS        32768
+
+static Envelope *envelope=NULL;
+static FILE     *rawFile=NULL;
+static double   envelopeTime=0.0;
+
+int32 CVICALLBACK EveryNCallback(TaskHandle taskHandle, int32 everyNsamplesEventType, uInt32 nSamples, void *callbackData);
+int32 CVICALLBACK DoneCallback(TaskHandle taskHandle, int32 status, void *callbackData);
+
+int main(void)
+{
+    int32       error=0;
+    TaskHandle  taskHandle=0;
+    char        errBuff[2048]={'\0'};
+
+    /*********************************************/
+    // Envelope Configure Code
+    /*********************************************/
+    // Level 0 bins span 64 samples, the top level 2^25 samples.
+    if( EnvelopeCreate(1,6,20,MAX_BINS,&envelope)!=0 || (rawFile=fopen("recording.bin","wb"))==NULL ) {
+        printf("Could not create the envelope or the raw data file\n");
+        goto Error;
+    }
+
+    /*********************************************/
+    // DAQmx Configure Code
+    /*********************************************/
+    DAQmxErrChk (DAQmxCreateTask("",&taskHandle));
+    DAQmxErrChk (DAQmxCreateAIVoltageChan(taskHandle,"Dev1/ai0","",DAQmx_Val_Cfg_Default,-10.0,10.0,DAQmx_Val_Volts,NULL));
+    DAQmxErrChk (DAQmxCfgSampClkTiming(taskHandle,"",RATE,DAQmx_Val_Rising,DAQmx_Val_ContSamps,BLOCK_SIZE));
+
+    DAQmxErrChk (DAQmxRegisterEveryNSamplesEvent(taskHandle,DAQmx_Val_Acquired_Into_Buffer,BLOCK_SIZE,0,EveryNCallback,NULL));
+    DAQmxErrChk (DAQmxRegisterDoneEvent(taskHandle,0,DoneCallback,NULL));
+
+    /*********************************************/
+    // DAQmx Start Code
+    /*********************************************/
+    DAQmxErrChk (DAQmxStartTask(taskHandle));
+
+    printf("Acquiring samples continuously. Press Enter to interrupt\n");
+    getchar();
+
+Error:
+    if( DAQmxFailed(error) )
+        DAQmxGetExtendedErrorInfo(errBuff,2048);
+    if( taskHandle!=0 ) {
+        /*********************************************/
+        // DAQmx Stop Code
+        /*********************************************/
+        DAQmxStopTask(taskHandle);
+        DAQmxClearTask(taskHandle);
+    }
+    if( rawFile )
+        fclose(rawFile);
+    if( envelope ) {
+        if( EnvelopeNumSamples(envelope)>0 ) {
+            printf("\nEnvelope update cost: %.2f ns/sample\n",1e9*envelopeTime/EnvelopeNumSamples(envelope));
+            if( EnvelopeSave(envelope,"recording.env")!=0 )
+                printf("Could not save recording.env\n");
+        }
+        EnvelopeClear(envelope);
+    }
+    if( DAQmxFailed(error) )
+        printf("DAQmx Error: %s\n",errBuff);
+    printf("End of program, press Enter key to quit\n");
+    getchar();
+    return 0;
+}
+
+int32 CVICALLBACK EveryNCallback(TaskHandle taskHandle, int32 everyNsamplesEventType, uInt32 nSamples, void *callbackData)
+{
+    int32       error=0;
+    char        errBuff[2048]={'\0'};
+    static int  totalRead=0;
+    int32       read=0;
+    float64     data[BLOCK_SIZE];
+    float       viewMin[NUM_PIXELS],viewMax[NUM_PIXELS];
+    double      t0;
+    long long   numSamples;
+    int         i;
+
+    /*********************************************/
+    // DAQmx Read Code
+    /*********************************************/
+    DAQmxErrChk (DAQmxReadAnalogF64(taskHandle,BLOCK_SIZE,10.0,DAQmx_Val_GroupByScanNumber,data,BLOCK_SIZE,&read,NULL));
+    if( read>0 ) {
+        fwrite(data,sizeof(float64),read,rawFile);
+        t0 = StreamTimeNow();
+        EnvelopeAddBlock(envelope,data,read,1);
+        envelopeTime += StreamTimeNow()-t0;
+
+        // Live view of the last second, one min/max pair per "pixel".
+        numSamples = EnvelopeNumSamples(envelope);
+        printf("Total %d ",(int)(totalRead+=read));
+        if( numSamples>=(long long)RATE &&
+            EnvelopeRender(envelope,0,numSamples-(long long)RATE,(long long)RATE,NUM_PIXELS,viewMin,viewMax,NULL)==0 ) {
+            for(i=0;i<NUM_PIXELS;++i)
+                printf("[%+.2f %+.2f]",viewMin[i],viewMax[i]);
+        }
+        printf("\r");
+        fflush(stdout);
+    }
+
+Error:
+    if( DAQmxFailed(error) ) {
+        DAQmxGetExtendedErrorInfo(errBuff,2048);
+        /*********************************************/
+        // DAQmx Stop Code
+        /*********************************************/
+        DAQmxStopTask(taskHandle);
+        DAQmxClearTask(taskHandle);
+        printf("DAQmx Error: %s\n",errBuff);
+    }
+    return 0;
+}
+
+int32 CVICALLBACK DoneCallback(TaskHandle taskHandle, int32 status, void *callbackData)
+{
+    int32   error=0;
+    char    errBuff[2048]={'\0'};
+
+    // Check to see if an error stopped the task.
+    DAQmxErrChk (status);
+
+Error:
+    if( DAQmxFailed(error) ) {
+        DAQmxGetExtendedErrorInfo(errBuff,2048);
+        DAQmxClearTask(taskHandle);
+        printf("DAQmx Error: %s\n",errBuff);
+    }
+    return 0;
+}
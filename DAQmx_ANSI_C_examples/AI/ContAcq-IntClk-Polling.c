@@ -0,0 +1,145 @@
+/*********************************************************************
+*
+* ANSI C Example program:
+*    ContAcq-IntClk-Polling.c
+*
+* Example Category:
+*    AI
+*
+* Description:
+*    This example compares three ways of getting continuous data to
+*    the application as soon as possible. ContAcq-IntClk.c reads in an
+*    EveryN callback. That needs a fixed block size and adds the
+*    driver's event dispatch to the latency. A dedicated reader
+*    thread can instead poll for available samples and read whatever
+*    has arrived, either spinning all the time or spinning for a
+*    while and then sleeping.
+*
+*    The same acquisition is run for a few seconds in each mode. For
+*    each mode the number of blocks, the mean block size, the
+*    latency percentiles and the CPU load are printed. The polling
+*    thread is pinned to one CPU.
+*
+* Instructions for Running:
+*    1. Select the physical channel to correspond to where your
+*       signal is input on the DAQ device.
+*    2. Enter the minimum and maximum voltage range.
+*    3. Set the rate of the acquisition, the callback block size and
+*       the CPU for the polling thread.
+*    4. Build this file together with ../Tasks/AIReader.c.
+*
+* Steps:
+*    For each mode:
+*    1. Create a task.
+*    2. Create an analog input voltage channel.
+*    3. Set the rate for the sample clock. Additionally, define the
+*       sample mode to be continuous.
+*    4. Create a reader for the task in the selected mode.
+*    5. Start the reader, which starts the task.
+*    6. After a few seconds stop the reader and print its statistics.
+*    7. Call the Clear Task function to clear the task.
+*    Then display an error if any.
+*
+* I/O Connections Overview:
+*    Make sure your signal input terminal matches the Physical
+*    Channel I/O control. For further connection information, refer
+*    to your hardware reference manual.
+*
+*********************************************************************/
+
+#include <stdio.h>
+#include <NIDAQmx.h>
+#include "../Tasks/AIReader.h"
+#include "../Processing/StreamTime.h"
+
+#define DAQmxErrChk(functionCall) if( DAQmxFailed(error=(functionCall)) ) goto Error; else
+
+#define RATE            100000.0
+#define EVERY_N         100
+#define POLL_CPU        1
+#define RUN_SECONDS     5.0
+
+static double   checksum=0.0;
+
+static int32 RunMode(const AIReaderConfig *config, AIReaderStats *stats);
+static void  Consume(const float64 data[], int32 numSampsPerChan, uInt32 numChans, void *consumerData);
+
+int main(void)
+{
+    int32           error=0;
+    char            errBuff[2048]={'\0'};
+    const char      *names[3]={"Callback","Busy poll","Hybrid poll"};
+    AIReaderConfig  cfg[3]={{0}};
+    AIReaderStats   stats;
+    int             m;
+
+    for(m=0;m<3;++m) {
+        cfg[m].mode = m;
+        cfg[m].rate = RATE;
+        cfg[m].everyN = EVERY_N;
+        cfg[m].minBlock = 1;
+        cfg[m].maxBlock = 10000;
+        cfg[m].cpu = POLL_CPU;
+        cfg[m].spinTime = 100e-6;
+        cfg[m].sleepTime = 200e-6;
+    }
+
+    printf("Mode\t\tBlocks\tSamps/block\tp50 (us)\tp99 (us)\tMax (us)\tCPU (%%)\n");
+    for(m=0;m<3;++m) {
+        DAQmxErrChk (RunMode(&cfg[m],&stats));
+        printf("%-12s\t%lld\t%.1f\t\t%.1f\t\t%.1f\t\t%.1f\t\t%.1f\n",names[m],stats.blocks,
+            stats.blocks ? (double)stats.samples/stats.blocks : 0.0,
+            1e6*stats.p50Latency,1e6*stats.p99Latency,1e6*stats.maxLatency,100.0*stats.cpuLoad);
+    }
+
+Error:
+    if( DAQmxFailed(error) ) {
+        DAQmxGetExtendedErrorInfo(errBuff,2048);
+        printf("DAQmx Error: %s\n",errBuff);
+    }
+    printf("End of program, press Enter key to quit\n");
+    getchar();
+    return 0;
+}
+
+static int32 RunMode(const AIReaderConfig *config, AIReaderStats *stats)
+{
+    int32       error=0;
+    TaskHandle  taskHandle=0;
+    AIReader    *reader=NULL;
+
+    /*********************************************/
+    // DAQmx Configure Code
+    /*********************************************/
+    DAQmxErrChk (DAQmxCreateTask("",&taskHandle));
+    DAQmxErrChk (DAQmxCreateAIVoltageChan(taskHandle,"Dev1/ai0","",DAQmx_Val_Cfg_Default,-10.0,10.0,DAQmx_Val_Volts,NULL));
+    DAQmxErrChk (DAQmxCfgSampClkTiming(taskHandle,"",RATE,DAQmx_Val_Rising,DAQmx_Val_ContSamps,(uInt64)RATE));
+    DAQmxErrChk (AIReaderCreate(taskHandle,config,Consume,NULL,&reader));
+
+    /*********************************************/
+    // DAQmx Start Code
+    /*********************************************/
+    DAQmxErrChk (AIReaderStart(reader));
+    StreamSleep(RUN_SECONDS);
+    AIReaderGetStats(reader,stats);
+
+    /*********************************************/
+    // DAQmx Stop Code
+    /*********************************************/
+    DAQmxErrChk (AIReaderStop(reader));
+
+Error:
+    AIReaderClear(reader);
+    if( taskHandle!=0 )
+        DAQmxClearTask(taskHandle);
+    return error;
+}
+
+// Stand-in for the controller or display that consumes the samples.
+static void Consume(const float64 data[], int32 numSampsPerChan, uInt32 numChans, void *consumerData)
+{
+    int32 i;
+
+    for(i=0;i<numSampsPerChan*(int32)numChans;++i)
+        checksum += data[i];
+}
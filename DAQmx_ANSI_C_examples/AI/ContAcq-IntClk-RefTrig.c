@@ -0,0 +1,190 @@
+/*********************************************************************
+*
+* ANSI C Example program:
+*    ContAcq-IntClk-RefTrig.c
+*
+* Example Category:
+*    AI
+*
+* Description:
+*    This example demonstrates how to capture event-triggered
+*    snapshots from a continuous acquisition. Instead of running
+*    finite acquisitions with a reference trigger, which have to be
+*    stopped and re-armed after every event, the task runs
+*    continuously and a software trigger watches ai0. For each rising
+*    crossing of the trigger level PRE_SAMPLES before and POST_SAMPLES
+*    after the crossing are handed to OnWindow for all channels, with
+*    no dead time between events.
+*
+* Instructions for Running:
+*    1. Select the physical channels to correspond to where your
+*       signals are input on the DAQ device. The first channel is the
+*       trigger channel.
+*    2. Set the trigger level, hysteresis and holdoff.
+*    3. Set the number of pre- and post-trigger samples.
+*    4. Build this file together with ../Processing/RefTrigger.c.
+*
+* Steps:
+*    1. Create a task.
+*    2. Create the analog input voltage channels.
+*    3. Set the rate for the sample clock. Additionally, define the
+*       sample mode to be continuous.
+*    4. Create the software reference trigger.
+*    5. Call the Start function to start the acquistion.
+*    6. Read the data in the EveryNCallback function and pass it to
+*       the trigger, which calls OnWindow for each completed window.
+*    7. Call the Clear Task function to clear the task.
+*    8. Display an error if any.
+*
+* I/O Connections Overview:
+*    Make sure your signal input terminals match the Physical
+*    Channel I/O Control. For further connection information, refer
+*    to your hardware reference manual.
+*
+*********************************************************************/
+
+#include <stdio.h>
+#include <NIDAQmx.h>
+#include "../Processing/RefTrigger.h"
+
+#define DAQmxErrChk(functionCall) if( DAQmxFailed(error=(functionCall)) ) goto Error; else
+
+#define NUM_CHANS       2
+#define RATE            10000.0
+#define BLOCK_SIZE      1000
+#define PRE_SAMPLES     200
+#define POST_SAMPLES    800
+
+static RefTrigger   *refTrigger=NULL;
+static double       lastPeak=0.0;
+
+int32 CVICALLBACK EveryNCallback(TaskHandle taskHandle, int32 everyNsamplesEventType, uInt32 nSamples, void *callbackData);
+int32 CVICALLBACK DoneCallback(TaskHandle taskHandle, int32 status, void *callbackData);
+
+// Called from within RefTriggerAddBlock once all post-trigger samples
+// have arrived. The window must be used or copied before returning.
+static void OnWindow(const RefTriggerView *view, void *callbackData)
+{
+    const double    *seg1,*seg2;
+    int             len1,len2,i;
+    double          peak=0.0;
+
+    // Peak of the second channel over the window.
+    RefTriggerViewChannel(view,1,&seg1,&len1,&seg2,&len2);
+    for(i=0;i<len1;++i)
+        peak = seg1[i]>peak ? seg1[i] : peak;
+    for(i=0;i<len2;++i)
+        peak = seg2[i]>peak ? seg2[i] : peak;
+    lastPeak = peak;
+}
+
+int main(void)
+{
+    int32               error=0;
+    TaskHandle          taskHandle=0;
+    char                errBuff[2048]={'\0'};
+    RefTriggerConfig    cfg;
+
+    /*********************************************/
+    // Trigger Configure Code
+    /*********************************************/
+    cfg.numChans = NUM_CHANS;
+    cfg.trigChan = 0;
+    cfg.slope = RefTriggerRising;
+    cfg.level = 1.0;
+    cfg.hysteresis = 0.1;
+    cfg.holdoff = 100;
+    cfg.preSamples = PRE_SAMPLES;
+    cfg.postSamples = POST_SAMPLES;
+    cfg.maxBlockSize = BLOCK_SIZE;
+    if( RefTriggerCreate(&cfg,OnWindow,NULL,&refTrigger)!=0 ) {
+        printf("Could not create the software trigger\n");
+        goto Error;
+    }
+
+    /*********************************************/
+    // DAQmx Configure Code
+    /*********************************************/
+    DAQmxErrChk (DAQmxCreateTask("",&taskHandle));
+    DAQmxErrChk (DAQmxCreateAIVoltageChan(taskHandle,"Dev1/ai0:1","",DAQmx_Val_Cfg_Default,-10.0,10.0,DAQmx_Val_Volts,NULL));
+    DAQmxErrChk (DAQmxCfgSampClkTiming(taskHandle,"",RATE,DAQmx_Val_Rising,DAQmx_Val_ContSamps,BLOCK_SIZE));
+
+    DAQmxErrChk (DAQmxRegisterEveryNSamplesEvent(taskHandle,DAQmx_Val_Acquired_Into_Buffer,BLOCK_SIZE,0,EveryNCallback,NULL));
+    DAQmxErrChk (DAQmxRegisterDoneEvent(taskHandle,0,DoneCallback,NULL));
+
+    /*********************************************/
+    // DAQmx Start Code
+    /*********************************************/
+    DAQmxErrChk (DAQmxStartTask(taskHandle));
+
+    printf("Acquiring samples continuously. Press Enter to interrupt\n");
+    getchar();
+
+Error:
+    if( DAQmxFailed(error) )
+        DAQmxGetExtendedErrorInfo(errBuff,2048);
+    if( taskHandle!=0 ) {
+        /*********************************************/
+        // DAQmx Stop Code
+        /*********************************************/
+        DAQmxStopTask(taskHandle);
+        DAQmxClearTask(taskHandle);
+    }
+    RefTriggerClear(refTrigger);
+    refTrigger = NULL;
+    if( DAQmxFailed(error) )
+        printf("DAQmx Error: %s\n",errBuff);
+    printf("End of program, press Enter key to quit\n");
+    getchar();
+    return 0;
+}
+
+int32 CVICALLBACK EveryNCallback(TaskHandle taskHandle, int32 everyNsamplesEventType, uInt32 nSamples, void *callbackData)
+{
+    int32               error=0;
+    char                errBuff[2048]={'\0'};
+    int32               read=0;
+    float64             data[NUM_CHANS*BLOCK_SIZE];
+    RefTriggerCounts    counts;
+
+    /*********************************************/
+    // DAQmx Read Code
+    /*********************************************/
+    DAQmxErrChk (DAQmxReadAnalogF64(taskHandle,BLOCK_SIZE,10.0,DAQmx_Val_GroupByChannel,data,NUM_CHANS*BLOCK_SIZE,&read,NULL));
+    if( read>0 ) {
+        RefTriggerAddBlock(refTrigger,data,read);
+        RefTriggerGetCounts(refTrigger,&counts);
+        printf("Total %d  Triggers %d  Windows %d  Dropped %d  Last peak %.3f V\r",
+            (int)counts.samples,(int)counts.triggers,(int)counts.windows,(int)counts.dropped,lastPeak);
+        fflush(stdout);
+    }
+
+Error:
+    if( DAQmxFailed(error) ) {
+        DAQmxGetExtendedErrorInfo(errBuff,2048);
+        /*********************************************/
+        // DAQmx Stop Code
+        /*********************************************/
+        DAQmxStopTask(taskHandle);
+        DAQmxClearTask(taskHandle);
+        printf("DAQmx Error: %s\n",errBuff);
+    }
+    return 0;
+}
+
+int32 CVICALLBACK DoneCallback(TaskHandle taskHandle, int32 status, void *callbackData)
+{
+    int32   error=0;
+    char    errBuff[2048]={'\0'};
+
+    // Check to see if an error stopped the task.
+    DAQmxErrChk (status);
+
+Error:
+    if( DAQmxFailed(error) ) {
+        DAQmxGetExtendedErrorInfo(errBuff,2048);
+        DAQmxClearTask(taskHandle);
+        printf("DAQmx Error: %s\n",errBuff);
+    }
+    return 0;
+}
@@ -0,0 +1,178 @@
+/*********************************************************************
+*
+* ANSI C Example program:
+*    ContAcq-IntClk-SharedMem.c
+*
+* Example Category:
+*    AI
+*
+* Description:
+*    This example extends ContAcq-IntClk.c to publish every block it
+*    reads into a named shared memory ring. Analysis running in other
+*    processes, such as MATLAB, Python or a C program built with
+*    ../Processing/ShmReader.c, can attach to the ring at any time and
+*    follow the live data without access to the DAQ device. Readers
+*    never hold up the acquisition. A reader that falls too far
+*    behind is told how many blocks it has lost.
+*
+*    Each block carries the index of its first sample and that
+*    sample's time on the monotonic clock, from a running fit of
+*    callback times against the samples acquired, as in
+*    ContAcq-IntClk-Timestamps.c.
+*
+* Instructions for Running:
+*    1. Select the physical channels to correspond to where your
+*       signals are input on the DAQ device.
+*    2. Enter the minimum and maximum voltage range.
+*    3. Set the rate of the acquisition and the Samples per Channel
+*       control. Set the shared memory name and the number of blocks
+*       the ring holds.
+*    4. Build this file together with ../Processing/ShmRing.c and
+*       ../Processing/SampleTimeMap.c.
+*
+* Steps:
+*    1. Create a task.
+*    2. Create the analog input voltage channels.
+*    3. Set the rate for the sample clock. Additionally, define the
+*       sample mode to be continuous.
+*    4. Create the shared memory ring and the sample time map.
+*    5. Call the Start function to start the acquistion.
+*    6. Read the data in the EveryNCallback function, grouped by
+*       channel, and publish it to the ring until the stop button is
+*       pressed or an error occurs.
+*    7. Call the Clear Task function to clear the task.
+*    8. Remove the shared memory ring.
+*    9. Display an error if any.
+*
+* I/O Connections Overview:
+*    Make sure your signal input terminals match the Physical
+*    Channel I/O Control. For further connection information, refer
+*    to your hardware reference manual.
+*
+*********************************************************************/
+
+#include <stdio.h>
+#include <NIDAQmx.h>
+#include "../Processing/ShmRing.h"
+#include "../Processing/SampleTimeMap.h"
+#include "../Processing/StreamTime.h"
+
+#define DAQmxErrChk(functionCall) if( DAQmxFailed(error=(functionCall)) ) goto Error; else
+
+#define NUM_CHANS       2
+#define RATE            10000.0
+#define BLOCK_SIZE      1000
+#define RING_NAME       "/daqmx_ai"
+#define RING_SLOTS      100         // 10 s of data
+
+static ShmRing          *ring=NULL;
+static SampleTimeMap    *timeMap=NULL;
+
+int32 CVICALLBACK EveryNCallback(TaskHandle taskHandle, int32 everyNsamplesEventType, uInt32 nSamples, void *callbackData);
+int32 CVICALLBACK DoneCallback(TaskHandle taskHandle, int32 status, void *callbackData);
+
+int main(void)
+{
+    int32               error=0;
+    TaskHandle          taskHandle=0;
+    char                errBuff[2048]={'\0'};
+    SampleTimeMapConfig timeConfig={RATE,(int)(60*RATE/BLOCK_SIZE),4.0,1e-3,10};
+
+    /*********************************************/
+    // Shared Memory Configure Code
+    /*********************************************/
+    if( ShmRingCreate(RING_NAME,NUM_CHANS,BLOCK_SIZE,RING_SLOTS,RATE,&ring)!=0
+        || SampleTimeMapCreate(&timeConfig,&timeMap)!=0 ) {
+        printf("Could not create the shared memory ring %s\n",RING_NAME);
+        goto Error;
+    }
+
+    /*********************************************/
+    // DAQmx Configure Code
+    /*********************************************/
+    DAQmxErrChk (DAQmxCreateTask("",&taskHandle));
+    DAQmxErrChk (DAQmxCreateAIVoltageChan(taskHandle,"Dev1/ai0:1","",DAQmx_Val_Cfg_Default,-10.0,10.0,DAQmx_Val_Volts,NULL));
+    DAQmxErrChk (DAQmxCfgSampClkTiming(taskHandle,"",RATE,DAQmx_Val_Rising,DAQmx_Val_ContSamps,BLOCK_SIZE));
+
+    DAQmxErrChk (DAQmxRegisterEveryNSamplesEvent(taskHandle,DAQmx_Val_Acquired_Into_Buffer,BLOCK_SIZE,0,EveryNCallback,NULL));
+    DAQmxErrChk (DAQmxRegisterDoneEvent(taskHandle,0,DoneCallback,NULL));
+
+    /*********************************************/
+    // DAQmx Start Code
+    /*********************************************/
+    DAQmxErrChk (DAQmxStartTask(taskHandle));
+
+    printf("Publishing samples continuously to %s. Press Enter to interrupt\n",RING_NAME);
+    getchar();
+
+Error:
+    if( DAQmxFailed(error) )
+        DAQmxGetExtendedErrorInfo(errBuff,2048);
+    if( taskHandle!=0 ) {
+        /*********************************************/
+        // DAQmx Stop Code
+        /*********************************************/
+        DAQmxStopTask(taskHandle);
+        DAQmxClearTask(taskHandle);
+    }
+    ShmRingClear(ring);
+    SampleTimeMapClear(timeMap);
+    if( DAQmxFailed(error) )
+        printf("DAQmx Error: %s\n",errBuff);
+    printf("End of program, press Enter key to quit\n");
+    getchar();
+    return 0;
+}
+
+int32 CVICALLBACK EveryNCallback(TaskHandle taskHandle, int32 everyNsamplesEventType, uInt32 nSamples, void *callbackData)
+{
+    int32           error=0;
+    char            errBuff[2048]={'\0'};
+    static uInt64   totalRead=0;
+    double          now=StreamTimeNow();
+    uInt64          acquired=0;
+    int32           read=0;
+    float64         data[NUM_CHANS*BLOCK_SIZE];
+
+    DAQmxErrChk (DAQmxGetReadTotalSampPerChanAcquired(taskHandle,&acquired));
+    SampleTimeMapAdd(timeMap,(long long)acquired,now);
+
+    /*********************************************/
+    // DAQmx Read Code
+    /*********************************************/
+    DAQmxErrChk (DAQmxReadAnalogF64(taskHandle,BLOCK_SIZE,10.0,DAQmx_Val_GroupByChannel,data,NUM_CHANS*BLOCK_SIZE,&read,NULL));
+    if( read>0 ) {
+        ShmRingPublish(ring,data,read,(long long)totalRead,SampleTimeMapTime(timeMap,(double)totalRead));
+        printf("Published %d samples. Total %llu, blocks %lld\r",(int)read,(unsigned long long)(totalRead+=read),ShmRingBlocksPublished(ring));
+        fflush(stdout);
+    }
+
+Error:
+    if( DAQmxFailed(error) ) {
+        DAQmxGetExtendedErrorInfo(errBuff,2048);
+        /*********************************************/
+        // DAQmx Stop Code
+        /*********************************************/
+        DAQmxStopTask(taskHandle);
+        DAQmxClearTask(taskHandle);
+        printf("DAQmx Error: %s\n",errBuff);
+    }
+    return 0;
+}
+
+int32 CVICALLBACK DoneCallback(TaskHandle taskHandle, int32 status, void *callbackData)
+{
+    int32   error=0;
+    char    errBuff[2048]={'\0'};
+
+    // Check to see if an error stopped the task.
+    DAQmxErrChk (status);
+
+Error:
+    if( DAQmxFailed(error) ) {
+        DAQmxGetExtendedErrorInfo(errBuff,2048);
+        DAQmxClearTask(taskHandle);
+        printf("DAQmx Error: %s\n",errBuff);
+    }
+    return 0;
+}
@@ -0,0 +1,188 @@
+/*********************************************************************
+*
+* ANSI C Example program:
+*    ContAcq-IntClk-Stats.c
+*
+* Example Category:
+*    AI
+*
+* Description:
+*    This example extends ContAcq-IntClk.c with per-channel health
+*    statistics. Straight after each DAQmxReadAnalogF64 call the block
+*    is reduced in a single pass to min, max, mean, RMS, NaN and
+*    clip counts for every channel. A separate monitor thread prints
+*    the running and the windowed (last second) results without ever
+*    blocking the read callback.
+*
+*    To work with raw ADC codes instead, read with DAQmxReadBinaryI16,
+*    give ChanStatsCreate the clip limits in codes and call
+*    ChanStatsAddI16.
+*
+* Instructions for Running:
+*    1. Select the physical channels to correspond to where your
+*       signals are input on the DAQ device.
+*    2. Enter the minimum and maximum voltage range. Samples at or
+*       beyond these values are counted as clipped.
+*    3. Set the rate of the acquisition and the Samples per Channel
+*       control.
+*    4. Build this file together with ../Processing/ChanStats.c.
+*
+* Steps:
+*    1. Create a task.
+*    2. Create the analog input voltage channels.
+*    3. Set the rate for the sample clock. Additionally, define the
+*       sample mode to be continuous.
+*    4. Create the statistics reducer and start the monitor thread.
+*    5. Call the Start function to start the acquistion.
+*    6. Read the data in the EveryNCallback function and reduce it.
+*    7. Call the Clear Task function to clear the task.
+*    8. Display an error if any.
+*
+* I/O Connections Overview:
+*    Make sure your signal input terminals match the Physical
+*    Channel I/O Control. For further connection information, refer
+*    to your hardware reference manual.
+*
+*********************************************************************/
+
+#include <stdio.h>
+#include <NIDAQmx.h>
+#include "../Processing/ChanStats.h"
+#include "../Processing/StreamThread.h"
+#include "../Processing/StreamTime.h"
+
+#define DAQmxErrChk(functionCall) if( DAQmxFailed(error=(functionCall)) ) goto Error; else
+
+#define NUM_CHANS       2
+#define MIN_VOLTS       -10.0
+#define MAX_VOLTS       10.0
+#define RATE            10000.0
+#define BLOCK_SIZE      1000
+
+static ChanStats    *stats=NULL;
+static volatile int monitorRunning=0;
+
+int32 CVICALLBACK EveryNCallback(TaskHandle taskHandle, int32 everyNsamplesEventType, uInt32 nSamples, void *callbackData);
+int32 CVICALLBACK DoneCallback(TaskHandle taskHandle, int32 status, void *callbackData);
+
+static STREAM_THREAD_PROC(MonitorThread,arg)
+{
+    ChanStatsResult running,window;
+    int             c;
+
+    while( monitorRunning ) {
+        StreamSleep(0.5);
+        for(c=0;c<NUM_CHANS;++c) {
+            ChanStatsQuery(stats,c,&running,&window);
+            printf("ai%d: mean %+.4f rms %.4f [%+.3f %+.3f] clip %lld/%lld nan %lld | 1 s: mean %+.4f sd %.4f\n",
+                c,running.mean,running.rms,running.min,running.max,running.numClipLow,running.numClipHigh,
+                running.numNaN,window.mean,window.stdDev);
+        }
+    }
+    return 0;
+}
+
+int main(void)
+{
+    int32           error=0;
+    TaskHandle      taskHandle=0;
+    char            errBuff[2048]={'\0'};
+    StreamThread    monitor;
+
+    /*********************************************/
+    // Statistics Configure Code
+    /*********************************************/
+    // The window spans one second of blocks.
+    if( ChanStatsCreate(NUM_CHANS,MIN_VOLTS,MAX_VOLTS,(int)(RATE/BLOCK_SIZE),&stats)!=0 ) {
+        printf("Could not create the statistics reducer\n");
+        goto Error;
+    }
+
+    /*********************************************/
+    // DAQmx Configure Code
+    /*********************************************/
+    DAQmxErrChk (DAQmxCreateTask("",&taskHandle));
+    DAQmxErrChk (DAQmxCreateAIVoltageChan(taskHandle,"Dev1/ai0:1","",DAQmx_Val_Cfg_Default,MIN_VOLTS,MAX_VOLTS,DAQmx_Val_Volts,NULL));
+    DAQmxErrChk (DAQmxCfgSampClkTiming(taskHandle,"",RATE,DAQmx_Val_Rising,DAQmx_Val_ContSamps,BLOCK_SIZE));
+
+    DAQmxErrChk (DAQmxRegisterEveryNSamplesEvent(taskHandle,DAQmx_Val_Acquired_Into_Buffer,BLOCK_SIZE,0,EveryNCallback,NULL));
+    DAQmxErrChk (DAQmxRegisterDoneEvent(taskHandle,0,DoneCallback,NULL));
+
+    /*********************************************/
+    // DAQmx Start Code
+    /*********************************************/
+    DAQmxErrChk (DAQmxStartTask(taskHandle));
+
+    monitorRunning = 1;
+    if( StreamThreadCreate(&monitor,MonitorThread,NULL)!=0 )
+        monitorRunning = 0;
+
+    printf("Acquiring samples continuously. Press Enter to interrupt\n");
+    getchar();
+
+Error:
+    if( DAQmxFailed(error) )
+        DAQmxGetExtendedErrorInfo(errBuff,2048);
+    if( monitorRunning ) {
+        monitorRunning = 0;
+        StreamThreadJoin(monitor);
+    }
+    if( taskHandle!=0 ) {
+        /*********************************************/
+        // DAQmx Stop Code
+        /*********************************************/
+        DAQmxStopTask(taskHandle);
+        DAQmxClearTask(taskHandle);
+    }
+    ChanStatsClear(stats);
+    stats = NULL;
+    if( DAQmxFailed(error) )
+        printf("DAQmx Error: %s\n",errBuff);
+    printf("End of program, press Enter key to quit\n");
+    getchar();
+    return 0;
+}
+
+int32 CVICALLBACK EveryNCallback(TaskHandle taskHandle, int32 everyNsamplesEventType, uInt32 nSamples, void *callbackData)
+{
+    int32       error=0;
+    char        errBuff[2048]={'\0'};
+    int32       read=0;
+    float64     data[NUM_CHANS*BLOCK_SIZE];
+
+    /*********************************************/
+    // DAQmx Read Code
+    /*********************************************/
+    DAQmxErrChk (DAQmxReadAnalogF64(taskHandle,BLOCK_SIZE,10.0,DAQmx_Val_GroupByChannel,data,NUM_CHANS*BLOCK_SIZE,&read,NULL));
+    if( read>0 )
+        ChanStatsAddF64(stats,data,read,0);
+
+Error:
+    if( DAQmxFailed(error) ) {
+        DAQmxGetExtendedErrorInfo(errBuff,2048);
+        /*********************************************/
+        // DAQmx Stop Code
+        /*********************************************/
+        DAQmxStopTask(taskHandle);
+        DAQmxClearTask(taskHandle);
+        printf("DAQmx Error: %s\n",errBuff);
+    }
+    return 0;
+}
+
+int32 CVICALLBACK DoneCallback(TaskHandle taskHandle, int32 status, void *callbackData)
+{
+    int32   error=0;
+    char    errBuff[2048]={'\0'};
+
+    // Check to see if an error stopped the task.
+    DAQmxErrChk (status);
+
+Error:
+    if( DAQmxFailed(error) ) {
+        DAQmxGetExtendedErrorInfo(errBuff,2048);
+        DAQmxClearTask(taskHandle);
+        printf("DAQmx Error: %s\n",errBuff);
+    }
+    return 0;
+}
@@ -0,0 +1,175 @@
+/*********************************************************************
+*
+* ANSI C Example program:
+*    ContAcq-IntClk-Timestamps.c
+*
+* Example Category:
+*    AI
+*
+* Description:
+*    This example extends ContAcq-IntClk.c with timestamps for every
+*    sample. On entry to each EveryN callback the monotonic clock and
+*    the number of samples acquired so far are recorded. These points
+*    feed a running fit from sample index to time, which rejects
+*    callbacks that were held up. Any sample index can then be turned
+*    into a time, and any time into a sample index, to correlate the
+*    data with other tasks, devices or instruments.
+*
+*    For each block the time of its first sample is printed, together
+*    with the measured sample rate, its drift from the nominal rate
+*    against the computer's clock, the RMS scatter of the callback
+*    times and the number of rejected callbacks.
+*
+* Instructions for Running:
+*    1. Select the physical channel to correspond to where your
+*       signal is input on the DAQ device.
+*    2. Enter the minimum and maximum voltage range.
+*    3. Set the rate of the acquisition and the Samples per Channel
+*       control.
+*    4. Build this file together with ../Processing/SampleTimeMap.c.
+*
+* Steps:
+*    1. Create a task.
+*    2. Create an analog input voltage channel.
+*    3. Set the rate for the sample clock. Additionally, define the
+*       sample mode to be continuous.
+*    4. Create the sample time map.
+*    5. Call the Start function to start the acquistion.
+*    6. In the EveryNCallback function, note the time and the total
+*       number of samples acquired, add them to the map and read the
+*       data, until the stop button is pressed or an error occurs.
+*    7. Call the Clear Task function to clear the task.
+*    8. Display an error if any.
+*
+* I/O Connections Overview:
+*    Make sure your signal input terminal matches the Physical
+*    Channel I/O control. For further connection information, refer
+*    to your hardware reference manual.
+*
+*********************************************************************/
+
+#include <stdio.h>
+#include <NIDAQmx.h>
+#include "../Processing/SampleTimeMap.h"
+#include "../Processing/StreamTime.h"
+
+#define DAQmxErrChk(functionCall) if( DAQmxFailed(error=(functionCall)) ) goto Error; else
+
+#define RATE            10000.0
+#define BLOCK_SIZE      1000
+
+static SampleTimeMap    *timeMap=NULL;
+
+int32 CVICALLBACK EveryNCallback(TaskHandle taskHandle, int32 everyNsamplesEventType, uInt32 nSamples, void *callbackData);
+int32 CVICALLBACK DoneCallback(TaskHandle taskHandle, int32 status, void *callbackData);
+
+int main(void)
+{
+    int32               error=0;
+    TaskHandle          taskHandle=0;
+    char                errBuff[2048]={'\0'};
+    // Fit over about a minute of callbacks, reject those more than
+    // 4 sigma or 1 ms off the line, refit after 10 rejections in a row.
+    SampleTimeMapConfig config={RATE,(int)(60*RATE/BLOCK_SIZE),4.0,1e-3,10};
+
+    /*********************************************/
+    // Timestamp Configure Code
+    /*********************************************/
+    if( SampleTimeMapCreate(&config,&timeMap)!=0 ) {
+        printf("Could not create the sample time map\n");
+        goto Error;
+    }
+
+    /*********************************************/
+    // DAQmx Configure Code
+    /*********************************************/
+    DAQmxErrChk (DAQmxCreateTask("",&taskHandle));
+    DAQmxErrChk (DAQmxCreateAIVoltageChan(taskHandle,"Dev1/ai0","",DAQmx_Val_Cfg_Default,-10.0,10.0,DAQmx_Val_Volts,NULL));
+    DAQmxErrChk (DAQmxCfgSampClkTiming(taskHandle,"",RATE,DAQmx_Val_Rising,DAQmx_Val_ContSamps,BLOCK_SIZE));
+
+    DAQmxErrChk (DAQmxRegisterEveryNSamplesEvent(taskHandle,DAQmx_Val_Acquired_Into_Buffer,BLOCK_SIZE,0,EveryNCallback,NULL));
+    DAQmxErrChk (DAQmxRegisterDoneEvent(taskHandle,0,DoneCallback,NULL));
+
+    /*********************************************/
+    // DAQmx Start Code
+    /*********************************************/
+    DAQmxErrChk (DAQmxStartTask(taskHandle));
+
+    printf("Acquiring samples continuously. Press Enter to interrupt\n");
+    printf("First sample (s)\tRate (Hz)\tDrift (ppm)\tScatter (us)\tRejected\n");
+    getchar();
+
+Error:
+    if( DAQmxFailed(error) )
+        DAQmxGetExtendedErrorInfo(errBuff,2048);
+    if( taskHandle!=0 ) {
+        /*********************************************/
+        // DAQmx Stop Code
+        /*********************************************/
+        DAQmxStopTask(taskHandle);
+        DAQmxClearTask(taskHandle);
+    }
+    SampleTimeMapClear(timeMap);
+    if( DAQmxFailed(error) )
+        printf("DAQmx Error: %s\n",errBuff);
+    printf("End of program, press Enter key to quit\n");
+    getchar();
+    return 0;
+}
+
+int32 CVICALLBACK EveryNCallback(TaskHandle taskHandle, int32 everyNsamplesEventType, uInt32 nSamples, void *callbackData)
+{
+    int32                       error=0;
+    char                        errBuff[2048]={'\0'};
+    static uInt64               totalRead=0;
+    double                      now=StreamTimeNow();
+    uInt64                      acquired=0;
+    int32                       read=0;
+    float64                     data[BLOCK_SIZE];
+    SampleTimeMapDiagnostics    diag;
+
+    // now is taken on entry, as anything done before it adds to the scatter.
+    DAQmxErrChk (DAQmxGetReadTotalSampPerChanAcquired(taskHandle,&acquired));
+    SampleTimeMapAdd(timeMap,(long long)acquired,now);
+
+    /*********************************************/
+    // DAQmx Read Code
+    /*********************************************/
+    DAQmxErrChk (DAQmxReadAnalogF64(taskHandle,BLOCK_SIZE,10.0,DAQmx_Val_GroupByScanNumber,data,BLOCK_SIZE,&read,NULL));
+    if( read>0 ) {
+        SampleTimeMapGetDiagnostics(timeMap,&diag);
+        printf("%.6f\t%.4f\t%+.2f\t\t%.1f\t\t%lld\r",SampleTimeMapTime(timeMap,(double)totalRead),
+            diag.rate,diag.driftPPM,1e6*diag.rmsResidual,diag.rejected);
+        fflush(stdout);
+        totalRead += read;
+    }
+
+Error:
+    if( DAQmxFailed(error) ) {
+        DAQmxGetExtendedErrorInfo(errBuff,2048);
+        /*********************************************/
+        // DAQmx Stop Code
+        /*********************************************/
+        DAQmxStopTask(taskHandle);
+        DAQmxClearTask(taskHandle);
+        printf("DAQmx Error: %s\n",errBuff);
+    }
+    return 0;
+}
+
+int32 CVICALLBACK DoneCallback(TaskHandle taskHandle, int32 status, void *callbackData)
+{
+    int32   error=0;
+    char    errBuff[2048]={'\0'};
+
+    // Check to see if an error stopped the task.
+    DAQmxErrChk (status);
+
+Error:
+    if( DAQmxFailed(error) ) {
+        DAQmxGetExtendedErrorInfo(errBuff,2048);
+        DAQmxClearTask(taskHandle);
+        printf("DAQmx Error: %s\n",errBuff);
+    }
+    return 0;
+}
@@ -10,6 +10,11 @@
 *    This example demonstrates how to acquire a continuous amount of
 *    data using the DAQ device's internal clock.
 *
+*    The data is read with AIRecoveryRead, so that a buffer overflow
+*    does not end the acquisition. The read position is moved past
+*    the lost samples, or after an onboard overflow the task is
+*    restarted, and the number of samples lost is printed.
+*
 * Instructions for Running:
 *    1. Select the physical channel to correspond to where your
 *       signal is input on the DAQ device.
@@ -22,17 +27,20 @@
 *       plotted on the graph each time.
 *    Note: The rate should be at least twice as fast as the maximum
 *          frequency component of the signal being acquired.
+*    4. Build this file together with ../Tasks/AIRecovery.c.
 *
 * Steps:
 *    1. Create a task.
 *    2. Create an analog input voltage channel.
 *    3. Set the rate for the sample clock. Additionally, define the
 *       sample mode to be continuous.
-*    4. Call the Start function to start the acquistion.
-*    5. Read the data in the EveryNCallback function until the stop
-*       button is pressed or an error occurs.
-*    6. Call the Clear Task function to clear the task.
-*    7. Display an error if any.
+*    4. Create the overflow recovery for the task.
+*    5. Call the Start function to start the acquistion.
+*    6. Read the data in the EveryNCallback function until the stop
+*       button is pressed or an error occurs. Overflows are recovered
+*       from and reported as gaps.
+*    7. Call the Clear Task function to clear the task.
+*    8. Display an error if any.
 *
 * I/O Connections Overview:
 *    Make sure your signal input terminal matches the Physical
@@ -43,6 +51,7 @@
 
 #include <stdio.h>
 #include <NIDAQmx.h>
+#include "../Tasks/AIRecovery.h"
 
 #define DAQmxErrChk(functionCall) if( DAQmxFailed(error=(functionCall)) ) goto Error; else
 
@@ -51,9 +60,11 @@ int32 CVICALLBACK DoneCallback(TaskHandle taskHandle, int32 status, void *callba
 
 int main(void)
 {
-    int32       error=0;
-    TaskHandle  taskHandle=0;
-    char        errBuff[2048]={'\0'};
+    int32               error=0;
+    TaskHandle          taskHandle=0;
+    char                errBuff[2048]={'\0'};
+    AIRecoveryConfig    recoveryCfg={AIRecoveryResync,10000.0,0};
+    AIRecovery          *recovery=NULL;
 
     /*********************************************/
     // DAQmx Configure Code
@@ -62,8 +73,10 @@ int main(void)
     DAQmxErrChk (DAQmxCreateAIVoltageChan(taskHandle,"Dev1/ai0","",DAQmx_Val_Cfg_Default,-10.0,10.0,DAQmx_Val_Volts,NULL));
     DAQmxErrChk (DAQmxCfgSampClkTiming(taskHandle,"",10000.0,DAQmx_Val_Rising,DAQmx_Val_ContSamps,1000));
 
-    DAQmxErrChk (DAQmxRegisterEveryNSamplesEvent(taskHandle,DAQmx_Val_Acquired_Into_Buffer,1000,0,EveryNCallback,NULL));
-    DAQmxErrChk (DAQmxRegisterDoneEvent(taskHandle,0,DoneCallback,NULL));
+    DAQmxErrChk (AIRecoveryCreate(&taskHandle,1,&recoveryCfg,&recovery));
+
+    DAQmxErrChk (DAQmxRegisterEveryNSamplesEvent(taskHandle,DAQmx_Val_Acquired_Into_Buffer,1000,0,EveryNCallback,recovery));
+    DAQmxErrChk (DAQmxRegisterDoneEvent(taskHandle,0,DoneCallback,recovery));
 
     /*********************************************/
     // DAQmx Start Code
@@ -83,6 +96,7 @@ Error:
         DAQmxStopTask(taskHandle);
         DAQmxClearTask(taskHandle);
     }
+    AIRecoveryClear(recovery);
     if( DAQmxFailed(error) )
         printf("DAQmx Error: %s\n",errBuff);
     printf("End of program, press Enter key to quit\n");
@@ -92,16 +106,21 @@ Error:
 
 int32 CVICALLBACK EveryNCallback(TaskHandle taskHandle, int32 everyNsamplesEventType, uInt32 nSamples, void *callbackData)
 {
-    int32       error=0;
-    char        errBuff[2048]={'\0'};
-    static int  totalRead=0;
-    int32       read=0;
-    float64     data[1000];
+    int32           error=0;
+    char            errBuff[2048]={'\0'};
+    static int      totalRead=0;
+    int32           read=0;
+    float64         data[1000];
+    float64         *taskData[1]={data};
+    AIRecoveryGap   gap;
 
     /*********************************************/
     // DAQmx Read Code
     /*********************************************/
-    DAQmxErrChk (DAQmxReadAnalogF64(taskHandle,1000,10.0,DAQmx_Val_GroupByScanNumber,data,1000,&read,NULL));
+    DAQmxErrChk (AIRecoveryRead((AIRecovery*)callbackData,1000,10.0,taskData,1000,&read,&gap));
+    if( gap.numLost>0 )
+        printf("\nBuffer overflow: %s%llu samples lost from sample %llu\n",gap.exact ? "" : "about ",
+               (unsigned long long)gap.numLost,(unsigned long long)gap.firstSample);
     if( read>0 ) {
         printf("Acquired %d samples. Total %d\r",(int)read,(int)(totalRead+=read));
         fflush(stdout);
@@ -125,6 +144,10 @@ int32 CVICALLBACK DoneCallback(TaskHandle taskHandle, int32 status, void *callba
     int32   error=0;
     char    errBuff[2048]={'\0'};
 
+    // An onboard overflow stops the task. Start it again, unless the
+    // read in EveryNCallback already has.
+    if( AIRecoveryIsRecoverable(status) && !DAQmxFailed(AIRecoveryRestartTasks((AIRecovery*)callbackData,status,NULL)) )
+        return 0;
     // Check to see if an error stopped the task.
     DAQmxErrChk (status);
 
@@ -0,0 +1,263 @@
+/*********************************************************************
+*
+* ANSI C Example program:
+*    ContGen-IntClk-LiveParams.c
+*
+* Example Category:
+*    AO
+*
+* Description:
+*    This example demonstrates how to change the amplitude, frequency,
+*    offset and phase of a continuously generated sine wave without
+*    stopping the task. ContGen-ExtClk-DigStart.c writes one period
+*    once and lets the device regenerate it, so any change needs a
+*    restart.
+*
+*    Here regeneration is disabled. The output is rendered block by
+*    block in an EveryN callback, only a few blocks ahead of the
+*    hardware. The main thread acts as the control thread: it posts a
+*    scripted series of changes into the generator's lock-free queue.
+*    Each change takes effect at an exact sample, ramped if requested,
+*    and the phase stays continuous across frequency changes.
+*
+*    The post-to-output latency in samples of the ASAP changes is
+*    printed once they have all taken effect. It is bounded by the
+*    number of samples written ahead of the output,
+*    LEAD_BLOCKS*BLOCK_SIZE plus what the device FIFO holds. Requesting
+*    data only when the on-board memory is empty keeps the FIFO part
+*    small. Changes take effect in the order they are posted, so the
+*    change scheduled for an exact sample is posted last, and the
+*    sample it took effect at is printed once it has been output.
+*
+* Instructions for Running:
+*    1. Select the Physical Channel to correspond to where your
+*       signal is output on the DAQ device.
+*    2. Enter the Minimum and Maximum Voltage Ranges.
+*    3. Set the sample rate, the block size and the number of blocks
+*       written ahead of the output.
+*    4. Build this file together with ../Processing/ToneSynth.c.
+*
+* Steps:
+*    1. Create a task.
+*    2. Create an Analog Output Voltage Channel.
+*    3. Set the rate for the sample clock, the buffer size and the
+*       sample mode to be continuous. Disable regeneration.
+*    4. Register an EveryN callback that renders and writes one block
+*       each time a block has been transferred to the device.
+*    5. Write the first blocks and start the task.
+*    6. Post the parameter changes, reading the output position just
+*       before each one, and wait for them to take effect.
+*    7. Call the Clear Task function to clear the task.
+*    8. Display an error if any.
+*
+* I/O Connections Overview:
+*    Make sure your signal output terminal matches the Physical
+*    Channel I/O Control. For further connection information, refer
+*    to your hardware reference manual.
+*
+*********************************************************************/
+
+#include <stdio.h>
+#include <NIDAQmx.h>
+#include "../Processing/ToneSynth.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#define SleepMs(ms)     Sleep(ms)
+#else
+#include <unistd.h>
+#define SleepMs(ms)     usleep((ms)*1000)
+#endif
+
+#define DAQmxErrChk(functionCall) if( DAQmxFailed(error=(functionCall)) ) goto Error; else
+
+#define PI              3.1415926535
+#define RATE            10000.0
+#define BLOCK_SIZE      100
+#define LEAD_BLOCKS     4
+
+typedef struct ScriptStep {
+    int         delayMs;        // wait before posting
+    int         param;
+    double      value;
+    int         rampSamples;
+    int         atSecond;       // apply at this second of output, or -1 for ASAP
+} ScriptStep;
+
+// A scheduled change holds back every change posted after it, so the
+// ASAP changes come first.
+static const ScriptStep script[] = {
+    { 500, ToneSynthAmplitude,  5.0,   2000, -1 },
+    { 500, ToneSynthFrequency,  250.0, 0,    -1 },
+    { 500, ToneSynthOffset,     1.0,   500,  -1 },
+    { 500, ToneSynthPhase,      PI,    0,    -1 },
+    { 500, ToneSynthAmplitude,  2.0,   0,    -1 },
+    { 500, ToneSynthOffset,     0.0,   1000, -1 },
+    { 500, ToneSynthFrequency,  100.0, 0,    -1 },
+    { 0,   ToneSynthFrequency,  50.0,  5000, 6  },
+};
+
+#define NUM_STEPS       (int)(sizeof(script)/sizeof(script[0]))
+
+static ToneSynth    *synth=NULL;
+
+int32 CVICALLBACK EveryNCallback(TaskHandle taskHandle, int32 everyNsamplesEventType, uInt32 nSamples, void *callbackData);
+int32 CVICALLBACK DoneCallback(TaskHandle taskHandle, int32 status, void *callbackData);
+
+int main(void)
+{
+    int32               error=0;
+    TaskHandle          taskHandle=0;
+    float64             data[BLOCK_SIZE];
+    char                errBuff[2048]={'\0'};
+    uInt64              generated;
+    ToneSynthLatency    lat;
+    long long           stamp=0,applyAt=0;
+    int                 i,waitMs,timeoutMs,posted=0;
+
+    if( ToneSynthCreate(RATE,2.0,100.0,0.0,64,&synth)!=0 ) {
+        printf("Could not create the tone generator\n");
+        goto Error;
+    }
+
+    /*********************************************/
+    // DAQmx Configure Code
+    /*********************************************/
+    DAQmxErrChk (DAQmxCreateTask("",&taskHandle));
+    DAQmxErrChk (DAQmxCreateAOVoltageChan(taskHandle,"Dev1/ao0","",-10.0,10.0,DAQmx_Val_Volts,NULL));
+    DAQmxErrChk (DAQmxCfgSampClkTiming(taskHandle,"",RATE,DAQmx_Val_Rising,DAQmx_Val_ContSamps,LEAD_BLOCKS*BLOCK_SIZE));
+    DAQmxErrChk (DAQmxCfgOutputBuffer(taskHandle,LEAD_BLOCKS*BLOCK_SIZE));
+    DAQmxErrChk (DAQmxSetWriteRegenMode(taskHandle,DAQmx_Val_DoNotAllowRegen));
+    // Keep as little data as possible between the buffer and the DAC.
+    DAQmxErrChk (DAQmxSetAODataXferReqCond(taskHandle,"",DAQmx_Val_OnBrdMemEmpty));
+
+    DAQmxErrChk (DAQmxRegisterEveryNSamplesEvent(taskHandle,DAQmx_Val_Transferred_From_Buffer,BLOCK_SIZE,0,EveryNCallback,NULL));
+    DAQmxErrChk (DAQmxRegisterDoneEvent(taskHandle,0,DoneCallback,NULL));
+
+    /*********************************************/
+    // DAQmx Write Code
+    /*********************************************/
+    for(i=0;i<LEAD_BLOCKS;++i) {
+        ToneSynthRender(synth,data,BLOCK_SIZE);
+        DAQmxErrChk (DAQmxWriteAnalogF64(taskHandle,BLOCK_SIZE,0,10.0,DAQmx_Val_GroupByChannel,data,NULL,NULL));
+    }
+
+    /*********************************************/
+    // DAQmx Start Code
+    /*********************************************/
+    DAQmxErrChk (DAQmxStartTask(taskHandle));
+
+    printf("Generating voltage continuously and posting %d changes\n",NUM_STEPS);
+    for(i=0;i<NUM_STEPS;++i) {
+        const ScriptStep *step=&script[i];
+
+        SleepMs(step->delayMs);
+        if( step->atSecond>=0 && applyAt==0 ) {
+            // Wait for the ASAP changes before the first scheduled one.
+            for(waitMs=0;waitMs<1000;waitMs+=10) {
+                ToneSynthGetLatency(synth,&lat);
+                if( lat.count==posted )
+                    break;
+                SleepMs(10);
+            }
+            printf("Post to output latency over %lld ASAP changes (samples):\n",lat.count);
+            printf("Mean %.1f, min %lld, max %lld (%.1f ms)\n",lat.mean,lat.min,lat.max,1e3*lat.max/RATE);
+            printf("Samples written ahead of the output: %d\n",LEAD_BLOCKS*BLOCK_SIZE);
+        }
+        DAQmxErrChk (DAQmxGetWriteTotalSampPerChanGenerated(taskHandle,&generated));
+        ToneSynthSetOutputPosition(synth,(long long)generated);
+        if( ToneSynthPost(synth,step->param,step->value,step->atSecond<0 ? ToneSynthAsap : (long long)(step->atSecond*RATE),step->rampSamples)!=0 ) {
+            printf("Change %d could not be posted\n",i);
+            continue;
+        }
+        ++posted;
+        if( step->atSecond>=0 ) {
+            stamp = (long long)generated;
+            applyAt = (long long)(step->atSecond*RATE);
+        }
+    }
+
+    // Wait until the last change posted has been output, allowing one
+    // second beyond the scheduled sample.
+    timeoutMs = 1000;
+    if( applyAt>(long long)generated )
+        timeoutMs += (int)(1e3*(double)(applyAt-(long long)generated)/RATE);
+    for(waitMs=0;;waitMs+=10) {
+        SleepMs(10);
+        ToneSynthGetLatency(synth,&lat);
+        DAQmxErrChk (DAQmxGetWriteTotalSampPerChanGenerated(taskHandle,&generated));
+        if( lat.count>=posted && (long long)generated>=applyAt )
+            break;
+        if( waitMs>=timeoutMs ) {
+            printf("Only %lld of %d changes reached the output\n",lat.count,posted);
+            break;
+        }
+    }
+    if( applyAt>0 && lat.count>=posted )
+        printf("Scheduled change for sample %lld took effect at sample %lld\n",applyAt,stamp+lat.last);
+    printf("Press Enter to stop\n");
+    getchar();
+
+Error:
+    if( DAQmxFailed(error) )
+        DAQmxGetExtendedErrorInfo(errBuff,2048);
+    if( taskHandle!=0 ) {
+        /*********************************************/
+        // DAQmx Stop Code
+        /*********************************************/
+        DAQmxStopTask(taskHandle);
+        DAQmxClearTask(taskHandle);
+    }
+    ToneSynthClear(synth);
+    synth = NULL;
+    if( DAQmxFailed(error) )
+        printf("DAQmx Error: %s\n",errBuff);
+    printf("End of program, press Enter key to quit\n");
+    getchar();
+    return 0;
+}
+
+int32 CVICALLBACK EveryNCallback(TaskHandle taskHandle, int32 everyNsamplesEventType, uInt32 nSamples, void *callbackData)
+{
+    int32       error=0;
+    char        errBuff[2048]={'\0'};
+    float64     data[BLOCK_SIZE];
+
+    // One block has left the buffer. Render its replacement as late as
+    // possible so that posted changes reach the output quickly.
+    ToneSynthRender(synth,data,BLOCK_SIZE);
+
+    /*********************************************/
+    // DAQmx Write Code
+    /*********************************************/
+    DAQmxErrChk (DAQmxWriteAnalogF64(taskHandle,BLOCK_SIZE,0,10.0,DAQmx_Val_GroupByChannel,data,NULL,NULL));
+
+Error:
+    if( DAQmxFailed(error) ) {
+        DAQmxGetExtendedErrorInfo(errBuff,2048);
+        /*********************************************/
+        // DAQmx Stop Code
+        /*********************************************/
+        DAQmxStopTask(taskHandle);
+        DAQmxClearTask(taskHandle);
+        printf("DAQmx Error: %s\n",errBuff);
+    }
+    return 0;
+}
+
+int32 CVICALLBACK DoneCallback(TaskHandle taskHandle, int32 status, void *callbackData)
+{
+    int32   error=0;
+    char    errBuff[2048]={'\0'};
+
+    // Check to see if an error stopped the task.
+    DAQmxErrChk (status);
+
+Error:
+    if( DAQmxFailed(error) ) {
+        DAQmxGetExtendedErrorInfo(errBuff,2048);
+        DAQmxClearTask(taskHandle);
+        printf("DAQmx Error: %s\n",errBuff);
+    }
+    return 0;
+}
@@ -0,0 +1,141 @@
+/*********************************************************************
+*
+* ANSI C Example program:
+*    MultVoltUpdates-IntClk-Cached.c
+*
+* Example Category:
+*    AO
+*
+* Description:
+*    This example demonstrates how to output a finite waveform that is
+*    kept in a persistent cache on disk instead of being computed at
+*    every start, as MultVoltUpdates-IntClk.c computes its ramp.
+*
+*    The waveform is described by its generator, parameters, rate
+*    and channel layout. The first run generates it into a file in
+*    CACHE_DIR. Later runs with the same description map that file
+*    and pass the mapped samples straight to the write, so the
+*    startup time no longer depends on how long the waveform takes to
+*    compute. The time to get the waveform, and whether it came from
+*    the cache, is printed.
+*
+* Instructions for Running:
+*    1. Select the Physical Channel to correspond to where your
+*       signal is output on the DAQ device.
+*    2. Enter the Minimum and Maximum Voltage Ranges.
+*    3. Set CACHE_DIR to an existing directory and CACHE_BYTES to the
+*       disk space the cache may use.
+*    4. Build this file together with ../Processing/WaveformCache.c.
+*
+* Steps:
+*    1. Open the waveform cache and get the waveform from it.
+*    2. Create a task.
+*    3. Create an Analog Output Voltage Channel.
+*    4. Setup the Timing for the generation, with as many samples as
+*       the waveform holds.
+*    5. Write the mapped waveform and start the task.
+*    6. Wait until the task is done, then call the Clear Task
+*       function to clear the Task.
+*    7. Release the waveform and close the cache.
+*    8. Display an error if any.
+*
+* I/O Connections Overview:
+*    Make sure your signal output terminal matches the Physical
+*    Channel I/O Control. For further connection information, refer
+*    to your hardware reference manual.
+*
+*********************************************************************/
+
+#include <stdio.h>
+#include <math.h>
+#include <NIDAQmx.h>
+#include "../Processing/WaveformCache.h"
+#include "../Processing/StreamTime.h"
+
+#define DAQmxErrChk(functionCall) if( DAQmxFailed(error=(functionCall)) ) goto Error; else
+
+#define CACHE_DIR       "."
+#define CACHE_BYTES     (1LL<<30)
+
+typedef struct RampParams {
+    double      amplitude;
+    double      period;         // s
+} RampParams;
+
+// The rate, the number of channels and the layout are part of the
+// cache key, so a generator must honour every one of them.
+static int GenRamp(const void *params, double rate, int numChans, int numSampsPerChan, int layout, double data[])
+{
+    const RampParams    *p=(const RampParams*)params;
+    int                 c,i;
+
+    if( rate<=0.0 || p->period<=0.0 )
+        return -1;
+    for(c=0;c<numChans;++c)
+        for(i=0;i<numSampsPerChan;++i)
+            data[layout==WaveformCacheGroupByChannel ? (size_t)c*numSampsPerChan+i : (size_t)i*numChans+c] =
+                p->amplitude*fmod((double)i/rate,p->period)/p->period;
+    return 0;
+}
+
+int main(void)
+{
+    int             error=0;
+    TaskHandle      taskHandle=0;
+    WaveformCache   *cache=NULL;
+    WaveformMap     wave={0};
+    RampParams      ramp={5.0,4.0};
+    WaveformSpec    spec={"ramp",GenRamp,&ramp,sizeof(ramp),1000.0,1,4000,WaveformCacheGroupByChannel};
+    char            errBuff[2048]={'\0'};
+    int32           written;
+    double          t0;
+
+    t0 = StreamTimeNow();
+    if( WaveformCacheCreate(CACHE_DIR,CACHE_BYTES,&cache)!=0 || WaveformCacheGet(cache,&spec,&wave)!=0 ) {
+        printf("Could not get the waveform from the cache in %s\n",CACHE_DIR);
+        goto Error;
+    }
+    printf("Waveform %016llx %s in %.3f ms\n",wave.key,wave.hit ? "mapped from the cache" : "generated",1e3*(StreamTimeNow()-t0));
+
+    /*********************************************/
+    // DAQmx Configure Code
+    /*********************************************/
+    DAQmxErrChk (DAQmxCreateTask("",&taskHandle));
+    DAQmxErrChk (DAQmxCreateAOVoltageChan(taskHandle,"Dev1/ao0","",-10.0,10.0,DAQmx_Val_Volts,NULL));
+    DAQmxErrChk (DAQmxCfgSampClkTiming(taskHandle,"",spec.rate,DAQmx_Val_Rising,DAQmx_Val_FiniteSamps,wave.numSampsPerChan));
+
+    /*********************************************/
+    // DAQmx Write Code
+    /*********************************************/
+    DAQmxErrChk (DAQmxWriteAnalogF64(taskHandle,wave.numSampsPerChan,0,10.0,wave.layout,wave.data,&written,NULL));
+
+    /*********************************************/
+    // DAQmx Start Code
+    /*********************************************/
+    DAQmxErrChk (DAQmxStartTask(taskHandle));
+
+    /*********************************************/
+    // DAQmx Wait Code
+    /*********************************************/
+    DAQmxErrChk (DAQmxWaitUntilTaskDone(taskHandle,10.0));
+
+Error:
+    if( DAQmxFailed(error) )
+        DAQmxGetExtendedErrorInfo(errBuff,2048);
+    if( taskHandle!=0 ) {
+        /*********************************************/
+        // DAQmx Stop Code
+        /*********************************************/
+        DAQmxStopTask(taskHandle);
+        DAQmxClearTask(taskHandle);
+    }
+    if( cache ) {
+        WaveformCacheRelease(cache,&wave);
+        WaveformCacheClear(cache);
+    }
+    if( DAQmxFailed(error) )
+        printf("DAQmx Error: %s\n",errBuff);
+    printf("End of program, press Enter key to quit\n");
+    getchar();
+    return 0;
+}
@@ -0,0 +1,131 @@
+/*********************************************************************
+*
+* ANSI C Example program:
+*    MultVoltUpdates-IntClk-Retrig-Pool.c
+*
+* Example Category:
+*    AO
+*
+* Description:
+*    This example extends MultVoltUpdates-IntClk-Retrig.c to
+*    stimulus protocols that switch between waveforms many times per
+*    second. Rather than building a new task from DAQmxCreateTask for
+*    every waveform, tasks are taken from a pool that keeps them
+*    configured and committed. Switching waveform then only rewrites
+*    the output buffer and starts the task.
+*
+*    The protocol alternates between three waveforms at one rate and
+*    now and then plays a waveform at a second rate. The second rate
+*    needs a differently configured task on the same device. At the
+*    end the check out to start latency is printed for warm
+*    (committed), recommitted and cold (newly created) tasks.
+*
+* Instructions for Running:
+*    1. Select the Physical Channel to correspond to where your
+*       signal is output on the DAQ device.
+*    2. Enter the Minimum and Maximum Voltage Ranges.
+*    3. Select the Digital Trigger Source.
+*    4. Build this file together with ../Tasks/TaskPool.c.
+*
+* Steps:
+*    1. Create a task pool.
+*    2. For each protocol step check out a task for the step's
+*       configuration. The first check out of a configuration creates,
+*       configures and commits the task.
+*    3. Write the step's waveform and start the task.
+*    4. Let the waveform play, then check the task back in, which
+*       stops it but leaves it committed.
+*    5. Clear the pool, which clears all tasks.
+*    6. Display an error if any.
+*
+* I/O Connections Overview:
+*    Make sure your signal output terminal matches the Physical
+*    Channel I/O Control. For further connection information, refer
+*    to your hardware reference manual.
+*
+*********************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <NIDAQmx.h>
+#include "../Tasks/TaskPool.h"
+
+#define DAQmxErrChk(functionCall) if( DAQmxFailed(error=(functionCall)) ) goto Error; else
+
+#define PI              3.1415926535
+#define NUM_SAMPS       4000
+#define NUM_STEPS       300
+
+int main(void)
+{
+    int32           error=0;
+    char            errBuff[2048]={'\0'};
+    TaskPool        *pool=NULL;
+    TaskPoolEntry   *entry=NULL;
+    TaskPoolConfig  cfg[2];
+    TaskPoolLatency lat;
+    static float64  waveforms[3][NUM_SAMPS];
+    const char      *pathNames[TaskPoolNumPaths]={"Warm","Recommit","Cold"};
+    int             i,step,path;
+
+    for(i=0;i<NUM_SAMPS;i++) {
+        waveforms[0][i] = 5.0*(double)i/NUM_SAMPS;
+        waveforms[1][i] = 5.0*sin(2.0*PI*i/NUM_SAMPS);
+        waveforms[2][i] = 5.0*(1.0-fabs(2.0*i/NUM_SAMPS-1.0));
+    }
+
+    // Two configurations that differ only in sample rate.
+    memset(cfg,0,sizeof(cfg));
+    strcpy(cfg[0].physicalChannel,"Dev1/ao0");
+    cfg[0].minVal = -10.0;
+    cfg[0].maxVal = 10.0;
+    cfg[0].rate = 100000.0;
+    cfg[0].sampsPerChan = NUM_SAMPS;
+    strcpy(cfg[0].triggerSource,"/Dev1/PFI0");
+    cfg[0].triggerEdge = DAQmx_Val_Rising;
+    cfg[0].retriggerable = 1;
+    cfg[1] = cfg[0];
+    cfg[1].rate = 50000.0;
+
+    if( TaskPoolCreate(4,&pool)!=0 ) {
+        printf("Could not create the task pool\n");
+        goto Error;
+    }
+
+    printf("Running %d protocol steps\n",NUM_STEPS);
+    for(step=0;step<NUM_STEPS;++step) {
+        int config=(step%50==49) ? 1 : 0;
+
+        DAQmxErrChk (TaskPoolCheckOut(pool,&cfg[config],&entry));
+        DAQmxErrChk (TaskPoolWriteAndStart(entry,waveforms[step%3]));
+
+        // In a real protocol the stimulus would be triggered here. The
+        // retriggerable task replays the waveform on every PFI0 edge.
+
+        DAQmxErrChk (TaskPoolCheckIn(pool,entry));
+        entry = NULL;
+    }
+
+    printf("Path\t\tCount\tMean (us)\tMin (us)\tMax (us)\n");
+    for(path=0;path<TaskPoolNumPaths;++path) {
+        TaskPoolGetLatency(pool,path,&lat);
+        printf("%s\t\t%lld\t%.1f\t\t%.1f\t\t%.1f\n",pathNames[path],lat.count,
+            lat.count ? 1e6*lat.total/lat.count : 0.0,1e6*lat.min,1e6*lat.max);
+    }
+
+Error:
+    if( DAQmxFailed(error) )
+        DAQmxGetExtendedErrorInfo(errBuff,2048);
+    if( entry )
+        TaskPoolCheckIn(pool,entry);
+    /*********************************************/
+    // DAQmx Stop Code
+    /*********************************************/
+    TaskPoolClear(pool);
+    if( DAQmxFailed(error) )
+        printf("DAQmx Error: %s\n",errBuff);
+    printf("End of program, press Enter key to quit\n");
+    getchar();
+    return 0;
+}
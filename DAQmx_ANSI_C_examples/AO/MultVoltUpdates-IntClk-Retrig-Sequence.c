@@ -0,0 +1,159 @@
+/*********************************************************************
+*
+* ANSI C Example program:
+*    MultVoltUpdates-IntClk-Retrig-Sequence.c
+*
+* Example Category:
+*    AO
+*
+* Description:
+*    This example extends MultVoltUpdates-IntClk-Retrig.c so that
+*    each trigger plays the next waveform segment of a sequence rather
+*    than the same buffer again. The task is never stopped between
+*    segments.
+*
+*    A retriggerable counter produces one segment's worth of sample
+*    clocks per PFI0 edge and clocks a continuous AO task. The output
+*    buffer is refilled one segment at a time as segments are
+*    transferred to the device. Four segments of different shape and
+*    length are played in the order 0 1 2 1 3, repeated.
+*
+*    Every second the sustained segments/s, the number of late
+*    segments and the shortest interval between two segments are
+*    printed. The shortest interval cannot be below the segment
+*    duration.
+*
+* Instructions for Running:
+*    1. Select the Physical Channel to correspond to where your
+*       signal is output on the DAQ device.
+*    2. Enter the Minimum and Maximum Voltage Ranges.
+*    3. Select the counter used as the sample clock and its internal
+*       output terminal.
+*    4. Select the Digital Trigger Source.
+*    5. Build this file together with ../Tasks/AOSequencer.c.
+*
+* Steps:
+*    1. Build the waveform segments.
+*    2. Create the sequencer. This creates the counter and AO tasks
+*       and configures the AO task not to regenerate.
+*    3. Register the segments and the sequence order.
+*    4. Start the sequencer. This fills the output buffer with the
+*       first segments and starts the AO task, then the counter.
+*    5. Print the statistics until the user presses Enter.
+*    6. Stop and clear the sequencer.
+*    7. Display an error if any.
+*
+* I/O Connections Overview:
+*    Make sure your signal output terminal matches the Physical
+*    Channel I/O Control, and connect the trigger to PFI0. For further
+*    connection information, refer to your hardware reference manual.
+*
+*********************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <NIDAQmx.h>
+#include "../Tasks/AOSequencer.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#include <conio.h>
+#define SleepMs(ms)     Sleep(ms)
+#define KeyPressed()    _kbhit()
+#else
+#include <unistd.h>
+#include <sys/select.h>
+#define SleepMs(ms)     usleep((ms)*1000)
+static int KeyPressed(void)
+{
+    struct timeval  tv={0,0};
+    fd_set          fds;
+
+    FD_ZERO(&fds);
+    FD_SET(0,&fds);
+    return select(1,&fds,NULL,NULL,&tv)>0;
+}
+#endif
+
+#define DAQmxErrChk(functionCall) if( DAQmxFailed(error=(functionCall)) ) goto Error; else
+
+#define PI              3.1415926535
+#define SEG_LEN         1000
+#define NUM_SEGMENTS    4
+
+int main(void)
+{
+    int32               error=0;
+    char                errBuff[2048]={'\0'};
+    AOSequencer         *seq=NULL;
+    AOSequencerConfig   cfg;
+    AOSequencerStats    stats;
+    static float64      ramp[SEG_LEN],sine[SEG_LEN],pulse[SEG_LEN/2],chirp[SEG_LEN];
+    const float64       *segments[NUM_SEGMENTS]={ramp,sine,pulse,chirp};
+    const int           lengths[NUM_SEGMENTS]={SEG_LEN,SEG_LEN,SEG_LEN/2,SEG_LEN};
+    const int           order[]={0,1,2,1,3};
+    int                 i;
+
+    for(i=0;i<SEG_LEN;i++) {
+        double x=(double)i/SEG_LEN;
+
+        ramp[i] = 5.0*x;
+        sine[i] = 5.0*sin(2.0*PI*4.0*x);
+        chirp[i] = 5.0*sin(2.0*PI*(2.0+10.0*x)*x);
+    }
+    // Shorter than the others; the sequencer holds its last value.
+    for(i=0;i<SEG_LEN/2;i++)
+        pulse[i] = (i>=SEG_LEN/8 && i<3*SEG_LEN/8) ? 5.0 : 0.0;
+
+    memset(&cfg,0,sizeof(cfg));
+    strcpy(cfg.aoChannels,"Dev1/ao0");
+    cfg.minVal = -10.0;
+    cfg.maxVal = 10.0;
+    strcpy(cfg.counter,"Dev1/ctr0");
+    strcpy(cfg.counterOutput,"/Dev1/Ctr0InternalOutput");
+    strcpy(cfg.triggerSource,"/Dev1/PFI0");
+    cfg.rate = 100000.0;
+    cfg.segmentLength = SEG_LEN;
+    cfg.bufferSegments = 8;
+    cfg.prefetchSegments = 4;
+
+    /*********************************************/
+    // DAQmx Configure Code
+    /*********************************************/
+    DAQmxErrChk (AOSequencerCreate(&cfg,&seq));
+    DAQmxErrChk (AOSequencerSetSegments(seq,segments,lengths,NUM_SEGMENTS));
+    DAQmxErrChk (AOSequencerSetSequence(seq,order,sizeof(order)/sizeof(order[0]),1));
+
+    /*********************************************/
+    // DAQmx Start Code
+    /*********************************************/
+    DAQmxErrChk (AOSequencerStart(seq));
+
+    printf("Generating segments on every trigger. Press Enter to stop.\n");
+    printf("Written\tPlayed\tLate\tSegments/s\tMin interval (ms)\n");
+    while( !KeyPressed() ) {
+        SleepMs(1000);
+        AOSequencerGetStats(seq,&stats);
+        printf("%lld\t%lld\t%lld\t%.1f\t\t%.3f\n",stats.segmentsWritten,stats.segmentsPlayed,
+            stats.lateSegments,stats.segmentsPerSec,1e3*stats.minInterval);
+    }
+    getchar();
+    AOSequencerGetStats(seq,&stats);
+    printf("Segment duration %.3f ms\n",1e3*stats.segmentDuration);
+
+    /*********************************************/
+    // DAQmx Stop Code
+    /*********************************************/
+    DAQmxErrChk (AOSequencerStop(seq));
+
+Error:
+    if( DAQmxFailed(error) )
+        DAQmxGetExtendedErrorInfo(errBuff,2048);
+    AOSequencerClear(seq);
+    if( DAQmxFailed(error) )
+        printf("DAQmx Error: %s\n",errBuff);
+    printf("End of program, press Enter key to quit\n");
+    getchar();
+    return 0;
+}
@@ -0,0 +1,166 @@
+/*********************************************************************
+*
+* ANSI C Example program:
+*    DigPulseTrain-Sched.c
+*
+* Example Category:
+*    CO
+*
+* Description:
+*    This example demonstrates how to generate a long train of pulses
+*    in which every pulse has its own high and low time, for example
+*    to gate a laser at variable intervals. DigPulse.c generates one
+*    pulse from fixed parameters, so a train of different pulses
+*    would need a task restart per pulse.
+*
+*    Here the counter uses buffered implicit timing and the pulses
+*    are streamed to it as tick counts from a producer thread. The
+*    schedule is a 5 us gate repeated at intervals that sweep from
+*    20 us to 200 us and back. At the end the quantisation error and
+*    the sustained pulses/s are printed. For comparison a short train
+*    is then generated the way DigPulse.c would, with one start and
+*    stop per pulse.
+*
+* Instructions for Running:
+*    1. Select the Physical Channel which corresponds to the counter
+*       you want to output your signal to on the DAQ device.
+*    2. Select the timebase that the pulse ticks count.
+*    3. Build this file together with ../Tasks/PulseScheduler.c and
+*       ../Processing/PulseTicks.c.
+*
+* Steps:
+*    1. Create the scheduler. This creates a Counter Output channel in
+*       terms of ticks with buffered, finite implicit timing and
+*       disables regeneration.
+*    2. Start the scheduler. This writes the first blocks of pulses
+*       and starts the task. The producer thread writes the rest.
+*    3. Wait until the last pulse has been generated.
+*    4. Print the statistics and clear the scheduler.
+*    5. Generate a short train with one task start per pulse and
+*       print its rate.
+*    6. Display an error if any.
+*
+* I/O Connections Overview:
+*    The counter will output the pulses on the output terminal of the
+*    counter specified in the Physical Channel I/O control.
+*
+*********************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+#include <NIDAQmx.h>
+#include "../Tasks/PulseScheduler.h"
+#include "../Processing/StreamTime.h"
+
+#define DAQmxErrChk(functionCall) if( DAQmxFailed(error=(functionCall)) ) goto Error; else
+
+#define NUM_PULSES      200000
+#define GATE_TIME       5e-6
+#define MIN_INTERVAL    20e-6
+#define MAX_INTERVAL    200e-6
+#define SWEEP_PULSES    1000
+#define ONE_SHOT_PULSES 200
+
+typedef struct Sweep {
+	long long	next;
+} Sweep;
+
+static int SweepSource(double highTime[], double lowTime[], int maxPulses, void *sourceData);
+
+int main(void)
+{
+	char					errBuff[2048]={'\0'};
+	TaskHandle				taskHandle=0;
+	int32					error=0;
+	PulseScheduler			*scheduler=NULL;
+	PulseSchedulerConfig	cfg;
+	PulseSchedulerStats		stats;
+	Sweep					sweep={0};
+	double					t0,oneShotRate;
+	int						i;
+
+	memset(&cfg,0,sizeof(cfg));
+	strcpy(cfg.counter,"Dev1/ctr0");
+	strcpy(cfg.timebase,"/Dev1/100MHzTimebase");
+	cfg.timebaseRate = 100e6;
+	cfg.idleState = DAQmx_Val_Low;
+	cfg.totalPulses = NUM_PULSES;
+	cfg.blockSize = 2000;
+	cfg.bufferBlocks = 4;
+
+	/*********************************************/
+	// DAQmx Configure Code
+	/*********************************************/
+	DAQmxErrChk (PulseSchedulerCreate(&cfg,SweepSource,&sweep,&scheduler));
+
+	/*********************************************/
+	// DAQmx Start Code
+	/*********************************************/
+	DAQmxErrChk (PulseSchedulerStart(scheduler));
+
+	/*********************************************/
+	// DAQmx Wait Code
+	/*********************************************/
+	DAQmxErrChk (PulseSchedulerWait(scheduler,60.0));
+
+	PulseSchedulerGetStats(scheduler,&stats);
+	printf("Buffered schedule: %lld pulses at %.0f pulses/s\n",stats.pulsesGenerated,stats.pulsesPerSec);
+	printf("Edge error: max %.2f ns, RMS %.2f ns. Interval error: max %.2f ns. Clamped: %lld\n",
+		1e9*stats.quantisation.maxEdgeError,1e9*stats.quantisation.rmsEdgeError,
+		1e9*stats.quantisation.maxIntervalError,stats.quantisation.numClamped);
+	PulseSchedulerClear(scheduler);
+	scheduler = NULL;
+
+	/*********************************************/
+	// One start per pulse, as in DigPulse.c
+	/*********************************************/
+	DAQmxErrChk (DAQmxCreateTask("",&taskHandle));
+	DAQmxErrChk (DAQmxCreateCOPulseChanTime(taskHandle,"Dev1/ctr0","",DAQmx_Val_Seconds,DAQmx_Val_Low,0.0,MIN_INTERVAL,GATE_TIME));
+	sweep.next = 0;
+	t0 = StreamTimeNow();
+	for(i=0;i<ONE_SHOT_PULSES;++i) {
+		double high,low;
+
+		SweepSource(&high,&low,1,&sweep);
+		DAQmxErrChk (DAQmxSetCOPulseHighTime(taskHandle,"",high));
+		DAQmxErrChk (DAQmxSetCOPulseLowTime(taskHandle,"",low));
+		DAQmxErrChk (DAQmxStartTask(taskHandle));
+		DAQmxErrChk (DAQmxWaitUntilTaskDone(taskHandle,10.0));
+		DAQmxErrChk (DAQmxStopTask(taskHandle));
+	}
+	oneShotRate = ONE_SHOT_PULSES/(StreamTimeNow()-t0);
+	printf("One start per pulse: %d pulses at %.0f pulses/s\n",ONE_SHOT_PULSES,oneShotRate);
+
+Error:
+	if( DAQmxFailed(error) )
+		DAQmxGetExtendedErrorInfo(errBuff,2048);
+	PulseSchedulerClear(scheduler);
+	if( taskHandle!=0 ) {
+		/*********************************************/
+		// DAQmx Stop Code
+		/*********************************************/
+		DAQmxStopTask(taskHandle);
+		DAQmxClearTask(taskHandle);
+	}
+	if( DAQmxFailed(error) )
+		printf("DAQmx Error: %s\n",errBuff);
+	printf("End of program, press Enter key to quit\n");
+	getchar();
+	return 0;
+}
+
+// Fixed gate time, with the low time sweeping linearly up and down.
+static int SweepSource(double highTime[], double lowTime[], int maxPulses, void *sourceData)
+{
+	Sweep	*s=(Sweep*)sourceData;
+	int		i;
+
+	for(i=0;i<maxPulses;++i,++s->next) {
+		long long	k=s->next%(2*SWEEP_PULSES);
+		double		x=(k<SWEEP_PULSES ? k : 2*SWEEP_PULSES-k)/(double)SWEEP_PULSES;
+
+		highTime[i] = GATE_TIME;
+		lowTime[i] = MIN_INTERVAL+x*(MAX_INTERVAL-MIN_INTERVAL)-GATE_TIME;
+	}
+	return maxPulses;
+}
@@ -13,6 +13,12 @@
 *    S Series, M Series, and DSA), to simultaneously acquire the
 *    data.
 *
+*    Both devices are read with AIRecoveryRead. After a buffer
+*    overflow the read positions of both are moved to the same newest
+*    sample, or after an onboard overflow both tasks are restarted,
+*    the slave before the master, so the data stays aligned. The
+*    number of samples lost is printed.
+*
 * Instructions for Running:
 *    1. Select the physical channel to correspond to where your
 *       signal is input on the DAQ device.
@@ -25,6 +31,8 @@
 *    4. Set the number of samples to acquire per channel.
 *    5. Choose which type of devices you are trying to synchronize.
 *       This will select the correct synchronization method to use.
+*    6. Build this file together with Tasks/DevTopology.c and
+*       Tasks/AIRecovery.c.
 *
 * Steps:
 *    1. Create a task.
@@ -36,21 +44,24 @@
 *       use different values for each device.
 *    4. The synchronization method chosen depends on what type of
 *       device you are using.
-*    5. Call the Get Terminal Name with Device Prefix utility
-*       function. This will take a Task and a terminal and create a
+*    5. Call the DevTopologyChannelTerminal function. This will
+*       take a physical channel and a terminal and look up a
 *       properly formatted device + terminal name to use as the
-*       source of the Slaves Trigger. For the Slave, set the Source
-*       for the trigger to the ai/StartTrigger of the Master Device.
+*       source of the Slaves Trigger. For the Slave, set the
+*       Source for the trigger to the ai/StartTrigger of the
+*       Master Device.
 *       This will ensure both devices start sampling at the same
 *       time. (Note: The trigger is automatically routed through the
 *       RTSI cable.)
-*    6. Call the Start function to start the acquisition.
-*    7. Read all of the data continuously. The 'Samples per Channel'
+*    6. Create the overflow recovery for the Master and Slave tasks.
+*    7. Call the Start function to start the acquisition.
+*    8. Read all of the data continuously. The 'Samples per Channel'
 *       control will specify how many samples per channel are read
-*       each time. If either device reports an error or the user
-*       presses the 'Stop' button, the acquisition will stop.
-*    8. Call the Clear Task function to clear the task.
-*    9. Display an error if any.
+*       each time. Overflows are recovered from and reported as gaps.
+*       If either device reports another error or the user presses
+*       the 'Stop' button, the acquisition will stop.
+*    9. Call the Clear Task function to clear the task.
+*    10. Display an error if any.
 *
 * I/O Connections Overview:
 *    Make sure your signal input terminal matches the Physical
@@ -67,13 +78,18 @@
 #include <string.h>
 #include <stdio.h>
 #include <NIDAQmx.h>
+#include "Tasks/DevTopology.h"
+#include "Tasks/AIRecovery.h"
 
 static TaskHandle masterTaskHandle=0,slaveTaskHandle=0;
 
 
 #define DAQmxErrChk(functionCall) if( DAQmxFailed(error=(functionCall)) ) goto Error; else
 
-static int32 GetTerminalNameWithDevPrefix(TaskHandle taskHandle, const char terminalName[], char triggerName[]);
+// The master's triggers and clocks are looked up from MASTER_CHAN, so
+// the channel is named in one place.
+#define MASTER_CHAN     "Dev1/ai0"
+#define SLAVE_CHAN      "Dev10/ai0"
 
 int32 CVICALLBACK EveryNCallback(TaskHandle taskHandle, int32 everyNsamplesEventType, uInt32 nSamples, void *callbackData);
 int32 CVICALLBACK DoneCallback(TaskHandle taskHandle, int32 status, void *callbackData);
@@ -84,6 +100,9 @@ int main(void)
     char        errBuff[2048]={'\0'};
     char        str1[256],str2[256],trigName[256];
     float64     clkRate;
+    TaskHandle  tasks[2];
+    AIRecoveryConfig recoveryCfg={AIRecoveryResync,10000.0,0};
+    AIRecovery  *recovery=NULL;
     // synchType indicates what device family the devices you are synching belong to:
     // 0 : E series
     // 1 : M series (PCI)
@@ -96,10 +115,10 @@ int main(void)
     // DAQmx Configure Code
     /*********************************************/
     DAQmxErrChk (DAQmxCreateTask("",&masterTaskHandle));
-    DAQmxErrChk (DAQmxCreateAIVoltageChan(masterTaskHandle,"Dev1/ai0","",DAQmx_Val_Cfg_Default,-10.0,10.0,DAQmx_Val_Volts,NULL));
+    DAQmxErrChk (DAQmxCreateAIVoltageChan(masterTaskHandle,MASTER_CHAN,"",DAQmx_Val_Cfg_Default,-10.0,10.0,DAQmx_Val_Volts,NULL));
     DAQmxErrChk (DAQmxCfgSampClkTiming(masterTaskHandle,"",10000.0,DAQmx_Val_Rising,DAQmx_Val_ContSamps,1000));
     DAQmxErrChk (DAQmxCreateTask("",&slaveTaskHandle));
-    DAQmxErrChk (DAQmxCreateAIVoltageChan(slaveTaskHandle,"Dev10/ai0","",DAQmx_Val_Cfg_Default,-10.0,10.0,DAQmx_Val_Volts,NULL));
+    DAQmxErrChk (DAQmxCreateAIVoltageChan(slaveTaskHandle,SLAVE_CHAN,"",DAQmx_Val_Cfg_Default,-10.0,10.0,DAQmx_Val_Volts,NULL));
     DAQmxErrChk (DAQmxCfgSampClkTiming(slaveTaskHandle,"",10000.0,DAQmx_Val_Rising,DAQmx_Val_ContSamps,1000));
     switch( synchType ) {
         case 0: // E & S Series Sharing Master Timebase
@@ -127,8 +146,8 @@ int main(void)
             break;
         case 3: // DSA Sharing Sample Clock
             // Note:  If you are using PXI DSA Devices, the master device must reside in PXI Slot 2.
-            DAQmxErrChk (GetTerminalNameWithDevPrefix(masterTaskHandle,"SampleClockTimebase",str1));
-            DAQmxErrChk (GetTerminalNameWithDevPrefix(masterTaskHandle,"SyncPulse",str2));
+            DAQmxErrChk (DevTopologyChannelTerminal(MASTER_CHAN,"SampleClockTimebase",str1,sizeof(str1)));
+            DAQmxErrChk (DevTopologyChannelTerminal(MASTER_CHAN,"SyncPulse",str2,sizeof(str2)));
             DAQmxErrChk (DAQmxSetSampClkTimebaseSrc(slaveTaskHandle,str1));
             DAQmxErrChk (DAQmxSetSyncPulseSrc(slaveTaskHandle,str2));
             break;
@@ -137,18 +156,22 @@ int main(void)
             // device manual for further information on whether this method of synchronization is supported
             // for your particular device
             DAQmxErrChk (DAQmxSetRefClkSrc(masterTaskHandle, "PXI_Clk10"));
-            DAQmxErrChk (GetTerminalNameWithDevPrefix(masterTaskHandle,"SyncPulse",str1));
+            DAQmxErrChk (DevTopologyChannelTerminal(MASTER_CHAN,"SyncPulse",str1,sizeof(str1)));
             DAQmxErrChk (DAQmxSetSyncPulseSrc(slaveTaskHandle, str1));
             DAQmxErrChk (DAQmxSetRefClkSrc(slaveTaskHandle, "PXI_Clk10"));
             break;
         default:
             break;
     }
-    DAQmxErrChk (GetTerminalNameWithDevPrefix(masterTaskHandle,"ai/StartTrigger",trigName));
+    DAQmxErrChk (DevTopologyChannelTerminal(MASTER_CHAN,"ai/StartTrigger",trigName,sizeof(trigName)));
     DAQmxErrChk (DAQmxCfgDigEdgeStartTrig(slaveTaskHandle,trigName,DAQmx_Val_Rising));
+
+    tasks[0] = masterTaskHandle;
+    tasks[1] = slaveTaskHandle;
+    DAQmxErrChk (AIRecoveryCreate(tasks,2,&recoveryCfg,&recovery));
     
-    DAQmxErrChk (DAQmxRegisterEveryNSamplesEvent(masterTaskHandle,DAQmx_Val_Acquired_Into_Buffer,1000,0,EveryNCallback,NULL));
-    DAQmxErrChk (DAQmxRegisterDoneEvent(masterTaskHandle,0,DoneCallback,NULL));
+    DAQmxErrChk (DAQmxRegisterEveryNSamplesEvent(masterTaskHandle,DAQmx_Val_Acquired_Into_Buffer,1000,0,EveryNCallback,recovery));
+    DAQmxErrChk (DAQmxRegisterDoneEvent(masterTaskHandle,0,DoneCallback,recovery));
 
     /*********************************************/
     // DAQmx Start Code
@@ -159,7 +182,8 @@ int main(void)
     DAQmxErrChk (DAQmxStartTask(masterTaskHandle));
     
     printf("Acquiring samples continuously. Press Enter to interrupt\n");
-    printf("\nRead:\tMaster\tSlave\tTotal:\tMaster\tSlave\n");
+    // AIRecoveryRead reads the same number of samples from both devices.
+    printf("\nRead:\tMaster+Slave\tTotal:\tMaster+Slave\n");
     getchar();
 
 Error:
@@ -179,6 +203,7 @@ Error:
         DAQmxClearTask(slaveTaskHandle);
         slaveTaskHandle = 0;
     }
+    AIRecoveryClear(recovery);
 
     if( DAQmxFailed(error) )
         printf("DAQmx Error: %s\n",errBuff);
@@ -187,47 +212,27 @@ Error:
     return 0;
 }
 
-static int32 GetTerminalNameWithDevPrefix(TaskHandle taskHandle, const char terminalName[], char triggerName[])
-{
-    int32   error=0;
-    char    device[256];
-    int32   productCategory;
-    uInt32  numDevices,i=1;
-
-    DAQmxErrChk (DAQmxGetTaskNumDevices(taskHandle,&numDevices));
-    while( i<=numDevices ) {
-        DAQmxErrChk (DAQmxGetNthTaskDevice(taskHandle,i++,device,256));
-        DAQmxErrChk (DAQmxGetDevProductCategory(device,&productCategory));
-        if( productCategory!=DAQmx_Val_CSeriesModule && productCategory!=DAQmx_Val_SCXIModule ) {
-            *triggerName++ = '/';
-            strcat(strcat(strcpy(triggerName,device),"/"),terminalName);
-            break;
-        }
-    }
-
-Error:
-    return error;
-}
-
 int32 CVICALLBACK EveryNCallback(TaskHandle taskHandle, int32 everyNsamplesEventType, uInt32 nSamples, void *callbackData)
 {
     int32           error=0;
     char            errBuff[2048]={'\0'};
-    static int32    masterTotal=0,slaveTotal=0;
-    int32           masterRead,slaveRead;
+    static int32    total=0;
+    int32           read;
     float64         masterData[1000],slaveData[1000];
+    float64         *data[2]={masterData,slaveData};
+    AIRecoveryGap   gap;
 
     /*********************************************/
     // DAQmx Read Code
     /*********************************************/
-    DAQmxErrChk (DAQmxReadAnalogF64(masterTaskHandle,1000,10.0,DAQmx_Val_GroupByChannel,masterData,1000,&masterRead,NULL));
-    DAQmxErrChk (DAQmxReadAnalogF64(slaveTaskHandle,1000,10.0,DAQmx_Val_GroupByChannel,slaveData,1000,&slaveRead,NULL));
+    DAQmxErrChk (AIRecoveryRead((AIRecovery*)callbackData,1000,10.0,data,1000,&read,&gap));
+    if( gap.numLost>0 )
+        printf("\nBuffer overflow: %s%llu samples lost from sample %llu\n",gap.exact ? "" : "about ",
+               (unsigned long long)gap.numLost,(unsigned long long)gap.firstSample);
     
-    if( masterRead>0 )
-        masterTotal += masterRead;
-    if( slaveRead>0 )
-        slaveTotal += slaveRead;
-    printf("\t%d\t%d\t\t%d\t%d\r",(int)masterRead,(int)slaveRead,(int)masterTotal,(int)slaveTotal);
+    if( read>0 )
+        total += read;
+    printf("\t%d\t\t\t%d\r",(int)read,(int)total);
     fflush(stdout);
 
 Error:
@@ -254,6 +259,10 @@ int32 CVICALLBACK DoneCallback(TaskHandle taskHandle, int32 status, void *callba
     int32   error=0;
     char    errBuff[2048]={'\0'};
 
+    // An onboard overflow stops the task. Restart both tasks, unless
+    // the read in EveryNCallback already has.
+    if( AIRecoveryIsRecoverable(status) && !DAQmxFailed(AIRecoveryRestartTasks((AIRecovery*)callbackData,status,NULL)) )
+        return 0;
     // Check to see if an error stopped the task.
     DAQmxErrChk (status);
 
@@ -0,0 +1,176 @@
+/*********************************************************************
+*
+* ANSI C Example program:
+*    WriteDigPort-IntClk-Pattern.c
+*
+* Example Category:
+*    DO
+*
+* Description:
+*    This example demonstrates how to generate a long hardware-timed
+*    digital pattern on a whole port. WriteDigChan.c writes a single
+*    on-demand sample with one uInt8 per line. Here the port is
+*    written with DAQmxWriteDigitalU32, one word per sample, at 1 MHz.
+*
+*    The pattern drives three lines of an imaging setup, described by
+*    their edges: a shutter open for most of each 100 ms frame, a
+*    Pockels cell gate pulsed during the open time and a camera
+*    trigger at the start of each frame. It is compiled to a run list
+*    and rendered block by block into a small non-regenerating
+*    buffer, so the full pattern never has to be held in memory.
+*
+* Instructions for Running:
+*    1. Select the digital port on the DAQ device to be written.
+*    2. Set the sample rate and pattern timing.
+*    3. Build this file together with ../Processing/DOPattern.c.
+*
+* Steps:
+*    1. Build the edge lists and compile the pattern.
+*    2. Create a task.
+*    3. Create a Digital Output channel. Use one channel for all
+*       lines of the port.
+*    4. Set the rate for the sample clock and the total number of
+*       samples. Use a buffer of a few blocks and disable regeneration.
+*    5. Render and write the first blocks, then start the task.
+*    6. Render and write each further block as buffer space frees up.
+*    7. Wait until the task is done.
+*    8. Call the Clear Task function to clear the Task.
+*    9. Display an error if any.
+*
+* I/O Connections Overview:
+*    Make sure your signal output terminals match the port I/O
+*    Control. Line 0 drives the shutter, line 1 the Pockels cell gate
+*    and line 2 the camera trigger.
+*
+*********************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <NIDAQmx.h>
+#include "../Processing/DOPattern.h"
+
+#define DAQmxErrChk(functionCall) if( DAQmxFailed(error=(functionCall)) ) goto Error; else
+
+#define RATE            1000000.0
+#define NUM_FRAMES      10
+#define FRAME_SAMPS     100000      // 100 ms
+#define SHUTTER_OPEN    5000
+#define SHUTTER_CLOSE   95000
+#define GATE_HIGH       2
+#define GATE_PERIOD     12
+#define CAMERA_HIGH     10
+#define BLOCK_SIZE      50000
+#define NUM_BLOCKS      4
+
+int main(void)
+{
+    int32           error=0;
+    TaskHandle      taskHandle=0;
+    DOPattern       *pattern=NULL;
+    long long       *edges=NULL;
+    long long       length=(long long)NUM_FRAMES*FRAME_SAMPS,s;
+    static uInt32   data[BLOCK_SIZE];
+    char            errBuff[2048]={'\0'};
+    int             gatePulses=(SHUTTER_CLOSE-SHUTTER_OPEN)/GATE_PERIOD;
+    int             f,n,numEdges,started=0;
+
+    /*********************************************/
+    // Pattern
+    /*********************************************/
+    if( DOPatternCreate(3,&pattern)!=0 ) {
+        printf("Could not create the pattern\n");
+        goto Error;
+    }
+    edges = (long long*)malloc((size_t)NUM_FRAMES*2*gatePulses*sizeof(long long));
+    if( !edges ) {
+        printf("Out of memory\n");
+        goto Error;
+    }
+
+    numEdges = 0;
+    for(f=0;f<NUM_FRAMES;++f) {
+        edges[numEdges++] = (long long)f*FRAME_SAMPS+SHUTTER_OPEN;
+        edges[numEdges++] = (long long)f*FRAME_SAMPS+SHUTTER_CLOSE;
+    }
+    if( DOPatternSetLine(pattern,0,0,edges,numEdges)!=0 ) {
+        printf("Invalid shutter edges\n");
+        goto Error;
+    }
+
+    numEdges = 0;
+    for(f=0;f<NUM_FRAMES;++f) {
+        if( (n=DOPatternPulseTrain(edges+numEdges,(long long)f*FRAME_SAMPS+SHUTTER_OPEN,GATE_HIGH,GATE_PERIOD,gatePulses))<0 ) {
+            printf("Invalid gate pulse train\n");
+            goto Error;
+        }
+        numEdges += n;
+    }
+    if( DOPatternSetLine(pattern,1,0,edges,numEdges)!=0 ) {
+        printf("Invalid gate edges\n");
+        goto Error;
+    }
+
+    if( (numEdges=DOPatternPulseTrain(edges,0,CAMERA_HIGH,FRAME_SAMPS,NUM_FRAMES))<0 ||
+        DOPatternSetLine(pattern,2,0,edges,numEdges)!=0 ) {
+        printf("Invalid camera edges\n");
+        goto Error;
+    }
+
+    if( DOPatternCompile(pattern,length)!=0 ) {
+        printf("Could not compile the pattern\n");
+        goto Error;
+    }
+    printf("Pattern of %lld samples compiled to %lld runs\n",length,DOPatternNumRuns(pattern));
+
+    /*********************************************/
+    // DAQmx Configure Code
+    /*********************************************/
+    DAQmxErrChk (DAQmxCreateTask("",&taskHandle));
+    DAQmxErrChk (DAQmxCreateDOChan(taskHandle,"Dev1/port0","",DAQmx_Val_ChanForAllLines));
+    DAQmxErrChk (DAQmxCfgSampClkTiming(taskHandle,"",RATE,DAQmx_Val_Rising,DAQmx_Val_FiniteSamps,(uInt64)length));
+    DAQmxErrChk (DAQmxCfgOutputBuffer(taskHandle,NUM_BLOCKS*BLOCK_SIZE));
+    DAQmxErrChk (DAQmxSetWriteRegenMode(taskHandle,DAQmx_Val_DoNotAllowRegen));
+
+    /*********************************************/
+    // DAQmx Write Code
+    /*********************************************/
+    for(s=0;s<length;s+=n) {
+        n = (int)(length-s<BLOCK_SIZE ? length-s : BLOCK_SIZE);
+        if( DOPatternRenderU32(pattern,s,n,data)!=0 ) {
+            printf("Could not render samples %lld to %lld\n",s,s+n-1);
+            goto Error;
+        }
+        // Writes block until the device has freed enough buffer space.
+        DAQmxErrChk (DAQmxWriteDigitalU32(taskHandle,n,0,10.0,DAQmx_Val_GroupByChannel,data,NULL,NULL));
+
+        /*********************************************/
+        // DAQmx Start Code
+        /*********************************************/
+        // Start once the buffer is full, or the whole pattern is in it.
+        if( !started && (s+n>=(long long)NUM_BLOCKS*BLOCK_SIZE || s+n==length) ) {
+            DAQmxErrChk (DAQmxStartTask(taskHandle));
+            started = 1;
+        }
+    }
+
+    DAQmxErrChk (DAQmxWaitUntilTaskDone(taskHandle,10.0));
+    printf("Generated %d frames\n",NUM_FRAMES);
+
+Error:
+    if( DAQmxFailed(error) )
+        DAQmxGetExtendedErrorInfo(errBuff,2048);
+    if( taskHandle!=0 ) {
+        /*********************************************/
+        // DAQmx Stop Code
+        /*********************************************/
+        DAQmxStopTask(taskHandle);
+        DAQmxClearTask(taskHandle);
+    }
+    DOPatternClear(pattern);
+    free(edges);
+    if( DAQmxFailed(error) )
+        printf("DAQmx Error: %s\n",errBuff);
+    printf("End of program, press Enter key to quit\n");
+    getchar();
+    return 0;
+}
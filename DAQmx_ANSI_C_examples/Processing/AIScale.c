@@ -0,0 +1,160 @@
+/*********************************************************************
+*
+* Processing stage:
+*    AIScale.c
+*
+* Description:
+*    Implementation of the raw to volts scaling. See AIScale.h.
+*
+*    The polynomial is evaluated by Horner's rule. For contiguous
+*    channels AVX converts 8 codes at a time to float, or 4 to double,
+*    with the coefficients kept in registers.
+*
+*********************************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+#include "AIScale.h"
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#endif
+
+struct AIScale {
+    int         numChans;
+    int         numCoeffs;
+    double      *coeffF64;      // numChans*numCoeffs
+    float       *coeffF32;
+};
+
+int AIScaleCreate(int numChans, const double coeffs[], int numCoeffs, AIScale **scale)
+{
+    AIScale *s;
+    int     i;
+
+    *scale = NULL;
+    if( numChans<1 || numCoeffs<1 || numCoeffs>AIScaleMaxCoeffs )
+        return AIScaleErrInvalidArg;
+    s = (AIScale*)calloc(1,sizeof(AIScale));
+    if( !s )
+        return AIScaleErrOutOfMemory;
+    s->numChans = numChans;
+    s->numCoeffs = numCoeffs;
+    s->coeffF64 = (double*)malloc(sizeof(double)*numChans*numCoeffs);
+    s->coeffF32 = (float*)malloc(sizeof(float)*numChans*numCoeffs);
+    if( !s->coeffF64 || !s->coeffF32 ) {
+        AIScaleClear(s);
+        return AIScaleErrOutOfMemory;
+    }
+    memcpy(s->coeffF64,coeffs,sizeof(double)*numChans*numCoeffs);
+    for(i=0;i<numChans*numCoeffs;++i)
+        s->coeffF32[i] = (float)coeffs[i];
+    *scale = s;
+    return 0;
+}
+
+void AIScaleClear(AIScale *scale)
+{
+    if( !scale )
+        return;
+    free(scale->coeffF64);
+    free(scale->coeffF32);
+    free(scale);
+}
+
+static void ScaleF32(const short x[], int n, size_t stride, const float c[], int numCoeffs, float y[])
+{
+    int i=0,k;
+
+#if defined(__AVX__)
+    if( stride==1 ) {
+        __m256  vc[AIScaleMaxCoeffs];
+
+        for(k=0;k<numCoeffs;++k)
+            vc[k] = _mm256_set1_ps(c[k]);
+        for(;i+8<=n;i+=8) {
+            __m128i raw=_mm_loadu_si128((const __m128i*)(x+i));
+            __m256i wide=_mm256_insertf128_si256(_mm256_castsi128_si256(_mm_cvtepi16_epi32(raw)),_mm_cvtepi16_epi32(_mm_srli_si128(raw,8)),1);
+            __m256  v=_mm256_cvtepi32_ps(wide);
+            __m256  acc=vc[numCoeffs-1];
+
+            for(k=numCoeffs-2;k>=0;--k)
+                acc = _mm256_add_ps(_mm256_mul_ps(acc,v),vc[k]);
+            _mm256_storeu_ps(y+i,acc);
+        }
+    }
+#endif
+    for(;i<n;++i) {
+        float v=(float)x[i*stride];
+        float acc=c[numCoeffs-1];
+
+        for(k=numCoeffs-2;k>=0;--k)
+            acc = acc*v+c[k];
+        y[i*stride] = acc;
+    }
+}
+
+static void ScaleF64(const short x[], int n, size_t stride, const double c[], int numCoeffs, double y[])
+{
+    int i=0,k;
+
+#if defined(__AVX__)
+    if( stride==1 ) {
+        __m256d vc[AIScaleMaxCoeffs];
+
+        for(k=0;k<numCoeffs;++k)
+            vc[k] = _mm256_set1_pd(c[k]);
+        for(;i+4<=n;i+=4) {
+            __m128i raw=_mm_loadl_epi64((const __m128i*)(x+i));
+            __m256d v=_mm256_cvtepi32_pd(_mm_cvtepi16_epi32(raw));
+            __m256d acc=vc[numCoeffs-1];
+
+            for(k=numCoeffs-2;k>=0;--k)
+                acc = _mm256_add_pd(_mm256_mul_pd(acc,v),vc[k]);
+            _mm256_storeu_pd(y+i,acc);
+        }
+    }
+#endif
+    for(;i<n;++i) {
+        double v=(double)x[i*stride];
+        double acc=c[numCoeffs-1];
+
+        for(k=numCoeffs-2;k>=0;--k)
+            acc = acc*v+c[k];
+        y[i*stride] = acc;
+    }
+}
+
+int AIScaleToF32(const AIScale *scale, const short raw[], int numSampsPerChan, int interleaved, float out[])
+{
+    int c;
+
+    if( numSampsPerChan<0 )
+        return AIScaleErrInvalidArg;
+    for(c=0;c<scale->numChans;++c) {
+        const float *coeffs=scale->coeffF32+(size_t)c*scale->numCoeffs;
+
+        if( interleaved )
+            ScaleF32(raw+c,numSampsPerChan,scale->numChans,coeffs,scale->numCoeffs,out+c);
+        else
+            ScaleF32(raw+(size_t)c*numSampsPerChan,numSampsPerChan,1,coeffs,scale->numCoeffs,out+(size_t)c*numSampsPerChan);
+    }
+    return 0;
+}
+
+int AIScaleToF64(const AIScale *scale, const short raw[], int numSampsPerChan, int interleaved, double out[])
+{
+    int c;
+
+    if( numSampsPerChan<0 )
+        return AIScaleErrInvalidArg;
+    for(c=0;c<scale->numChans;++c) {
+        const double *coeffs=scale->coeffF64+(size_t)c*scale->numCoeffs;
+
+        if( interleaved )
+            ScaleF64(raw+c,numSampsPerChan,scale->numChans,coeffs,scale->numCoeffs,out+c);
+        else
+            ScaleF64(raw+(size_t)c*numSampsPerChan,numSampsPerChan,1,coeffs,scale->numCoeffs,out+(size_t)c*numSampsPerChan);
+    }
+    return 0;
+}
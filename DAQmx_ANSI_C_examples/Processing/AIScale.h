@@ -0,0 +1,48 @@
+/*********************************************************************
+*
+* Processing stage:
+*    AIScale.h
+*
+* Description:
+*    Converts raw analog input codes read with DAQmxReadBinaryI16 to
+*    volts, in float or double. DAQmx has no float32 read, so a
+*    pipeline that works in float reads raw data and scales it here
+*    instead of reading float64 and converting it a second time.
+*
+*    Each channel has its own polynomial, volts = c[0] + c[1]*x +
+*    c[2]*x^2 + ..., with the coefficients in the ascending order that
+*    DAQmxGetAIDevScalingCoeff returns them for that channel. The
+*    polynomial is evaluated in the output type, which for float is
+*    still well below one code of a 16 bit converter.
+*
+*********************************************************************/
+
+#ifndef AISCALE_H
+#define AISCALE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define AIScaleErrInvalidArg        -1
+#define AIScaleErrOutOfMemory       -2
+
+#define AIScaleMaxCoeffs            8
+
+typedef struct AIScale AIScale;
+
+// coeffs holds numCoeffs coefficients for each of numChans channels,
+// channel after channel.
+int  AIScaleCreate(int numChans, const double coeffs[], int numCoeffs, AIScale **scale);
+void AIScaleClear(AIScale *scale);
+
+// Data are DAQmx_Val_GroupByScanNumber when interleaved is set and
+// DAQmx_Val_GroupByChannel otherwise. The output has the same layout.
+int  AIScaleToF32(const AIScale *scale, const short raw[], int numSampsPerChan, int interleaved, float out[]);
+int  AIScaleToF64(const AIScale *scale, const short raw[], int numSampsPerChan, int interleaved, double out[]);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
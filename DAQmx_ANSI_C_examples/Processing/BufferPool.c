@@ -0,0 +1,364 @@
+/*********************************************************************
+*
+* Processing helper:
+*    BufferPool.c
+*
+* Description:
+*    Implementation of the NUMA local, huge page buffer pool. See
+*    BufferPool.h.
+*
+*    On Linux the node is set with the mbind system call and read
+*    back with get_mempolicy, so libnuma is not needed, and the huge
+*    page coverage is read from /proc/self/smaps. The free buffers are
+*    kept in a bounded multi-producer, multi-consumer ring, after
+*    Vyukov.
+*
+*********************************************************************/
+
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE     // for MAP_HUGETLB and syscall
+#endif
+
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "BufferPool.h"
+
+#if defined(WIN32) || defined(_WIN32)
+#include <windows.h>
+#include <psapi.h>
+#elif defined(__linux__)
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+// From linux/mempolicy.h.
+#define MPOL_PREFERRED_     1
+#define MPOL_F_NODE_        (1<<0)
+#define MPOL_F_ADDR_        (1<<1)
+
+typedef struct Slab {
+    char        *base;
+    size_t      bytes;
+    int         hugeTlb;
+} Slab;
+
+typedef struct Cell {
+    atomic_size_t   seq;
+    void            *buffer;
+} Cell;
+
+struct BufferPool {
+    BufferPoolConfig    cfg;
+    size_t              bufferBytes;
+    size_t              slabBytes;
+    int                 numSlabs;
+    int                 pages;
+    Slab                *slabs;
+    Cell                *cells;
+    size_t              mask;
+    atomic_size_t       tail;
+    char                pad[64];        // keeps head and tail on separate cache lines
+    atomic_size_t       head;
+};
+
+/*********************************************/
+// Slabs
+/*********************************************/
+#if defined(WIN32) || defined(_WIN32)
+
+static int CurrentNode(void)
+{
+    PROCESSOR_NUMBER    proc;
+    USHORT              node;
+
+    GetCurrentProcessorNumberEx(&proc);
+    return GetNumaProcessorNodeEx(&proc,&node) ? (int)node : 0;
+}
+
+// Large pages need the Lock Pages in Memory privilege.
+static int MapSlab(Slab *slab, size_t bytes, int node, int hugePages, int *pages)
+{
+    DWORD   numaNode=node>=0 ? (DWORD)node : (DWORD)CurrentNode();
+    SIZE_T  large=GetLargePageMinimum();
+
+    if( hugePages && large>0 && bytes%large==0 ) {
+        slab->base = (char*)VirtualAllocExNuma(GetCurrentProcess(),NULL,bytes,MEM_RESERVE|MEM_COMMIT|MEM_LARGE_PAGES,PAGE_READWRITE,numaNode);
+        if( slab->base ) {
+            slab->bytes = bytes;
+            slab->hugeTlb = 1;
+            *pages = BufferPoolPagesHuge;
+            return 0;
+        }
+    }
+    slab->base = (char*)VirtualAllocExNuma(GetCurrentProcess(),NULL,bytes,MEM_RESERVE|MEM_COMMIT,PAGE_READWRITE,numaNode);
+    slab->bytes = bytes;
+    slab->hugeTlb = 0;
+    return slab->base ? 0 : -1;
+}
+
+static void UnmapSlab(Slab *slab)
+{
+    VirtualFree(slab->base,0,MEM_RELEASE);
+}
+
+static int SlabNode(const Slab *slab)
+{
+    PSAPI_WORKING_SET_EX_INFORMATION    info;
+
+    info.VirtualAddress = slab->base;
+    if( !QueryWorkingSetEx(GetCurrentProcess(),&info,sizeof(info)) || !info.VirtualAttributes.Valid )
+        return -1;
+    return (int)info.VirtualAttributes.Node;
+}
+
+static long long HugeBytes(const BufferPool *pool)
+{
+    return pool->pages==BufferPoolPagesHuge ? (long long)pool->numSlabs*pool->slabBytes : 0;
+}
+
+#elif defined(__linux__)
+
+static int MapSlab(Slab *slab, size_t bytes, int node, int hugePages, int *pages)
+{
+    char    *p;
+    size_t  head;
+
+    slab->hugeTlb = 0;
+    if( hugePages ) {
+        p = (char*)mmap(NULL,bytes,PROT_READ|PROT_WRITE,MAP_PRIVATE|MAP_ANONYMOUS|MAP_HUGETLB,-1,0);
+        if( p!=MAP_FAILED ) {
+            slab->base = p;
+            slab->bytes = bytes;
+            slab->hugeTlb = 1;
+            *pages = BufferPoolPagesHuge;
+        }
+    }
+    if( !slab->hugeTlb ) {
+        // Map one slab more and trim it to a 2 MB boundary.
+        p = (char*)mmap(NULL,bytes+BufferPoolSlabBytes,PROT_READ|PROT_WRITE,MAP_PRIVATE|MAP_ANONYMOUS,-1,0);
+        if( p==MAP_FAILED )
+            return -1;
+        head = (BufferPoolSlabBytes-(uintptr_t)p%BufferPoolSlabBytes)%BufferPoolSlabBytes;
+        if( head )
+            munmap(p,head);
+        munmap(p+head+bytes,BufferPoolSlabBytes-head);
+        slab->base = p+head;
+        slab->bytes = bytes;
+#ifdef MADV_HUGEPAGE
+        if( hugePages && madvise(slab->base,bytes,MADV_HUGEPAGE)==0 && *pages==BufferPoolPagesNormal )
+            *pages = BufferPoolPagesTransparent;
+#endif
+    }
+#ifdef SYS_mbind
+    // Only where the pages will be faulted in; a node that is full or
+    // not allowed to the process is not an error.
+    if( node>=0 && node<64 ) {
+        unsigned long mask=1ul<<node;
+
+        syscall(SYS_mbind,slab->base,bytes,MPOL_PREFERRED_,&mask,64ul,0u);
+    }
+#endif
+    return 0;
+}
+
+static void UnmapSlab(Slab *slab)
+{
+    munmap(slab->base,slab->bytes);
+}
+
+static int SlabNode(const Slab *slab)
+{
+#ifdef SYS_get_mempolicy
+    int node=-1;
+
+    if( syscall(SYS_get_mempolicy,&node,NULL,0ul,slab->base,(unsigned long)(MPOL_F_NODE_|MPOL_F_ADDR_))==0 )
+        return node;
+#endif
+    return -1;
+}
+
+// Counts the slabs on explicit huge pages, and sums AnonHugePages
+// over the mappings that hold the others. Mappings that the kernel
+// merged with a neighbour may add a little.
+static long long HugeBytes(const BufferPool *pool)
+{
+    FILE            *f;
+    char            line[256];
+    unsigned long   start,end;
+    int             inPool=0,s;
+    long long       kb,total=0,poolBytes=(long long)pool->numSlabs*pool->slabBytes;
+
+    for(s=0;s<pool->numSlabs;++s)
+        if( pool->slabs[s].hugeTlb )
+            total += (long long)pool->slabBytes;
+    if( total==poolBytes )
+        return total;
+    if( !(f=fopen("/proc/self/smaps","r")) )
+        return -1;
+    while( fgets(line,sizeof(line),f) ) {
+        if( sscanf(line,"%lx-%lx ",&start,&end)==2 ) {
+            inPool = 0;
+            for(s=0;s<pool->numSlabs && !inPool;++s)
+                inPool = !pool->slabs[s].hugeTlb && (uintptr_t)pool->slabs[s].base<end && (uintptr_t)pool->slabs[s].base+pool->slabBytes>start;
+        }
+        else if( inPool && sscanf(line,"AnonHugePages: %lld kB",&kb)==1 )
+            total += 1024*kb;
+    }
+    fclose(f);
+    return total<poolBytes ? total : poolBytes;
+}
+
+#else
+
+static int MapSlab(Slab *slab, size_t bytes, int node, int hugePages, int *pages)
+{
+    void *p=NULL;
+
+    (void)node;
+    (void)hugePages;
+    (void)pages;
+    if( posix_memalign(&p,BufferPoolSlabBytes,bytes)!=0 )
+        return -1;
+    slab->base = (char*)p;
+    slab->bytes = bytes;
+    slab->hugeTlb = 0;
+    return 0;
+}
+
+static void UnmapSlab(Slab *slab)            { free(slab->base); }
+static int  SlabNode(const Slab *slab)       { (void)slab; return -1; }
+static long long HugeBytes(const BufferPool *pool) { (void)pool; return -1; }
+
+#endif
+
+/*********************************************/
+// Pool
+/*********************************************/
+int BufferPoolCreate(const BufferPoolConfig *config, BufferPool **pool)
+{
+    BufferPool  *p;
+    size_t      perSlab,capacity,b;
+    int         s;
+
+    *pool = NULL;
+    if( !config || config->bufferBytes==0 || config->numBuffers<1 )
+        return BufferPoolErrInvalidArg;
+    p = (BufferPool*)calloc(1,sizeof(BufferPool));
+    if( !p )
+        return BufferPoolErrOutOfMemory;
+    p->cfg = *config;
+    p->bufferBytes = (config->bufferBytes+63)&~(size_t)63;
+    p->slabBytes = (p->bufferBytes+BufferPoolSlabBytes-1)/BufferPoolSlabBytes*BufferPoolSlabBytes;
+    perSlab = p->slabBytes/p->bufferBytes;
+    p->numSlabs = (int)((config->numBuffers+perSlab-1)/perSlab);
+    for(capacity=2;capacity<(size_t)config->numBuffers;capacity*=2)
+        ;
+    p->mask = capacity-1;
+    p->slabs = (Slab*)calloc(p->numSlabs,sizeof(Slab));
+    p->cells = (Cell*)calloc(capacity,sizeof(Cell));
+    if( !p->slabs || !p->cells ) {
+        BufferPoolClear(p);
+        return BufferPoolErrOutOfMemory;
+    }
+    for(b=0;b<capacity;++b)
+        atomic_init(&p->cells[b].seq,b);
+    atomic_init(&p->tail,0);
+    atomic_init(&p->head,0);
+
+    for(s=0;s<p->numSlabs;++s) {
+        if( MapSlab(&p->slabs[s],p->slabBytes,config->node,config->hugePages,&p->pages)!=0 ) {
+            p->numSlabs = s;
+            BufferPoolClear(p);
+            return BufferPoolErrOutOfMemory;
+        }
+        // Fault the pages in now, on this thread's node unless bound.
+        memset(p->slabs[s].base,0,p->slabBytes);
+    }
+    for(b=0;b<(size_t)config->numBuffers;++b)
+        BufferPoolPut(p,p->slabs[b/perSlab].base+(b%perSlab)*p->bufferBytes);
+    *pool = p;
+    return 0;
+}
+
+void BufferPoolClear(BufferPool *pool)
+{
+    int s;
+
+    if( !pool )
+        return;
+    for(s=0;pool->slabs && s<pool->numSlabs;++s)
+        UnmapSlab(&pool->slabs[s]);
+    free(pool->slabs);
+    free(pool->cells);
+    free(pool);
+}
+
+void *BufferPoolGet(BufferPool *pool)
+{
+    size_t pos=atomic_load_explicit(&pool->head,memory_order_relaxed);
+
+    for(;;) {
+        Cell    *cell=&pool->cells[pos&pool->mask];
+        size_t  seq=atomic_load_explicit(&cell->seq,memory_order_acquire);
+
+        if( seq==pos+1 ) {
+            if( atomic_compare_exchange_weak_explicit(&pool->head,&pos,pos+1,memory_order_relaxed,memory_order_relaxed) ) {
+                void *buffer=cell->buffer;
+
+                atomic_store_explicit(&cell->seq,pos+pool->mask+1,memory_order_release);
+                return buffer;
+            }
+        }
+        else if( seq<pos+1 )
+            return NULL;
+        else
+            pos = atomic_load_explicit(&pool->head,memory_order_relaxed);
+    }
+}
+
+// The ring holds at least numBuffers cells, so a buffer of the pool
+// always finds one.
+void BufferPoolPut(BufferPool *pool, void *buffer)
+{
+    size_t pos=atomic_load_explicit(&pool->tail,memory_order_relaxed);
+
+    for(;;) {
+        Cell    *cell=&pool->cells[pos&pool->mask];
+        size_t  seq=atomic_load_explicit(&cell->seq,memory_order_acquire);
+
+        if( seq==pos ) {
+            if( atomic_compare_exchange_weak_explicit(&pool->tail,&pos,pos+1,memory_order_relaxed,memory_order_relaxed) ) {
+                cell->buffer = buffer;
+                atomic_store_explicit(&cell->seq,pos+1,memory_order_release);
+                return;
+            }
+        }
+        else
+            pos = atomic_load_explicit(&pool->tail,memory_order_relaxed);
+    }
+}
+
+int BufferPoolGetPlacement(const BufferPool *pool, BufferPoolPlacement *placement)
+{
+    int s,node;
+
+    memset(placement,0,sizeof(BufferPoolPlacement));
+    placement->bufferBytes = pool->bufferBytes;
+    placement->slabBytes = pool->slabBytes;
+    placement->numSlabs = pool->numSlabs;
+    placement->pages = pool->pages;
+    placement->hugeBytes = HugeBytes(pool);
+    placement->node = -1;
+    for(s=0;s<pool->numSlabs;++s) {
+        node = SlabNode(&pool->slabs[s]);
+        if( s==0 )
+            placement->node = node;
+        if( pool->cfg.node>=0 && node>=0 && node!=pool->cfg.node )
+            ++placement->nodeMismatches;
+    }
+    return 0;
+}
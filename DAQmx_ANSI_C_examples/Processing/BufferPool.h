@@ -0,0 +1,85 @@
+/*********************************************************************
+*
+* Processing helper:
+*    BufferPool.h
+*
+* Description:
+*    Fixed pool of equal sample buffers for one stage of an
+*    acquisition pipeline, in place of the stack arrays of the
+*    examples, which do not scale to many channels or deep queues.
+*
+*    The buffers are carved from 2 MB slabs, each aligned to 2 MB, so
+*    that they can be backed by huge pages and a pass over a buffer
+*    touches a few TLB entries instead of hundreds. With hugePages
+*    set, the pool asks for explicit huge pages (Linux hugetlbfs,
+*    Windows large pages), then for transparent huge pages, and
+*    otherwise uses normal pages. A buffer never straddles two slabs;
+*    buffers larger than a slab get slabs of several times 2 MB.
+*
+*    The slabs are placed on NUMA node node, or with node -1 on the
+*    node of the thread that creates the pool, and all their pages
+*    are touched when the pool is created, so that no page faults
+*    happen on the data path. Create the pool for a stage on the node
+*    its threads are pinned to (ThreadAffinityNode).
+*
+*    BufferPoolGetPlacement says where the memory ended up: how much
+*    of it is on huge pages and on which node, as far as the system
+*    reports it.
+*
+*    BufferPoolGet and BufferPoolPut are lock-free and may be called
+*    from any thread, including an EveryN callback. Get returns NULL
+*    when every buffer is in use.
+*
+*********************************************************************/
+
+#ifndef BUFFERPOOL_H
+#define BUFFERPOOL_H
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define BufferPoolErrInvalidArg     -1
+#define BufferPoolErrOutOfMemory    -2
+
+#define BufferPoolSlabBytes         ((size_t)2<<20)
+
+// BufferPoolPlacement.pages
+#define BufferPoolPagesNormal       0
+#define BufferPoolPagesHuge         1   // explicit huge pages
+#define BufferPoolPagesTransparent  2   // transparent huge pages were requested
+
+typedef struct BufferPoolConfig {
+    size_t      bufferBytes;
+    int         numBuffers;
+    int         node;           // NUMA node, or -1 for the calling thread's
+    int         hugePages;      // nonzero to use huge pages where available
+} BufferPoolConfig;
+
+typedef struct BufferPoolPlacement {
+    size_t      bufferBytes;    // rounded up to a multiple of 64
+    size_t      slabBytes;
+    int         numSlabs;
+    int         pages;          // BufferPoolPagesNormal, ...
+    long long   hugeBytes;      // bytes on huge pages, or -1 if not known
+    int         node;           // node of the first slab, or -1 if not known
+    int         nodeMismatches; // slabs found on another node than asked
+} BufferPoolPlacement;
+
+typedef struct BufferPool BufferPool;
+
+int   BufferPoolCreate(const BufferPoolConfig *config, BufferPool **pool);
+void  BufferPoolClear(BufferPool *pool);
+
+void *BufferPoolGet(BufferPool *pool);
+void  BufferPoolPut(BufferPool *pool, void *buffer);
+
+int   BufferPoolGetPlacement(const BufferPool *pool, BufferPoolPlacement *placement);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,410 @@
+/*********************************************************************
+*
+* Processing benchmark:
+*    BufferPoolBench.c
+*
+* Description:
+*    Runs a three stage pipeline over 64 channel blocks of 16384
+*    samples (8 MB each) and compares where its buffers live:
+*
+*      reader      fills a block interleaved by scan, as the driver
+*                  delivers it with DAQmx_Val_GroupByScanNumber
+*      processing  transposes it into channel order in a second
+*                  buffer
+*      writer      reads the channel ordered block back, as a copy to
+*                  a file or an AO task would
+*
+*    The transpose writes 64 channels 128 kB apart for every scan,
+*    which is the access pattern that needs many TLB entries when the
+*    buffers are on 4 kB pages.
+*
+*    Configurations:
+*
+*      malloc           buffers from malloc, threads not pinned
+*      pool, 4 kB       BufferPool without huge pages, threads pinned,
+*                       buffers on the node of the threads that use them
+*      pool, huge       as above, on huge pages where the system has
+*                       them
+*      pool, remote     huge pages on another NUMA node than the
+*                       threads, on machines with more than one node
+*
+*    The thread placement comes from -affinity (see ThreadAffinity.h),
+*    by default one CPU for the reader, one for the writer and the
+*    rest for processing. The affinity of each role and the placement
+*    of each pool are printed before the runs. Reports MB/s of samples
+*    through the pipeline, best of 3 runs of 1 s.
+*
+*    No DAQ hardware is needed. Build with BufferPool.c and
+*    ThreadAffinity.c, and on Linux with -lpthread.
+*
+*********************************************************************/
+
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE     // for pthread_setaffinity_np
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "BufferPool.h"
+#include "ThreadAffinity.h"
+#include "StreamThread.h"
+#include "StreamTime.h"
+
+#if defined(__linux__) || defined(__APPLE__)
+#include <unistd.h>
+#endif
+
+#define NUM_CHANS       64
+#define NUM_SAMPS       16384
+#define BLOCK_BYTES     (sizeof(double)*NUM_CHANS*NUM_SAMPS)
+#define NUM_BUFFERS     6       // per stage
+#define MAX_WORKERS     64
+#define RUN_TIME        1.0
+#define NUM_RUNS        3
+
+/*********************************************/
+// Blocking queue of buffers between stages
+/*********************************************/
+typedef struct Queue {
+    StreamMutex     mutex;
+    StreamCond      cond;
+    void            *items[2*NUM_BUFFERS+MAX_WORKERS];
+    int             head;
+    int             count;
+} Queue;
+
+#define QUEUE_SIZE  ((int)(sizeof(((Queue*)0)->items)/sizeof(void*)))
+
+static void QueueInit(Queue *q)
+{
+    StreamMutexInit(&q->mutex);
+    StreamCondInit(&q->cond);
+    q->head = q->count = 0;
+}
+
+static void QueueDestroy(Queue *q)
+{
+    StreamCondDestroy(&q->cond);
+    StreamMutexDestroy(&q->mutex);
+}
+
+static void QueuePush(Queue *q, void *item)
+{
+    StreamMutexLock(&q->mutex);
+    q->items[(q->head+q->count++)%QUEUE_SIZE] = item;
+    StreamCondSignal(&q->cond);
+    StreamMutexUnlock(&q->mutex);
+}
+
+static void *QueuePop(Queue *q)
+{
+    void *item;
+
+    StreamMutexLock(&q->mutex);
+    while( q->count==0 )
+        StreamCondWait(&q->cond,&q->mutex);
+    item = q->items[q->head];
+    q->head = (q->head+1)%QUEUE_SIZE;
+    --q->count;
+    StreamMutexUnlock(&q->mutex);
+    return item;
+}
+
+/*********************************************/
+// Buffers of one stage: a pool, or malloc
+/*********************************************/
+typedef struct Buffers {
+    BufferPool  *pool;
+    Queue       free;           // malloc'd buffers when there is no pool
+    void        *blocks[NUM_BUFFERS];
+} Buffers;
+
+static int BuffersCreate(Buffers *b, int usePool, int node, int hugePages)
+{
+    BufferPoolConfig    cfg;
+    int                 i;
+
+    memset(b,0,sizeof(Buffers));
+    QueueInit(&b->free);
+    if( usePool ) {
+        cfg.bufferBytes = BLOCK_BYTES;
+        cfg.numBuffers = NUM_BUFFERS;
+        cfg.node = node;
+        cfg.hugePages = hugePages;
+        return BufferPoolCreate(&cfg,&b->pool);
+    }
+    for(i=0;i<NUM_BUFFERS;++i) {
+        if( !(b->blocks[i]=malloc(BLOCK_BYTES)) )
+            return BufferPoolErrOutOfMemory;
+        // Touched beforehand, as the pool does, so no run pays the faults.
+        memset(b->blocks[i],0,BLOCK_BYTES);
+        QueuePush(&b->free,b->blocks[i]);
+    }
+    return 0;
+}
+
+static void BuffersClear(Buffers *b)
+{
+    int i;
+
+    BufferPoolClear(b->pool);
+    for(i=0;i<NUM_BUFFERS;++i)
+        free(b->blocks[i]);
+    QueueDestroy(&b->free);
+}
+
+static double *GetBuffer(Buffers *b)
+{
+    double *p;
+
+    if( !b->pool )
+        return (double*)QueuePop(&b->free);
+    while( !(p=(double*)BufferPoolGet(b->pool)) )
+        StreamSleep(20e-6);
+    return p;
+}
+
+static void PutBuffer(Buffers *b, double *p)
+{
+    if( b->pool )
+        BufferPoolPut(b->pool,p);
+    else
+        QueuePush(&b->free,p);
+}
+
+/*********************************************/
+// Pipeline
+/*********************************************/
+typedef struct Pipeline {
+    const ThreadAffinity    *affinity;
+    int                     pin;
+    int                     numWorkers;
+    Buffers                 raw;
+    Buffers                 out;
+    Queue                   toProcess;
+    Queue                   toWrite;
+    volatile int            stop;
+    long long               blocksWritten;
+    double                  checksum;
+} Pipeline;
+
+typedef struct Worker {
+    Pipeline    *p;
+    int         index;
+} Worker;
+
+static STREAM_THREAD_PROC(ReaderThread,arg)
+{
+    Pipeline    *p=(Pipeline*)arg;
+    long long   k=0;
+    int         i,w;
+
+    if( p->pin )
+        ThreadAffinityPin(p->affinity,ThreadRoleReader,0);
+    while( !p->stop ) {
+        double *data=GetBuffer(&p->raw);
+
+        for(i=0;i<NUM_CHANS*NUM_SAMPS;++i)
+            data[i] = (double)(k+i);
+        ++k;
+        QueuePush(&p->toProcess,data);
+    }
+    for(w=0;w<p->numWorkers;++w)
+        QueuePush(&p->toProcess,NULL);
+    return 0;
+}
+
+static STREAM_THREAD_PROC(ProcessingThread,arg)
+{
+    Worker      *w=(Worker*)arg;
+    Pipeline    *p=w->p;
+    double      *in,*out;
+    int         c,s,k;
+
+    if( p->pin )
+        ThreadAffinityPin(p->affinity,ThreadRoleProcessing,w->index);
+    while( (in=(double*)QueuePop(&p->toProcess)) ) {
+        out = GetBuffer(&p->out);
+        // 8 scans at a time, so each channel's cache line is written
+        // whole before the next one.
+        for(s=0;s<NUM_SAMPS;s+=8)
+            for(c=0;c<NUM_CHANS;++c)
+                for(k=0;k<8;++k)
+                    out[(size_t)c*NUM_SAMPS+s+k] = in[(size_t)(s+k)*NUM_CHANS+c];
+        PutBuffer(&p->raw,in);
+        QueuePush(&p->toWrite,out);
+    }
+    QueuePush(&p->toWrite,NULL);
+    return 0;
+}
+
+static STREAM_THREAD_PROC(WriterThread,arg)
+{
+    Pipeline    *p=(Pipeline*)arg;
+    double      *data,sum=0.0;
+    int         ended=0,i;
+
+    if( p->pin )
+        ThreadAffinityPin(p->affinity,ThreadRoleWriter,0);
+    while( ended<p->numWorkers ) {
+        if( !(data=(double*)QueuePop(&p->toWrite)) ) {
+            ++ended;
+            continue;
+        }
+        for(i=0;i<NUM_CHANS*NUM_SAMPS;++i)
+            sum += data[i];
+        ++p->blocksWritten;
+        PutBuffer(&p->out,data);
+    }
+    p->checksum = sum;
+    return 0;
+}
+
+// Returns MB/s, or a negative value if the run could not be set up.
+static double RunPipeline(const ThreadAffinity *affinity, int numWorkers, int usePool, int rawNode, int outNode, int hugePages, int report)
+{
+    Pipeline            p;
+    Worker              workers[MAX_WORKERS];
+    StreamThread        reader,writer,proc[MAX_WORKERS];
+    BufferPoolPlacement pl;
+    double              t0,best=0.0;
+    int                 run,w;
+
+    memset(&p,0,sizeof(p));
+    p.affinity = affinity;
+    p.pin = usePool;
+    p.numWorkers = numWorkers;
+    if( BuffersCreate(&p.raw,usePool,rawNode,hugePages)!=0 || BuffersCreate(&p.out,usePool,outNode,hugePages)!=0 ) {
+        BuffersClear(&p.raw);
+        BuffersClear(&p.out);
+        return -1.0;
+    }
+    if( report )
+        for(w=0;w<2;++w) {
+            const char *pages[]={"4 kB","huge","transparent huge"};
+
+            BufferPoolGetPlacement(w ? p.out.pool : p.raw.pool,&pl);
+            printf("    %-4s pool: %d x %.1f MB slabs, %s pages requested, %.0f%% on huge pages, node %d%s\n",
+                   w ? "out" : "raw",pl.numSlabs,pl.slabBytes/1048576.0,pages[pl.pages],
+                   pl.hugeBytes>=0 ? 100.0*pl.hugeBytes/((double)pl.numSlabs*pl.slabBytes) : -1.0,pl.node,
+                   pl.nodeMismatches ? ", some slabs on other nodes" : "");
+        }
+    for(run=0;run<NUM_RUNS;++run) {
+        QueueInit(&p.toProcess);
+        QueueInit(&p.toWrite);
+        p.stop = 0;
+        p.blocksWritten = 0;
+        t0 = StreamTimeNow();
+        StreamThreadCreate(&reader,ReaderThread,&p);
+        for(w=0;w<numWorkers;++w) {
+            workers[w].p = &p;
+            workers[w].index = w;
+            StreamThreadCreate(&proc[w],ProcessingThread,&workers[w]);
+        }
+        StreamThreadCreate(&writer,WriterThread,&p);
+        StreamSleep(RUN_TIME);
+        p.stop = 1;
+        StreamThreadJoin(reader);
+        for(w=0;w<numWorkers;++w)
+            StreamThreadJoin(proc[w]);
+        StreamThreadJoin(writer);
+        t0 = StreamTimeNow()-t0;
+        if( p.blocksWritten*BLOCK_BYTES/t0/1e6>best )
+            best = p.blocksWritten*BLOCK_BYTES/t0/1e6;
+        QueueDestroy(&p.toProcess);
+        QueueDestroy(&p.toWrite);
+    }
+    BuffersClear(&p.raw);
+    BuffersClear(&p.out);
+    return best;
+}
+
+static int NumCpus(void)
+{
+#if defined(WIN32) || defined(_WIN32)
+    SYSTEM_INFO info;
+
+    GetSystemInfo(&info);
+    return (int)info.dwNumberOfProcessors;
+#else
+    long n=sysconf(_SC_NPROCESSORS_ONLN);
+
+    return n>0 ? (int)n : 1;
+#endif
+}
+
+int main(int argc, char *argv[])
+{
+    ThreadAffinity  affinity;
+    char            spec[128];
+    const char      *affinitySpec=NULL;
+    int             numCpus=NumCpus(),numWorkers,role,i,a;
+    int             procNode,readerNode,writerNode,remote=-1;
+    double          mbps;
+
+    for(a=1;a<argc;++a) {
+        if( strcmp(argv[a],"-affinity")==0 && a+1<argc )
+            affinitySpec = argv[++a];
+        else {
+            printf("Usage: %s [-affinity \"reader=0 processing=1-6 writer=7\"]\n",argv[0]);
+            return 2;
+        }
+    }
+    if( !affinitySpec ) {
+        if( numCpus>=3 )
+            sprintf(spec,"reader=0 processing=1-%d writer=%d",numCpus-2<MAX_WORKERS ? numCpus-2 : MAX_WORKERS,numCpus-1);
+        else
+            sprintf(spec,"reader=0 processing=%d writer=0",numCpus-1);
+        affinitySpec = spec;
+    }
+    if( ThreadAffinityParse(affinitySpec,&affinity)!=0 ) {
+        printf("Invalid affinity: %s\n",affinitySpec);
+        return 2;
+    }
+    numWorkers = affinity.numCpus[ThreadRoleProcessing]>0 ? affinity.numCpus[ThreadRoleProcessing] : 1;
+    if( numWorkers>MAX_WORKERS )
+        numWorkers = MAX_WORKERS;
+
+    printf("%d CPUs, affinity \"%s\"\n",numCpus,affinitySpec);
+    for(role=0;role<ThreadNumRoles;++role) {
+        printf("    %-10s",ThreadAffinityRoleName(role));
+        if( affinity.numCpus[role]==0 )
+            printf(" not pinned\n");
+        else {
+            printf(" CPUs");
+            for(i=0;i<affinity.numCpus[role];++i)
+                printf(" %d",affinity.cpus[role][i]);
+            printf(", node %d\n",ThreadAffinityNode(&affinity,role));
+        }
+    }
+    // The raw buffers are written by the reader and read by the
+    // processing threads, which also write the out buffers; place
+    // both on the processing node.
+    procNode = ThreadAffinityNode(&affinity,ThreadRoleProcessing);
+    readerNode = ThreadAffinityNode(&affinity,ThreadRoleReader);
+    writerNode = ThreadAffinityNode(&affinity,ThreadRoleWriter);
+    if( (readerNode>=0 && readerNode!=procNode) || (writerNode>=0 && writerNode!=procNode) )
+        printf("    reader, processing and writer are on different nodes\n");
+    for(i=0;i<numCpus && remote<0;++i)
+        if( ThreadAffinityCpuNode(i)>=0 && ThreadAffinityCpuNode(i)!=procNode )
+            remote = ThreadAffinityCpuNode(i);
+
+    printf("\n%d channels x %d samples, %.0f MB per block, %d processing threads\n",NUM_CHANS,NUM_SAMPS,BLOCK_BYTES/1e6,numWorkers);
+    printf("%-18s%12s\n","Buffers","MB/s");
+    printf("%-18s%12.0f\n","malloc",RunPipeline(&affinity,numWorkers,0,-1,-1,0,0));
+    printf("pool, 4 kB\n");
+    mbps = RunPipeline(&affinity,numWorkers,1,procNode,procNode,0,1);
+    printf("%-18s%12.0f\n","",mbps);
+    printf("pool, huge\n");
+    mbps = RunPipeline(&affinity,numWorkers,1,procNode,procNode,1,1);
+    printf("%-18s%12.0f\n","",mbps);
+    if( remote>=0 ) {
+        printf("pool, remote (node %d)\n",remote);
+        mbps = RunPipeline(&affinity,numWorkers,1,remote,remote,1,1);
+        printf("%-18s%12.0f\n","",mbps);
+    }
+    else
+        printf("pool, remote       skipped, one NUMA node\n");
+    return 0;
+}
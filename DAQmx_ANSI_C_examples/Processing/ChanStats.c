@@ -0,0 +1,511 @@
+/*********************************************************************
+*
+* Processing stage:
+*    ChanStats.c
+*
+* Description:
+*    Implementation of the fused per-channel statistics reducer. See
+*    ChanStats.h for the calling conventions.
+*
+*    One block produces one ChanStatsAccum per channel. Those are
+*    folded into the running total and stored in a ring of
+*    windowBlocks entries from which the window result is rebuilt.
+*    Results are published with a sequence counter: the writer makes
+*    it odd while it copies, readers retry until they see the same
+*    even value before and after their copy.
+*
+*    The F64 and F32 passes over GroupByChannel data run eight or four
+*    lanes wide with AVX, half that with SSE2 on other x86 builds, and
+*    as plain C elsewhere. The plain loop also does interleaved data
+*    and the samples left over after the vector loop.
+*
+*********************************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <stdatomic.h>
+#include "ChanStats.h"
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP>=2)
+#define CHANSTATS_SSE2
+#include <emmintrin.h>
+#endif
+
+typedef struct ChanStatsAccum {
+    double      min;
+    double      max;
+    double      sum;
+    double      sumSq;
+    long long   count;
+    long long   numNaN;
+    long long   numClipLow;
+    long long   numClipHigh;
+} ChanStatsAccum;
+
+struct ChanStats {
+    int             numChans;
+    double          clipLow;
+    double          clipHigh;
+    int             windowBlocks;
+    long long       numBlocks;
+    int             ringPos;
+    ChanStatsAccum  *total;         // numChans
+    ChanStatsAccum  *ring;          // windowBlocks*numChans
+    ChanStatsResult *pubRunning;    // numChans, read under seq
+    ChanStatsResult *pubWindow;
+    long long       pubBlocks;
+    atomic_uint     seq;
+};
+
+static void AccumInit(ChanStatsAccum *a)
+{
+    memset(a,0,sizeof(ChanStatsAccum));
+    a->min = HUGE_VAL;
+    a->max = -HUGE_VAL;
+}
+
+static void AccumMerge(ChanStatsAccum *a, const ChanStatsAccum *b)
+{
+    a->min = b->min<a->min ? b->min : a->min;
+    a->max = b->max>a->max ? b->max : a->max;
+    a->sum += b->sum;
+    a->sumSq += b->sumSq;
+    a->count += b->count;
+    a->numNaN += b->numNaN;
+    a->numClipLow += b->numClipLow;
+    a->numClipHigh += b->numClipHigh;
+}
+
+static void AccumToResult(const ChanStatsAccum *a, ChanStatsResult *r)
+{
+    double  var;
+
+    r->count = a->count;
+    r->numNaN = a->numNaN;
+    r->numClipLow = a->numClipLow;
+    r->numClipHigh = a->numClipHigh;
+    if( a->count==0 ) {
+        r->min = r->max = r->mean = r->rms = r->stdDev = NAN;
+        return;
+    }
+    r->min = a->min;
+    r->max = a->max;
+    r->mean = a->sum/a->count;
+    r->rms = sqrt(a->sumSq/a->count);
+    var = a->sumSq/a->count-r->mean*r->mean;
+    r->stdDev = var>0.0 ? sqrt(var) : 0.0;
+}
+
+// The single pass over one channel. NaN samples are counted and left
+// out of every other statistic.
+static void ReduceF64(const double x[], int n, size_t stride, double lo, double hi, ChanStatsAccum *a)
+{
+    double      mn=HUGE_VAL,mx=-HUGE_VAL,sum=0.0,sumSq=0.0;
+    long long   numNaN=0,numLo=0,numHi=0;
+    int         i=0;
+
+#if defined(__AVX__)
+    if( stride==1 && n>=4 ) {
+        const __m256d   ones=_mm256_set1_pd(1.0),vlo=_mm256_set1_pd(lo),vhi=_mm256_set1_pd(hi);
+        __m256d         vmin=_mm256_set1_pd(HUGE_VAL),vmax=_mm256_set1_pd(-HUGE_VAL);
+        __m256d         vsum=_mm256_setzero_pd(),vsq=_mm256_setzero_pd();
+        __m256d         vnan=_mm256_setzero_pd(),vnlo=_mm256_setzero_pd(),vnhi=_mm256_setzero_pd();
+        double          lane[4];
+        int             k;
+
+        for(;i+4<=n;i+=4) {
+            __m256d v=_mm256_loadu_pd(x+i);
+            __m256d ord=_mm256_cmp_pd(v,v,_CMP_ORD_Q);
+            __m256d vz=_mm256_and_pd(v,ord);
+
+            // min/max return the second operand when the first is NaN.
+            vmin = _mm256_min_pd(v,vmin);
+            vmax = _mm256_max_pd(v,vmax);
+            vsum = _mm256_add_pd(vsum,vz);
+            vsq = _mm256_add_pd(vsq,_mm256_mul_pd(vz,vz));
+            vnan = _mm256_add_pd(vnan,_mm256_andnot_pd(ord,ones));
+            vnlo = _mm256_add_pd(vnlo,_mm256_and_pd(_mm256_cmp_pd(v,vlo,_CMP_LE_OQ),ones));
+            vnhi = _mm256_add_pd(vnhi,_mm256_and_pd(_mm256_cmp_pd(v,vhi,_CMP_GE_OQ),ones));
+        }
+        _mm256_storeu_pd(lane,vmin);
+        for(k=0;k<4;++k) mn = lane[k]<mn ? lane[k] : mn;
+        _mm256_storeu_pd(lane,vmax);
+        for(k=0;k<4;++k) mx = lane[k]>mx ? lane[k] : mx;
+        _mm256_storeu_pd(lane,vsum);
+        sum = (lane[0]+lane[1])+(lane[2]+lane[3]);
+        _mm256_storeu_pd(lane,vsq);
+        sumSq = (lane[0]+lane[1])+(lane[2]+lane[3]);
+        _mm256_storeu_pd(lane,vnan);
+        numNaN = (long long)(lane[0]+lane[1]+lane[2]+lane[3]);
+        _mm256_storeu_pd(lane,vnlo);
+        numLo = (long long)(lane[0]+lane[1]+lane[2]+lane[3]);
+        _mm256_storeu_pd(lane,vnhi);
+        numHi = (long long)(lane[0]+lane[1]+lane[2]+lane[3]);
+    }
+#elif defined(CHANSTATS_SSE2)
+    // The same loop two lanes wide, for x86 builds without AVX.
+    if( stride==1 && n>=2 ) {
+        const __m128d   ones=_mm_set1_pd(1.0),vlo=_mm_set1_pd(lo),vhi=_mm_set1_pd(hi);
+        __m128d         vmin=_mm_set1_pd(HUGE_VAL),vmax=_mm_set1_pd(-HUGE_VAL);
+        __m128d         vsum=_mm_setzero_pd(),vsq=_mm_setzero_pd();
+        __m128d         vnan=_mm_setzero_pd(),vnlo=_mm_setzero_pd(),vnhi=_mm_setzero_pd();
+        double          lane[2];
+
+        for(;i+2<=n;i+=2) {
+            __m128d v=_mm_loadu_pd(x+i);
+            __m128d ord=_mm_cmpord_pd(v,v);
+            __m128d vz=_mm_and_pd(v,ord);
+
+            vmin = _mm_min_pd(v,vmin);
+            vmax = _mm_max_pd(v,vmax);
+            vsum = _mm_add_pd(vsum,vz);
+            vsq = _mm_add_pd(vsq,_mm_mul_pd(vz,vz));
+            vnan = _mm_add_pd(vnan,_mm_andnot_pd(ord,ones));
+            vnlo = _mm_add_pd(vnlo,_mm_and_pd(_mm_cmple_pd(v,vlo),ones));
+            vnhi = _mm_add_pd(vnhi,_mm_and_pd(_mm_cmpge_pd(v,vhi),ones));
+        }
+        _mm_storeu_pd(lane,vmin);
+        mn = lane[0]<lane[1] ? lane[0] : lane[1];
+        _mm_storeu_pd(lane,vmax);
+        mx = lane[0]>lane[1] ? lane[0] : lane[1];
+        _mm_storeu_pd(lane,vsum);
+        sum = lane[0]+lane[1];
+        _mm_storeu_pd(lane,vsq);
+        sumSq = lane[0]+lane[1];
+        _mm_storeu_pd(lane,vnan);
+        numNaN = (long long)(lane[0]+lane[1]);
+        _mm_storeu_pd(lane,vnlo);
+        numLo = (long long)(lane[0]+lane[1]);
+        _mm_storeu_pd(lane,vnhi);
+        numHi = (long long)(lane[0]+lane[1]);
+    }
+#endif
+    for(;i<n;++i) {
+        double v=x[i*stride];
+
+        if( v!=v ) {
+            ++numNaN;
+            continue;
+        }
+        mn = v<mn ? v : mn;
+        mx = v>mx ? v : mx;
+        sum += v;
+        sumSq += v*v;
+        numLo += v<=lo;
+        numHi += v>=hi;
+    }
+    a->min = mn;
+    a->max = mx;
+    a->sum = sum;
+    a->sumSq = sumSq;
+    a->numNaN = numNaN;
+    a->count = n-numNaN;
+    a->numClipLow = numLo;
+    a->numClipHigh = numHi;
+}
+
+// As ReduceF64. The vector loop keeps 8 float lanes and folds them
+// into the double totals every FOLD_F32 iterations, so that the float
+// sums never grow large enough to lose precision.
+#define FOLD_F32    64
+
+static void ReduceF32(const float x[], int n, size_t stride, double lo, double hi, ChanStatsAccum *a)
+{
+    float       mn=HUGE_VALF,mx=-HUGE_VALF;
+    double      sum=0.0,sumSq=0.0;
+    long long   numNaN=0,numLo=0,numHi=0;
+    int         i=0;
+
+#if defined(__AVX__)
+    if( stride==1 && n>=8 ) {
+        const __m256    ones=_mm256_set1_ps(1.0f),vlo=_mm256_set1_ps((float)lo),vhi=_mm256_set1_ps((float)hi);
+        __m256          vmin=_mm256_set1_ps(HUGE_VALF),vmax=_mm256_set1_ps(-HUGE_VALF);
+        float           lane[8];
+        int             k;
+
+        while( i+8<=n ) {
+            __m256  vsum=_mm256_setzero_ps(),vsq=_mm256_setzero_ps();
+            __m256  vnan=_mm256_setzero_ps(),vnlo=_mm256_setzero_ps(),vnhi=_mm256_setzero_ps();
+            int     end=n-i>=8*FOLD_F32 ? i+8*FOLD_F32 : i+((n-i)&~7);
+
+            for(;i<end;i+=8) {
+                __m256 v=_mm256_loadu_ps(x+i);
+                __m256 ord=_mm256_cmp_ps(v,v,_CMP_ORD_Q);
+                __m256 vz=_mm256_and_ps(v,ord);
+
+                vmin = _mm256_min_ps(v,vmin);
+                vmax = _mm256_max_ps(v,vmax);
+                vsum = _mm256_add_ps(vsum,vz);
+                vsq = _mm256_add_ps(vsq,_mm256_mul_ps(vz,vz));
+                vnan = _mm256_add_ps(vnan,_mm256_andnot_ps(ord,ones));
+                vnlo = _mm256_add_ps(vnlo,_mm256_and_ps(_mm256_cmp_ps(v,vlo,_CMP_LE_OQ),ones));
+                vnhi = _mm256_add_ps(vnhi,_mm256_and_ps(_mm256_cmp_ps(v,vhi,_CMP_GE_OQ),ones));
+            }
+            _mm256_storeu_ps(lane,vsum);
+            for(k=0;k<8;++k) sum += lane[k];
+            _mm256_storeu_ps(lane,vsq);
+            for(k=0;k<8;++k) sumSq += lane[k];
+            _mm256_storeu_ps(lane,vnan);
+            for(k=0;k<8;++k) numNaN += (long long)lane[k];
+            _mm256_storeu_ps(lane,vnlo);
+            for(k=0;k<8;++k) numLo += (long long)lane[k];
+            _mm256_storeu_ps(lane,vnhi);
+            for(k=0;k<8;++k) numHi += (long long)lane[k];
+        }
+        _mm256_storeu_ps(lane,vmin);
+        for(k=0;k<8;++k) mn = lane[k]<mn ? lane[k] : mn;
+        _mm256_storeu_ps(lane,vmax);
+        for(k=0;k<8;++k) mx = lane[k]>mx ? lane[k] : mx;
+    }
+#elif defined(CHANSTATS_SSE2)
+    if( stride==1 && n>=4 ) {
+        const __m128    ones=_mm_set1_ps(1.0f),vlo=_mm_set1_ps((float)lo),vhi=_mm_set1_ps((float)hi);
+        __m128          vmin=_mm_set1_ps(HUGE_VALF),vmax=_mm_set1_ps(-HUGE_VALF);
+        float           lane[4];
+        int             k;
+
+        while( i+4<=n ) {
+            __m128  vsum=_mm_setzero_ps(),vsq=_mm_setzero_ps();
+            __m128  vnan=_mm_setzero_ps(),vnlo=_mm_setzero_ps(),vnhi=_mm_setzero_ps();
+            int     end=n-i>=4*FOLD_F32 ? i+4*FOLD_F32 : i+((n-i)&~3);
+
+            for(;i<end;i+=4) {
+                __m128 v=_mm_loadu_ps(x+i);
+                __m128 ord=_mm_cmpord_ps(v,v);
+                __m128 vz=_mm_and_ps(v,ord);
+
+                vmin = _mm_min_ps(v,vmin);
+                vmax = _mm_max_ps(v,vmax);
+                vsum = _mm_add_ps(vsum,vz);
+                vsq = _mm_add_ps(vsq,_mm_mul_ps(vz,vz));
+                vnan = _mm_add_ps(vnan,_mm_andnot_ps(ord,ones));
+                vnlo = _mm_add_ps(vnlo,_mm_and_ps(_mm_cmple_ps(v,vlo),ones));
+                vnhi = _mm_add_ps(vnhi,_mm_and_ps(_mm_cmpge_ps(v,vhi),ones));
+            }
+            _mm_storeu_ps(lane,vsum);
+            for(k=0;k<4;++k) sum += lane[k];
+            _mm_storeu_ps(lane,vsq);
+            for(k=0;k<4;++k) sumSq += lane[k];
+            _mm_storeu_ps(lane,vnan);
+            for(k=0;k<4;++k) numNaN += (long long)lane[k];
+            _mm_storeu_ps(lane,vnlo);
+            for(k=0;k<4;++k) numLo += (long long)lane[k];
+            _mm_storeu_ps(lane,vnhi);
+            for(k=0;k<4;++k) numHi += (long long)lane[k];
+        }
+        _mm_storeu_ps(lane,vmin);
+        for(k=0;k<4;++k) mn = lane[k]<mn ? lane[k] : mn;
+        _mm_storeu_ps(lane,vmax);
+        for(k=0;k<4;++k) mx = lane[k]>mx ? lane[k] : mx;
+    }
+#endif
+    for(;i<n;++i) {
+        float v=x[i*stride];
+
+        if( v!=v ) {
+            ++numNaN;
+            continue;
+        }
+        mn = v<mn ? v : mn;
+        mx = v>mx ? v : mx;
+        sum += v;
+        sumSq += (double)v*v;
+        numLo += v<=lo;
+        numHi += v>=hi;
+    }
+    a->min = mn;
+    a->max = mx;
+    a->sum = sum;
+    a->sumSq = sumSq;
+    a->numNaN = numNaN;
+    a->count = n-numNaN;
+    a->numClipLow = numLo;
+    a->numClipHigh = numHi;
+}
+
+static void ReduceI16(const short x[], int n, size_t stride, int lo, int hi, ChanStatsAccum *a)
+{
+    int         mn=32767,mx=-32768,i;
+    long long   sum=0,sumSq=0,numLo=0,numHi=0;
+
+    // Integer accumulation is exact, so the compiler is free to
+    // vectorise this loop.
+    for(i=0;i<n;++i) {
+        int v=x[i*stride];
+
+        mn = v<mn ? v : mn;
+        mx = v>mx ? v : mx;
+        sum += v;
+        sumSq += v*v;
+        numLo += v<=lo;
+        numHi += v>=hi;
+    }
+    a->min = n ? mn : HUGE_VAL;
+    a->max = n ? mx : -HUGE_VAL;
+    a->sum = (double)sum;
+    a->sumSq = (double)sumSq;
+    a->numNaN = 0;
+    a->count = n;
+    a->numClipLow = numLo;
+    a->numClipHigh = numHi;
+}
+
+static void Publish(ChanStats *s)
+{
+    unsigned        seq=atomic_load_explicit(&s->seq,memory_order_relaxed);
+    ChanStatsAccum  win;
+    int             c,k,numWin=s->numBlocks<s->windowBlocks ? (int)s->numBlocks : s->windowBlocks;
+
+    atomic_store_explicit(&s->seq,seq+1,memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    for(c=0;c<s->numChans;++c) {
+        AccumToResult(&s->total[c],&s->pubRunning[c]);
+        AccumInit(&win);
+        for(k=0;k<numWin;++k)
+            AccumMerge(&win,&s->ring[k*s->numChans+c]);
+        AccumToResult(&win,&s->pubWindow[c]);
+    }
+    s->pubBlocks = s->numBlocks;
+    atomic_store_explicit(&s->seq,seq+2,memory_order_release);
+}
+
+int ChanStatsCreate(int numChans, double clipLow, double clipHigh, int windowBlocks, ChanStats **stats)
+{
+    ChanStats   *s;
+
+    *stats = NULL;
+    if( numChans<1 || windowBlocks<1 || clipLow>=clipHigh )
+        return ChanStatsErrInvalidArg;
+    s = (ChanStats*)calloc(1,sizeof(ChanStats));
+    if( !s )
+        return ChanStatsErrOutOfMemory;
+    s->numChans = numChans;
+    s->clipLow = clipLow;
+    s->clipHigh = clipHigh;
+    s->windowBlocks = windowBlocks;
+    s->total = (ChanStatsAccum*)malloc(sizeof(ChanStatsAccum)*numChans);
+    s->ring = (ChanStatsAccum*)malloc(sizeof(ChanStatsAccum)*numChans*windowBlocks);
+    s->pubRunning = (ChanStatsResult*)malloc(sizeof(ChanStatsResult)*numChans);
+    s->pubWindow = (ChanStatsResult*)malloc(sizeof(ChanStatsResult)*numChans);
+    if( !s->total || !s->ring || !s->pubRunning || !s->pubWindow ) {
+        ChanStatsClear(s);
+        return ChanStatsErrOutOfMemory;
+    }
+    atomic_init(&s->seq,0);
+    ChanStatsReset(s);
+    *stats = s;
+    return 0;
+}
+
+void ChanStatsClear(ChanStats *stats)
+{
+    if( !stats )
+        return;
+    free(stats->total);
+    free(stats->ring);
+    free(stats->pubRunning);
+    free(stats->pubWindow);
+    free(stats);
+}
+
+void ChanStatsReset(ChanStats *stats)
+{
+    int c;
+
+    for(c=0;c<stats->numChans;++c)
+        AccumInit(&stats->total[c]);
+    stats->numBlocks = 0;
+    stats->ringPos = 0;
+    Publish(stats);
+}
+
+int ChanStatsAddF64(ChanStats *stats, const double data[], int numSampsPerChan, int interleaved)
+{
+    ChanStatsAccum  *slot;
+    int             c;
+
+    if( numSampsPerChan<0 )
+        return ChanStatsErrInvalidArg;
+    slot = &stats->ring[stats->ringPos*stats->numChans];
+    for(c=0;c<stats->numChans;++c) {
+        if( interleaved )
+            ReduceF64(data+c,numSampsPerChan,stats->numChans,stats->clipLow,stats->clipHigh,&slot[c]);
+        else
+            ReduceF64(data+(size_t)c*numSampsPerChan,numSampsPerChan,1,stats->clipLow,stats->clipHigh,&slot[c]);
+        AccumMerge(&stats->total[c],&slot[c]);
+    }
+    stats->ringPos = (stats->ringPos+1)%stats->windowBlocks;
+    ++stats->numBlocks;
+    Publish(stats);
+    return 0;
+}
+
+int ChanStatsAddF32(ChanStats *stats, const float data[], int numSampsPerChan, int interleaved)
+{
+    ChanStatsAccum  *slot;
+    int             c;
+
+    if( numSampsPerChan<0 )
+        return ChanStatsErrInvalidArg;
+    slot = &stats->ring[stats->ringPos*stats->numChans];
+    for(c=0;c<stats->numChans;++c) {
+        if( interleaved )
+            ReduceF32(data+c,numSampsPerChan,stats->numChans,stats->clipLow,stats->clipHigh,&slot[c]);
+        else
+            ReduceF32(data+(size_t)c*numSampsPerChan,numSampsPerChan,1,stats->clipLow,stats->clipHigh,&slot[c]);
+        AccumMerge(&stats->total[c],&slot[c]);
+    }
+    stats->ringPos = (stats->ringPos+1)%stats->windowBlocks;
+    ++stats->numBlocks;
+    Publish(stats);
+    return 0;
+}
+
+int ChanStatsAddI16(ChanStats *stats, const short data[], int numSampsPerChan, int interleaved)
+{
+    ChanStatsAccum  *slot;
+    int             lo=(int)ceil(stats->clipLow),hi=(int)floor(stats->clipHigh);
+    int             c;
+
+    if( numSampsPerChan<0 )
+        return ChanStatsErrInvalidArg;
+    slot = &stats->ring[stats->ringPos*stats->numChans];
+    for(c=0;c<stats->numChans;++c) {
+        if( interleaved )
+            ReduceI16(data+c,numSampsPerChan,stats->numChans,lo,hi,&slot[c]);
+        else
+            ReduceI16(data+(size_t)c*numSampsPerChan,numSampsPerChan,1,lo,hi,&slot[c]);
+        AccumMerge(&stats->total[c],&slot[c]);
+    }
+    stats->ringPos = (stats->ringPos+1)%stats->windowBlocks;
+    ++stats->numBlocks;
+    Publish(stats);
+    return 0;
+}
+
+long long ChanStatsQuery(const ChanStats *stats, int chan, ChanStatsResult *running, ChanStatsResult *window)
+{
+    atomic_uint     *seq=(atomic_uint*)&stats->seq;
+    ChanStatsResult r,w;
+    long long       numBlocks;
+    unsigned        before,after;
+
+    if( chan<0 || chan>=stats->numChans )
+        return ChanStatsErrInvalidArg;
+    do {
+        before = atomic_load_explicit(seq,memory_order_acquire);
+        r = stats->pubRunning[chan];
+        w = stats->pubWindow[chan];
+        numBlocks = stats->pubBlocks;
+        atomic_thread_fence(memory_order_acquire);
+        after = atomic_load_explicit(seq,memory_order_relaxed);
+    } while( (before&1) || before!=after );
+    if( running )
+        *running = r;
+    if( window )
+        *window = w;
+    return numBlocks;
+}
@@ -0,0 +1,66 @@
+/*********************************************************************
+*
+* Processing stage:
+*    ChanStats.h
+*
+* Description:
+*    Per-channel health statistics computed in a single pass over the
+*    buffer that DAQmxReadAnalogF64 or DAQmxReadBinaryI16 has just
+*    filled, or that AIScale has just scaled to float, while it is
+*    still in cache. Each block updates the min, max, sum, sum of
+*    squares, NaN count and the number of samples at or beyond the
+*    clip limits (normally the -10/+10 V range given to
+*    DAQmxCreateAIVoltageChan, or the matching raw codes for I16).
+*
+*    Two aggregates are kept per channel: a running total since the
+*    stream started and a window over the last windowBlocks blocks.
+*    After every block they are published under a sequence lock, so
+*    ChanStatsQuery may be called from any other thread without
+*    blocking the acquisition.
+*
+*********************************************************************/
+
+#ifndef CHANSTATS_H
+#define CHANSTATS_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define ChanStatsErrInvalidArg      -1
+#define ChanStatsErrOutOfMemory     -2
+
+typedef struct ChanStatsResult {
+    double      min;
+    double      max;
+    double      mean;
+    double      rms;
+    double      stdDev;
+    long long   count;          // samples that were not NaN
+    long long   numNaN;
+    long long   numClipLow;     // samples <= clipLow
+    long long   numClipHigh;    // samples >= clipHigh
+} ChanStatsResult;
+
+typedef struct ChanStats ChanStats;
+
+int  ChanStatsCreate(int numChans, double clipLow, double clipHigh, int windowBlocks, ChanStats **stats);
+void ChanStatsClear(ChanStats *stats);
+void ChanStatsReset(ChanStats *stats);
+
+// Data are DAQmx_Val_GroupByScanNumber when interleaved is set and
+// DAQmx_Val_GroupByChannel otherwise. For I16 data the clip limits
+// and the results are in raw ADC codes.
+int  ChanStatsAddF64(ChanStats *stats, const double data[], int numSampsPerChan, int interleaved);
+int  ChanStatsAddF32(ChanStats *stats, const float data[], int numSampsPerChan, int interleaved);
+int  ChanStatsAddI16(ChanStats *stats, const short data[], int numSampsPerChan, int interleaved);
+
+// Safe to call from any thread. Either output pointer may be NULL.
+// Returns the number of blocks included in the running result.
+long long ChanStatsQuery(const ChanStats *stats, int chan, ChanStatsResult *running, ChanStatsResult *window);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
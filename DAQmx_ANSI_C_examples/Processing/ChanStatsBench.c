@@ -0,0 +1,115 @@
+/*********************************************************************
+*
+* Processing benchmark:
+*    ChanStatsBench.c
+*
+* Description:
+*    Compares ChanStatsAddF64/ChanStatsAddI16 with the separate loops
+*    they replace (one pass each for min, max, sum, sum of squares
+*    and clip counts) on GroupByChannel blocks of several sizes.
+*    The fused results for channel 0 are printed as a sanity check.
+*
+*    No DAQ hardware is needed. Build with ChanStats.c.
+*
+*********************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include "ChanStats.h"
+#include "StreamTime.h"
+
+#define NUM_CHANS   8
+#define TOTAL_SAMPS 20000000
+
+static double   naiveSink;
+
+static void NaiveF64(const double data[], int numChans, int n, double lo, double hi)
+{
+    int c,i;
+
+    for(c=0;c<numChans;++c) {
+        const double    *x=data+(size_t)c*n;
+        double          mn=HUGE_VAL,mx=-HUGE_VAL,sum=0.0,sumSq=0.0;
+        long long       numLo=0,numHi=0;
+
+        for(i=0;i<n;++i) mn = x[i]<mn ? x[i] : mn;
+        for(i=0;i<n;++i) mx = x[i]>mx ? x[i] : mx;
+        for(i=0;i<n;++i) sum += x[i];
+        for(i=0;i<n;++i) sumSq += x[i]*x[i];
+        for(i=0;i<n;++i) numLo += x[i]<=lo;
+        for(i=0;i<n;++i) numHi += x[i]>=hi;
+        naiveSink += mn+mx+sum+sumSq+(double)(numLo+numHi);
+    }
+}
+
+static void NaiveI16(const short data[], int numChans, int n, int lo, int hi)
+{
+    int c,i;
+
+    for(c=0;c<numChans;++c) {
+        const short *x=data+(size_t)c*n;
+        int         mn=32767,mx=-32768;
+        long long   sum=0,sumSq=0,numLo=0,numHi=0;
+
+        for(i=0;i<n;++i) mn = x[i]<mn ? x[i] : mn;
+        for(i=0;i<n;++i) mx = x[i]>mx ? x[i] : mx;
+        for(i=0;i<n;++i) sum += x[i];
+        for(i=0;i<n;++i) sumSq += x[i]*x[i];
+        for(i=0;i<n;++i) numLo += x[i]<=lo;
+        for(i=0;i<n;++i) numHi += x[i]>=hi;
+        naiveSink += mn+mx+(double)(sum+sumSq+numLo+numHi);
+    }
+}
+
+int main(void)
+{
+    int         blockSizes[]={100,1000,10000,100000};
+    int         k;
+
+    printf("Block\tF64 naive\tF64 fused\tI16 naive\tI16 fused   (ns/sample)\n");
+    for(k=0;k<(int)(sizeof(blockSizes)/sizeof(blockSizes[0]));++k) {
+        int             n=blockSizes[k],reps=TOTAL_SAMPS/(n*NUM_CHANS),r,i;
+        double          *f=(double*)malloc(sizeof(double)*n*NUM_CHANS);
+        short           *s=(short*)malloc(sizeof(short)*n*NUM_CHANS);
+        ChanStats       *stats;
+        ChanStatsResult res;
+        double          t[5];
+
+        for(i=0;i<n*NUM_CHANS;++i) {
+            f[i] = 10.5*sin(0.01*i);
+            s[i] = (short)(32767*sin(0.01*i));
+        }
+        ChanStatsCreate(NUM_CHANS,-10.0,10.0,10,&stats);
+
+        t[0] = StreamTimeNow();
+        for(r=0;r<reps;++r)
+            NaiveF64(f,NUM_CHANS,n,-10.0,10.0);
+        t[1] = StreamTimeNow();
+        for(r=0;r<reps;++r)
+            ChanStatsAddF64(stats,f,n,0);
+        t[2] = StreamTimeNow();
+        ChanStatsQuery(stats,0,&res,NULL);
+        ChanStatsClear(stats);
+
+        ChanStatsCreate(NUM_CHANS,-32000.0,32000.0,10,&stats);
+        t[3] = StreamTimeNow();
+        for(r=0;r<reps;++r)
+            NaiveI16(s,NUM_CHANS,n,-32000,32000);
+        t[4] = StreamTimeNow();
+        for(r=0;r<reps;++r)
+            ChanStatsAddI16(stats,s,n,0);
+        t[3] = (t[4]-t[3]);
+        t[4] = StreamTimeNow()-t[4];
+        ChanStatsClear(stats);
+
+        printf("%d\t%.3f\t\t%.3f\t\t%.3f\t\t%.3f\n",n,
+            1e9*(t[1]-t[0])/((double)reps*n*NUM_CHANS),1e9*(t[2]-t[1])/((double)reps*n*NUM_CHANS),
+            1e9*t[3]/((double)reps*n*NUM_CHANS),1e9*t[4]/((double)reps*n*NUM_CHANS));
+        printf("\tchan 0: min %.3f max %.3f rms %.3f clipped %lld/%lld\n",
+            res.min,res.max,res.rms,res.numClipLow,res.numClipHigh);
+        free(f);
+        free(s);
+    }
+    return naiveSink==12345.0;
+}
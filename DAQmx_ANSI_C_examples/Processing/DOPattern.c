@@ -0,0 +1,269 @@
+/*********************************************************************
+*
+* Processing stage:
+*    DOPattern.c
+*
+* Description:
+*    Implementation of the digital pattern compiler. See DOPattern.h
+*    for the calling conventions.
+*
+*    Compiling is a merge of the per-line edge lists. A port has at
+*    most 32 lines, so the next edge is found by scanning the line
+*    heads rather than with a heap. Edges of several lines at the same
+*    sample toggle together and produce a single run.
+*
+*********************************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+#include "DOPattern.h"
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
+
+typedef struct Line {
+    long long   *edges;
+    int         numEdges;
+    int         initialLevel;
+} Line;
+
+struct DOPattern {
+    int         numLines;
+    Line        lines[DOPatternMaxLines];
+    long long   length;
+    long long   *runStart;      // numRuns+1 entries, the last one is length
+    unsigned    *runWord;
+    long long   numRuns;
+    long long   cursor;         // run holding the sample after the last render
+    long long   cursorSample;
+};
+
+int DOPatternCreate(int numLines, DOPattern **pattern)
+{
+    DOPattern   *p;
+
+    *pattern = NULL;
+    if( numLines<1 || numLines>DOPatternMaxLines )
+        return DOPatternErrInvalidArg;
+    p = (DOPattern*)calloc(1,sizeof(DOPattern));
+    if( !p )
+        return DOPatternErrOutOfMemory;
+    p->numLines = numLines;
+    p->cursorSample = -1;
+    *pattern = p;
+    return 0;
+}
+
+void DOPatternClear(DOPattern *pattern)
+{
+    int i;
+
+    if( !pattern )
+        return;
+    for(i=0;i<pattern->numLines;++i)
+        free(pattern->lines[i].edges);
+    free(pattern->runStart);
+    free(pattern->runWord);
+    free(pattern);
+}
+
+int DOPatternSetLine(DOPattern *pattern, int line, int initialLevel, const long long edges[], int numEdges)
+{
+    Line        *l;
+    long long   *copy=NULL;
+    int         i;
+
+    if( line<0 || line>=pattern->numLines || numEdges<0 || (numEdges>0 && !edges) )
+        return DOPatternErrInvalidArg;
+    for(i=0;i<numEdges;++i)
+        if( edges[i]<0 || (i>0 && edges[i]<=edges[i-1]) )
+            return DOPatternErrInvalidArg;
+    if( numEdges>0 ) {
+        copy = (long long*)malloc(numEdges*sizeof(long long));
+        if( !copy )
+            return DOPatternErrOutOfMemory;
+        memcpy(copy,edges,numEdges*sizeof(long long));
+    }
+    l = &pattern->lines[line];
+    free(l->edges);
+    l->edges = copy;
+    l->numEdges = numEdges;
+    l->initialLevel = initialLevel!=0;
+    pattern->numRuns = 0;
+    return 0;
+}
+
+int DOPatternPulseTrain(long long edges[], long long start, long long highSamples, long long period, int count)
+{
+    int k;
+
+    if( start<0 || highSamples<1 || period<=highSamples || count<0 )
+        return DOPatternErrInvalidArg;
+    for(k=0;k<count;++k) {
+        edges[2*k] = start+k*period;
+        edges[2*k+1] = start+k*period+highSamples;
+    }
+    return 2*count;
+}
+
+int DOPatternCompile(DOPattern *p, long long length)
+{
+    int         head[DOPatternMaxLines];
+    long long   maxRuns=1,n=0;
+    unsigned    word=0;
+    int         i;
+
+    if( length<1 )
+        return DOPatternErrInvalidArg;
+    for(i=0;i<p->numLines;++i) {
+        head[i] = 0;
+        maxRuns += p->lines[i].numEdges;
+        word |= (unsigned)p->lines[i].initialLevel<<i;
+    }
+    free(p->runStart);
+    free(p->runWord);
+    p->numRuns = 0;
+    p->runStart = (long long*)malloc((maxRuns+1)*sizeof(long long));
+    p->runWord = (unsigned*)malloc(maxRuns*sizeof(unsigned));
+    if( !p->runStart || !p->runWord )
+        return DOPatternErrOutOfMemory;
+
+    p->runStart[0] = 0;
+    p->runWord[0] = word;
+    n = 1;
+    for(;;) {
+        long long   next=length;
+        unsigned    toggle=0;
+
+        for(i=0;i<p->numLines;++i)
+            if( head[i]<p->lines[i].numEdges && p->lines[i].edges[head[i]]<next )
+                next = p->lines[i].edges[head[i]];
+        if( next>=length )
+            break;
+        for(i=0;i<p->numLines;++i)
+            if( head[i]<p->lines[i].numEdges && p->lines[i].edges[head[i]]==next ) {
+                toggle |= 1u<<i;
+                ++head[i];
+            }
+        word ^= toggle;
+        if( next==p->runStart[n-1] )
+            p->runWord[n-1] = word;     // edges at sample 0
+        else {
+            p->runStart[n] = next;
+            p->runWord[n] = word;
+            ++n;
+        }
+    }
+    p->runStart[n] = length;
+    p->numRuns = n;
+    p->length = length;
+    p->cursorSample = -1;
+    return 0;
+}
+
+long long DOPatternLength(const DOPattern *pattern)
+{
+    return pattern->length;
+}
+
+long long DOPatternNumRuns(const DOPattern *pattern)
+{
+    return pattern->numRuns;
+}
+
+static void FillU32(unsigned int out[], unsigned int word, long long n)
+{
+    long long   i=0;
+
+#if defined(__AVX__)
+    __m256i v=_mm256_set1_epi32((int)word);
+
+    for(;i+32<=n;i+=32) {
+        _mm256_storeu_si256((__m256i*)(out+i),v);
+        _mm256_storeu_si256((__m256i*)(out+i+8),v);
+        _mm256_storeu_si256((__m256i*)(out+i+16),v);
+        _mm256_storeu_si256((__m256i*)(out+i+24),v);
+    }
+    for(;i+8<=n;i+=8)
+        _mm256_storeu_si256((__m256i*)(out+i),v);
+#elif defined(__SSE2__) || defined(_M_X64)
+    __m128i v=_mm_set1_epi32((int)word);
+
+    for(;i+16<=n;i+=16) {
+        _mm_storeu_si128((__m128i*)(out+i),v);
+        _mm_storeu_si128((__m128i*)(out+i+4),v);
+        _mm_storeu_si128((__m128i*)(out+i+8),v);
+        _mm_storeu_si128((__m128i*)(out+i+12),v);
+    }
+    for(;i+4<=n;i+=4)
+        _mm_storeu_si128((__m128i*)(out+i),v);
+#endif
+    for(;i<n;++i)
+        out[i] = word;
+}
+
+// Run holding sample s, by binary search unless s continues the last
+// render.
+static long long FindRun(DOPattern *p, long long s)
+{
+    long long lo=0,hi=p->numRuns-1;
+
+    if( s==p->cursorSample )
+        return p->cursor;
+    if( s>=p->length )
+        return p->numRuns-1;
+    while( lo<hi ) {
+        long long mid=(lo+hi+1)/2;
+
+        if( p->runStart[mid]<=s )
+            lo = mid;
+        else
+            hi = mid-1;
+    }
+    return lo;
+}
+
+// Fills out with the words for [first,first+numSamples), one run at
+// a time. wordSize is 4 for U32 and 1 for U8 ports.
+static void RenderRuns(DOPattern *p, long long first, int numSamples, void *out, int wordSize)
+{
+    long long   r=FindRun(p,first),s=first,end=first+numSamples;
+
+    while( s<end ) {
+        long long stop=r<p->numRuns-1 && p->runStart[r+1]<end ? p->runStart[r+1] : end;
+
+        if( wordSize==4 )
+            FillU32((unsigned int*)out+(s-first),p->runWord[r],stop-s);
+        else
+            // memset is already vectorised by the C library.
+            memset((unsigned char*)out+(s-first),(int)p->runWord[r],(size_t)(stop-s));
+        s = stop;
+        if( r<p->numRuns-1 && s==p->runStart[r+1] )
+            ++r;
+    }
+    p->cursor = r;
+    p->cursorSample = end;
+}
+
+int DOPatternRenderU32(DOPattern *pattern, long long first, int numSamples, unsigned int out[])
+{
+    if( pattern->numRuns==0 )
+        return DOPatternErrNotCompiled;
+    if( first<0 || numSamples<0 )
+        return DOPatternErrInvalidArg;
+    RenderRuns(pattern,first,numSamples,out,4);
+    return 0;
+}
+
+int DOPatternRenderU8(DOPattern *pattern, long long first, int numSamples, unsigned char out[])
+{
+    if( pattern->numRuns==0 )
+        return DOPatternErrNotCompiled;
+    if( first<0 || numSamples<0 || pattern->numLines>8 )
+        return DOPatternErrInvalidArg;
+    RenderRuns(pattern,first,numSamples,out,1);
+    return 0;
+}
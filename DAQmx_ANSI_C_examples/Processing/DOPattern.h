@@ -0,0 +1,65 @@
+/*********************************************************************
+*
+* Processing stage:
+*    DOPattern.h
+*
+* Description:
+*    Compiles per-line edge lists into packed port words for
+*    hardware-timed digital output. WriteDigChan.c writes one uInt8
+*    per line with DAQmxWriteDigitalLines. A port-wide DO channel
+*    written with DAQmxWriteDigitalU32 (or U8 for ports of up to 8
+*    lines) takes one word per sample, with line k in bit k.
+*
+*    Each line is described by its level at sample 0 and the sorted
+*    sample indices at which it toggles. DOPatternCompile merges the
+*    lines into a run list: the sample at which each run starts and
+*    the port word held until the next run. The run list is usually
+*    far smaller than the pattern, so a pattern of any length can be
+*    rendered block by block into a non-regenerating output buffer.
+*    Rendering is a vectorised fill of each run.
+*
+*********************************************************************/
+
+#ifndef DOPATTERN_H
+#define DOPATTERN_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define DOPatternErrInvalidArg      -1
+#define DOPatternErrOutOfMemory     -2
+#define DOPatternErrNotCompiled     -3
+
+#define DOPatternMaxLines           32
+
+typedef struct DOPattern DOPattern;
+
+int  DOPatternCreate(int numLines, DOPattern **pattern);
+void DOPatternClear(DOPattern *pattern);
+
+// edges holds numEdges strictly increasing, non-negative sample
+// indices at which the line toggles. The edges are copied.
+int  DOPatternSetLine(DOPattern *pattern, int line, int initialLevel, const long long edges[], int numEdges);
+
+// Fills edges with count pulses of highSamples starting every period
+// samples from start, i.e. 2*count edges. Returns the number written.
+int  DOPatternPulseTrain(long long edges[], long long start, long long highSamples, long long period, int count);
+
+// Merges the lines into runs over samples [0,length).
+int  DOPatternCompile(DOPattern *pattern, long long length);
+
+long long DOPatternLength(const DOPattern *pattern);
+long long DOPatternNumRuns(const DOPattern *pattern);
+
+// Writes the port words for samples [first,first+numSamples). Samples
+// at or past the pattern length repeat the final word. Consecutive
+// calls that continue where the last one ended need no search.
+int  DOPatternRenderU32(DOPattern *pattern, long long first, int numSamples, unsigned int out[]);
+int  DOPatternRenderU8(DOPattern *pattern, long long first, int numSamples, unsigned char out[]);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
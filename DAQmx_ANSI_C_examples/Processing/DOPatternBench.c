@@ -0,0 +1,105 @@
+/*********************************************************************
+*
+* Processing benchmark:
+*    DOPatternBench.c
+*
+* Description:
+*    Compiles a pattern of one million edges spread over 8 lines and
+*    reports the compile throughput in edges/s. The compiled pattern
+*    is then rendered block by block as it would be for a streaming
+*    non-regenerating DO task, into U32 and U8 words. A direct
+*    per-sample, per-line construction of the same words is timed for
+*    comparison, and the results are checked against it.
+*
+*    No DAQ hardware is needed. Build with DOPattern.c.
+*
+*********************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "DOPattern.h"
+#include "StreamTime.h"
+
+#define NUM_LINES       8
+#define EDGES_PER_LINE  125000
+#define BLOCK_SIZE      65536
+
+int main(void)
+{
+    static long long    edges[NUM_LINES][EDGES_PER_LINE];
+    static unsigned int u32[BLOCK_SIZE],ref[BLOCK_SIZE];
+    static unsigned char u8[BLOCK_SIZE];
+    DOPattern           *pattern;
+    long long           length=0,s;
+    int                 head[NUM_LINES]={0};
+    unsigned            level;
+    double              t0,t1,tU32=0.0,tU8=0.0,tRef=0.0;
+    int                 line,i,mismatch=0;
+
+    // Random pulse widths and gaps of 1 to 200 samples on every line.
+    srand(1);
+    for(line=0;line<NUM_LINES;++line) {
+        long long t=rand()%100;
+
+        for(i=0;i<EDGES_PER_LINE;++i) {
+            edges[line][i] = t;
+            t += 1+rand()%200;
+        }
+        if( t>length )
+            length = t;
+    }
+
+    if( DOPatternCreate(NUM_LINES,&pattern)!=0 ) {
+        printf("Could not create pattern\n");
+        return 1;
+    }
+    for(line=0;line<NUM_LINES;++line)
+        DOPatternSetLine(pattern,line,0,edges[line],EDGES_PER_LINE);
+
+    t0 = StreamTimeNow();
+    DOPatternCompile(pattern,length);
+    t1 = StreamTimeNow();
+    printf("Compiled %d edges on %d lines into %lld runs over %lld samples\n",
+        NUM_LINES*EDGES_PER_LINE,NUM_LINES,DOPatternNumRuns(pattern),length);
+    printf("Compile: %.1f ms, %.1f Medges/s\n",1e3*(t1-t0),1e-6*NUM_LINES*EDGES_PER_LINE/(t1-t0));
+
+    level = 0;
+    for(s=0;s<length;s+=BLOCK_SIZE) {
+        int n=(int)(length-s<BLOCK_SIZE ? length-s : BLOCK_SIZE);
+
+        t0 = StreamTimeNow();
+        DOPatternRenderU32(pattern,s,n,u32);
+        t1 = StreamTimeNow();
+        tU32 += t1-t0;
+
+        t0 = StreamTimeNow();
+        DOPatternRenderU8(pattern,s,n,u8);
+        t1 = StreamTimeNow();
+        tU8 += t1-t0;
+
+        // Direct construction: test every line at every sample.
+        t0 = StreamTimeNow();
+        for(i=0;i<n;++i) {
+            for(line=0;line<NUM_LINES;++line)
+                if( head[line]<EDGES_PER_LINE && edges[line][head[line]]==s+i ) {
+                    level ^= 1u<<line;
+                    ++head[line];
+                }
+            ref[i] = level;
+        }
+        t1 = StreamTimeNow();
+        tRef += t1-t0;
+
+        for(i=0;i<n;++i)
+            if( u32[i]!=ref[i] || u8[i]!=(unsigned char)ref[i] )
+                ++mismatch;
+    }
+    printf("Render\t\tns/sample\tGB/s\n");
+    printf("U32 runs\t%.3f\t\t%.2f\n",1e9*tU32/length,4e-9*length/tU32);
+    printf("U8 runs\t\t%.3f\t\t%.2f\n",1e9*tU8/length,1e-9*length/tU8);
+    printf("U32 direct\t%.3f\t\t%.2f\n",1e9*tRef/length,4e-9*length/tRef);
+    printf("Mismatched samples: %d\n",mismatch);
+
+    DOPatternClear(pattern);
+    return mismatch!=0;
+}
@@ -0,0 +1,407 @@
+/*********************************************************************
+*
+* Processing stage:
+*    Envelope.c
+*
+* Description:
+*    Implementation of the min/max/mean envelope pyramid. See
+*    Envelope.h for the calling conventions.
+*
+*    Each channel accumulates samples into one pending level 0 bin.
+*    Whenever a level gains an even number of bins, its last two are
+*    merged into one bin of the level above, so a sample costs one
+*    compare/add in the inner loop plus on average 2/2^baseShift bin
+*    merges.
+*
+*    A level keeps its bins in a buffer of 2*maxBins. When that is
+*    full the newest maxBins are moved to the front and the rest are
+*    dropped, so the move costs O(1) per bin on average and the bins
+*    retained are always contiguous.
+*
+*    File layout (native endianness):
+*        "ENV2", int32 numChans, int32 baseShift, int32 numLevels,
+*        int32 maxBins, int64 numSamples, then for every channel and
+*        level an int32 bin count, the int64 index of the first bin
+*        and the bins. Samples of a bin that was still incomplete when
+*        the file was saved are not stored.
+*
+*********************************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <math.h>
+#include "Envelope.h"
+
+typedef struct EnvelopeLevel {
+    EnvelopeBin *bins;
+    int         numBins;    // retained
+    int         capacity;
+    long long   first;      // index of bins[0] since the start
+} EnvelopeLevel;
+
+typedef struct EnvelopeAccum {
+    double      min;
+    double      max;
+    double      sum;
+    int         count;
+} EnvelopeAccum;
+
+struct Envelope {
+    int             numChans;
+    int             baseShift;
+    int             numLevels;
+    int             maxBins;
+    long long       numSamples;
+    EnvelopeLevel   *levels;    // numChans*numLevels, channel major
+    EnvelopeAccum   *accum;     // one pending level 0 bin per channel
+};
+
+static int PushBin(Envelope *env, int chan, int level, EnvelopeBin bin)
+{
+    EnvelopeLevel   *lev=&env->levels[chan*env->numLevels+level];
+
+    if( lev->numBins==2*env->maxBins ) {
+        // Drop the oldest half.
+        memmove(lev->bins,lev->bins+lev->numBins-env->maxBins,sizeof(EnvelopeBin)*env->maxBins);
+        lev->first += lev->numBins-env->maxBins;
+        lev->numBins = env->maxBins;
+    }
+    else if( lev->numBins==lev->capacity ) {
+        int         capacity=lev->capacity ? 2*lev->capacity : 1024;
+        EnvelopeBin *bins;
+
+        if( capacity>2*env->maxBins )
+            capacity = 2*env->maxBins;
+        if( !(bins=(EnvelopeBin*)realloc(lev->bins,sizeof(EnvelopeBin)*capacity)) )
+            return EnvelopeErrOutOfMemory;
+        lev->bins = bins;
+        lev->capacity = capacity;
+    }
+    lev->bins[lev->numBins++] = bin;
+
+    // Every second bin completes a bin in the level above.
+    if( ((lev->first+lev->numBins)&1)==0 && level+1<env->numLevels ) {
+        const EnvelopeBin   *a=&lev->bins[lev->numBins-2],*b=&lev->bins[lev->numBins-1];
+        EnvelopeBin         up;
+
+        up.min = a->min<b->min ? a->min : b->min;
+        up.max = a->max>b->max ? a->max : b->max;
+        up.mean = 0.5f*(a->mean+b->mean);
+        return PushBin(env,chan,level+1,up);
+    }
+    return 0;
+}
+
+int EnvelopeCreate(int numChans, int baseShift, int numLevels, int maxBins, Envelope **envelope)
+{
+    Envelope    *env;
+
+    *envelope = NULL;
+    if( numChans<1 || baseShift<0 || baseShift>24 || numLevels<1 || baseShift+numLevels>40 || maxBins<2 || maxBins>(1<<28) )
+        return EnvelopeErrInvalidArg;
+    env = (Envelope*)calloc(1,sizeof(Envelope));
+    if( !env )
+        return EnvelopeErrOutOfMemory;
+    env->numChans = numChans;
+    env->baseShift = baseShift;
+    env->numLevels = numLevels;
+    env->maxBins = maxBins;
+    env->levels = (EnvelopeLevel*)calloc((size_t)numChans*numLevels,sizeof(EnvelopeLevel));
+    env->accum = (EnvelopeAccum*)calloc(numChans,sizeof(EnvelopeAccum));
+    if( !env->levels || !env->accum ) {
+        EnvelopeClear(env);
+        return EnvelopeErrOutOfMemory;
+    }
+    *envelope = env;
+    return 0;
+}
+
+void EnvelopeClear(Envelope *envelope)
+{
+    int i;
+
+    if( !envelope )
+        return;
+    if( envelope->levels )
+        for(i=0;i<envelope->numChans*envelope->numLevels;++i)
+            free(envelope->levels[i].bins);
+    free(envelope->levels);
+    free(envelope->accum);
+    free(envelope);
+}
+
+// Pushes the level 0 bin of channel c once it has binSize samples.
+static int CompleteBin(Envelope *env, int c, EnvelopeAccum *acc, int binSize)
+{
+    EnvelopeBin bin;
+
+    if( acc->count<binSize )
+        return 0;
+    bin.min = (float)acc->min;
+    bin.max = (float)acc->max;
+    bin.mean = (float)(acc->sum/binSize);
+    acc->count = 0;
+    return PushBin(env,c,0,bin);
+}
+
+int EnvelopeAddBlock(Envelope *envelope, const double data[], int numSampsPerChan, int interleaved)
+{
+    Envelope    *env=envelope;
+    int         binSize=1<<env->baseShift;
+    int         c,error=0;
+
+    if( numSampsPerChan<0 )
+        return EnvelopeErrInvalidArg;
+    for(c=0;c<env->numChans;++c) {
+        EnvelopeAccum   *acc=&env->accum[c];
+        size_t          stride=interleaved ? (size_t)env->numChans : 1;
+        const double    *x=interleaved ? data+c : data+(size_t)c*numSampsPerChan;
+        int             i=0;
+
+        while( i<numSampsPerChan ) {
+            int     n=binSize-acc->count;
+            int     j;
+            double  mn,mx,sum=0.0;
+
+            if( n>numSampsPerChan-i )
+                n = numSampsPerChan-i;
+            if( acc->count==0 ) {
+                mn = x[i*stride];
+                mx = mn;
+            }
+            else {
+                mn = acc->min;
+                mx = acc->max;
+            }
+            // Kept free of branches other than min/max so that the
+            // compiler can vectorise the contiguous case.
+            for(j=0;j<n;++j) {
+                double v=x[(i+j)*stride];
+                mn = v<mn ? v : mn;
+                mx = v>mx ? v : mx;
+                sum += v;
+            }
+            acc->min = mn;
+            acc->max = mx;
+            acc->sum = (acc->count ? acc->sum : 0.0)+sum;
+            acc->count += n;
+            i += n;
+            if( (error=CompleteBin(env,c,acc,binSize))!=0 )
+                return error;
+        }
+    }
+    env->numSamples += numSampsPerChan;
+    return 0;
+}
+
+// As EnvelopeAddBlock, with the inner loop in float. The float sum
+// runs over at most MAX_RUN_F32 samples before it is added to the
+// double total, so that wide bins keep their precision.
+#define MAX_RUN_F32     1024
+
+int EnvelopeAddBlockF32(Envelope *envelope, const float data[], int numSampsPerChan, int interleaved)
+{
+    Envelope    *env=envelope;
+    int         binSize=1<<env->baseShift;
+    int         c,error=0;
+
+    if( numSampsPerChan<0 )
+        return EnvelopeErrInvalidArg;
+    for(c=0;c<env->numChans;++c) {
+        EnvelopeAccum   *acc=&env->accum[c];
+        size_t          stride=interleaved ? (size_t)env->numChans : 1;
+        const float     *x=interleaved ? data+c : data+(size_t)c*numSampsPerChan;
+        int             i=0;
+
+        while( i<numSampsPerChan ) {
+            int     n=binSize-acc->count;
+            int     j;
+            float   mn,mx,sum=0.0f;
+
+            if( n>numSampsPerChan-i )
+                n = numSampsPerChan-i;
+            if( n>MAX_RUN_F32 )
+                n = MAX_RUN_F32;
+            if( acc->count==0 ) {
+                mn = x[i*stride];
+                mx = mn;
+            }
+            else {
+                mn = (float)acc->min;
+                mx = (float)acc->max;
+            }
+            for(j=0;j<n;++j) {
+                float v=x[(i+j)*stride];
+                mn = v<mn ? v : mn;
+                mx = v>mx ? v : mx;
+                sum += v;
+            }
+            acc->min = mn;
+            acc->max = mx;
+            acc->sum = (acc->count ? acc->sum : 0.0)+sum;
+            acc->count += n;
+            i += n;
+            if( (error=CompleteBin(env,c,acc,binSize))!=0 )
+                return error;
+        }
+    }
+    env->numSamples += numSampsPerChan;
+    return 0;
+}
+
+long long EnvelopeFirstBin(const Envelope *envelope, int chan, int level)
+{
+    if( chan<0 || chan>=envelope->numChans || level<0 || level>=envelope->numLevels )
+        return 0;
+    return envelope->levels[chan*envelope->numLevels+level].first;
+}
+
+long long EnvelopeNumSamples(const Envelope *envelope)
+{
+    return envelope->numSamples;
+}
+
+int EnvelopeNumBins(const Envelope *envelope, int chan, int level)
+{
+    if( chan<0 || chan>=envelope->numChans || level<0 || level>=envelope->numLevels )
+        return 0;
+    return envelope->levels[chan*envelope->numLevels+level].numBins;
+}
+
+const EnvelopeBin *EnvelopeGetLevel(const Envelope *envelope, int chan, int level, int *numBins)
+{
+    *numBins = EnvelopeNumBins(envelope,chan,level);
+    if( *numBins==0 )
+        return NULL;
+    return envelope->levels[chan*envelope->numLevels+level].bins;
+}
+
+int EnvelopeRender(const Envelope *envelope, int chan, long long firstSample, long long numSamples,
+                   int numPixels, float outMin[], float outMax[], float outMean[])
+{
+    const Envelope      *env=envelope;
+    const EnvelopeLevel *lev;
+    double              perPixel;
+    int                 level=0,shift,p;
+
+    if( chan<0 || chan>=env->numChans || firstSample<0 || numSamples<1 || numPixels<1 )
+        return EnvelopeErrInvalidArg;
+    perPixel = (double)numSamples/numPixels;
+    if( perPixel<(double)(1LL<<env->baseShift) )
+        return EnvelopeErrBelowBaseLevel;
+    while( level+1<env->numLevels && (double)(1LL<<(env->baseShift+level+1))<=perPixel )
+        ++level;
+    // Where the range starts before the bins still held at that
+    // level, coarser levels reach further back.
+    while( level+1<env->numLevels && (firstSample>>(env->baseShift+level))<env->levels[chan*env->numLevels+level].first )
+        ++level;
+    shift = env->baseShift+level;
+    lev = &env->levels[chan*env->numLevels+level];
+
+    // A pixel is usually at least one bin and less than two bins wide,
+    // so it overlaps at most three bins.
+    for(p=0;p<numPixels;++p) {
+        long long   s0=firstSample+(long long)(p*perPixel);
+        long long   s1=firstSample+(long long)((p+1)*perPixel);
+        long long   b0=s0>>shift,b1=(s1+(1LL<<shift)-1)>>shift,b;
+        float       mn,mx,sum=0.0f;
+
+        if( b0<lev->first )
+            b0 = lev->first;
+        if( b1>lev->first+lev->numBins )
+            b1 = lev->first+lev->numBins;
+        if( b0>=b1 ) {
+            outMin[p] = outMax[p] = NAN;
+            if( outMean )
+                outMean[p] = NAN;
+            continue;
+        }
+        mn = lev->bins[b0-lev->first].min;
+        mx = lev->bins[b0-lev->first].max;
+        for(b=b0-lev->first;b<b1-lev->first;++b) {
+            mn = lev->bins[b].min<mn ? lev->bins[b].min : mn;
+            mx = lev->bins[b].max>mx ? lev->bins[b].max : mx;
+            sum += lev->bins[b].mean;
+        }
+        outMin[p] = mn;
+        outMax[p] = mx;
+        if( outMean )
+            outMean[p] = sum/(float)(b1-b0);
+    }
+    return 0;
+}
+
+int EnvelopeSave(const Envelope *envelope, const char fileName[])
+{
+    FILE        *fid=fopen(fileName,"wb");
+    int         header[4];
+    int         i,ok;
+
+    if( !fid )
+        return EnvelopeErrFile;
+    header[0] = envelope->numChans;
+    header[1] = envelope->baseShift;
+    header[2] = envelope->numLevels;
+    header[3] = envelope->maxBins;
+    ok = fwrite("ENV2",1,4,fid)==4;
+    ok = ok && fwrite(header,sizeof(int),4,fid)==4;
+    ok = ok && fwrite(&envelope->numSamples,sizeof(long long),1,fid)==1;
+    for(i=0;ok && i<envelope->numChans*envelope->numLevels;++i) {
+        const EnvelopeLevel *lev=&envelope->levels[i];
+
+        ok = fwrite(&lev->numBins,sizeof(int),1,fid)==1;
+        ok = ok && fwrite(&lev->first,sizeof(long long),1,fid)==1;
+        ok = ok && (int)fwrite(lev->bins,sizeof(EnvelopeBin),lev->numBins,fid)==lev->numBins;
+    }
+    if( fclose(fid)!=0 )
+        ok = 0;
+    return ok ? 0 : EnvelopeErrFile;
+}
+
+int EnvelopeLoad(const char fileName[], Envelope **envelope)
+{
+    FILE        *fid=fopen(fileName,"rb");
+    char        magic[4];
+    int         header[4];
+    long long   numSamples;
+    Envelope    *env=NULL;
+    int         i,error=EnvelopeErrFile;
+
+    *envelope = NULL;
+    if( !fid )
+        return EnvelopeErrFile;
+    if( fread(magic,1,4,fid)!=4 || memcmp(magic,"ENV2",4)!=0 )
+        goto Error;
+    if( fread(header,sizeof(int),4,fid)!=4 || fread(&numSamples,sizeof(long long),1,fid)!=1 )
+        goto Error;
+    if( (error=EnvelopeCreate(header[0],header[1],header[2],header[3],&env))!=0 )
+        goto Error;
+    env->numSamples = numSamples;
+    error = EnvelopeErrFile;
+    for(i=0;i<env->numChans*env->numLevels;++i) {
+        EnvelopeLevel   *lev=&env->levels[i];
+        int             n;
+
+        if( fread(&n,sizeof(int),1,fid)!=1 || n<0 || n>2*env->maxBins
+            || fread(&lev->first,sizeof(long long),1,fid)!=1 || lev->first<0 )
+            goto Error;
+        lev->bins = (EnvelopeBin*)malloc(sizeof(EnvelopeBin)*2*env->maxBins);
+        if( !lev->bins ) {
+            error = EnvelopeErrOutOfMemory;
+            goto Error;
+        }
+        lev->capacity = 2*env->maxBins;
+        if( (int)fread(lev->bins,sizeof(EnvelopeBin),n,fid)!=n )
+            goto Error;
+        lev->numBins = n;
+    }
+    fclose(fid);
+    *envelope = env;
+    return 0;
+
+Error:
+    fclose(fid);
+    EnvelopeClear(env);
+    return error;
+}
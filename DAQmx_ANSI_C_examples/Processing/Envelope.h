@@ -0,0 +1,79 @@
+/*********************************************************************
+*
+* Processing stage:
+*    Envelope.h
+*
+* Description:
+*    Multi-resolution min/max/mean envelope pyramid for continuous
+*    acquisitions. Level 0 summarises bins of 2^baseShift samples and
+*    each further level halves the resolution. Blocks are added as
+*    they are read, every completed bin is folded into the level
+*    above, so the update cost is amortised O(1) per sample.
+*
+*    EnvelopeRender picks the coarsest level whose bins are no wider
+*    than one pixel and so draws any time range in O(numPixels),
+*    regardless of how long the recording is. The pyramid can be
+*    saved next to the raw data file and loaded again for review.
+*
+*    Every level keeps at most 2*maxBins of its newest bins, so the
+*    memory stays bounded however long the acquisition runs. Level k
+*    then covers at least maxBins*2^(baseShift+k) samples: recent data
+*    can be viewed at full resolution, older data only at the coarser
+*    levels that still reach back to it.
+*
+*********************************************************************/
+
+#ifndef ENVELOPE_H
+#define ENVELOPE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define EnvelopeErrInvalidArg       -1
+#define EnvelopeErrOutOfMemory      -2
+#define EnvelopeErrFile             -3
+#define EnvelopeErrBelowBaseLevel   -4
+
+typedef struct EnvelopeBin {
+    float   min;
+    float   max;
+    float   mean;
+} EnvelopeBin;
+
+typedef struct Envelope Envelope;
+
+// Creates a pyramid with numLevels levels, the finest of which holds
+// bins of 2^baseShift samples. Each level retains at least the
+// newest maxBins bins (2 or more).
+int  EnvelopeCreate(int numChans, int baseShift, int numLevels, int maxBins, Envelope **envelope);
+void EnvelopeClear(Envelope *envelope);
+
+// Adds numSampsPerChan samples for every channel. With interleaved
+// set the data are in DAQmx_Val_GroupByScanNumber order, otherwise
+// DAQmx_Val_GroupByChannel. The bins are float for either type.
+int  EnvelopeAddBlock(Envelope *envelope, const double data[], int numSampsPerChan, int interleaved);
+int  EnvelopeAddBlockF32(Envelope *envelope, const float data[], int numSampsPerChan, int interleaved);
+
+// EnvelopeGetLevel returns the retained bins of a level; the first
+// of them is bin number EnvelopeFirstBin since the start.
+long long EnvelopeNumSamples(const Envelope *envelope);
+int  EnvelopeNumBins(const Envelope *envelope, int chan, int level);
+long long EnvelopeFirstBin(const Envelope *envelope, int chan, int level);
+const EnvelopeBin *EnvelopeGetLevel(const Envelope *envelope, int chan, int level, int *numBins);
+
+// Fills numPixels columns covering samples [firstSample,firstSample+numSamples)
+// of one channel. Returns EnvelopeErrBelowBaseLevel when a pixel is
+// narrower than a level 0 bin, in which case the raw data should be drawn.
+// Pixels before the oldest retained bin of every level are NaN.
+int  EnvelopeRender(const Envelope *envelope, int chan, long long firstSample, long long numSamples,
+                    int numPixels, float outMin[], float outMax[], float outMean[]);
+
+int  EnvelopeSave(const Envelope *envelope, const char fileName[]);
+int  EnvelopeLoad(const char fileName[], Envelope **envelope);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,63 @@
+/*********************************************************************
+*
+* Processing benchmark:
+*    EnvelopeBench.c
+*
+* Description:
+*    Measures the cost of EnvelopeAddBlock per sample for increasing
+*    recording lengths, and the cost of EnvelopeRender for a full
+*    width view of the whole recording. The update cost should stay
+*    flat as the recording grows, and render time should depend only
+*    on the number of pixels. The bins kept per channel show that the
+*    memory stops growing once the levels are full.
+*
+*    No DAQ hardware is needed. Build with Envelope.c.
+*
+*********************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include "Envelope.h"
+#include "StreamTime.h"
+
+#define NUM_CHANS   4
+#define BLOCK_SIZE  1000
+#define NUM_PIXELS  1920
+#define NUM_LEVELS  20
+#define MAX_BINS    65536
+
+int main(void)
+{
+    static double   data[NUM_CHANS*BLOCK_SIZE];
+    static float    mn[NUM_PIXELS],mx[NUM_PIXELS],mean[NUM_PIXELS];
+    long long       lengths[]={100000LL,1000000LL,10000000LL,100000000LL};
+    int             i,k;
+
+    for(i=0;i<NUM_CHANS*BLOCK_SIZE;++i)
+        data[i] = sin(0.001*i)+0.01*(rand()%100);
+
+    printf("Samples/chan\tUpdate ns/sample\tRender us (%d px)\tBins kept\n",NUM_PIXELS);
+    for(k=0;k<(int)(sizeof(lengths)/sizeof(lengths[0]));++k) {
+        Envelope    *env;
+        long long   n,kept=0;
+        double      t0,t1,t2;
+        int         level;
+
+        if( EnvelopeCreate(NUM_CHANS,6,NUM_LEVELS,MAX_BINS,&env)!=0 ) {
+            printf("Could not create envelope\n");
+            return 1;
+        }
+        t0 = StreamTimeNow();
+        for(n=0;n<lengths[k];n+=BLOCK_SIZE)
+            EnvelopeAddBlock(env,data,BLOCK_SIZE,0);
+        t1 = StreamTimeNow();
+        EnvelopeRender(env,0,0,EnvelopeNumSamples(env),NUM_PIXELS,mn,mx,mean);
+        t2 = StreamTimeNow();
+        for(level=0;level<NUM_LEVELS;++level)
+            kept += EnvelopeNumBins(env,0,level);
+        printf("%lld\t%.3f\t\t\t%.1f\t\t\t%lld\n",lengths[k],1e9*(t1-t0)/((double)lengths[k]*NUM_CHANS),1e6*(t2-t1),kept);
+        EnvelopeClear(env);
+    }
+    return 0;
+}
@@ -0,0 +1,550 @@
+/*********************************************************************
+*
+* Processing benchmark:
+*    KernelBench.c
+*
+* Description:
+*    Times every sample-processing kernel in this directory, and the
+*    GenSineWave fill of the AO examples, on 1, 8 and 32 channels and
+*    on blocks of 100, 1000 and 10000 samples per channel. Each case
+*    is repeated until it has run for about 20 ms, and the best of
+*    five such runs is kept. The result is reported in ns per sample
+*    (per channel sample, or per line sample for the digital
+*    patterns) and in GB/s of input read plus output written.
+*
+*    The results can be saved to a baseline file and later compared
+*    against it. A case that has become slower than its baseline by
+*    more than the threshold is reported as a regression and the
+*    program exits with status 1, so it can gate a build.
+*
+*    Usage:
+*        KernelBench [-cpu n] [-save file] [-baseline file]
+*                    [-threshold percent] [-kernel name]
+*
+*        -cpu n          pin to CPU n (default 0, -1 to not pin)
+*        -save file      write the results as a new baseline
+*        -baseline file  compare with a baseline
+*        -threshold p    allowed slowdown in percent (default 10)
+*        -kernel name    only run the kernels whose name starts so
+*
+*    The baseline is a text file with one line per case: kernel,
+*    type, channels, block size and ns per sample. Only compare
+*    baselines recorded on the same computer and build.
+*
+*    No DAQ hardware is needed. Build with ChanStats.c, Envelope.c,
+*    Resampler.c, RefTrigger.c, PulseTicks.c, DOPattern.c,
+*    ToneSynth.c, PIDControl.c and AIScale.c.
+*
+*********************************************************************/
+
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE     // for pthread_setaffinity_np
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "ChanStats.h"
+#include "Envelope.h"
+#include "Resampler.h"
+#include "RefTrigger.h"
+#include "PulseTicks.h"
+#include "DOPattern.h"
+#include "ToneSynth.h"
+#include "PIDControl.h"
+#include "AIScale.h"
+#include "StreamTime.h"
+#include "StreamThread.h"
+
+#define MAX_CHANS       32
+#define MAX_BLOCK       10000
+#define MAX_CASES       256
+#define MIN_RUN_TIME    0.02
+#define NUM_RUNS        5
+#define DO_LENGTH       100000
+#define DO_PULSES       512
+#define PI              3.1415926535
+
+typedef struct Case {
+    int             chans;
+    int             block;
+    void            *obj[MAX_CHANS];
+    PIDControl      pid[MAX_CHANS];
+    double          phase;
+    long long       position;
+} Case;
+
+typedef struct Kernel {
+    const char  *name;
+    const char  *type;
+    int         bytesPerSample;     // read plus written
+    int         maxChans;
+    int         (*create)(Case *c);
+    void        (*run)(Case *c);
+    void        (*clear)(Case *c);
+} Kernel;
+
+typedef struct Result {
+    char        name[32];
+    char        type[8];
+    int         chans;
+    int         block;
+    double      nsPerSample;
+} Result;
+
+static double           *f64In,*f64Out;
+static float            *f32In,*f32Out;
+static short            *i16In;
+static double           *highTime,*lowTime;
+static unsigned int     *u32Out,*u32Out2;
+static unsigned char    *u8Out;
+static double           sink;
+
+/*********************************************/
+// Kernels
+/*********************************************/
+static int CreateNothing(Case *c)
+{
+    return 0;
+}
+
+static void ClearNothing(Case *c)
+{
+}
+
+static int CreateChanStatsF64(Case *c)
+{
+    return ChanStatsCreate(c->chans,-10.0,10.0,10,(ChanStats**)&c->obj[0]);
+}
+
+static int CreateChanStatsI16(Case *c)
+{
+    return ChanStatsCreate(c->chans,-32000.0,32000.0,10,(ChanStats**)&c->obj[0]);
+}
+
+static void RunChanStatsF64(Case *c)        { ChanStatsAddF64((ChanStats*)c->obj[0],f64In,c->block,0); }
+static void RunChanStatsF64Inter(Case *c)   { ChanStatsAddF64((ChanStats*)c->obj[0],f64In,c->block,1); }
+static void RunChanStatsF32(Case *c)        { ChanStatsAddF32((ChanStats*)c->obj[0],f32In,c->block,0); }
+static void RunChanStatsF32Inter(Case *c)   { ChanStatsAddF32((ChanStats*)c->obj[0],f32In,c->block,1); }
+static void RunChanStatsI16(Case *c)        { ChanStatsAddI16((ChanStats*)c->obj[0],i16In,c->block,0); }
+static void RunChanStatsI16Inter(Case *c)   { ChanStatsAddI16((ChanStats*)c->obj[0],i16In,c->block,1); }
+static void ClearChanStats(Case *c)         { ChanStatsClear((ChanStats*)c->obj[0]); }
+
+static int CreateEnvelope(Case *c)
+{
+    return EnvelopeCreate(c->chans,6,8,1<<16,(Envelope**)&c->obj[0]);
+}
+
+static void RunEnvelope(Case *c)            { EnvelopeAddBlock((Envelope*)c->obj[0],f64In,c->block,0); }
+static void RunEnvelopeInter(Case *c)       { EnvelopeAddBlock((Envelope*)c->obj[0],f64In,c->block,1); }
+static void RunEnvelopeF32(Case *c)         { EnvelopeAddBlockF32((Envelope*)c->obj[0],f32In,c->block,0); }
+static void RunEnvelopeF32Inter(Case *c)    { EnvelopeAddBlockF32((Envelope*)c->obj[0],f32In,c->block,1); }
+static void ClearEnvelope(Case *c)          { EnvelopeClear((Envelope*)c->obj[0]); }
+
+static int CreateResampler(Case *c)
+{
+    return ResamplerCreate(c->chans,3,2,16,c->block,(Resampler**)&c->obj[0]);
+}
+
+static void RunResamplerF64(Case *c)
+{
+    int numOut;
+
+    ResamplerProcessF64((Resampler*)c->obj[0],f64In,c->block,f64Out,2*MAX_BLOCK,&numOut);
+}
+
+static void RunResamplerF32(Case *c)
+{
+    int numOut;
+
+    ResamplerProcessF32((Resampler*)c->obj[0],f32In,c->block,f32Out,2*MAX_BLOCK,&numOut);
+}
+
+static void ClearResampler(Case *c)     { ResamplerClear((Resampler*)c->obj[0]); }
+
+static void OnTrigger(const RefTriggerView *view, void *callbackData)
+{
+    sink += (double)view->triggerSample;
+}
+
+static int CreateRefTrigger(Case *c)
+{
+    RefTriggerConfig config={c->chans,0,RefTriggerRising,9.0,0.5,0,500,1500,c->block};
+
+    return RefTriggerCreate(&config,OnTrigger,NULL,(RefTrigger**)&c->obj[0]);
+}
+
+static void RunRefTrigger(Case *c)      { RefTriggerAddBlock((RefTrigger*)c->obj[0],f64In,c->block); }
+static void ClearRefTrigger(Case *c)    { RefTriggerClear((RefTrigger*)c->obj[0]); }
+
+static int CreatePulseTicks(Case *c)
+{
+    return PulseTicksCreate(100e6,2,c->block,(PulseTicks**)&c->obj[0]);
+}
+
+static void RunPulseTicks(Case *c)
+{
+    PulseTicksConvert((PulseTicks*)c->obj[0],highTime,lowTime,c->block,u32Out,u32Out2);
+}
+
+static void ClearPulseTicks(Case *c)    { PulseTicksClear((PulseTicks*)c->obj[0]); }
+
+static int CreateDOPattern(Case *c)
+{
+    DOPattern   *p;
+    long long   edges[2*DO_PULSES];
+    int         line,n,error;
+
+    if( (error=DOPatternCreate(c->chans,&p))!=0 )
+        return error;
+    for(line=0;line<c->chans;++line) {
+        n = DOPatternPulseTrain(edges,line,10+line,100+7*line,DO_PULSES);
+        DOPatternSetLine(p,line,0,edges,n);
+    }
+    c->obj[0] = p;
+    return DOPatternCompile(p,DO_LENGTH);
+}
+
+static void RunDOPatternU32(Case *c)
+{
+    if( c->position+c->block>DO_LENGTH )
+        c->position = 0;
+    DOPatternRenderU32((DOPattern*)c->obj[0],c->position,c->block,u32Out);
+    c->position += c->block;
+}
+
+static void RunDOPatternU8(Case *c)
+{
+    if( c->position+c->block>DO_LENGTH )
+        c->position = 0;
+    DOPatternRenderU8((DOPattern*)c->obj[0],c->position,c->block,u8Out);
+    c->position += c->block;
+}
+
+static void ClearDOPattern(Case *c)     { DOPatternClear((DOPattern*)c->obj[0]); }
+
+static int CreateToneSynth(Case *c)
+{
+    int i,error;
+
+    for(i=0;i<c->chans;++i)
+        if( (error=ToneSynthCreate(10000.0,5.0,10.0+i,0.0,64,(ToneSynth**)&c->obj[i]))!=0 )
+            return error;
+    return 0;
+}
+
+static void RunToneSynth(Case *c)
+{
+    int i;
+
+    for(i=0;i<c->chans;++i)
+        ToneSynthRender((ToneSynth*)c->obj[i],f64Out+(size_t)i*c->block,c->block);
+}
+
+static void RunToneSynthF32(Case *c)
+{
+    int i;
+
+    for(i=0;i<c->chans;++i)
+        ToneSynthRenderF32((ToneSynth*)c->obj[i],f32Out+(size_t)i*c->block,c->block);
+}
+
+static void ClearToneSynth(Case *c)
+{
+    int i;
+
+    for(i=0;i<c->chans;++i)
+        if( c->obj[i] )
+            ToneSynthClear((ToneSynth*)c->obj[i]);
+}
+
+// As in SynchAI-AO.c and the AO examples.
+static int GenSineWave(int numElements, double amplitude, double frequency, double *phase, double sineWave[])
+{
+    int i=0;
+
+    for(;i<numElements;++i)
+        sineWave[i] = amplitude*sin(PI/180.0*(*phase+360.0*frequency*i));
+    *phase = fmod(*phase+frequency*360.0*numElements,360.0);
+    return 0;
+}
+
+static void RunGenSineWave(Case *c)
+{
+    int i;
+
+    for(i=0;i<c->chans;++i)
+        GenSineWave(c->block,5.0,1.0/c->block,&c->phase,f64Out+(size_t)i*c->block);
+}
+
+static int CreatePID(Case *c)
+{
+    int i;
+
+    for(i=0;i<c->chans;++i)
+        PIDInit(&c->pid[i],2.0,100.0,1e-4,1e-4,-10.0,10.0);
+    return 0;
+}
+
+static void RunPID(Case *c)
+{
+    int i,j;
+
+    for(i=0;i<c->chans;++i) {
+        const double    *in=f64In+(size_t)i*c->block;
+        double          *out=f64Out+(size_t)i*c->block;
+
+        for(j=0;j<c->block;++j)
+            out[j] = PIDStep(&c->pid[i],in[j]);
+    }
+}
+
+// A cubic with the magnitudes of a 16 bit device's scaling coefficients.
+static int CreateAIScale(Case *c)
+{
+    double  coeffs[MAX_CHANS*4];
+    int     i;
+
+    for(i=0;i<c->chans;++i) {
+        coeffs[4*i] = 1e-3*i;
+        coeffs[4*i+1] = 3.05e-4;
+        coeffs[4*i+2] = 1e-12;
+        coeffs[4*i+3] = -2e-17;
+    }
+    return AIScaleCreate(c->chans,coeffs,4,(AIScale**)&c->obj[0]);
+}
+
+static void RunAIScaleF64(Case *c)      { AIScaleToF64((AIScale*)c->obj[0],i16In,c->block,0,f64Out); }
+static void RunAIScaleF32(Case *c)      { AIScaleToF32((AIScale*)c->obj[0],i16In,c->block,0,f32Out); }
+static void ClearAIScale(Case *c)       { AIScaleClear((AIScale*)c->obj[0]); }
+
+static const Kernel kernels[]={
+    {"ChanStats",               "f64",  8,  0,  CreateChanStatsF64, RunChanStatsF64,        ClearChanStats},
+    {"ChanStats/interleaved",   "f64",  8,  0,  CreateChanStatsF64, RunChanStatsF64Inter,   ClearChanStats},
+    {"ChanStats",               "f32",  4,  0,  CreateChanStatsF64, RunChanStatsF32,        ClearChanStats},
+    {"ChanStats/interleaved",   "f32",  4,  0,  CreateChanStatsF64, RunChanStatsF32Inter,   ClearChanStats},
+    {"ChanStats",               "i16",  2,  0,  CreateChanStatsI16, RunChanStatsI16,        ClearChanStats},
+    {"ChanStats/interleaved",   "i16",  2,  0,  CreateChanStatsI16, RunChanStatsI16Inter,   ClearChanStats},
+    {"Envelope",                "f64",  8,  0,  CreateEnvelope,     RunEnvelope,            ClearEnvelope},
+    {"Envelope/interleaved",    "f64",  8,  0,  CreateEnvelope,     RunEnvelopeInter,       ClearEnvelope},
+    {"Envelope",                "f32",  4,  0,  CreateEnvelope,     RunEnvelopeF32,         ClearEnvelope},
+    {"Envelope/interleaved",    "f32",  4,  0,  CreateEnvelope,     RunEnvelopeF32Inter,    ClearEnvelope},
+    {"Resampler/3:2",           "f64",  20, 0,  CreateResampler,    RunResamplerF64,        ClearResampler},
+    {"Resampler/3:2",           "f32",  10, 0,  CreateResampler,    RunResamplerF32,        ClearResampler},
+    {"RefTrigger",              "f64",  8,  0,  CreateRefTrigger,   RunRefTrigger,          ClearRefTrigger},
+    {"PulseTicks",              "f64",  24, 1,  CreatePulseTicks,   RunPulseTicks,          ClearPulseTicks},
+    {"DOPattern",               "u32",  0,  32, CreateDOPattern,    RunDOPatternU32,        ClearDOPattern},
+    {"DOPattern",               "u8",   0,  8,  CreateDOPattern,    RunDOPatternU8,         ClearDOPattern},
+    {"ToneSynth",               "f64",  8,  0,  CreateToneSynth,    RunToneSynth,           ClearToneSynth},
+    {"ToneSynth",               "f32",  4,  0,  CreateToneSynth,    RunToneSynthF32,        ClearToneSynth},
+    {"GenSineWave",             "f64",  8,  0,  CreateNothing,      RunGenSineWave,         ClearNothing},
+    {"AIScale",                 "f64",  10, 0,  CreateAIScale,      RunAIScaleF64,          ClearAIScale},
+    {"AIScale",                 "f32",  6,  0,  CreateAIScale,      RunAIScaleF32,          ClearAIScale},
+    {"PIDStep",                 "f64",  16, 0,  CreatePID,          RunPID,                 ClearNothing},
+};
+
+/*********************************************/
+// Driver
+/*********************************************/
+static void FillInputs(void)
+{
+    size_t i,n=(size_t)MAX_CHANS*MAX_BLOCK;
+
+    for(i=0;i<n;++i) {
+        f64In[i] = 10.0*sin(0.0123*(double)i);
+        f32In[i] = (float)f64In[i];
+        i16In[i] = (short)(3276.7*f64In[i]);
+    }
+    // Pulse high and low times of 1 to 2 us.
+    for(i=0;i<MAX_BLOCK;++i) {
+        highTime[i] = 1e-6*(1.5+0.5*sin(0.01*(double)i));
+        lowTime[i] = 1e-6*(1.5+0.5*cos(0.01*(double)i));
+    }
+}
+
+// Best time per block of NUM_RUNS runs of at least MIN_RUN_TIME.
+static double TimeCase(const Kernel *k, Case *c)
+{
+    double  best=HUGE_VAL,t0,t;
+    long    reps=1,r;
+    int     run;
+
+    k->run(c);
+    for(;;) {
+        t0 = StreamTimeNow();
+        for(r=0;r<reps;++r)
+            k->run(c);
+        t = StreamTimeNow()-t0;
+        if( t>=MIN_RUN_TIME )
+            break;
+        reps = t>0.0 && 2.0*MIN_RUN_TIME/t<1e6 ? (long)(reps*2.0*MIN_RUN_TIME/t)+1 : reps*16;
+    }
+    for(run=0;run<NUM_RUNS;++run) {
+        t0 = StreamTimeNow();
+        for(r=0;r<reps;++r)
+            k->run(c);
+        t = (StreamTimeNow()-t0)/reps;
+        if( t<best )
+            best = t;
+    }
+    return best;
+}
+
+static int LoadBaseline(const char *fileName, Result *base, int maxResults)
+{
+    FILE    *f=fopen(fileName,"r");
+    int     n=0;
+
+    if( !f )
+        return -1;
+    while( n<maxResults && fscanf(f,"%31s %7s %d %d %lf",base[n].name,base[n].type,&base[n].chans,&base[n].block,&base[n].nsPerSample)==5 )
+        ++n;
+    fclose(f);
+    return n;
+}
+
+static const Result *FindResult(const Result *results, int n, const Result *key)
+{
+    int i;
+
+    for(i=0;i<n;++i)
+        if( strcmp(results[i].name,key->name)==0 && strcmp(results[i].type,key->type)==0 &&
+            results[i].chans==key->chans && results[i].block==key->block )
+            return &results[i];
+    return NULL;
+}
+
+int main(int argc, char *argv[])
+{
+    static Result   results[MAX_CASES],base[MAX_CASES];
+    int             chanCounts[]={1,8,32};
+    int             blockSizes[]={100,1000,10000};
+    const char      *saveFile=NULL,*baseFile=NULL,*only=NULL;
+    double          threshold=10.0;
+    int             cpu=0,numResults=0,numBase=0,regressions=0;
+    size_t          k;
+    int             a,i,j;
+
+    for(a=1;a<argc;++a) {
+        if( strcmp(argv[a],"-cpu")==0 && a+1<argc )
+            cpu = atoi(argv[++a]);
+        else if( strcmp(argv[a],"-save")==0 && a+1<argc )
+            saveFile = argv[++a];
+        else if( strcmp(argv[a],"-baseline")==0 && a+1<argc )
+            baseFile = argv[++a];
+        else if( strcmp(argv[a],"-threshold")==0 && a+1<argc )
+            threshold = atof(argv[++a]);
+        else if( strcmp(argv[a],"-kernel")==0 && a+1<argc )
+            only = argv[++a];
+        else {
+            printf("Usage: %s [-cpu n] [-save file] [-baseline file] [-threshold percent] [-kernel name]\n",argv[0]);
+            return 2;
+        }
+    }
+    if( baseFile && (numBase=LoadBaseline(baseFile,base,MAX_CASES))<0 ) {
+        printf("Could not read baseline %s\n",baseFile);
+        return 2;
+    }
+    if( cpu>=0 && StreamThreadPinCurrent(cpu)!=0 )
+        printf("Could not pin to CPU %d, timings may be noisy\n",cpu);
+
+    f64In = (double*)malloc(sizeof(double)*MAX_CHANS*MAX_BLOCK);
+    f64Out = (double*)malloc(sizeof(double)*MAX_CHANS*2*MAX_BLOCK);
+    f32In = (float*)malloc(sizeof(float)*MAX_CHANS*MAX_BLOCK);
+    f32Out = (float*)malloc(sizeof(float)*MAX_CHANS*2*MAX_BLOCK);
+    i16In = (short*)malloc(sizeof(short)*MAX_CHANS*MAX_BLOCK);
+    highTime = (double*)malloc(sizeof(double)*MAX_BLOCK);
+    lowTime = (double*)malloc(sizeof(double)*MAX_BLOCK);
+    u32Out = (unsigned int*)malloc(sizeof(unsigned int)*MAX_BLOCK);
+    u32Out2 = (unsigned int*)malloc(sizeof(unsigned int)*MAX_BLOCK);
+    u8Out = (unsigned char*)malloc(MAX_BLOCK);
+    if( !f64In || !f64Out || !f32In || !f32Out || !i16In || !highTime || !lowTime || !u32Out || !u32Out2 || !u8Out ) {
+        printf("Out of memory\n");
+        return 2;
+    }
+    FillInputs();
+
+    printf("%-24s%-6s%6s%8s%12s%10s%12s\n","Kernel","Type","Chans","Block","ns/sample","GB/s","Baseline");
+    for(k=0;k<sizeof(kernels)/sizeof(kernels[0]);++k) {
+        const Kernel *kern=&kernels[k];
+
+        if( only && strncmp(kern->name,only,strlen(only))!=0 )
+            continue;
+        for(i=0;i<(int)(sizeof(chanCounts)/sizeof(chanCounts[0]));++i)
+            for(j=0;j<(int)(sizeof(blockSizes)/sizeof(blockSizes[0]));++j) {
+                Case            c;
+                Result          *res=&results[numResults];
+                const Result    *old;
+                double          t,samples,bytesPerSample;
+                int             chans=kern->maxChans ? (i==0 ? 1 : kern->maxChans) : chanCounts[i];
+
+                // Kernels with a fixed channel limit run at 1 and at the limit.
+                if( kern->maxChans && i==2 )
+                    continue;
+                if( kern->maxChans==1 && i>0 )
+                    continue;
+                memset(&c,0,sizeof(c));
+                c.chans = chans;
+                c.block = blockSizes[j];
+                if( kern->create(&c)!=0 ) {
+                    printf("%-24s%-6s%6d%8d  could not create\n",kern->name,kern->type,chans,c.block);
+                    kern->clear(&c);
+                    continue;
+                }
+                t = TimeCase(kern,&c);
+                kern->clear(&c);
+
+                samples = (double)chans*c.block;
+                // A digital pattern writes one port word for all lines.
+                bytesPerSample = kern->bytesPerSample ? kern->bytesPerSample : (strcmp(kern->type,"u8")==0 ? 1.0 : 4.0)/chans;
+                strcpy(res->name,kern->name);
+                strcpy(res->type,kern->type);
+                res->chans = chans;
+                res->block = c.block;
+                res->nsPerSample = 1e9*t/samples;
+                printf("%-24s%-6s%6d%8d%12.3f%10.2f",res->name,res->type,chans,c.block,res->nsPerSample,1e-9*bytesPerSample*samples/t);
+                old = FindResult(base,numBase,res);
+                if( old ) {
+                    double change=100.0*(res->nsPerSample/old->nsPerSample-1.0);
+
+                    printf("%+11.1f%%",change);
+                    if( change>threshold ) {
+                        printf("  REGRESSION");
+                        regressions++;
+                    }
+                }
+                else if( baseFile )
+                    printf("%12s","new");
+                printf("\n");
+                if( numResults<MAX_CASES-1 )
+                    numResults++;
+            }
+    }
+
+    if( saveFile ) {
+        FILE *f=fopen(saveFile,"w");
+
+        if( !f ) {
+            printf("Could not write baseline %s\n",saveFile);
+            return 2;
+        }
+        for(i=0;i<numResults;++i)
+            fprintf(f,"%s %s %d %d %.4f\n",results[i].name,results[i].type,results[i].chans,results[i].block,results[i].nsPerSample);
+        fclose(f);
+        printf("\nBaseline saved to %s\n",saveFile);
+    }
+    if( baseFile )
+        printf("\n%d regression%s beyond %.1f%% against %s\n",regressions,regressions==1 ? "" : "s",threshold,baseFile);
+    free(f64In);
+    free(f64Out);
+    free(f32In);
+    free(f32Out);
+    free(i16In);
+    free(highTime);
+    free(lowTime);
+    free(u32Out);
+    free(u32Out2);
+    free(u8Out);
+    return regressions>0 || sink==12345.0;
+}
@@ -0,0 +1,82 @@
+/*********************************************************************
+*
+* Processing helper:
+*    LatencyHist.h
+*
+* Description:
+*    Fixed-size histogram of time intervals for latency and jitter
+*    reports. Bins are a quarter octave wide from 0.1 us up, so
+*    nanoseconds to seconds fit in LATENCYHIST_BINS bins with about
+*    19% resolution. Adding a value costs a log2 and never allocates,
+*    so it may be called from a real-time loop.
+*
+*********************************************************************/
+
+#ifndef LATENCYHIST_H
+#define LATENCYHIST_H
+
+#include <math.h>
+#include <string.h>
+
+#define LATENCYHIST_BINS    96
+#define LATENCYHIST_FLOOR   1e-7    // upper edge of bin 0, seconds
+
+typedef struct LatencyHist {
+    long long   bins[LATENCYHIST_BINS];
+    long long   count;
+    double      sum;
+    double      min;
+    double      max;
+} LatencyHist;
+
+static inline void LatencyHistReset(LatencyHist *h)
+{
+    memset(h,0,sizeof(LatencyHist));
+}
+
+static inline double LatencyHistBinEdge(int bin)
+{
+    return LATENCYHIST_FLOOR*pow(2.0,0.25*bin);
+}
+
+static inline void LatencyHistAdd(LatencyHist *h, double seconds)
+{
+    int bin=seconds<=LATENCYHIST_FLOOR ? 0 : 1+(int)(4.0*log2(seconds/LATENCYHIST_FLOOR));
+
+    if( bin>=LATENCYHIST_BINS )
+        bin = LATENCYHIST_BINS-1;
+    ++h->bins[bin];
+    if( h->count==0 || seconds<h->min )
+        h->min = seconds;
+    if( h->count==0 || seconds>h->max )
+        h->max = seconds;
+    h->sum += seconds;
+    ++h->count;
+}
+
+static inline double LatencyHistMean(const LatencyHist *h)
+{
+    return h->count>0 ? h->sum/h->count : 0.0;
+}
+
+// Upper edge of the bin holding the p-th fraction of the values,
+// capped at the largest value seen.
+static inline double LatencyHistPercentile(const LatencyHist *h, double p)
+{
+    long long   target=(long long)ceil(p*h->count),seen=0;
+    int         bin;
+
+    if( h->count==0 )
+        return 0.0;
+    for(bin=0;bin<LATENCYHIST_BINS;++bin) {
+        seen += h->bins[bin];
+        if( seen>=target && seen>0 ) {
+            double edge=LatencyHistBinEdge(bin);
+
+            return edge<h->max ? edge : h->max;
+        }
+    }
+    return h->max;
+}
+
+#endif
@@ -0,0 +1,51 @@
+/*********************************************************************
+*
+* Processing stage:
+*    PIDControl.c
+*
+* Description:
+*    Implementation of the discrete PID controller. See PIDControl.h.
+*
+*********************************************************************/
+
+#include "PIDControl.h"
+
+void PIDInit(PIDControl *pid, double kp, double ki, double kd, double dt, double outMin, double outMax)
+{
+    pid->kp = kp;
+    pid->ki = ki;
+    pid->kd = kd;
+    pid->dt = dt;
+    pid->outMin = outMin;
+    pid->outMax = outMax;
+    pid->setpoint = 0.0;
+    PIDReset(pid);
+}
+
+void PIDReset(PIDControl *pid)
+{
+    pid->integral = 0.0;
+    pid->prevMeasurement = 0.0;
+    pid->primed = 0;
+}
+
+double PIDStep(PIDControl *pid, double measurement)
+{
+    double  error=pid->setpoint-measurement;
+    double  derivative=0.0,integral,out;
+
+    if( pid->primed )
+        derivative = -(measurement-pid->prevMeasurement)/pid->dt;
+    pid->prevMeasurement = measurement;
+    pid->primed = 1;
+
+    integral = pid->integral+pid->ki*error*pid->dt;
+    out = pid->kp*error+integral+pid->kd*derivative;
+    if( out>pid->outMax )
+        out = pid->outMax;
+    else if( out<pid->outMin )
+        out = pid->outMin;
+    else
+        pid->integral = integral;   // only integrate while unsaturated
+    return out;
+}
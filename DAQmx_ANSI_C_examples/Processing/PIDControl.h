@@ -0,0 +1,48 @@
+/*********************************************************************
+*
+* Processing stage:
+*    PIDControl.h
+*
+* Description:
+*    Discrete PID controller for loops that run once per sample clock
+*    tick. The derivative acts on the measurement rather than the
+*    error, so setpoint steps do not kick the output. The integral
+*    stops accumulating while the output is clamped to its limits,
+*    which prevents wind-up.
+*
+*    The state is a plain struct so that a controller can live on the
+*    stack or inside another structure. PIDStep does no allocation
+*    and no I/O.
+*
+*********************************************************************/
+
+#ifndef PIDCONTROL_H
+#define PIDCONTROL_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct PIDControl {
+    double      kp;
+    double      ki;             // per second
+    double      kd;             // seconds
+    double      dt;             // seconds per step
+    double      outMin;
+    double      outMax;
+    double      setpoint;
+
+    double      integral;
+    double      prevMeasurement;
+    int         primed;
+} PIDControl;
+
+void   PIDInit(PIDControl *pid, double kp, double ki, double kd, double dt, double outMin, double outMax);
+void   PIDReset(PIDControl *pid);
+double PIDStep(PIDControl *pid, double measurement);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
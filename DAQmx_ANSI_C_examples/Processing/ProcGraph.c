@@ -0,0 +1,710 @@
+/*********************************************************************
+*
+* Processing helper:
+*    ProcGraph.c
+*
+* Description:
+*    Implementation of the work-stealing processing graph. See
+*    ProcGraph.h.
+*
+*    A task is one tile of one stage of one block in flight, packed
+*    into 64 bits. Each block in flight has a slot holding, per stage
+*    and tile, the number of predecessors it still waits for; the
+*    worker that brings a count to zero makes the tile ready. Ready
+*    tiles go to the worker's own deque. Tiles made ready by the
+*    producer, and with static assignment all tiles, go to a worker's
+*    mailbox, a short queue under a mutex.
+*
+*    A sink that becomes ready before the blocks ahead of it have
+*    been through it is parked in its slot, and the sink call of the
+*    block ahead pushes it when it is done.
+*
+*********************************************************************/
+
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE     // for pthread_setaffinity_np
+#endif
+
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "ProcGraph.h"
+#include "StreamThread.h"
+#include "StreamTime.h"
+
+#define TASK(slot,stage,tile)   (((uint64_t)(slot)<<24)|((uint64_t)(stage)<<16)|(uint64_t)(tile))
+#define TASK_SLOT(task)         ((int)((task)>>24))
+#define TASK_STAGE(task)        ((int)(((task)>>16)&0xff))
+#define TASK_TILE(task)         ((int)((task)&0xffff))
+
+#define SPIN_ROUNDS             64
+
+typedef struct Stage {
+    const char          *name;
+    int                 kind;
+    ProcStageFunction   function;
+    void                *data;
+    int                 numTiles;
+    int                 numPred;
+    int                 numSucc;
+    int                 succ[ProcGraphMaxStages];
+    long long           nextBlock;      // sinks: next block to pass
+} Stage;
+
+typedef struct Slot {
+    long long           block;
+    void                *data;
+    int                 busy;           // under slotMutex
+    atomic_int          stagesLeft;
+    atomic_int          *tilesLeft;     // [stage]
+    atomic_int          *waits;         // [stage*numTiles+tile], predecessors not yet done
+    int                 *parked;        // [stage], sinks ready but waiting their turn
+} Slot;
+
+// Chase-Lev deque. Only the owner pushes and takes; others steal.
+typedef struct Deque {
+    atomic_llong        top;
+    char                pad0[56];
+    atomic_llong        bottom;
+    char                pad1[56];
+    atomic_ullong       *items;
+    long long           mask;
+} Deque;
+
+typedef struct Mailbox {
+    StreamMutex         mutex;
+    StreamCond          cond;           // static assignment: the owner waits here
+    uint64_t            *items;
+    long long           head;
+    long long           count;
+} Mailbox;
+
+typedef struct WorkerStats {
+    long long           calls[ProcGraphMaxStages];
+    double              busy[ProcGraphMaxStages];
+    double              max[ProcGraphMaxStages];
+    long long           steals;
+    char                pad[64];
+} WorkerStats;
+
+typedef struct Worker {
+    ProcGraph           *graph;
+    int                 index;
+    uint32_t            rng;
+} Worker;
+
+struct ProcGraph {
+    ProcGraphConfig     cfg;
+    int                 numChanTiles;
+    Stage               stages[ProcGraphMaxStages];
+    int                 numStages;
+    int                 started;
+    long long           capacity;       // tasks a queue can hold
+    Slot                *slots;
+    Deque               deques[ProcGraphMaxWorkers];
+    Mailbox             mailboxes[ProcGraphMaxWorkers];
+    WorkerStats         *stats;
+    Worker              workers[ProcGraphMaxWorkers];
+    StreamThread        threads[ProcGraphMaxWorkers];
+    int                 numThreads;
+    StreamMutex         sinkMutex;
+    // Idle workers, with stealing.
+    atomic_int          pending;        // tasks queued and not yet taken
+    atomic_int          sleepers;
+    atomic_int          stop;
+    StreamMutex         idleMutex;
+    StreamCond          idleCond;
+    // Slots and drain.
+    StreamMutex         slotMutex;
+    StreamCond          slotCond;
+    long long           submitted;
+    long long           completed;
+    atomic_int          error;
+};
+
+/*********************************************/
+// Queues
+/*********************************************/
+static void DequePush(Deque *d, uint64_t task)
+{
+    long long b=atomic_load_explicit(&d->bottom,memory_order_relaxed);
+
+    atomic_store_explicit(&d->items[b&d->mask],task,memory_order_relaxed);
+    atomic_store_explicit(&d->bottom,b+1,memory_order_release);
+}
+
+static int DequeTake(Deque *d, uint64_t *task)
+{
+    long long   b=atomic_load_explicit(&d->bottom,memory_order_relaxed)-1;
+    long long   t;
+    int         got=1;
+
+    atomic_store_explicit(&d->bottom,b,memory_order_relaxed);
+    atomic_thread_fence(memory_order_seq_cst);
+    t = atomic_load_explicit(&d->top,memory_order_relaxed);
+    if( t<=b ) {
+        *task = atomic_load_explicit(&d->items[b&d->mask],memory_order_relaxed);
+        if( t==b ) {
+            // The last item: race the thieves for it.
+            got = atomic_compare_exchange_strong_explicit(&d->top,&t,t+1,memory_order_seq_cst,memory_order_relaxed);
+            atomic_store_explicit(&d->bottom,b+1,memory_order_relaxed);
+        }
+        return got;
+    }
+    atomic_store_explicit(&d->bottom,b+1,memory_order_relaxed);
+    return 0;
+}
+
+static int DequeSteal(Deque *d, uint64_t *task)
+{
+    long long t=atomic_load_explicit(&d->top,memory_order_acquire);
+    long long b;
+
+    atomic_thread_fence(memory_order_seq_cst);
+    b = atomic_load_explicit(&d->bottom,memory_order_acquire);
+    if( t>=b )
+        return 0;
+    *task = atomic_load_explicit(&d->items[t&d->mask],memory_order_relaxed);
+    return atomic_compare_exchange_strong_explicit(&d->top,&t,t+1,memory_order_seq_cst,memory_order_relaxed);
+}
+
+static void MailboxPush(ProcGraph *g, Mailbox *m, uint64_t task)
+{
+    StreamMutexLock(&m->mutex);
+    m->items[(m->head+m->count++)%g->capacity] = task;
+    StreamCondSignal(&m->cond);
+    StreamMutexUnlock(&m->mutex);
+}
+
+static int MailboxPop(ProcGraph *g, Mailbox *m, uint64_t *task)
+{
+    int got=0;
+
+    StreamMutexLock(&m->mutex);
+    if( m->count>0 ) {
+        *task = m->items[m->head];
+        m->head = (m->head+1)%g->capacity;
+        --m->count;
+        got = 1;
+    }
+    StreamMutexUnlock(&m->mutex);
+    return got;
+}
+
+// worker is -1 for the producer.
+static void Push(ProcGraph *g, int worker, uint64_t task)
+{
+    int target;
+
+    if( g->cfg.steal && worker>=0 ) {
+        DequePush(&g->deques[worker],task);
+    }
+    else {
+        const Slot *s=&g->slots[TASK_SLOT(task)];
+
+        // Channel tiles by channel, whole blocks by block.
+        if( g->stages[TASK_STAGE(task)].kind==ProcStageChannels )
+            target = TASK_TILE(task)%g->cfg.numWorkers;
+        else
+            target = (int)(s->block%g->cfg.numWorkers);
+        MailboxPush(g,&g->mailboxes[target],task);
+    }
+    if( g->cfg.steal ) {
+        atomic_fetch_add(&g->pending,1);
+        if( atomic_load(&g->sleepers)>0 ) {
+            StreamMutexLock(&g->idleMutex);
+            StreamCondSignal(&g->idleCond);
+            StreamMutexUnlock(&g->idleMutex);
+        }
+    }
+}
+
+/*********************************************/
+// Dependencies
+/*********************************************/
+static void Ready(ProcGraph *g, int worker, int slot, int stage, int tile)
+{
+    Stage   *st=&g->stages[stage];
+    int     now=1;
+
+    if( st->kind==ProcStageSink ) {
+        StreamMutexLock(&g->sinkMutex);
+        if( g->slots[slot].block!=st->nextBlock ) {
+            g->slots[slot].parked[stage] = 1;
+            now = 0;
+        }
+        StreamMutexUnlock(&g->sinkMutex);
+    }
+    if( now )
+        Push(g,worker,TASK(slot,stage,tile));
+}
+
+static void BlockDone(ProcGraph *g, Slot *s)
+{
+    if( g->cfg.release )
+        g->cfg.release(s->data,s->block,g->cfg.releaseData);
+    StreamMutexLock(&g->slotMutex);
+    s->busy = 0;
+    ++g->completed;
+    StreamCondBroadcast(&g->slotCond);
+    StreamMutexUnlock(&g->slotMutex);
+}
+
+static void Complete(ProcGraph *g, int worker, int slot, int stage, int tile)
+{
+    Slot    *s=&g->slots[slot];
+    Stage   *st=&g->stages[stage];
+    int     i,t;
+
+    if( st->kind==ProcStageChannels )
+        for(i=0;i<st->numSucc;++i) {
+            int next=st->succ[i];
+
+            if( g->stages[next].kind==ProcStageChannels && atomic_fetch_sub(&s->waits[next*g->numChanTiles+tile],1)==1 )
+                Ready(g,worker,slot,next,tile);
+        }
+    if( atomic_fetch_sub(&s->tilesLeft[stage],1)!=1 )
+        return;
+
+    // The whole stage is done for this block.
+    for(i=0;i<st->numSucc;++i) {
+        int next=st->succ[i];
+
+        if( st->kind==ProcStageChannels && g->stages[next].kind==ProcStageChannels )
+            continue;
+        for(t=0;t<g->stages[next].numTiles;++t)
+            if( atomic_fetch_sub(&s->waits[next*g->numChanTiles+t],1)==1 )
+                Ready(g,worker,slot,next,t);
+    }
+    if( st->kind==ProcStageSink ) {
+        Slot *n;
+
+        StreamMutexLock(&g->sinkMutex);
+        ++st->nextBlock;
+        n = &g->slots[st->nextBlock%g->cfg.maxBlocks];
+        if( n->block==st->nextBlock && n->parked[stage] ) {
+            n->parked[stage] = 0;
+            StreamMutexUnlock(&g->sinkMutex);
+            Push(g,worker,TASK(n-g->slots,stage,0));
+        }
+        else
+            StreamMutexUnlock(&g->sinkMutex);
+    }
+    if( atomic_fetch_sub(&s->stagesLeft,1)==1 )
+        BlockDone(g,s);
+}
+
+/*********************************************/
+// Workers
+/*********************************************/
+static void Run(ProcGraph *g, Worker *w, uint64_t task)
+{
+    int         slot=TASK_SLOT(task),stage=TASK_STAGE(task),t=TASK_TILE(task);
+    Slot        *s=&g->slots[slot];
+    Stage       *st=&g->stages[stage];
+    WorkerStats *ws=&g->stats[w->index];
+    ProcTile    tile;
+    double      t0,dt;
+    int         error,expected=0;
+
+    tile.block = s->block;
+    tile.blockData = s->data;
+    tile.worker = w->index;
+    if( st->kind==ProcStageChannels ) {
+        tile.firstChan = t*g->cfg.chansPerTile;
+        tile.numChans = g->cfg.numChans-tile.firstChan<g->cfg.chansPerTile ? g->cfg.numChans-tile.firstChan : g->cfg.chansPerTile;
+    }
+    else {
+        tile.firstChan = 0;
+        tile.numChans = g->cfg.numChans;
+    }
+    t0 = StreamTimeNow();
+    error = st->function(&tile,st->data);
+    dt = StreamTimeNow()-t0;
+    ++ws->calls[stage];
+    ws->busy[stage] += dt;
+    if( dt>ws->max[stage] )
+        ws->max[stage] = dt;
+    if( error )
+        atomic_compare_exchange_strong(&g->error,&expected,error);
+    Complete(g,w->index,slot,stage,t);
+}
+
+static int Steal(ProcGraph *g, Worker *w, uint64_t *task)
+{
+    int n=g->cfg.numWorkers,i,v;
+
+    w->rng ^= w->rng<<13;
+    w->rng ^= w->rng>>17;
+    w->rng ^= w->rng<<5;
+    for(i=0;i<n;++i) {
+        v = (int)((w->rng+i)%n);
+        if( v==w->index )
+            continue;
+        if( DequeSteal(&g->deques[v],task) || MailboxPop(g,&g->mailboxes[v],task) ) {
+            ++g->stats[w->index].steals;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static int Take(ProcGraph *g, Worker *w, uint64_t *task)
+{
+    if( DequeTake(&g->deques[w->index],task) || MailboxPop(g,&g->mailboxes[w->index],task) || Steal(g,w,task) ) {
+        atomic_fetch_sub(&g->pending,1);
+        return 1;
+    }
+    return 0;
+}
+
+static STREAM_THREAD_PROC(WorkerThread,arg)
+{
+    Worker      *w=(Worker*)arg;
+    ProcGraph   *g=w->graph;
+    Mailbox     *m=&g->mailboxes[w->index];
+    uint64_t    task;
+    int         spin;
+
+    if( g->cfg.affinity )
+        ThreadAffinityPin(g->cfg.affinity,ThreadRoleProcessing,w->index);
+    if( !g->cfg.steal ) {
+        // Static assignment: only this worker's mailbox.
+        StreamMutexLock(&m->mutex);
+        for(;;) {
+            while( m->count==0 && !atomic_load(&g->stop) )
+                StreamCondWait(&m->cond,&m->mutex);
+            if( m->count==0 )
+                break;
+            task = m->items[m->head];
+            m->head = (m->head+1)%g->capacity;
+            --m->count;
+            StreamMutexUnlock(&m->mutex);
+            Run(g,w,task);
+            StreamMutexLock(&m->mutex);
+        }
+        StreamMutexUnlock(&m->mutex);
+        return 0;
+    }
+    for(;;) {
+        for(spin=0;spin<SPIN_ROUNDS;++spin) {
+            if( Take(g,w,&task) )
+                break;
+            StreamCpuRelax();
+        }
+        if( spin<SPIN_ROUNDS ) {
+            Run(g,w,task);
+            continue;
+        }
+        StreamMutexLock(&g->idleMutex);
+        atomic_fetch_add(&g->sleepers,1);
+        while( atomic_load(&g->pending)==0 && !atomic_load(&g->stop) )
+            StreamCondWait(&g->idleCond,&g->idleMutex);
+        atomic_fetch_sub(&g->sleepers,1);
+        StreamMutexUnlock(&g->idleMutex);
+        if( atomic_load(&g->stop) && atomic_load(&g->pending)==0 )
+            break;
+    }
+    return 0;
+}
+
+/*********************************************/
+// Interface
+/*********************************************/
+int ProcGraphCreate(const ProcGraphConfig *config, ProcGraph **graph)
+{
+    ProcGraph *g;
+
+    *graph = NULL;
+    if( !config || config->numWorkers<1 || config->numWorkers>ProcGraphMaxWorkers || config->numChans<1
+        || config->chansPerTile<1 || config->maxBlocks<1 || config->maxBlocks>(1<<20) )
+        return ProcGraphErrInvalidArg;
+    g = (ProcGraph*)calloc(1,sizeof(ProcGraph));
+    if( !g )
+        return ProcGraphErrOutOfMemory;
+    g->cfg = *config;
+    g->numChanTiles = (config->numChans+config->chansPerTile-1)/config->chansPerTile;
+    if( g->numChanTiles>0xffff ) {
+        free(g);
+        return ProcGraphErrInvalidArg;
+    }
+    StreamMutexInit(&g->sinkMutex);
+    StreamMutexInit(&g->idleMutex);
+    StreamCondInit(&g->idleCond);
+    StreamMutexInit(&g->slotMutex);
+    StreamCondInit(&g->slotCond);
+    *graph = g;
+    return 0;
+}
+
+int ProcGraphAddStage(ProcGraph *graph, const char *name, int kind, ProcStageFunction function, void *stageData, int *stage)
+{
+    Stage *st;
+
+    if( graph->started )
+        return ProcGraphErrState;
+    if( !function || kind<ProcStageChannels || kind>ProcStageSink || graph->numStages==ProcGraphMaxStages )
+        return ProcGraphErrInvalidArg;
+    st = &graph->stages[graph->numStages];
+    memset(st,0,sizeof(Stage));
+    st->name = name ? name : "";
+    st->kind = kind;
+    st->function = function;
+    st->data = stageData;
+    st->numTiles = kind==ProcStageChannels ? graph->numChanTiles : 1;
+    if( stage )
+        *stage = graph->numStages;
+    ++graph->numStages;
+    return 0;
+}
+
+int ProcGraphConnect(ProcGraph *graph, int from, int to)
+{
+    Stage   *st;
+    int     i;
+
+    if( graph->started )
+        return ProcGraphErrState;
+    if( from<0 || from>=graph->numStages || to<0 || to>=graph->numStages || from==to )
+        return ProcGraphErrInvalidArg;
+    st = &graph->stages[from];
+    for(i=0;i<st->numSucc;++i)
+        if( st->succ[i]==to )
+            return 0;
+    st->succ[st->numSucc++] = to;
+    ++graph->stages[to].numPred;
+    return 0;
+}
+
+// Kahn's algorithm: every stage must be reachable in topological order.
+static int HasCycle(const ProcGraph *g)
+{
+    int preds[ProcGraphMaxStages],queue[ProcGraphMaxStages],head=0,tail=0,i,k;
+
+    for(i=0;i<g->numStages;++i)
+        if( (preds[i]=g->stages[i].numPred)==0 )
+            queue[tail++] = i;
+    while( head<tail ) {
+        const Stage *st=&g->stages[queue[head++]];
+
+        for(k=0;k<st->numSucc;++k)
+            if( --preds[st->succ[k]]==0 )
+                queue[tail++] = st->succ[k];
+    }
+    return tail<g->numStages;
+}
+
+// Frees what ProcGraphStart allocated and leaves the pointers NULL,
+// so a failed start can be retried or cleared.
+static void FreeBuffers(ProcGraph *g)
+{
+    int i;
+
+    for(i=0;i<g->cfg.numWorkers;++i) {
+        free(g->deques[i].items);
+        free(g->mailboxes[i].items);
+        g->deques[i].items = NULL;
+        g->mailboxes[i].items = NULL;
+    }
+    for(i=0;g->slots && i<g->cfg.maxBlocks;++i) {
+        free(g->slots[i].tilesLeft);
+        free(g->slots[i].waits);
+        free(g->slots[i].parked);
+    }
+    free(g->slots);
+    free(g->stats);
+    g->slots = NULL;
+    g->stats = NULL;
+}
+
+int ProcGraphStart(ProcGraph *graph)
+{
+    ProcGraph   *g=graph;
+    long long   tasks;
+    int         i;
+
+    if( g->started )
+        return ProcGraphErrState;
+    if( g->numStages==0 )
+        return ProcGraphErrInvalidArg;
+    if( HasCycle(g) )
+        return ProcGraphErrCycle;
+    tasks = (long long)g->cfg.maxBlocks*g->numStages*g->numChanTiles;
+    for(g->capacity=2;g->capacity<tasks;g->capacity*=2)
+        ;
+    g->slots = (Slot*)calloc(g->cfg.maxBlocks,sizeof(Slot));
+    g->stats = (WorkerStats*)calloc(g->cfg.numWorkers,sizeof(WorkerStats));
+    if( !g->slots || !g->stats )
+        goto Error;
+    for(i=0;i<g->cfg.maxBlocks;++i) {
+        Slot *s=&g->slots[i];
+
+        s->block = -1;
+        s->tilesLeft = (atomic_int*)calloc(g->numStages,sizeof(atomic_int));
+        s->waits = (atomic_int*)calloc((size_t)g->numStages*g->numChanTiles,sizeof(atomic_int));
+        s->parked = (int*)calloc(g->numStages,sizeof(int));
+        if( !s->tilesLeft || !s->waits || !s->parked )
+            goto Error;
+    }
+    for(i=0;i<g->cfg.numWorkers;++i) {
+        g->deques[i].items = (atomic_ullong*)calloc(g->capacity,sizeof(atomic_ullong));
+        g->deques[i].mask = g->capacity-1;
+        g->mailboxes[i].items = (uint64_t*)calloc(g->capacity,sizeof(uint64_t));
+        if( !g->deques[i].items || !g->mailboxes[i].items )
+            goto Error;
+    }
+    // The mailbox locks are only set up once nothing can fail, so that
+    // ProcGraphClear destroys them exactly when the graph has started.
+    for(i=0;i<g->cfg.numWorkers;++i) {
+        StreamMutexInit(&g->mailboxes[i].mutex);
+        StreamCondInit(&g->mailboxes[i].cond);
+    }
+    g->started = 1;
+    for(i=0;i<g->cfg.numWorkers;++i) {
+        g->workers[i].graph = g;
+        g->workers[i].index = i;
+        g->workers[i].rng = 2463534242u+977u*(uint32_t)i;
+        if( StreamThreadCreate(&g->threads[i],WorkerThread,&g->workers[i])!=0 )
+            return ProcGraphErrThread;
+        g->numThreads = i+1;
+    }
+    return 0;
+
+Error:
+    FreeBuffers(g);
+    return ProcGraphErrOutOfMemory;
+}
+
+int ProcGraphSubmit(ProcGraph *graph, void *blockData, long long *block)
+{
+    ProcGraph   *g=graph;
+    long long   b=g->submitted;
+    int         idx=(int)(b%g->cfg.maxBlocks),i,t;
+    Slot        *s=&g->slots[idx];
+
+    if( !g->started || g->numThreads<g->cfg.numWorkers )
+        return ProcGraphErrState;
+    StreamMutexLock(&g->slotMutex);
+    while( s->busy )
+        StreamCondWait(&g->slotCond,&g->slotMutex);
+    s->busy = 1;
+    StreamMutexUnlock(&g->slotMutex);
+
+    s->data = blockData;
+    atomic_store(&s->stagesLeft,g->numStages);
+    for(i=0;i<g->numStages;++i) {
+        atomic_store(&s->tilesLeft[i],g->stages[i].numTiles);
+        for(t=0;t<g->stages[i].numTiles;++t)
+            atomic_store(&s->waits[i*g->numChanTiles+t],g->stages[i].numPred);
+    }
+    StreamMutexLock(&g->sinkMutex);
+    memset(s->parked,0,sizeof(int)*g->numStages);
+    s->block = b;
+    StreamMutexUnlock(&g->sinkMutex);
+
+    StreamMutexLock(&g->slotMutex);
+    g->submitted = b+1;
+    StreamMutexUnlock(&g->slotMutex);
+    if( block )
+        *block = b;
+    for(i=0;i<g->numStages;++i)
+        if( g->stages[i].numPred==0 )
+            for(t=0;t<g->stages[i].numTiles;++t)
+                Ready(g,-1,idx,i,t);
+    return 0;
+}
+
+void ProcGraphDrain(ProcGraph *graph)
+{
+    StreamMutexLock(&graph->slotMutex);
+    while( graph->completed<graph->submitted )
+        StreamCondWait(&graph->slotCond,&graph->slotMutex);
+    StreamMutexUnlock(&graph->slotMutex);
+}
+
+void ProcGraphClear(ProcGraph *graph)
+{
+    ProcGraph   *g=graph;
+    int         i;
+
+    if( !g )
+        return;
+    if( g->numThreads==g->cfg.numWorkers )
+        ProcGraphDrain(g);
+    atomic_store(&g->stop,1);
+    StreamMutexLock(&g->idleMutex);
+    StreamCondBroadcast(&g->idleCond);
+    StreamMutexUnlock(&g->idleMutex);
+    for(i=0;i<g->numThreads;++i) {
+        StreamMutexLock(&g->mailboxes[i].mutex);
+        StreamCondBroadcast(&g->mailboxes[i].cond);
+        StreamMutexUnlock(&g->mailboxes[i].mutex);
+    }
+    for(i=0;i<g->numThreads;++i)
+        StreamThreadJoin(g->threads[i]);
+    if( g->started )
+        for(i=0;i<g->cfg.numWorkers;++i) {
+            StreamCondDestroy(&g->mailboxes[i].cond);
+            StreamMutexDestroy(&g->mailboxes[i].mutex);
+        }
+    FreeBuffers(g);
+    StreamCondDestroy(&g->slotCond);
+    StreamMutexDestroy(&g->slotMutex);
+    StreamCondDestroy(&g->idleCond);
+    StreamMutexDestroy(&g->idleMutex);
+    StreamMutexDestroy(&g->sinkMutex);
+    free(g);
+}
+
+int ProcGraphGetError(ProcGraph *graph)
+{
+    return atomic_load(&graph->error);
+}
+
+// The statistics are read without stopping the workers, so take them
+// after ProcGraphDrain for exact figures.
+int ProcGraphGetStageStats(ProcGraph *graph, int stage, ProcStageStats *stats)
+{
+    int w;
+
+    memset(stats,0,sizeof(ProcStageStats));
+    if( stage<0 || stage>=graph->numStages )
+        return ProcGraphErrInvalidArg;
+    stats->name = graph->stages[stage].name;
+    for(w=0;graph->stats && w<graph->cfg.numWorkers;++w) {
+        const WorkerStats *ws=&graph->stats[w];
+
+        stats->calls += ws->calls[stage];
+        stats->busy += ws->busy[stage];
+        if( ws->max[stage]>stats->max )
+            stats->max = ws->max[stage];
+    }
+    stats->mean = stats->calls ? stats->busy/stats->calls : 0.0;
+    return 0;
+}
+
+void ProcGraphGetStats(ProcGraph *graph, ProcGraphStats *stats)
+{
+    int w,s;
+
+    memset(stats,0,sizeof(ProcGraphStats));
+    StreamMutexLock(&graph->slotMutex);
+    stats->blocks = graph->completed;
+    StreamMutexUnlock(&graph->slotMutex);
+    for(w=0;graph->stats && w<graph->cfg.numWorkers;++w) {
+        const WorkerStats *ws=&graph->stats[w];
+
+        stats->steals += ws->steals;
+        for(s=0;s<graph->numStages;++s) {
+            stats->tiles += ws->calls[s];
+            stats->busy[w] += ws->busy[s];
+        }
+    }
+}
+
+void ProcGraphResetStats(ProcGraph *graph)
+{
+    if( graph->stats )
+        memset(graph->stats,0,sizeof(WorkerStats)*graph->cfg.numWorkers);
+}
@@ -0,0 +1,136 @@
+/*********************************************************************
+*
+* Processing helper:
+*    ProcGraph.h
+*
+* Description:
+*    Runs the per-block work that follows an EveryN read (scaling,
+*    filtering, statistics, compression, writing) as a graph of
+*    stages on a pool of worker threads. Giving each thread a fixed
+*    set of channels leaves threads idle whenever the channels cost
+*    different amounts; here the work is split into tiles and idle
+*    workers steal tiles from busy ones.
+*
+*    Each stage is a node with a function of one of three kinds:
+*
+*      ProcStageChannels   called once per tile of chansPerTile
+*                          channels of a block, tiles in parallel
+*      ProcStageBlock      called once per block, blocks in parallel
+*      ProcStageSink       called once per block, in the order the
+*                          blocks were submitted, one at a time
+*
+*    ProcGraphConnect(from,to) makes stage to wait for stage from in
+*    the same block. Between two channel stages the wait is per tile,
+*    so tile t of a filter can run as soon as tile t of the scaling
+*    is done. Otherwise the stage waits for the whole of the other.
+*
+*    The producer, e.g. the EveryN callback, calls ProcGraphSubmit
+*    for each block. Up to maxBlocks blocks are processed at once;
+*    Submit waits when that many are in flight. When every stage of a
+*    block has run, the release function is called with its data.
+*
+*    Each worker keeps its ready tiles in its own deque: it pushes
+*    and takes at one end, and idle workers steal from the other
+*    (Chase and Lev). Tiles that become ready on a worker are pushed
+*    to that worker's deque, so the stages of a tile tend to run on
+*    the same core while its channels are still in cache. With steal
+*    set to 0, tile t always runs on worker t mod numWorkers instead,
+*    which is the static assignment to compare with.
+*
+*    The time spent in every stage is measured per call and kept per
+*    worker, and ProcGraphGetStageStats adds it up.
+*
+*********************************************************************/
+
+#ifndef PROCGRAPH_H
+#define PROCGRAPH_H
+
+#include "ThreadAffinity.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define ProcGraphErrInvalidArg      -1
+#define ProcGraphErrOutOfMemory     -2
+#define ProcGraphErrThread          -3
+#define ProcGraphErrCycle           -4
+#define ProcGraphErrState           -5      // started, or not started
+
+#define ProcGraphMaxStages          16
+#define ProcGraphMaxWorkers         64
+
+#define ProcStageChannels           0
+#define ProcStageBlock              1
+#define ProcStageSink               2
+
+typedef struct ProcTile {
+    long long   block;          // sequence number, from 0
+    void        *blockData;     // as submitted
+    int         firstChan;
+    int         numChans;       // all channels for block and sink stages
+    int         worker;
+} ProcTile;
+
+// Returns 0, or an error that ProcGraphGetError reports.
+typedef int  (*ProcStageFunction)(const ProcTile *tile, void *stageData);
+typedef void (*ProcGraphRelease)(void *blockData, long long block, void *releaseData);
+
+typedef struct ProcGraphConfig {
+    int                     numWorkers;
+    int                     numChans;
+    int                     chansPerTile;
+    int                     maxBlocks;          // blocks in flight
+    int                     steal;              // 0 for static assignment
+    const ThreadAffinity    *affinity;          // processing CPUs, worker i on the (i mod n)th, or NULL
+    ProcGraphRelease        release;            // or NULL
+    void                    *releaseData;
+} ProcGraphConfig;
+
+typedef struct ProcStageStats {
+    const char  *name;
+    long long   calls;
+    double      busy;           // seconds, summed over workers
+    double      mean;           // seconds per call
+    double      max;
+} ProcStageStats;
+
+typedef struct ProcGraphStats {
+    long long   blocks;         // completed
+    long long   tiles;          // stage calls
+    long long   steals;
+    double      busy[ProcGraphMaxWorkers];  // seconds in stage calls, per worker
+} ProcGraphStats;
+
+typedef struct ProcGraph ProcGraph;
+
+int  ProcGraphCreate(const ProcGraphConfig *config, ProcGraph **graph);
+
+// Waits for the blocks in flight and stops the workers.
+void ProcGraphClear(ProcGraph *graph);
+
+// Stages and edges are added before ProcGraphStart. name must stay
+// valid while the graph exists.
+int  ProcGraphAddStage(ProcGraph *graph, const char *name, int kind, ProcStageFunction function, void *stageData, int *stage);
+int  ProcGraphConnect(ProcGraph *graph, int from, int to);
+
+int  ProcGraphStart(ProcGraph *graph);
+
+// Called by one producer thread. *block receives the block's number.
+int  ProcGraphSubmit(ProcGraph *graph, void *blockData, long long *block);
+
+// Waits until every submitted block has been released.
+void ProcGraphDrain(ProcGraph *graph);
+
+// First error returned by a stage function, or 0.
+int  ProcGraphGetError(ProcGraph *graph);
+
+int  ProcGraphGetStageStats(ProcGraph *graph, int stage, ProcStageStats *stats);
+void ProcGraphGetStats(ProcGraph *graph, ProcGraphStats *stats);
+void ProcGraphResetStats(ProcGraph *graph);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,338 @@
+/*********************************************************************
+*
+* Processing benchmark:
+*    ProcGraphBench.c
+*
+* Description:
+*    Runs the per-block processing of a 64 channel stream, in blocks
+*    of 4096 samples per channel, as a ProcGraph:
+*
+*      scale       raw samples to volts              channels
+*      filter      cascade of biquad sections        channels
+*      stats       mean and RMS per channel          channels
+*      compress    deltas of the block to 16 bits    block
+*      write       checks the block order and the    sink
+*                  statistics
+*
+*    with scale -> filter -> stats -> write and filter -> compress ->
+*    write. Channel c runs 1 + c mod 8 filter sections, so the tiles
+*    of 4 channels alternate between cheap and expensive ones, as a
+*    mix of channels with different filters does.
+*
+*    The producer fills a block, as the EveryN callback would, and
+*    submits it, with up to 4 blocks in flight. Each worker count is
+*    run with work stealing and with static assignment (tile t on
+*    worker t mod workers). Reports millions of samples per second,
+*    steals, and the load imbalance: the busiest worker's time in
+*    stage calls over the mean. The stage timing of the last run with
+*    work stealing is printed at the end.
+*
+*    Scaling with workers needs as many free CPUs. The processing
+*    CPUs can be given with -affinity "processing=1-7" (see
+*    ThreadAffinity.h). Worker i is pinned to the (i mod n)th of the
+*    n CPUs listed, so more workers than CPUs share them.
+*
+*    No DAQ hardware is needed. Build with ProcGraph.c and
+*    ThreadAffinity.c, and on Linux with -lpthread -lm.
+*
+*********************************************************************/
+
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE     // for pthread_setaffinity_np
+#endif
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "ProcGraph.h"
+#include "ThreadAffinity.h"
+#include "StreamThread.h"
+#include "StreamTime.h"
+
+#define NUM_CHANS       64
+#define NUM_SAMPS       4096
+#define CHANS_PER_TILE  4
+#define MAX_BLOCKS      4
+#define NUM_BLOCKS      100
+#define MAX_SECTIONS    8
+#define RAW_SCALE       (10.0/32768.0)
+
+typedef struct Block {
+    short       raw[NUM_CHANS*NUM_SAMPS];       // by channel
+    double      volts[NUM_CHANS*NUM_SAMPS];
+    double      filtered[NUM_CHANS*NUM_SAMPS];
+    short       packed[NUM_CHANS*NUM_SAMPS];
+    double      mean[NUM_CHANS];
+    double      rms[NUM_CHANS];
+    long long   clipped;
+    int         free;
+} Block;
+
+typedef struct Bench {
+    Block           blocks[MAX_BLOCKS];
+    StreamMutex     mutex;
+    StreamCond      cond;
+    long long       nextBlock;      // write stage
+    long long       outOfOrder;
+    double          checksum;
+} Bench;
+
+static const double section[5]={0.0675,0.1349,0.0675,-1.1430,0.4128};  // b0 b1 b2 a1 a2, low pass
+
+/*********************************************/
+// Stages
+/*********************************************/
+static int Scale(const ProcTile *tile, void *data)
+{
+    Block   *b=(Block*)tile->blockData;
+    int     i,n=tile->numChans*NUM_SAMPS,first=tile->firstChan*NUM_SAMPS;
+
+    for(i=0;i<n;++i)
+        b->volts[first+i] = RAW_SCALE*b->raw[first+i];
+    return 0;
+}
+
+static int Filter(const ProcTile *tile, void *data)
+{
+    Block   *b=(Block*)tile->blockData;
+    int     c,k,i;
+
+    for(c=tile->firstChan;c<tile->firstChan+tile->numChans;++c) {
+        const double    *x=&b->volts[c*NUM_SAMPS];
+        double          *y=&b->filtered[c*NUM_SAMPS];
+
+        memcpy(y,x,sizeof(double)*NUM_SAMPS);
+        for(k=0;k<1+c%MAX_SECTIONS;++k) {
+            double x1=0.0,x2=0.0,y1=0.0,y2=0.0;
+
+            for(i=0;i<NUM_SAMPS;++i) {
+                double in=y[i];
+                double out=section[0]*in+section[1]*x1+section[2]*x2-section[3]*y1-section[4]*y2;
+
+                x2 = x1; x1 = in;
+                y2 = y1; y1 = out;
+                y[i] = out;
+            }
+        }
+    }
+    return 0;
+}
+
+static int Stats(const ProcTile *tile, void *data)
+{
+    Block   *b=(Block*)tile->blockData;
+    int     c,i;
+
+    for(c=tile->firstChan;c<tile->firstChan+tile->numChans;++c) {
+        const double    *y=&b->filtered[c*NUM_SAMPS];
+        double          sum=0.0,sumSq=0.0;
+
+        for(i=0;i<NUM_SAMPS;++i) {
+            sum += y[i];
+            sumSq += y[i]*y[i];
+        }
+        b->mean[c] = sum/NUM_SAMPS;
+        b->rms[c] = sqrt(sumSq/NUM_SAMPS);
+    }
+    return 0;
+}
+
+static int Compress(const ProcTile *tile, void *data)
+{
+    Block       *b=(Block*)tile->blockData;
+    long long   clipped=0;
+    int         c,i;
+
+    for(c=0;c<NUM_CHANS;++c) {
+        const double    *y=&b->filtered[c*NUM_SAMPS];
+        double          prev=0.0;
+
+        for(i=0;i<NUM_SAMPS;++i) {
+            double d=(y[i]-prev)*(1.0/RAW_SCALE);
+
+            if( d>32767.0 || d<-32768.0 ) {
+                d = d>0.0 ? 32767.0 : -32768.0;
+                ++clipped;
+            }
+            b->packed[c*NUM_SAMPS+i] = (short)d;
+            prev += b->packed[c*NUM_SAMPS+i]*RAW_SCALE;
+        }
+    }
+    b->clipped = clipped;
+    return 0;
+}
+
+static int Write(const ProcTile *tile, void *data)
+{
+    Bench   *bench=(Bench*)data;
+    Block   *b=(Block*)tile->blockData;
+    int     c;
+
+    if( tile->block!=bench->nextBlock )
+        ++bench->outOfOrder;
+    bench->nextBlock = tile->block+1;
+    for(c=0;c<NUM_CHANS;++c)
+        bench->checksum += b->rms[c];
+    return 0;
+}
+
+static void Release(void *blockData, long long block, void *releaseData)
+{
+    Bench *bench=(Bench*)releaseData;
+
+    StreamMutexLock(&bench->mutex);
+    ((Block*)blockData)->free = 1;
+    StreamCondSignal(&bench->cond);
+    StreamMutexUnlock(&bench->mutex);
+}
+
+/*********************************************/
+// Runs
+/*********************************************/
+typedef struct Result {
+    double          msps;
+    long long       steals;
+    double          imbalance;
+    double          checksum;
+    long long       outOfOrder;
+    ProcStageStats  stages[5];
+} Result;
+
+static int Run(Bench *bench, const ThreadAffinity *affinity, int numWorkers, int steal, Result *r)
+{
+    ProcGraphConfig cfg={0};
+    ProcGraph       *graph;
+    ProcGraphStats  st;
+    int             s[5],i,w,error;
+    double          t0,elapsed,sum=0.0,max=0.0;
+
+    cfg.numWorkers = numWorkers;
+    cfg.numChans = NUM_CHANS;
+    cfg.chansPerTile = CHANS_PER_TILE;
+    cfg.maxBlocks = MAX_BLOCKS;
+    cfg.steal = steal;
+    cfg.affinity = affinity;
+    cfg.release = Release;
+    cfg.releaseData = bench;
+    if( ProcGraphCreate(&cfg,&graph)!=0 )
+        return -1;
+    ProcGraphAddStage(graph,"scale",ProcStageChannels,Scale,NULL,&s[0]);
+    ProcGraphAddStage(graph,"filter",ProcStageChannels,Filter,NULL,&s[1]);
+    ProcGraphAddStage(graph,"stats",ProcStageChannels,Stats,NULL,&s[2]);
+    ProcGraphAddStage(graph,"compress",ProcStageBlock,Compress,NULL,&s[3]);
+    ProcGraphAddStage(graph,"write",ProcStageSink,Write,bench,&s[4]);
+    ProcGraphConnect(graph,s[0],s[1]);
+    ProcGraphConnect(graph,s[1],s[2]);
+    ProcGraphConnect(graph,s[1],s[3]);
+    ProcGraphConnect(graph,s[2],s[4]);
+    ProcGraphConnect(graph,s[3],s[4]);
+    if( (error=ProcGraphStart(graph))!=0 ) {
+        ProcGraphClear(graph);
+        return error;
+    }
+    bench->nextBlock = 0;
+    bench->outOfOrder = 0;
+    bench->checksum = 0.0;
+    for(i=0;i<MAX_BLOCKS;++i)
+        bench->blocks[i].free = 1;
+
+    t0 = StreamTimeNow();
+    for(i=0;i<NUM_BLOCKS;++i) {
+        Block   *b=&bench->blocks[i%MAX_BLOCKS];
+        int     c,k;
+
+        StreamMutexLock(&bench->mutex);
+        while( !b->free )
+            StreamCondWait(&bench->cond,&bench->mutex);
+        b->free = 0;
+        StreamMutexUnlock(&bench->mutex);
+        // As the read of the block: a tone per channel and some noise.
+        for(c=0;c<NUM_CHANS;++c)
+            for(k=0;k<NUM_SAMPS;++k)
+                b->raw[c*NUM_SAMPS+k] = (short)(8000.0*sin(0.01*(c+1)*k+i)+(rand()&255)-128);
+        ProcGraphSubmit(graph,b,NULL);
+    }
+    ProcGraphDrain(graph);
+    elapsed = StreamTimeNow()-t0;
+
+    ProcGraphGetStats(graph,&st);
+    for(w=0;w<numWorkers;++w) {
+        sum += st.busy[w];
+        if( st.busy[w]>max )
+            max = st.busy[w];
+    }
+    r->msps = (double)NUM_BLOCKS*NUM_CHANS*NUM_SAMPS/elapsed/1e6;
+    r->steals = st.steals;
+    r->imbalance = sum>0.0 ? max/(sum/numWorkers) : 0.0;
+    r->checksum = bench->checksum;
+    r->outOfOrder = bench->outOfOrder;
+    for(i=0;i<5;++i)
+        ProcGraphGetStageStats(graph,s[i],&r->stages[i]);
+    error = ProcGraphGetError(graph);
+    ProcGraphClear(graph);
+    return error;
+}
+
+int main(int argc, char *argv[])
+{
+    static Bench    bench;
+    ThreadAffinity  affinity;
+    const char      *affinitySpec=NULL;
+    Result          r,last;
+    double          checksum=0.0;
+    int             workers[6]={1,2,4,8,16,32},i,steal,a,ok=1;
+
+    for(a=1;a<argc;++a) {
+        if( strcmp(argv[a],"-affinity")==0 && a+1<argc )
+            affinitySpec = argv[++a];
+        else {
+            printf("Usage: %s [-affinity \"processing=1-7\"]\n",argv[0]);
+            return 1;
+        }
+    }
+    if( affinitySpec && ThreadAffinityParse(affinitySpec,&affinity)!=0 ) {
+        printf("Invalid affinity: %s\n",affinitySpec);
+        return 1;
+    }
+    StreamMutexInit(&bench.mutex);
+    StreamCondInit(&bench.cond);
+
+    printf("%d channels x %d samples per block, %d channels per tile, %d blocks\n\n",NUM_CHANS,NUM_SAMPS,CHANS_PER_TILE,NUM_BLOCKS);
+    printf("%-10s%16s%12s%12s%16s%12s\n","Workers","stealing MS/s","steals","imbalance","static MS/s","imbalance");
+    for(i=0;i<6;++i) {
+        printf("%-10d",workers[i]);
+        for(steal=1;steal>=0;--steal) {
+            srand(1);
+            if( Run(&bench,affinitySpec ? &affinity : NULL,workers[i],steal,&r)!=0 ) {
+                printf("\nThe run failed\n");
+                return 2;
+            }
+            if( steal )
+                printf("%16.1f%12lld%12.2f",r.msps,r.steals,r.imbalance);
+            else
+                printf("%16.1f%12.2f",r.msps,r.imbalance);
+            fflush(stdout);
+            // Every run processes the same samples.
+            if( i==0 && steal )
+                checksum = r.checksum;
+            else if( fabs(r.checksum-checksum)>1e-9*fabs(checksum) )
+                ok = 0;
+            if( r.outOfOrder )
+                ok = 0;
+            if( steal )
+                last = r;
+        }
+        printf("\n");
+    }
+    printf("\nBlocks written in order with the same statistics in every run: %s\n",ok ? "yes" : "NO");
+
+    printf("\nStage timing, %d workers with stealing\n",workers[5]);
+    printf("%-10s%10s%14s%14s%14s\n","Stage","calls","busy (ms)","mean (us)","max (us)");
+    for(i=0;i<5;++i)
+        printf("%-10s%10lld%14.1f%14.1f%14.1f\n",last.stages[i].name,last.stages[i].calls,1e3*last.stages[i].busy,1e6*last.stages[i].mean,1e6*last.stages[i].max);
+
+    StreamCondDestroy(&bench.cond);
+    StreamMutexDestroy(&bench.mutex);
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,149 @@
+/*********************************************************************
+*
+* Processing stage:
+*    PulseTicks.c
+*
+* Description:
+*    Implementation of the pulse time to tick converter. See
+*    PulseTicks.h for the calling conventions.
+*
+*    A block is converted in three passes. The ideal edge positions
+*    are accumulated in ticks, relative to the last edge emitted by
+*    the previous block. They are then rounded, four at a time with
+*    AVX. Finally the rounded positions are differenced into high and
+*    low ticks, which is where the minimum is enforced.
+*
+*********************************************************************/
+
+#include <stdlib.h>
+#include <math.h>
+#include "PulseTicks.h"
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#endif
+
+struct PulseTicks {
+    double          rate;
+    double          minTicks;
+    int             maxBlockSize;
+    double          *ideal;         // 2*maxBlockSize edge positions
+    double          *rounded;
+    double          residual;       // ideal minus emitted position of the last edge, ticks
+
+    long long       numPulses;
+    long long       numClamped;
+    double          sumSqEdge;
+    double          maxEdge;
+    double          maxInterval;
+};
+
+int PulseTicksCreate(double timebaseRate, unsigned int minTicks, int maxBlockSize, PulseTicks **ticks)
+{
+    PulseTicks  *p;
+
+    *ticks = NULL;
+    if( timebaseRate<=0.0 || minTicks<1 || maxBlockSize<1 )
+        return PulseTicksErrInvalidArg;
+    p = (PulseTicks*)calloc(1,sizeof(PulseTicks));
+    if( !p )
+        return PulseTicksErrOutOfMemory;
+    p->ideal = (double*)malloc(2*(size_t)maxBlockSize*sizeof(double));
+    p->rounded = (double*)malloc(2*(size_t)maxBlockSize*sizeof(double));
+    if( !p->ideal || !p->rounded ) {
+        PulseTicksClear(p);
+        return PulseTicksErrOutOfMemory;
+    }
+    p->rate = timebaseRate;
+    p->minTicks = minTicks;
+    p->maxBlockSize = maxBlockSize;
+    *ticks = p;
+    return 0;
+}
+
+void PulseTicksClear(PulseTicks *ticks)
+{
+    if( !ticks )
+        return;
+    free(ticks->ideal);
+    free(ticks->rounded);
+    free(ticks);
+}
+
+void PulseTicksReset(PulseTicks *ticks)
+{
+    ticks->residual = 0.0;
+    ticks->numPulses = 0;
+    ticks->numClamped = 0;
+    ticks->sumSqEdge = 0.0;
+    ticks->maxEdge = 0.0;
+    ticks->maxInterval = 0.0;
+}
+
+static void RoundAll(const double in[], double out[], int n)
+{
+    int i=0;
+
+#if defined(__AVX__)
+    for(;i+4<=n;i+=4)
+        _mm256_storeu_pd(out+i,_mm256_round_pd(_mm256_loadu_pd(in+i),_MM_FROUND_TO_NEAREST_INT|_MM_FROUND_NO_EXC));
+#endif
+    for(;i<n;++i)
+        out[i] = nearbyint(in[i]);
+}
+
+int PulseTicksConvert(PulseTicks *p, const double highTime[], const double lowTime[], int numPulses,
+                      unsigned int highTicks[], unsigned int lowTicks[])
+{
+    double      c=p->residual,prevIdeal=p->residual,prev=0.0;
+    int         n=2*numPulses,k;
+
+    if( numPulses<0 || numPulses>p->maxBlockSize )
+        return PulseTicksErrInvalidArg;
+
+    for(k=0;k<numPulses;++k) {
+        c += highTime[k]*p->rate;
+        p->ideal[2*k] = c;
+        c += lowTime[k]*p->rate;
+        p->ideal[2*k+1] = c;
+    }
+    RoundAll(p->ideal,p->rounded,n);
+
+    for(k=0;k<n;++k) {
+        double t=p->rounded[k]-prev,err;
+
+        if( t<p->minTicks ) {
+            t = p->minTicks;
+            ++p->numClamped;
+        }
+        if( t>4294967295.0 )
+            return PulseTicksErrOverflow;
+        if( k&1 )
+            lowTicks[k>>1] = (unsigned int)t;
+        else
+            highTicks[k>>1] = (unsigned int)t;
+        prev += t;
+
+        err = fabs(prev-p->ideal[k]);
+        p->sumSqEdge += err*err;
+        if( err>p->maxEdge )
+            p->maxEdge = err;
+        err = fabs(t-(p->ideal[k]-prevIdeal));
+        if( err>p->maxInterval )
+            p->maxInterval = err;
+        prevIdeal = p->ideal[k];
+    }
+    if( n>0 )
+        p->residual = p->ideal[n-1]-prev;
+    p->numPulses += numPulses;
+    return 0;
+}
+
+void PulseTicksGetStats(const PulseTicks *ticks, PulseTicksStats *stats)
+{
+    stats->numPulses = ticks->numPulses;
+    stats->numClamped = ticks->numClamped;
+    stats->maxEdgeError = ticks->maxEdge/ticks->rate;
+    stats->rmsEdgeError = ticks->numPulses>0 ? sqrt(ticks->sumSqEdge/(2.0*ticks->numPulses))/ticks->rate : 0.0;
+    stats->maxIntervalError = ticks->maxInterval/ticks->rate;
+}
@@ -0,0 +1,62 @@
+/*********************************************************************
+*
+* Processing stage:
+*    PulseTicks.h
+*
+* Description:
+*    Converts pulse high and low times in seconds into counter ticks
+*    for DAQmxWriteCtrTicks, a block of pulses at a time.
+*
+*    Rounding every interval on its own lets the rounding errors add
+*    up, so a long schedule drifts away from its ideal edge times.
+*    Instead the edge times are accumulated and each edge is rounded
+*    to the nearest tick. Every edge is then within half a tick of its
+*    ideal time, however long the schedule, and the error of an
+*    interval is below one tick. The residual is carried from block to
+*    block.
+*
+*    Counters need a minimum number of ticks per phase, usually 2.
+*    Shorter intervals are lengthened to that minimum and counted; the
+*    extra time is taken out of the following intervals.
+*
+*********************************************************************/
+
+#ifndef PULSETICKS_H
+#define PULSETICKS_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define PulseTicksErrInvalidArg     -1
+#define PulseTicksErrOutOfMemory    -2
+#define PulseTicksErrOverflow       -3      // an interval needs more than 2^32-1 ticks
+
+typedef struct PulseTicksStats {
+    long long   numPulses;
+    long long   numClamped;         // intervals lengthened to minTicks
+    double      maxEdgeError;       // s, largest |quantised-ideal| edge time
+    double      rmsEdgeError;       // s
+    double      maxIntervalError;   // s, largest |quantised-ideal| high or low time
+} PulseTicksStats;
+
+typedef struct PulseTicks PulseTicks;
+
+int  PulseTicksCreate(double timebaseRate, unsigned int minTicks, int maxBlockSize, PulseTicks **ticks);
+void PulseTicksClear(PulseTicks *ticks);
+
+// Starts a new schedule and clears the statistics.
+void PulseTicksReset(PulseTicks *ticks);
+
+// Converts numPulses pulses, at most maxBlockSize, continuing the
+// schedule of the previous call.
+int  PulseTicksConvert(PulseTicks *ticks, const double highTime[], const double lowTime[], int numPulses,
+                       unsigned int highTicks[], unsigned int lowTicks[]);
+
+void PulseTicksGetStats(const PulseTicks *ticks, PulseTicksStats *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,82 @@
+/*********************************************************************
+*
+* Processing benchmark:
+*    PulseTicksBench.c
+*
+* Description:
+*    Converts ten million pulses with random high and low times of 1 us
+*    to 1 ms to ticks of a 100 MHz timebase. Reports the conversion
+*    rate in pulses/s and the quantisation error. For comparison every
+*    interval is also rounded on its own. That is as fast, but its edge
+*    error grows with the length of the schedule.
+*
+*    No DAQ hardware is needed. Build with PulseTicks.c.
+*
+*********************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include "PulseTicks.h"
+#include "StreamTime.h"
+
+#define TIMEBASE    100e6
+#define NUM_PULSES  10000000
+#define BLOCK_SIZE  4096
+
+int main(void)
+{
+    static double       high[BLOCK_SIZE],low[BLOCK_SIZE];
+    static unsigned int highTicks[BLOCK_SIZE],lowTicks[BLOCK_SIZE];
+    PulseTicks          *ticks;
+    PulseTicksStats     stats;
+    double              t0,tBulk=0.0,tNaive=0.0;
+    double              ideal=0.0,naiveMaxErr=0.0;
+    long long           naiveTicks=0;
+    int                 done,i;
+
+    if( PulseTicksCreate(TIMEBASE,2,BLOCK_SIZE,&ticks)!=0 ) {
+        printf("Could not create converter\n");
+        return 1;
+    }
+    srand(1);
+    for(done=0;done<NUM_PULSES;done+=BLOCK_SIZE) {
+        for(i=0;i<BLOCK_SIZE;++i) {
+            high[i] = 1e-6+1e-3*rand()/RAND_MAX;
+            low[i] = 1e-6+1e-3*rand()/RAND_MAX;
+        }
+
+        t0 = StreamTimeNow();
+        PulseTicksConvert(ticks,high,low,BLOCK_SIZE,highTicks,lowTicks);
+        tBulk += StreamTimeNow()-t0;
+
+        t0 = StreamTimeNow();
+        for(i=0;i<BLOCK_SIZE;++i) {
+            highTicks[i] = (unsigned int)nearbyint(high[i]*TIMEBASE);
+            lowTicks[i] = (unsigned int)nearbyint(low[i]*TIMEBASE);
+        }
+        tNaive += StreamTimeNow()-t0;
+
+        // Edge error of the per-interval rounding, in ticks.
+        for(i=0;i<BLOCK_SIZE;++i) {
+            double err;
+
+            ideal += high[i]*TIMEBASE+low[i]*TIMEBASE;
+            naiveTicks += (long long)highTicks[i]+lowTicks[i];
+            err = fabs(naiveTicks-ideal);
+            if( err>naiveMaxErr )
+                naiveMaxErr = err;
+        }
+    }
+    PulseTicksGetStats(ticks,&stats);
+
+    printf("%lld pulses, %.0f MHz timebase\n",stats.numPulses,1e-6*TIMEBASE);
+    printf("Method\t\tMpulses/s\tMax edge error (ns)\n");
+    printf("Accumulated\t%.1f\t\t%.2f\n",1e-6*stats.numPulses/tBulk,1e9*stats.maxEdgeError);
+    printf("Per interval\t%.1f\t\t%.2f\n",1e-6*stats.numPulses/tNaive,1e9*naiveMaxErr/TIMEBASE);
+    printf("RMS edge error %.2f ns, max interval error %.2f ns, %lld intervals clamped\n",
+        1e9*stats.rmsEdgeError,1e9*stats.maxIntervalError,stats.numClamped);
+
+    PulseTicksClear(ticks);
+    return 0;
+}
@@ -0,0 +1,237 @@
+/*********************************************************************
+*
+* Processing stage:
+*    RefTrigger.c
+*
+* Description:
+*    Implementation of the software reference trigger. See
+*    RefTrigger.h for the calling conventions.
+*
+*    The ring holds a power of two number of samples per channel, at
+*    least one window plus one block, so a window is still complete in
+*    the ring when the block holding its last sample has been written.
+*    The detector alternates between searching for the arming sample
+*    (the far side of the hysteresis band) and the trigger sample, and
+*    each search is a vectorised scan for the first sample beyond a
+*    threshold, so quiet stretches of signal cost little.
+*
+*********************************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+#include "RefTrigger.h"
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#endif
+
+#define MAX_PENDING 4096
+
+struct RefTrigger {
+    RefTriggerConfig    cfg;
+    RefTriggerCallback  callback;
+    void                *callbackData;
+    double              *ring;          // numChans*capacity
+    int                 capacity;       // power of two
+    long long           written;        // samples per channel written so far
+    int                 armed;
+    long long           holdoffUntil;
+    long long           *pending;       // trigger samples waiting for post-trigger data
+    int                 pendHead;
+    int                 pendCount;
+    int                 maxPending;
+    RefTriggerCounts    counts;
+};
+
+#if defined(__AVX__)
+static int FirstBit4(int mask)
+{
+    return (mask&1) ? 0 : (mask&2) ? 1 : (mask&4) ? 2 : 3;
+}
+#endif
+
+// Index of the first x[i]>=t, or n if there is none.
+static int FindFirstGE(const double x[], int n, double t)
+{
+    int i=0;
+
+#if defined(__AVX__)
+    __m256d vt=_mm256_set1_pd(t);
+
+    for(;i+4<=n;i+=4) {
+        int m=_mm256_movemask_pd(_mm256_cmp_pd(_mm256_loadu_pd(x+i),vt,_CMP_GE_OQ));
+        if( m )
+            return i+FirstBit4(m);
+    }
+#endif
+    for(;i<n;++i)
+        if( x[i]>=t )
+            return i;
+    return n;
+}
+
+// Index of the first x[i]<=t, or n if there is none.
+static int FindFirstLE(const double x[], int n, double t)
+{
+    int i=0;
+
+#if defined(__AVX__)
+    __m256d vt=_mm256_set1_pd(t);
+
+    for(;i+4<=n;i+=4) {
+        int m=_mm256_movemask_pd(_mm256_cmp_pd(_mm256_loadu_pd(x+i),vt,_CMP_LE_OQ));
+        if( m )
+            return i+FirstBit4(m);
+    }
+#endif
+    for(;i<n;++i)
+        if( x[i]<=t )
+            return i;
+    return n;
+}
+
+int RefTriggerCreate(const RefTriggerConfig *config, RefTriggerCallback callback, void *callbackData, RefTrigger **trigger)
+{
+    RefTrigger  *t;
+    long long   needed;
+    int         capacity=1024;
+
+    *trigger = NULL;
+    if( config->numChans<1 || config->trigChan<0 || config->trigChan>=config->numChans ||
+        config->preSamples<0 || config->postSamples<1 || config->maxBlockSize<1 ||
+        config->hysteresis<0.0 || config->holdoff<0 || !callback )
+        return RefTriggerErrInvalidArg;
+    needed = (long long)config->preSamples+config->postSamples+config->maxBlockSize;
+    if( needed>(1<<28) )
+        return RefTriggerErrInvalidArg;
+    while( capacity<needed )
+        capacity <<= 1;
+
+    t = (RefTrigger*)calloc(1,sizeof(RefTrigger));
+    if( !t )
+        return RefTriggerErrOutOfMemory;
+    t->cfg = *config;
+    t->callback = callback;
+    t->callbackData = callbackData;
+    t->capacity = capacity;
+    t->maxPending = (int)((config->postSamples+config->maxBlockSize)/(config->holdoff>0 ? config->holdoff : 1))+1;
+    if( t->maxPending>MAX_PENDING )
+        t->maxPending = MAX_PENDING;
+    t->ring = (double*)calloc((size_t)capacity*config->numChans,sizeof(double));
+    t->pending = (long long*)malloc(sizeof(long long)*t->maxPending);
+    if( !t->ring || !t->pending ) {
+        RefTriggerClear(t);
+        return RefTriggerErrOutOfMemory;
+    }
+    *trigger = t;
+    return 0;
+}
+
+void RefTriggerClear(RefTrigger *trigger)
+{
+    if( !trigger )
+        return;
+    free(trigger->ring);
+    free(trigger->pending);
+    free(trigger);
+}
+
+static void Detect(RefTrigger *t, const double x[], int n)
+{
+    const RefTriggerConfig  *cfg=&t->cfg;
+    double                  armLevel=cfg->slope==RefTriggerRising ? cfg->level-cfg->hysteresis : cfg->level+cfg->hysteresis;
+    long long               base=t->written;
+    int                     i=0;
+
+    if( t->holdoffUntil>base )
+        i = t->holdoffUntil-base<n ? (int)(t->holdoffUntil-base) : n;
+    while( i<n ) {
+        int k;
+
+        if( !t->armed ) {
+            k = cfg->slope==RefTriggerRising ? FindFirstLE(x+i,n-i,armLevel) : FindFirstGE(x+i,n-i,armLevel);
+            if( (i+=k)>=n )
+                break;
+            t->armed = 1;
+            ++i;
+            continue;
+        }
+        k = cfg->slope==RefTriggerRising ? FindFirstGE(x+i,n-i,cfg->level) : FindFirstLE(x+i,n-i,cfg->level);
+        if( (i+=k)>=n )
+            break;
+
+        // Trigger at absolute sample base+i.
+        t->armed = 0;
+        ++t->counts.triggers;
+        if( base+i>=cfg->preSamples ) {
+            if( t->pendCount<t->maxPending )
+                t->pending[(t->pendHead+t->pendCount++)%t->maxPending] = base+i;
+            else
+                ++t->counts.dropped;
+        }
+        t->holdoffUntil = base+i+(cfg->holdoff>0 ? cfg->holdoff : 1);
+        i = t->holdoffUntil-base<n ? (int)(t->holdoffUntil-base) : n;
+    }
+}
+
+int RefTriggerAddBlock(RefTrigger *trigger, const double data[], int numSampsPerChan)
+{
+    RefTrigger  *t=trigger;
+    int         n=numSampsPerChan,c;
+    int         pos,first;
+
+    if( n<0 )
+        return RefTriggerErrInvalidArg;
+    if( n>t->cfg.maxBlockSize )
+        return RefTriggerErrBlockTooLarge;
+
+    // Copy the block into the ring, in at most two pieces per channel.
+    pos = (int)(t->written&(t->capacity-1));
+    first = t->capacity-pos<n ? t->capacity-pos : n;
+    for(c=0;c<t->cfg.numChans;++c) {
+        double          *ring=t->ring+(size_t)c*t->capacity;
+        const double    *x=data+(size_t)c*n;
+
+        memcpy(ring+pos,x,sizeof(double)*first);
+        memcpy(ring,x+first,sizeof(double)*(n-first));
+    }
+
+    Detect(t,data+(size_t)t->cfg.trigChan*n,n);
+    t->written += n;
+    t->counts.samples = t->written;
+
+    // Report every window whose last sample has now arrived.
+    while( t->pendCount>0 ) {
+        long long       trig=t->pending[t->pendHead];
+        RefTriggerView  view;
+
+        if( trig+t->cfg.postSamples>t->written )
+            break;
+        view.owner = t;
+        view.triggerSample = trig;
+        view.firstSample = trig-t->cfg.preSamples;
+        view.length = t->cfg.preSamples+t->cfg.postSamples;
+        t->callback(&view,t->callbackData);
+        ++t->counts.windows;
+        t->pendHead = (t->pendHead+1)%t->maxPending;
+        --t->pendCount;
+    }
+    return 0;
+}
+
+void RefTriggerViewChannel(const RefTriggerView *view, int chan, const double **seg1, int *len1, const double **seg2, int *len2)
+{
+    const RefTrigger    *t=view->owner;
+    const double        *ring=t->ring+(size_t)chan*t->capacity;
+    int                 pos=(int)(view->firstSample&(t->capacity-1));
+
+    *seg1 = ring+pos;
+    *len1 = t->capacity-pos<view->length ? t->capacity-pos : view->length;
+    *seg2 = ring;
+    *len2 = view->length-*len1;
+}
+
+void RefTriggerGetCounts(const RefTrigger *trigger, RefTriggerCounts *counts)
+{
+    *counts = trigger->counts;
+}
@@ -0,0 +1,79 @@
+/*********************************************************************
+*
+* Processing stage:
+*    RefTrigger.h
+*
+* Description:
+*    Software reference trigger for a continuous acquisition. Blocks
+*    from the EveryNCallback are copied once into a per-channel history
+*    ring. A level/slope detector with hysteresis and holdoff scans the
+*    trigger channel, and for every trigger a window of preSamples
+*    before and postSamples after the trigger sample is reported as
+*    soon as its last sample has arrived. Windows may span any number
+*    of blocks, and the task never has to be stopped and re-armed.
+*
+*    Windows are passed to the callback as views into the ring, so no
+*    samples are copied. A view stays valid until the callback returns.
+*    Each channel of a view is at most two contiguous segments, because
+*    the ring wraps; use RefTriggerViewChannel to get them.
+*
+*********************************************************************/
+
+#ifndef REFTRIGGER_H
+#define REFTRIGGER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define RefTriggerErrInvalidArg     -1
+#define RefTriggerErrOutOfMemory    -2
+#define RefTriggerErrBlockTooLarge  -3
+
+#define RefTriggerRising    0
+#define RefTriggerFalling   1
+
+typedef struct RefTrigger RefTrigger;
+
+typedef struct RefTriggerConfig {
+    int         numChans;
+    int         trigChan;       // channel the detector watches
+    int         slope;          // RefTriggerRising or RefTriggerFalling
+    double      level;
+    double      hysteresis;     // signal must first be this far on the other side of level
+    long long   holdoff;        // samples after a trigger during which no new trigger is accepted
+    int         preSamples;
+    int         postSamples;    // including the trigger sample
+    int         maxBlockSize;
+} RefTriggerConfig;
+
+typedef struct RefTriggerView {
+    const RefTrigger    *owner;
+    long long           triggerSample;  // absolute sample index since the stream started
+    long long           firstSample;
+    int                 length;         // preSamples+postSamples
+} RefTriggerView;
+
+typedef void (*RefTriggerCallback)(const RefTriggerView *view, void *callbackData);
+
+typedef struct RefTriggerCounts {
+    long long   samples;
+    long long   triggers;
+    long long   windows;        // windows passed to the callback
+    long long   dropped;        // triggers lost because too many windows were pending
+} RefTriggerCounts;
+
+int  RefTriggerCreate(const RefTriggerConfig *config, RefTriggerCallback callback, void *callbackData, RefTrigger **trigger);
+void RefTriggerClear(RefTrigger *trigger);
+
+// data is DAQmx_Val_GroupByChannel with numSampsPerChan samples per channel.
+int  RefTriggerAddBlock(RefTrigger *trigger, const double data[], int numSampsPerChan);
+
+void RefTriggerViewChannel(const RefTriggerView *view, int chan, const double **seg1, int *len1, const double **seg2, int *len2);
+void RefTriggerGetCounts(const RefTrigger *trigger, RefTriggerCounts *counts);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
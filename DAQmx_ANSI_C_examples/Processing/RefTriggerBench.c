@@ -0,0 +1,90 @@
+/*********************************************************************
+*
+* Processing benchmark:
+*    RefTriggerBench.c
+*
+* Description:
+*    Feeds a synthetic multi-channel stream that crosses the trigger
+*    level every PERIOD samples through RefTriggerAddBlock. Reports
+*    the sustained sample and trigger rates, and checks that no
+*    trigger was dropped and that every window lines up with its
+*    trigger sample.
+*
+*    No DAQ hardware is needed. Build with RefTrigger.c.
+*
+*********************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include "RefTrigger.h"
+#include "StreamTime.h"
+
+#define NUM_CHANS       4
+#define BLOCK_SIZE      1000
+#define TOTAL_SAMPS     50000000LL
+#define PERIOD          100
+#define PI              3.1415926535
+
+static long long    misaligned=0;
+static double       checksum=0.0;
+
+static void OnWindow(const RefTriggerView *view, void *callbackData)
+{
+    const RefTriggerConfig  *cfg=(const RefTriggerConfig*)callbackData;
+    const double            *seg1,*seg2;
+    int                     len1,len2,c,k=cfg->preSamples;
+    double                  atTrigger,before;
+
+    // The trigger sample must be the first one at or above the level.
+    RefTriggerViewChannel(view,cfg->trigChan,&seg1,&len1,&seg2,&len2);
+    atTrigger = k<len1 ? seg1[k] : seg2[k-len1];
+    before = k-1<len1 ? seg1[k-1] : seg2[k-1-len1];
+    if( !(atTrigger>=cfg->level && before<cfg->level) )
+        ++misaligned;
+    for(c=0;c<cfg->numChans;++c) {
+        RefTriggerViewChannel(view,c,&seg1,&len1,&seg2,&len2);
+        checksum += seg1[0]+(len2 ? seg2[len2-1] : seg1[len1-1]);
+    }
+}
+
+int main(void)
+{
+    RefTriggerConfig    cfg;
+    RefTriggerCounts    counts;
+    RefTrigger          *trig;
+    static double       block[NUM_CHANS*BLOCK_SIZE];
+    long long           n;
+    double              t0,elapsed=0.0;
+    int                 c,i;
+
+    cfg.numChans = NUM_CHANS;
+    cfg.trigChan = 1;
+    cfg.slope = RefTriggerRising;
+    cfg.level = 0.0;
+    cfg.hysteresis = 0.2;
+    cfg.holdoff = PERIOD/2;
+    cfg.preSamples = 250;
+    cfg.postSamples = 750;
+    cfg.maxBlockSize = BLOCK_SIZE;
+    if( RefTriggerCreate(&cfg,OnWindow,&cfg,&trig)!=0 ) {
+        printf("Could not create the trigger\n");
+        return 1;
+    }
+
+    for(n=0;n<TOTAL_SAMPS;n+=BLOCK_SIZE) {
+        for(c=0;c<NUM_CHANS;++c)
+            for(i=0;i<BLOCK_SIZE;++i)
+                block[c*BLOCK_SIZE+i] = sin(2.0*PI*((n+i)%PERIOD+0.5)/PERIOD+c);
+        t0 = StreamTimeNow();
+        RefTriggerAddBlock(trig,block,BLOCK_SIZE);
+        elapsed += StreamTimeNow()-t0;
+    }
+    RefTriggerGetCounts(trig,&counts);
+
+    printf("%lld samples/chan, %lld triggers, %lld windows, %lld dropped, %lld misaligned\n",
+        counts.samples,counts.triggers,counts.windows,counts.dropped,misaligned);
+    printf("%.1f Msamples/s/chan, %.0f triggers/s\n",1e-6*counts.samples/elapsed,counts.triggers/elapsed);
+    RefTriggerClear(trig);
+    return (counts.dropped>0 || misaligned>0) || checksum==12345.0;
+}
@@ -0,0 +1,320 @@
+/*********************************************************************
+*
+* Processing stage:
+*    Resampler.c
+*
+* Description:
+*    Implementation of the streaming polyphase resampler. See
+*    Resampler.h for the calling conventions.
+*
+*    Output sample m lies at time m*downFactor on the upsampled grid.
+*    The phase accumulator holds that position relative to the first
+*    sample of the current block, in units of 1/upFactor input
+*    samples. Each channel keeps a work buffer whose first
+*    tapsPerPhase-1 entries are the tail of the previous block, so
+*    every output is a single contiguous dot product.
+*
+*********************************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "Resampler.h"
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
+
+#define PI  3.1415926535897932
+
+struct Resampler {
+    int         numChans;
+    int         up;
+    int         down;
+    int         taps;           // taps per phase, multiple of 8
+    int         maxBlock;
+    long long   phaseAcc;       // next output position, 1/up input samples
+    double      *coefF64;       // up phases of taps coefficients, time reversed
+    float       *coefF32;
+    double      *workF64;       // numChans * (taps-1+maxBlock)
+    float       *workF32;
+};
+
+static double DotF64(const double a[], const double b[], int n)
+{
+    int     i=0;
+#if defined(__AVX__)
+    __m256d s0=_mm256_setzero_pd(),s1=_mm256_setzero_pd();
+    __m128d lo;
+
+    for(;i<n;i+=8) {
+        s0 = _mm256_add_pd(s0,_mm256_mul_pd(_mm256_loadu_pd(a+i),_mm256_loadu_pd(b+i)));
+        s1 = _mm256_add_pd(s1,_mm256_mul_pd(_mm256_loadu_pd(a+i+4),_mm256_loadu_pd(b+i+4)));
+    }
+    s0 = _mm256_add_pd(s0,s1);
+    lo = _mm_add_pd(_mm256_castpd256_pd128(s0),_mm256_extractf128_pd(s0,1));
+    return _mm_cvtsd_f64(_mm_add_sd(lo,_mm_unpackhi_pd(lo,lo)));
+#elif defined(__SSE2__) || defined(_M_X64)
+    __m128d s0=_mm_setzero_pd(),s1=_mm_setzero_pd();
+
+    for(;i<n;i+=4) {
+        s0 = _mm_add_pd(s0,_mm_mul_pd(_mm_loadu_pd(a+i),_mm_loadu_pd(b+i)));
+        s1 = _mm_add_pd(s1,_mm_mul_pd(_mm_loadu_pd(a+i+2),_mm_loadu_pd(b+i+2)));
+    }
+    s0 = _mm_add_pd(s0,s1);
+    return _mm_cvtsd_f64(_mm_add_sd(s0,_mm_unpackhi_pd(s0,s0)));
+#else
+    double  s0=0.0,s1=0.0,s2=0.0,s3=0.0;
+
+    for(;i<n;i+=4) {
+        s0 += a[i]*b[i];
+        s1 += a[i+1]*b[i+1];
+        s2 += a[i+2]*b[i+2];
+        s3 += a[i+3]*b[i+3];
+    }
+    return (s0+s1)+(s2+s3);
+#endif
+}
+
+static float DotF32(const float a[], const float b[], int n)
+{
+    int     i=0;
+#if defined(__AVX__)
+    __m256  s=_mm256_setzero_ps();
+    __m128  q;
+
+    for(;i<n;i+=8)
+        s = _mm256_add_ps(s,_mm256_mul_ps(_mm256_loadu_ps(a+i),_mm256_loadu_ps(b+i)));
+    q = _mm_add_ps(_mm256_castps256_ps128(s),_mm256_extractf128_ps(s,1));
+    q = _mm_add_ps(q,_mm_movehl_ps(q,q));
+    return _mm_cvtss_f32(_mm_add_ss(q,_mm_shuffle_ps(q,q,1)));
+#elif defined(__SSE2__) || defined(_M_X64)
+    __m128  s0=_mm_setzero_ps(),s1=_mm_setzero_ps();
+
+    for(;i<n;i+=8) {
+        s0 = _mm_add_ps(s0,_mm_mul_ps(_mm_loadu_ps(a+i),_mm_loadu_ps(b+i)));
+        s1 = _mm_add_ps(s1,_mm_mul_ps(_mm_loadu_ps(a+i+4),_mm_loadu_ps(b+i+4)));
+    }
+    s0 = _mm_add_ps(s0,s1);
+    s0 = _mm_add_ps(s0,_mm_movehl_ps(s0,s0));
+    return _mm_cvtss_f32(_mm_add_ss(s0,_mm_shuffle_ps(s0,s0,1)));
+#else
+    float   s0=0.0f,s1=0.0f,s2=0.0f,s3=0.0f;
+
+    for(;i<n;i+=4) {
+        s0 += a[i]*b[i];
+        s1 += a[i+1]*b[i+1];
+        s2 += a[i+2]*b[i+2];
+        s3 += a[i+3]*b[i+3];
+    }
+    return (s0+s1)+(s2+s3);
+#endif
+}
+
+static int GreatestCommonDivisor(int a, int b)
+{
+    while( b ) {
+        int t = a%b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+// Windowed-sinc low pass of length up*taps-1, stored as up phases of
+// taps coefficients each, time reversed so that phase p applied to
+// x[base-taps+1..base] is a plain dot product. The final slot of the
+// last phase is zero, which keeps the filter odd length and its
+// group delay a whole number of upsampled samples.
+static void DesignFilter(Resampler *r)
+{
+    int     len=r->up*r->taps-1,n,p,j;
+    double  centre=(len-1)/2.0;
+    double  cutoff=0.45/(r->up>r->down?r->up:r->down);
+    double  sum=0.0,*h;
+
+    h = (double*)calloc(len+1,sizeof(double));
+    for(n=0;n<len;++n) {
+        double x=n-centre;
+        double w=0.42-0.5*cos(2.0*PI*n/(len-1))+0.08*cos(4.0*PI*n/(len-1));
+        h[n] = w*(x==0.0 ? 2.0*cutoff : sin(2.0*PI*cutoff*x)/(PI*x));
+        sum += h[n];
+    }
+    for(n=0;n<len;++n)
+        h[n] *= r->up/sum;
+
+    for(p=0;p<r->up;++p)
+        for(j=0;j<r->taps;++j) {
+            r->coefF64[p*r->taps+j] = h[p+(r->taps-1-j)*r->up];
+            r->coefF32[p*r->taps+j] = (float)r->coefF64[p*r->taps+j];
+        }
+    free(h);
+}
+
+int ResamplerCreate(int numChans, int upFactor, int downFactor, int tapsPerPhase, int maxBlockSize, Resampler **resampler)
+{
+    Resampler   *r;
+    int         g;
+
+    *resampler = NULL;
+    if( numChans<1 || upFactor<1 || downFactor<1 || tapsPerPhase<1 || maxBlockSize<1 )
+        return ResamplerErrInvalidArg;
+
+    g = GreatestCommonDivisor(upFactor,downFactor);
+    r = (Resampler*)calloc(1,sizeof(Resampler));
+    if( !r )
+        return ResamplerErrOutOfMemory;
+    r->numChans = numChans;
+    r->up = upFactor/g;
+    r->down = downFactor/g;
+    r->taps = (tapsPerPhase+7)&~7;
+    r->maxBlock = maxBlockSize;
+    r->coefF64 = (double*)malloc(sizeof(double)*r->up*r->taps);
+    r->coefF32 = (float*)malloc(sizeof(float)*r->up*r->taps);
+    if( !r->coefF64 || !r->coefF32 ) {
+        ResamplerClear(r);
+        return ResamplerErrOutOfMemory;
+    }
+    DesignFilter(r);
+    *resampler = r;
+    return 0;
+}
+
+int ResamplerCreateRatio(int numChans, double ratio, int maxFactor, int tapsPerPhase, int maxBlockSize, Resampler **resampler)
+{
+    // Best rational approximation by continued fractions, stopping
+    // before either term exceeds maxFactor.
+    long long   p0=0,q0=1,p1=1,q1=0;
+    double      x=ratio;
+
+    *resampler = NULL;
+    if( ratio<=0.0 || maxFactor<1 )
+        return ResamplerErrInvalidArg;
+    for(;;) {
+        long long   a=(long long)floor(x);
+        long long   p2=a*p1+p0,q2=a*q1+q0;
+
+        if( p2>maxFactor || q2>maxFactor )
+            break;
+        p0 = p1; q0 = q1;
+        p1 = p2; q1 = q2;
+        if( x-a<1e-12 )
+            break;
+        x = 1.0/(x-a);
+    }
+    if( q1==0 || p1==0 )
+        return ResamplerErrInvalidArg;
+    return ResamplerCreate(numChans,(int)p1,(int)q1,tapsPerPhase,maxBlockSize,resampler);
+}
+
+void ResamplerClear(Resampler *resampler)
+{
+    if( !resampler )
+        return;
+    free(resampler->coefF64);
+    free(resampler->coefF32);
+    free(resampler->workF64);
+    free(resampler->workF32);
+    free(resampler);
+}
+
+void ResamplerReset(Resampler *resampler)
+{
+    int stride=resampler->taps-1+resampler->maxBlock;
+
+    resampler->phaseAcc = 0;
+    if( resampler->workF64 )
+        memset(resampler->workF64,0,sizeof(double)*stride*resampler->numChans);
+    if( resampler->workF32 )
+        memset(resampler->workF32,0,sizeof(float)*stride*resampler->numChans);
+}
+
+void ResamplerGetFactors(const Resampler *resampler, int *upFactor, int *downFactor)
+{
+    *upFactor = resampler->up;
+    *downFactor = resampler->down;
+}
+
+double ResamplerGroupDelay(const Resampler *resampler)
+{
+    return (resampler->up*resampler->taps-2)/2.0/resampler->down;
+}
+
+int ResamplerMaxOutput(const Resampler *resampler, int numInput)
+{
+    return (int)(((long long)numInput*resampler->up+resampler->down-1)/resampler->down)+1;
+}
+
+int ResamplerProcessF64(Resampler *resampler, const double in[], int numInput, double out[], int outSizePerChan, int *numOut)
+{
+    Resampler   *r=resampler;
+    int         hist=r->taps-1,stride=hist+r->maxBlock;
+    int         c,n=0;
+    long long   acc=0;
+
+    *numOut = 0;
+    if( numInput>r->maxBlock )
+        return ResamplerErrBlockTooLarge;
+    if( outSizePerChan<ResamplerMaxOutput(r,numInput) )
+        return ResamplerErrOutputTooSmall;
+    if( !r->workF64 ) {
+        r->workF64 = (double*)calloc((size_t)stride*r->numChans,sizeof(double));
+        if( !r->workF64 )
+            return ResamplerErrOutOfMemory;
+    }
+
+    for(c=0;c<r->numChans;++c) {
+        double  *work=r->workF64+(size_t)c*stride;
+        double  *y=out+(size_t)c*outSizePerChan;
+        long long end=(long long)numInput*r->up;
+
+        memcpy(work+hist,in+(size_t)c*numInput,sizeof(double)*numInput);
+        for(n=0,acc=r->phaseAcc;acc<end;acc+=r->down,++n) {
+            int base=(int)(acc/r->up);
+            int phase=(int)(acc%r->up);
+            y[n] = DotF64(r->coefF64+phase*r->taps,work+base,r->taps);
+        }
+        memmove(work,work+numInput,sizeof(double)*hist);
+    }
+    r->phaseAcc = acc-(long long)numInput*r->up;
+    *numOut = n;
+    return 0;
+}
+
+int ResamplerProcessF32(Resampler *resampler, const float in[], int numInput, float out[], int outSizePerChan, int *numOut)
+{
+    Resampler   *r=resampler;
+    int         hist=r->taps-1,stride=hist+r->maxBlock;
+    int         c,n=0;
+    long long   acc=0;
+
+    *numOut = 0;
+    if( numInput>r->maxBlock )
+        return ResamplerErrBlockTooLarge;
+    if( outSizePerChan<ResamplerMaxOutput(r,numInput) )
+        return ResamplerErrOutputTooSmall;
+    if( !r->workF32 ) {
+        r->workF32 = (float*)calloc((size_t)stride*r->numChans,sizeof(float));
+        if( !r->workF32 )
+            return ResamplerErrOutOfMemory;
+    }
+
+    for(c=0;c<r->numChans;++c) {
+        float   *work=r->workF32+(size_t)c*stride;
+        float   *y=out+(size_t)c*outSizePerChan;
+        long long end=(long long)numInput*r->up;
+
+        memcpy(work+hist,in+(size_t)c*numInput,sizeof(float)*numInput);
+        for(n=0,acc=r->phaseAcc;acc<end;acc+=r->down,++n) {
+            int base=(int)(acc/r->up);
+            int phase=(int)(acc%r->up);
+            y[n] = DotF32(r->coefF32+phase*r->taps,work+base,r->taps);
+        }
+        memmove(work,work+numInput,sizeof(float)*hist);
+    }
+    r->phaseAcc = acc-(long long)numInput*r->up;
+    *numOut = n;
+    return 0;
+}
@@ -0,0 +1,76 @@
+/*********************************************************************
+*
+* Processing stage:
+*    Resampler.h
+*
+* Description:
+*    Streaming polyphase resampler for blocks read or written with
+*    DAQmx_Val_GroupByChannel layout. The rate is changed by the
+*    rational factor upFactor/downFactor using a windowed-sinc
+*    prototype filter that is split into upFactor phases. Filter
+*    history and the phase accumulator are carried across calls, so
+*    consecutive blocks produce exactly the same output as one long
+*    block would.
+*
+*    Typical uses:
+*    - Bring a 5 kHz AO reference stream onto a 10 kHz AI timebase
+*      (upFactor=2, downFactor=1) so that commanded and measured
+*      signals can be compared sample by sample.
+*    - Decimate an oversampled channel before it is stored
+*      (upFactor=1, downFactor=N).
+*
+*    The filter is linear phase. ResamplerGroupDelay returns the delay
+*    it introduces, in output samples, so the caller can delay the
+*    other stream by the same amount.
+*
+*    The inner dot products use AVX or SSE2 when the compiler targets
+*    them and fall back to plain C otherwise.
+*
+*********************************************************************/
+
+#ifndef RESAMPLER_H
+#define RESAMPLER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define ResamplerErrInvalidArg      -1
+#define ResamplerErrOutOfMemory     -2
+#define ResamplerErrBlockTooLarge   -3
+#define ResamplerErrOutputTooSmall  -4
+
+typedef struct Resampler Resampler;
+
+// Creates a resampler for numChans channels. tapsPerPhase is rounded
+// up to a multiple of 8 and sets the filter length (upFactor*tapsPerPhase).
+// maxBlockSize is the largest number of samples per channel that will
+// be passed to a single Process call.
+int  ResamplerCreate(int numChans, int upFactor, int downFactor, int tapsPerPhase, int maxBlockSize, Resampler **resampler);
+
+// As ResamplerCreate, but the rate change outRate/inRate is approximated
+// by a fraction with a denominator of at most maxFactor.
+int  ResamplerCreateRatio(int numChans, double ratio, int maxFactor, int tapsPerPhase, int maxBlockSize, Resampler **resampler);
+
+void ResamplerClear(Resampler *resampler);
+
+// Clears the filter history and phase so the next block starts a new stream.
+void ResamplerReset(Resampler *resampler);
+
+void   ResamplerGetFactors(const Resampler *resampler, int *upFactor, int *downFactor);
+double ResamplerGroupDelay(const Resampler *resampler);
+
+// Upper bound on the number of output samples per channel produced by
+// numInput input samples per channel.
+int  ResamplerMaxOutput(const Resampler *resampler, int numInput);
+
+// Both data arrays are GroupByChannel. Input channel c starts at
+// in[c*numInput] and output channel c starts at out[c*outSizePerChan].
+int  ResamplerProcessF64(Resampler *resampler, const double in[], int numInput, double out[], int outSizePerChan, int *numOut);
+int  ResamplerProcessF32(Resampler *resampler, const float in[], int numInput, float out[], int outSizePerChan, int *numOut);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
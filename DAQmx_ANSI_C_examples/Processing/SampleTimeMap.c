@@ -0,0 +1,214 @@
+/*********************************************************************
+*
+* Processing stage:
+*    SampleTimeMap.c
+*
+* Description:
+*    Implementation of the sample index to time map. See
+*    SampleTimeMap.h.
+*
+*    The fit keeps exponentially weighted means and co-moments of the
+*    points, updated in Welford's form so that the large sample
+*    indices of a long run do not cancel. Indices and times are taken
+*    relative to the first point of the fit. Each new point is tested
+*    against the line fitted before it, so an outlier never pulls the
+*    line towards itself.
+*
+*    The published line and diagnostics are written under a sequence
+*    lock, as in ChanStats.c.
+*
+*********************************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <stdatomic.h>
+#include "SampleTimeMap.h"
+
+typedef struct Published {
+    long long                   points;
+    double                      index;      // a point on the line
+    double                      time;
+    double                      slope;      // seconds per sample
+    SampleTimeMapDiagnostics    diag;
+} Published;
+
+struct SampleTimeMap {
+    SampleTimeMapConfig cfg;
+    double              lambda;
+
+    // Fit, touched only by the thread calling SampleTimeMapAdd
+    double              xRef;
+    double              yRef;
+    double              w;
+    double              mx;
+    double              my;
+    double              cxx;
+    double              cxy;
+    double              resSum;     // weighted sum of squared residuals
+    double              resW;
+    int                 consecutiveRejects;
+    SampleTimeMapDiagnostics diag;
+
+    atomic_uint         seq;
+    Published           pub;
+};
+
+int SampleTimeMapCreate(const SampleTimeMapConfig *config, SampleTimeMap **map)
+{
+    SampleTimeMap   *m;
+
+    *map = NULL;
+    if( config->nominalRate<=0.0 || config->horizon<2 || config->rejectSigma<=0.0 || config->minTolerance<0.0 || config->maxRejects<1 )
+        return SampleTimeMapErrInvalidArg;
+    m = (SampleTimeMap*)calloc(1,sizeof(SampleTimeMap));
+    if( !m )
+        return SampleTimeMapErrOutOfMemory;
+    m->cfg = *config;
+    m->lambda = 1.0-1.0/config->horizon;
+    atomic_init(&m->seq,0);
+    SampleTimeMapReset(m);
+    *map = m;
+    return 0;
+}
+
+void SampleTimeMapClear(SampleTimeMap *map)
+{
+    free(map);
+}
+
+// Forgets the current fit but keeps the counters.
+static void StartFit(SampleTimeMap *m)
+{
+    m->w = 0.0;
+    m->mx = m->my = 0.0;
+    m->cxx = m->cxy = 0.0;
+    m->resSum = m->resW = 0.0;
+    m->consecutiveRejects = 0;
+    m->diag.accepted = 0;
+    m->diag.rmsResidual = 0.0;
+    m->diag.minResidual = m->diag.maxResidual = 0.0;
+}
+
+static void Publish(SampleTimeMap *m, double slope)
+{
+    unsigned    seq=atomic_load_explicit(&m->seq,memory_order_relaxed);
+
+    m->diag.rate = 1.0/slope;
+    m->diag.driftPPM = (m->diag.rate/m->cfg.nominalRate-1.0)*1e6;
+    atomic_store_explicit(&m->seq,seq+1,memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    m->pub.points = m->diag.accepted;
+    m->pub.index = m->xRef+m->mx;
+    m->pub.time = m->yRef+m->my;
+    m->pub.slope = slope;
+    m->pub.diag = m->diag;
+    atomic_store_explicit(&m->seq,seq+2,memory_order_release);
+}
+
+void SampleTimeMapReset(SampleTimeMap *map)
+{
+    memset(&map->diag,0,sizeof(SampleTimeMapDiagnostics));
+    StartFit(map);
+    Publish(map,1.0/map->cfg.nominalRate);
+}
+
+static double Slope(const SampleTimeMap *m)
+{
+    return m->diag.accepted>=2 && m->cxx>0.0 ? m->cxy/m->cxx : 1.0/m->cfg.nominalRate;
+}
+
+int SampleTimeMapAdd(SampleTimeMap *map, long long sampleIndex, double time)
+{
+    SampleTimeMap   *m=map;
+    double          x,y,dx,dy,slope,residual=0.0;
+
+    if( m->diag.accepted==0 ) {
+        m->xRef = (double)sampleIndex;
+        m->yRef = time;
+    }
+    x = (double)sampleIndex-m->xRef;
+    y = time-m->yRef;
+    slope = Slope(m);
+
+    if( m->diag.accepted>0 ) {
+        residual = y-(m->my+slope*(x-m->mx));
+        if( m->diag.accepted>=3 ) {
+            double tolerance=m->cfg.rejectSigma*m->diag.rmsResidual;
+
+            if( tolerance<m->cfg.minTolerance )
+                tolerance = m->cfg.minTolerance;
+            if( fabs(residual)>tolerance ) {
+                m->diag.rejected++;
+                if( ++m->consecutiveRejects<m->cfg.maxRejects ) {
+                    Publish(m,slope);
+                    return 0;
+                }
+                // The stream has moved, e.g. after a restart: refit from here.
+                m->diag.refits++;
+                StartFit(m);
+                m->xRef = (double)sampleIndex;
+                m->yRef = time;
+                x = y = residual = 0.0;
+            }
+        }
+        if( m->diag.accepted>0 ) {    // not after a refit
+            m->resSum = m->lambda*m->resSum+residual*residual;
+            m->resW = m->lambda*m->resW+1.0;
+            m->diag.rmsResidual = sqrt(m->resSum/m->resW);
+            if( m->diag.accepted==1 || residual<m->diag.minResidual )
+                m->diag.minResidual = residual;
+            if( m->diag.accepted==1 || residual>m->diag.maxResidual )
+                m->diag.maxResidual = residual;
+        }
+    }
+    m->consecutiveRejects = 0;
+
+    m->w = m->lambda*m->w+1.0;
+    dx = x-m->mx;
+    dy = y-m->my;
+    m->mx += dx/m->w;
+    m->my += dy/m->w;
+    m->cxx = m->lambda*m->cxx+dx*(x-m->mx);
+    m->cxy = m->lambda*m->cxy+dx*(y-m->my);
+    m->diag.accepted++;
+    Publish(m,Slope(m));
+    return 1;
+}
+
+static void ReadPublished(const SampleTimeMap *map, Published *pub)
+{
+    SampleTimeMap   *m=(SampleTimeMap*)map;
+    unsigned        before,after;
+
+    do {
+        before = atomic_load_explicit(&m->seq,memory_order_acquire);
+        *pub = m->pub;
+        atomic_thread_fence(memory_order_acquire);
+        after = atomic_load_explicit(&m->seq,memory_order_relaxed);
+    } while( before!=after || (before&1) );
+}
+
+double SampleTimeMapTime(const SampleTimeMap *map, double index)
+{
+    Published   pub;
+
+    ReadPublished(map,&pub);
+    return pub.points>0 ? pub.time+pub.slope*(index-pub.index) : 0.0;
+}
+
+double SampleTimeMapIndex(const SampleTimeMap *map, double time)
+{
+    Published   pub;
+
+    ReadPublished(map,&pub);
+    return pub.points>0 ? pub.index+(time-pub.time)/pub.slope : 0.0;
+}
+
+void SampleTimeMapGetDiagnostics(const SampleTimeMap *map, SampleTimeMapDiagnostics *diag)
+{
+    Published   pub;
+
+    ReadPublished(map,&pub);
+    *diag = pub.diag;
+}
@@ -0,0 +1,88 @@
+/*********************************************************************
+*
+* Processing stage:
+*    SampleTimeMap.h
+*
+* Description:
+*    Maps the sample index of an acquisition stream to the monotonic
+*    clock of StreamTimeNow (CLOCK_MONOTONIC on Linux and macOS,
+*    QueryPerformanceCounter on Windows) and back. Timestamps from
+*    different tasks, devices or other instruments can then be
+*    compared on one time base.
+*
+*    After each block the application adds one point: the value of
+*    DAQmxGetReadTotalSampPerChanAcquired and the time at which the
+*    block arrived, e.g. taken on entry to the EveryN callback. The
+*    map keeps a least-squares line through the points, weighted so
+*    that a point's influence halves roughly every 0.7*horizon
+*    points, which lets it follow the drift of the sample clock
+*    against the computer's clock. Points that lie further from the
+*    line than rejectSigma times the RMS residual, and at least
+*    minTolerance seconds, are rejected as outliers, e.g. a callback
+*    delayed by a page fault. After maxRejects consecutive rejections
+*    the map assumes the stream has restarted and starts a new fit.
+*
+*    The line goes through the mean arrival times, so it includes the
+*    mean delivery latency. Subtract minResidual-meanResidual from
+*    the diagnostics, or a delay measured separately, if timestamps
+*    nearer to the moment of conversion are needed.
+*
+*    Adding a point costs a few multiplications. The fit is published
+*    under a sequence lock, so SampleTimeMapTime and
+*    SampleTimeMapIndex are O(1) and may be called from any thread.
+*
+*********************************************************************/
+
+#ifndef SAMPLETIMEMAP_H
+#define SAMPLETIMEMAP_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SampleTimeMapErrInvalidArg      -1
+#define SampleTimeMapErrOutOfMemory     -2
+
+typedef struct SampleTimeMapConfig {
+    double      nominalRate;    // the task's sample clock rate, Hz
+    int         horizon;        // points, at least 2
+    double      rejectSigma;    // outlier threshold in RMS residuals
+    double      minTolerance;   // smallest outlier threshold, seconds
+    int         maxRejects;     // consecutive rejections before a new fit
+} SampleTimeMapConfig;
+
+typedef struct SampleTimeMapDiagnostics {
+    long long   accepted;       // points in the current fit
+    long long   rejected;       // since create or reset
+    long long   refits;         // new fits started after maxRejects rejections
+    double      rate;           // measured sample rate against the monotonic clock, Hz
+    double      driftPPM;       // (rate/nominalRate-1)*1e6
+    double      rmsResidual;    // seconds, weighted as the fit
+    double      minResidual;    // seconds, accepted points of the current fit
+    double      maxResidual;
+} SampleTimeMapDiagnostics;
+
+typedef struct SampleTimeMap SampleTimeMap;
+
+int  SampleTimeMapCreate(const SampleTimeMapConfig *config, SampleTimeMap **map);
+void SampleTimeMapClear(SampleTimeMap *map);
+void SampleTimeMapReset(SampleTimeMap *map);
+
+// Adds the point (sampleIndex, time). Returns 1 if the point was
+// accepted and 0 if it was rejected. Points must come from a single
+// thread.
+int  SampleTimeMapAdd(SampleTimeMap *map, long long sampleIndex, double time);
+
+// Time at which sample index was acquired, in StreamTimeNow seconds,
+// and the inverse. Before the first point they return 0.0. With one
+// point the nominal rate is used.
+double SampleTimeMapTime(const SampleTimeMap *map, double index);
+double SampleTimeMapIndex(const SampleTimeMap *map, double time);
+
+void SampleTimeMapGetDiagnostics(const SampleTimeMap *map, SampleTimeMapDiagnostics *diag);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
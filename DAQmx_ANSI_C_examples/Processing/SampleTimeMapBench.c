@@ -0,0 +1,95 @@
+/*********************************************************************
+*
+* Processing benchmark:
+*    SampleTimeMapBench.c
+*
+* Description:
+*    Simulates one million callbacks of a 100 kS/s acquisition read in
+*    blocks of 100 samples. The sample clock runs 50 ppm fast against
+*    the computer's clock. Each callback arrives 50 us after its last
+*    sample plus an exponentially distributed delay of mean 20 us, and
+*    one callback in a hundred is held up by a further 1 to 10 ms.
+*
+*    Reports the time per added point and per lookup, the rate error
+*    of the fit in ppm, the number of rejected points and the error of
+*    the mapped times against the true acquisition times offset by
+*    the mean latency.
+*
+*    No DAQ hardware is needed. Build with SampleTimeMap.c.
+*
+*********************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include "SampleTimeMap.h"
+#include "StreamTime.h"
+
+#define RATE            100000.0
+#define DRIFT_PPM       50.0
+#define BLOCK_SIZE      100
+#define NUM_BLOCKS      1000000
+#define NUM_LOOKUPS     10000000
+#define BASE_LATENCY    50e-6
+#define MEAN_JITTER     20e-6
+
+static double Uniform(void)
+{
+    return (rand()+0.5)/((double)RAND_MAX+1.0);
+}
+
+int main(void)
+{
+    static double               arrival[NUM_BLOCKS];
+    SampleTimeMapConfig         config={RATE,2048,4.0,100e-6,16};
+    SampleTimeMapDiagnostics    diag;
+    SampleTimeMap               *map;
+    double                      trueRate=RATE*(1.0+1e-6*DRIFT_PPM);
+    double                      t0,tAdd,tLookup,sink=0.0,maxErr=0.0;
+    long long                   i,injected=0;
+
+    if( SampleTimeMapCreate(&config,&map)!=0 ) {
+        printf("Could not create map\n");
+        return 1;
+    }
+    srand(1);
+    for(i=0;i<NUM_BLOCKS;++i) {
+        arrival[i] = 1000.0+(i+1)*BLOCK_SIZE/trueRate+BASE_LATENCY-MEAN_JITTER*log(Uniform());
+        if( rand()%100==0 ) {
+            arrival[i] += 1e-3+9e-3*Uniform();
+            injected++;
+        }
+    }
+
+    t0 = StreamTimeNow();
+    for(i=0;i<NUM_BLOCKS;++i)
+        SampleTimeMapAdd(map,(i+1)*BLOCK_SIZE,arrival[i]);
+    tAdd = StreamTimeNow()-t0;
+
+    t0 = StreamTimeNow();
+    for(i=0;i<NUM_LOOKUPS;++i)
+        sink += SampleTimeMapTime(map,(double)i);
+    tLookup = StreamTimeNow()-t0;
+
+    // Compare with the truth over the last horizon of blocks.
+    for(i=NUM_BLOCKS-config.horizon;i<NUM_BLOCKS;++i) {
+        double  index=(double)(i+1)*BLOCK_SIZE;
+        double  truth=1000.0+index/trueRate+BASE_LATENCY+MEAN_JITTER;
+        double  err=fabs(SampleTimeMapTime(map,index)-truth);
+
+        if( err>maxErr )
+            maxErr = err;
+    }
+    SampleTimeMapGetDiagnostics(map,&diag);
+
+    printf("%d blocks of %d samples, %lld delayed callbacks injected\n",NUM_BLOCKS,BLOCK_SIZE,injected);
+    printf("Add: %.1f ns/point, lookup: %.1f ns (checksum %g)\n",1e9*tAdd/NUM_BLOCKS,1e9*tLookup/NUM_LOOKUPS,sink);
+    printf("Rate error: %.3f ppm (fit %.3f ppm, true %.3f ppm)\n",diag.driftPPM-DRIFT_PPM,diag.driftPPM,DRIFT_PPM);
+    printf("Rejected %lld points, %lld refits, RMS residual %.1f us\n",diag.rejected,diag.refits,1e6*diag.rmsResidual);
+    printf("Max time error over the last %d blocks: %.2f us\n",config.horizon,1e6*maxErr);
+    printf("Round trip error at the last sample: %.3g samples\n",
+        SampleTimeMapIndex(map,SampleTimeMapTime(map,(double)NUM_BLOCKS*BLOCK_SIZE))-(double)NUM_BLOCKS*BLOCK_SIZE);
+
+    SampleTimeMapClear(map);
+    return 0;
+}
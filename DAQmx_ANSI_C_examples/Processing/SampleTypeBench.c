@@ -0,0 +1,332 @@
+/*********************************************************************
+*
+* Processing benchmark:
+*    SampleTypeBench.c
+*
+* Description:
+*    Runs the same acquisition pipeline with float and with double
+*    samples and compares their throughput, stage by stage and end to
+*    end. Each block of raw I16 data, as DAQmxReadBinaryI16 returns
+*    it, is
+*
+*    1. scaled to volts with AIScale,
+*    2. added to the ChanStats health statistics,
+*    3. added to the Envelope display pyramid,
+*    4. decimated 4:1 with the Resampler for storage,
+*
+*    and the same number of samples are rendered for 2 AO channels by
+*    ToneSynth and converted to the float64 that DAQmxWriteAnalogF64
+*    takes. The double pipeline renders straight into the write buffer.
+*
+*    Blocks of 1000 and 10000 samples per channel on 8 and 32 channels
+*    are timed, cycling through 4 different raw blocks. Times are in
+*    ns per channel sample; each case is the best of 3 runs of at
+*    least 0.2 s. Afterwards the two pipelines' results are compared,
+*    to show what float costs in accuracy.
+*
+*    Build with AVX enabled (-mavx, or /arch:AVX with MSVC). Without
+*    it the explicit vector paths of AIScale and ChanStats are left out
+*    and float gains little.
+*
+*    Usage:
+*        SampleTypeBench [-cpu n]
+*
+*    No DAQ hardware is needed. Build with AIScale.c, ChanStats.c,
+*    Envelope.c, Resampler.c and ToneSynth.c.
+*
+*********************************************************************/
+
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE     // for pthread_setaffinity_np
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "AIScale.h"
+#include "ChanStats.h"
+#include "Envelope.h"
+#include "Resampler.h"
+#include "ToneSynth.h"
+#include "StreamTime.h"
+#include "StreamThread.h"
+
+#define MAX_CHANS       32
+#define MAX_BLOCK       10000
+#define NUM_RAW         4
+#define AO_CHANS        2
+#define DECIMATION      4
+#define MIN_RUN_TIME    0.2
+#define NUM_RUNS        3
+
+enum { StageScale, StageStats, StageEnvelope, StageDecimate, StageAO, NumStages };
+
+static const char *stageNames[NumStages]={"AIScale","ChanStats","Envelope","Resampler 1:4","ToneSynth+write"};
+
+typedef struct Pipeline {
+    int         chans;
+    int         block;
+    AIScale     *scale;
+    ChanStats   *stats;
+    Envelope    *envelope;
+    Resampler   *decimator;
+    ToneSynth   *synth[AO_CHANS];
+    void        *samples;       // chans*block, float or double
+    void        *stored;        // chans*(block/DECIMATION+1)
+    int         numStored;      // per channel, by the last block
+    void        *ao;            // AO_CHANS*block
+    double      *aoWrite;       // AO_CHANS*block, as passed to DAQmxWriteAnalogF64
+    long long   numBlocks;
+    double      stageTime[NumStages];
+} Pipeline;
+
+static short    *raw;           // NUM_RAW blocks of MAX_CHANS*MAX_BLOCK
+
+static void PipelineClear(Pipeline *p)
+{
+    int i;
+
+    AIScaleClear(p->scale);
+    ChanStatsClear(p->stats);
+    EnvelopeClear(p->envelope);
+    ResamplerClear(p->decimator);
+    for(i=0;i<AO_CHANS;++i)
+        ToneSynthClear(p->synth[i]);
+    free(p->samples);
+    free(p->stored);
+    free(p->ao);
+    free(p->aoWrite);
+    memset(p,0,sizeof(Pipeline));
+}
+
+static int PipelineCreate(int chans, int block, size_t sampleSize, Pipeline *p)
+{
+    double  coeffs[MAX_CHANS*4];
+    int     i,error;
+
+    memset(p,0,sizeof(Pipeline));
+    p->chans = chans;
+    p->block = block;
+    // The magnitudes of a 16 bit device's calibration polynomial.
+    for(i=0;i<chans;++i) {
+        coeffs[4*i] = 1e-3*i;
+        coeffs[4*i+1] = 3.05e-4;
+        coeffs[4*i+2] = 1e-12;
+        coeffs[4*i+3] = -2e-17;
+    }
+    if( (error=AIScaleCreate(chans,coeffs,4,&p->scale))!=0 ||
+        (error=ChanStatsCreate(chans,-9.99,9.99,10,&p->stats))!=0 ||
+        (error=EnvelopeCreate(chans,6,10,1<<16,&p->envelope))!=0 ||
+        (error=ResamplerCreate(chans,1,DECIMATION,16,block,&p->decimator))!=0 )
+        goto Error;
+    for(i=0;i<AO_CHANS;++i)
+        if( (error=ToneSynthCreate(10000.0,5.0,10.0+i,0.0,64,&p->synth[i]))!=0 )
+            goto Error;
+    p->samples = malloc(sampleSize*chans*block);
+    p->stored = malloc(sampleSize*chans*(block/DECIMATION+1));
+    p->ao = malloc(sampleSize*AO_CHANS*block);
+    p->aoWrite = (double*)malloc(sizeof(double)*AO_CHANS*block);
+    if( !p->samples || !p->stored || !p->ao || !p->aoWrite ) {
+        error = -2;
+        goto Error;
+    }
+    return 0;
+
+Error:
+    PipelineClear(p);
+    return error;
+}
+
+static const short *RawBlock(const Pipeline *p)
+{
+    return raw+(size_t)(p->numBlocks%NUM_RAW)*MAX_CHANS*MAX_BLOCK;
+}
+
+/*********************************************/
+// The pipeline, once for each sample type
+/*********************************************/
+static void RunF32(Pipeline *p)
+{
+    float   *x=(float*)p->samples,*ao=(float*)p->ao;
+    double  t[NumStages+1];
+    size_t  i;
+    int     c;
+
+    t[0] = StreamTimeNow();
+    AIScaleToF32(p->scale,RawBlock(p),p->block,0,x);
+    t[1] = StreamTimeNow();
+    ChanStatsAddF32(p->stats,x,p->block,0);
+    t[2] = StreamTimeNow();
+    EnvelopeAddBlockF32(p->envelope,x,p->block,0);
+    t[3] = StreamTimeNow();
+    ResamplerProcessF32(p->decimator,x,p->block,(float*)p->stored,p->block/DECIMATION+1,&p->numStored);
+    t[4] = StreamTimeNow();
+    for(c=0;c<AO_CHANS;++c)
+        ToneSynthRenderF32(p->synth[c],ao+(size_t)c*p->block,p->block);
+    // The only place the AO data are widened to the driver's type.
+    for(i=0;i<(size_t)AO_CHANS*p->block;++i)
+        p->aoWrite[i] = ao[i];
+    t[5] = StreamTimeNow();
+    for(c=0;c<NumStages;++c)
+        p->stageTime[c] += t[c+1]-t[c];
+    p->numBlocks++;
+}
+
+static void RunF64(Pipeline *p)
+{
+    double  *x=(double*)p->samples;
+    double  t[NumStages+1];
+    int     c;
+
+    t[0] = StreamTimeNow();
+    AIScaleToF64(p->scale,RawBlock(p),p->block,0,x);
+    t[1] = StreamTimeNow();
+    ChanStatsAddF64(p->stats,x,p->block,0);
+    t[2] = StreamTimeNow();
+    EnvelopeAddBlock(p->envelope,x,p->block,0);
+    t[3] = StreamTimeNow();
+    ResamplerProcessF64(p->decimator,x,p->block,(double*)p->stored,p->block/DECIMATION+1,&p->numStored);
+    t[4] = StreamTimeNow();
+    for(c=0;c<AO_CHANS;++c)
+        ToneSynthRender(p->synth[c],p->aoWrite+(size_t)c*p->block,p->block);
+    t[5] = StreamTimeNow();
+    for(c=0;c<NumStages;++c)
+        p->stageTime[c] += t[c+1]-t[c];
+    p->numBlocks++;
+}
+
+// Best of NUM_RUNS runs, in ns per channel sample for each stage and
+// in total.
+static int Time(int chans, int block, int f32, double ns[NumStages+1])
+{
+    Pipeline    p;
+    int         run,s,error;
+
+    for(s=0;s<=NumStages;++s)
+        ns[s] = HUGE_VAL;
+    for(run=0;run<NUM_RUNS;++run) {
+        double  t0,total,samples;
+
+        if( (error=PipelineCreate(chans,block,f32 ? sizeof(float) : sizeof(double),&p))!=0 )
+            return error;
+        f32 ? RunF32(&p) : RunF64(&p);
+        memset(p.stageTime,0,sizeof(p.stageTime));
+        p.numBlocks = 0;
+        t0 = StreamTimeNow();
+        do {
+            f32 ? RunF32(&p) : RunF64(&p);
+        } while( StreamTimeNow()-t0<MIN_RUN_TIME );
+        total = StreamTimeNow()-t0;
+        samples = (double)p.numBlocks*chans*block;
+        for(s=0;s<NumStages;++s)
+            if( 1e9*p.stageTime[s]/samples<ns[s] )
+                ns[s] = 1e9*p.stageTime[s]/samples;
+        if( 1e9*total/samples<ns[NumStages] )
+            ns[NumStages] = 1e9*total/samples;
+        PipelineClear(&p);
+    }
+    return 0;
+}
+
+// Runs both pipelines over the same blocks and prints the largest
+// differences between their results.
+static int Compare(int chans, int block)
+{
+    Pipeline        p32,p64;
+    ChanStatsResult r32,r64;
+    double          dStored=0.0,dMean=0.0,dRms=0.0,dBin=0.0,dAO=0.0;
+    int             i,c,k,level0,error;
+
+    if( (error=PipelineCreate(chans,block,sizeof(float),&p32))!=0 )
+        return error;
+    if( (error=PipelineCreate(chans,block,sizeof(double),&p64))!=0 ) {
+        PipelineClear(&p32);
+        return error;
+    }
+    for(i=0;i<200;++i) {
+        RunF32(&p32);
+        RunF64(&p64);
+        for(c=0;c<chans;++c)
+            for(k=0;k<p32.numStored;++k) {
+                size_t  at=(size_t)c*(block/DECIMATION+1)+k;
+                double  d=fabs(((float*)p32.stored)[at]-((double*)p64.stored)[at]);
+
+                dStored = d>dStored ? d : dStored;
+            }
+        for(c=0;c<AO_CHANS*block;++c) {
+            double d=fabs(p32.aoWrite[c]-p64.aoWrite[c]);
+            dAO = d>dAO ? d : dAO;
+        }
+    }
+    for(c=0;c<chans;++c) {
+        const EnvelopeBin   *b32,*b64;
+        int                 n;
+
+        ChanStatsQuery(p32.stats,c,&r32,NULL);
+        ChanStatsQuery(p64.stats,c,&r64,NULL);
+        dMean = fabs(r32.mean-r64.mean)>dMean ? fabs(r32.mean-r64.mean) : dMean;
+        dRms = fabs(r32.rms-r64.rms)>dRms ? fabs(r32.rms-r64.rms) : dRms;
+        b32 = EnvelopeGetLevel(p32.envelope,c,0,&level0);
+        b64 = EnvelopeGetLevel(p64.envelope,c,0,&n);
+        for(i=0;i<level0 && i<n;++i) {
+            double d=fabs(b32[i].mean-b64[i].mean);
+            dBin = d>dBin ? d : dBin;
+        }
+    }
+    printf("Largest |f32-f64| after %d blocks of %d x %d:\n",200,chans,block);
+    printf("  stored samples %.2e V, AO samples %.2e V, envelope means %.2e V\n",dStored,dAO,dBin);
+    printf("  running mean %.2e V, running rms %.2e V (one code is %.2e V)\n",dMean,dRms,3.05e-4);
+    PipelineClear(&p32);
+    PipelineClear(&p64);
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    int     chanCounts[]={8,32};
+    int     blockSizes[]={1000,10000};
+    int     cpu=0,a,i,j,s,k;
+    size_t  n;
+
+    for(a=1;a<argc;++a) {
+        if( strcmp(argv[a],"-cpu")==0 && a+1<argc )
+            cpu = atoi(argv[++a]);
+        else {
+            printf("Usage: %s [-cpu n]\n",argv[0]);
+            return 2;
+        }
+    }
+    if( cpu>=0 && StreamThreadPinCurrent(cpu)!=0 )
+        printf("Could not pin to CPU %d, timings may be noisy\n",cpu);
+
+    n = (size_t)NUM_RAW*MAX_CHANS*MAX_BLOCK;
+    raw = (short*)malloc(sizeof(short)*n);
+    if( !raw ) {
+        printf("Out of memory\n");
+        return 2;
+    }
+    // A 9 V sine plus a little deterministic noise.
+    for(k=0;k<(int)n;++k)
+        raw[k] = (short)(29500.0*sin(0.00123*k)+40.0*sin(1.7*(double)k*k));
+
+    for(i=0;i<2;++i)
+        for(j=0;j<2;++j) {
+            double ns32[NumStages+1],ns64[NumStages+1];
+
+            if( Time(chanCounts[i],blockSizes[j],1,ns32)!=0 || Time(chanCounts[i],blockSizes[j],0,ns64)!=0 ) {
+                printf("Could not create the pipeline\n");
+                free(raw);
+                return 1;
+            }
+            printf("\n%d channels, %d samples per block (ns per channel sample)\n",chanCounts[i],blockSizes[j]);
+            printf("%-18s%10s%10s%10s\n","Stage","f64","f32","f64/f32");
+            for(s=0;s<NumStages;++s)
+                printf("%-18s%10.3f%10.3f%10.2f\n",stageNames[s],ns64[s],ns32[s],ns64[s]/ns32[s]);
+            printf("%-18s%10.3f%10.3f%10.2f\n","End to end",ns64[NumStages],ns32[NumStages],ns64[NumStages]/ns32[NumStages]);
+        }
+    printf("\n");
+    Compare(8,1000);
+    free(raw);
+    return 0;
+}
@@ -0,0 +1,134 @@
+/*********************************************************************
+*
+* Processing stage:
+*    ShmReader.c
+*
+* Description:
+*    Implementation of the shared memory ring reader. See ShmReader.h
+*    and ShmRingFormat.h.
+*
+*********************************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+#include "ShmReader.h"
+#include "ShmRingFormat.h"
+
+struct ShmReader {
+    ShmMapping          map;
+    ShmRingHeader       *header;
+    ShmReaderFormat     format;
+    uint32_t            slotBytes;
+    uint64_t            next;           // block to read next
+    long long           blocksRead;
+    long long           blocksLost;
+};
+
+int ShmReaderOpen(const char *name, ShmReader **reader)
+{
+    ShmReader       *r;
+    ShmRingHeader   *h;
+
+    *reader = NULL;
+    if( !name || !name[0] )
+        return ShmReaderErrInvalidArg;
+    r = (ShmReader*)calloc(1,sizeof(ShmReader));
+    if( !r )
+        return ShmReaderErrOutOfMemory;
+    if( ShmMapOpen(name,&r->map)!=0 ) {
+        free(r);
+        return ShmReaderErrSharedMemory;
+    }
+    h = r->header = (ShmRingHeader*)r->map.base;
+    if( h->magic!=SHMRING_MAGIC || h->version!=SHMRING_VERSION
+        || r->map.bytes<SHMRING_HEADER_BYTES+(size_t)h->slotBytes*h->numSlots ) {
+        ShmMapClose(&r->map,NULL);
+        free(r);
+        return ShmReaderErrFormat;
+    }
+    atomic_thread_fence(memory_order_acquire);
+    r->format.numChans = (int)h->numChans;
+    r->format.slotSamples = (int)h->slotSamples;
+    r->format.numSlots = (int)h->numSlots;
+    r->format.sampleRate = h->sampleRate;
+    r->slotBytes = h->slotBytes;
+    r->next = atomic_load_explicit(&h->head,memory_order_acquire);
+    if( r->next>0 )
+        r->next--;      // start with the newest block
+    *reader = r;
+    return 0;
+}
+
+void ShmReaderClose(ShmReader *reader)
+{
+    if( !reader )
+        return;
+    ShmMapClose(&reader->map,NULL);
+    free(reader);
+}
+
+void ShmReaderGetFormat(const ShmReader *reader, ShmReaderFormat *format)
+{
+    *format = reader->format;
+}
+
+int ShmReaderNext(ShmReader *reader, double data[], ShmReaderBlock *block)
+{
+    ShmReader       *r=reader;
+    ShmRingHeader   *h=r->header;
+    uint64_t        head,want;
+    long long       lost=0;
+
+    for(;;) {
+        ShmRingSlot *slot;
+        uint64_t    before,after;
+        uint32_t    n,c;
+
+        head = atomic_load_explicit(&h->head,memory_order_acquire);
+        if( r->next>=head )
+            return 0;
+        if( head-r->next>h->numSlots ) {
+            // Already overwritten, no need to look.
+            lost += (long long)(head-1-r->next);
+            r->next = head-1;
+        }
+        want = 2*r->next+2;
+        slot = ShmRingSlotAt(h,r->slotBytes,r->next,h->numSlots);
+        before = atomic_load_explicit(&slot->seq,memory_order_acquire);
+        if( before==want ) {
+            block->block = (long long)slot->block;
+            block->firstSample = slot->firstSample;
+            block->timestamp = slot->timestamp;
+            n = slot->numSampsPerChan;
+            if( n>h->slotSamples )
+                n = h->slotSamples;
+            for(c=0;c<h->numChans;++c)
+                memcpy(data+(size_t)c*n,ShmRingSlotData(slot)+(size_t)c*h->slotSamples,(size_t)n*sizeof(double));
+            atomic_thread_fence(memory_order_acquire);
+            after = atomic_load_explicit(&slot->seq,memory_order_relaxed);
+            if( after==want ) {
+                block->numSampsPerChan = (int)n;
+                block->lost = lost;
+                r->next++;
+                r->blocksRead++;
+                r->blocksLost += lost;
+                return 1;
+            }
+        }
+        // The writer has lapped us, as head>next means block next was
+        // complete before. Skip to the newest block.
+        head = atomic_load_explicit(&h->head,memory_order_acquire);
+        lost += (long long)(head-1-r->next);
+        r->next = head-1;
+    }
+}
+
+long long ShmReaderBlocksRead(const ShmReader *reader)
+{
+    return reader->blocksRead;
+}
+
+long long ShmReaderBlocksLost(const ShmReader *reader)
+{
+    return reader->blocksLost;
+}
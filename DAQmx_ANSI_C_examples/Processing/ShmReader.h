@@ -0,0 +1,69 @@
+/*********************************************************************
+*
+* Processing stage:
+*    ShmReader.h
+*
+* Description:
+*    Reader library for the shared memory ring written by ShmRing.c.
+*    A process opens the ring by name and then polls ShmReaderNext,
+*    which copies the next block if one has been published. Readers
+*    never block the writer and do not affect each other.
+*
+*    A reader starts at the newest published block. If it falls so
+*    far behind that the writer overwrites the block it wants, the
+*    block is not returned half-updated. Instead the reader skips to
+*    the newest block and reports the number of blocks it lost.
+*
+*    Build a reader with ShmReader.c only. On Linux older C libraries
+*    also need -lrt.
+*
+*********************************************************************/
+
+#ifndef SHMREADER_H
+#define SHMREADER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define ShmReaderErrInvalidArg      -1
+#define ShmReaderErrOutOfMemory     -2
+#define ShmReaderErrSharedMemory    -3
+#define ShmReaderErrFormat          -4
+
+typedef struct ShmReaderFormat {
+    int         numChans;
+    int         slotSamples;    // largest block, samples per channel
+    int         numSlots;
+    double      sampleRate;
+} ShmReaderFormat;
+
+typedef struct ShmReaderBlock {
+    long long   block;          // index of the block in the stream
+    long long   firstSample;
+    double      timestamp;
+    int         numSampsPerChan;
+    long long   lost;           // blocks skipped just before this one
+} ShmReaderBlock;
+
+typedef struct ShmReader ShmReader;
+
+int  ShmReaderOpen(const char *name, ShmReader **reader);
+void ShmReaderClose(ShmReader *reader);
+void ShmReaderGetFormat(const ShmReader *reader, ShmReaderFormat *format);
+
+// Copies the next block into data, numSampsPerChan samples for each
+// channel grouped by channel. data must hold numChans*slotSamples
+// values. Returns 1 if a block was copied and 0 if there is no new
+// block yet.
+int  ShmReaderNext(ShmReader *reader, double data[], ShmReaderBlock *block);
+
+// Totals since the reader was opened.
+long long ShmReaderBlocksRead(const ShmReader *reader);
+long long ShmReaderBlocksLost(const ShmReader *reader);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,112 @@
+/*********************************************************************
+*
+* Processing stage:
+*    ShmRing.c
+*
+* Description:
+*    Implementation of the shared memory ring writer. See ShmRing.h
+*    and ShmRingFormat.h.
+*
+*********************************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+#include "ShmRing.h"
+#include "ShmRingFormat.h"
+
+struct ShmRing {
+    char                *name;
+    ShmMapping          map;
+    ShmRingHeader       *header;
+    uint64_t            next;           // block to write next
+};
+
+int ShmRingCreate(const char *name, int numChans, int slotSamples, int numSlots, double sampleRate, ShmRing **ring)
+{
+    ShmRing         *r;
+    ShmRingHeader   *h;
+    size_t          slotBytes;
+    int             i;
+
+    *ring = NULL;
+    if( !name || !name[0] || numChans<1 || slotSamples<1 || numSlots<2 )
+        return ShmRingErrInvalidArg;
+    slotBytes = SHMRING_SLOT_HEADER_BYTES+(size_t)numChans*slotSamples*sizeof(double);
+    slotBytes = (slotBytes+63)&~(size_t)63;
+    if( slotBytes>0xffffffffu )
+        return ShmRingErrInvalidArg;
+
+    r = (ShmRing*)calloc(1,sizeof(ShmRing));
+    if( !r )
+        return ShmRingErrOutOfMemory;
+    r->name = (char*)malloc(strlen(name)+1);
+    if( !r->name ) {
+        free(r);
+        return ShmRingErrOutOfMemory;
+    }
+    strcpy(r->name,name);
+    if( ShmMapCreate(name,SHMRING_HEADER_BYTES+slotBytes*numSlots,&r->map)!=0 ) {
+        free(r->name);
+        free(r);
+        return ShmRingErrSharedMemory;
+    }
+
+    h = r->header = (ShmRingHeader*)r->map.base;
+    h->version = SHMRING_VERSION;
+    h->numChans = (uint32_t)numChans;
+    h->slotSamples = (uint32_t)slotSamples;
+    h->numSlots = (uint32_t)numSlots;
+    h->slotBytes = (uint32_t)slotBytes;
+    h->sampleRate = sampleRate;
+    atomic_init(&h->head,0);
+    for(i=0;i<numSlots;++i)
+        atomic_init(&ShmRingSlotAt(h,h->slotBytes,(uint64_t)i,h->numSlots)->seq,0);
+    // Readers check the magic last, so they never see a half-built header.
+    atomic_thread_fence(memory_order_release);
+    h->magic = SHMRING_MAGIC;
+    *ring = r;
+    return 0;
+}
+
+void ShmRingClear(ShmRing *ring)
+{
+    if( !ring )
+        return;
+    ShmMapClose(&ring->map,ring->name);
+    free(ring->name);
+    free(ring);
+}
+
+int ShmRingPublish(ShmRing *ring, const double data[], int numSampsPerChan, long long firstSample, double timestamp)
+{
+    ShmRingHeader   *h=ring->header;
+    uint64_t        b=ring->next;
+    ShmRingSlot     *slot;
+    double          *dest;
+    uint32_t        c;
+
+    if( numSampsPerChan<0 || (uint32_t)numSampsPerChan>h->slotSamples )
+        return ShmRingErrInvalidArg;
+    slot = ShmRingSlotAt(h,h->slotBytes,b,h->numSlots);
+    dest = ShmRingSlotData(slot);
+
+    atomic_store_explicit(&slot->seq,2*b+1,memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    slot->block = b;
+    slot->firstSample = firstSample;
+    slot->timestamp = timestamp;
+    slot->numSampsPerChan = (uint32_t)numSampsPerChan;
+    // Each channel starts at its slotSamples offset, so readers can
+    // index channels without knowing the block length.
+    for(c=0;c<h->numChans;++c)
+        memcpy(dest+(size_t)c*h->slotSamples,data+(size_t)c*numSampsPerChan,(size_t)numSampsPerChan*sizeof(double));
+    atomic_store_explicit(&slot->seq,2*b+2,memory_order_release);
+    atomic_store_explicit(&h->head,b+1,memory_order_release);
+    ring->next = b+1;
+    return 0;
+}
+
+long long ShmRingBlocksPublished(const ShmRing *ring)
+{
+    return (long long)ring->next;
+}
@@ -0,0 +1,55 @@
+/*********************************************************************
+*
+* Processing stage:
+*    ShmRing.h
+*
+* Description:
+*    Publishes the blocks of an acquisition into a named shared memory
+*    ring, so that analysis running in other processes (MATLAB,
+*    Python, ShmReader.c) can follow the live stream without access to
+*    the DAQ device.
+*
+*    The writer never waits for readers. Each slot is guarded by its
+*    own sequence counter, so any number of readers can attach at any
+*    time, and a reader that falls more than numSlots blocks behind
+*    sees that the blocks it wanted were overwritten rather than
+*    getting mixed data. See ShmRingFormat.h for the layout.
+*
+*    ShmRingPublish copies one block with memcpy and touches two
+*    counters, so it can be called from the EveryN callback.
+*
+*********************************************************************/
+
+#ifndef SHMRING_H
+#define SHMRING_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define ShmRingErrInvalidArg        -1
+#define ShmRingErrOutOfMemory       -2
+#define ShmRingErrSharedMemory      -3
+
+typedef struct ShmRing ShmRing;
+
+// Creates the named object, replacing any stale one of the same name.
+int  ShmRingCreate(const char *name, int numChans, int slotSamples, int numSlots, double sampleRate, ShmRing **ring);
+
+// Unmaps and removes the name. Readers that are attached keep their
+// mapping until they close it.
+void ShmRingClear(ShmRing *ring);
+
+// data holds numSampsPerChan samples for each channel, grouped by
+// channel, with numSampsPerChan no more than slotSamples.
+// firstSample is the stream index of the first sample and timestamp
+// its time, e.g. from SampleTimeMapTime, or 0.
+int  ShmRingPublish(ShmRing *ring, const double data[], int numSampsPerChan, long long firstSample, double timestamp);
+
+long long ShmRingBlocksPublished(const ShmRing *ring);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,145 @@
+/*********************************************************************
+*
+* Processing benchmark:
+*    ShmRingBench.c
+*
+* Description:
+*    Publishes blocks of 8 channels by 1024 samples into a shared
+*    memory ring of 64 slots while 1, 2, 4 and 8 reader threads each
+*    open the ring by name and follow it. Every reader checks the
+*    first and last sample of each channel of every block it gets.
+*
+*    Each configuration is run twice: with the writer publishing as
+*    fast as it can, which shows the copy throughput and makes slow
+*    readers lose blocks, and paced at 2000 blocks/s (16 MS/s), where
+*    no reader should lose anything. Reports writer and per-reader
+*    GB/s, blocks lost and torn blocks (which must be 0).
+*
+*    No DAQ hardware is needed. Build with ShmRing.c and ShmReader.c,
+*    and on Linux with -lpthread (and -lrt on older C libraries).
+*
+*********************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "ShmRing.h"
+#include "ShmReader.h"
+#include "StreamTime.h"
+#include "StreamThread.h"
+
+#define RING_NAME       "/daqmx_shmring_bench"
+#define NUM_CHANS       8
+#define BLOCK_SIZE      1024
+#define NUM_SLOTS       64
+#define FAST_BLOCKS     100000
+#define PACED_BLOCKS    4000
+#define PACED_RATE      2000.0
+#define MAX_READERS     8
+
+typedef struct ReaderArg {
+    volatile int    *writerDone;
+    long long       blocks;
+    long long       lost;
+    long long       torn;
+    double          seconds;
+} ReaderArg;
+
+static STREAM_THREAD_PROC(ReaderThread,arg)
+{
+    ReaderArg       *a=(ReaderArg*)arg;
+    ShmReader       *reader;
+    ShmReaderBlock  block;
+    double          *data=(double*)malloc(NUM_CHANS*BLOCK_SIZE*sizeof(double));
+    double          t0;
+    int             c,got;
+
+    if( !data || ShmReaderOpen(RING_NAME,&reader)!=0 ) {
+        free(data);
+        return 0;
+    }
+    t0 = StreamTimeNow();
+    for(;;) {
+        got = ShmReaderNext(reader,data,&block);
+        if( !got ) {
+            if( *a->writerDone )
+                break;
+            StreamCpuRelax();
+            continue;
+        }
+        for(c=0;c<NUM_CHANS;++c) {
+            double expect=(double)(block.block*NUM_CHANS+c);
+
+            if( data[c*block.numSampsPerChan]!=expect || data[(c+1)*block.numSampsPerChan-1]!=expect )
+                a->torn++;
+        }
+    }
+    a->seconds = StreamTimeNow()-t0;
+    a->blocks = ShmReaderBlocksRead(reader);
+    a->lost = ShmReaderBlocksLost(reader);
+    ShmReaderClose(reader);
+    free(data);
+    return 0;
+}
+
+static int Run(ShmRing *ring, int numReaders, long long numBlocks, double pace)
+{
+    static double   data[NUM_CHANS*BLOCK_SIZE];
+    StreamThread    threads[MAX_READERS];
+    ReaderArg       args[MAX_READERS];
+    volatile int    writerDone=0;
+    long long       b,first=ShmRingBlocksPublished(ring);
+    long long       lost=0,torn=0;
+    double          t0,tWrite,readGBs=0.0;
+    int             i,c;
+
+    memset(args,0,sizeof(args));
+    for(i=0;i<numReaders;++i) {
+        args[i].writerDone = &writerDone;
+        if( StreamThreadCreate(&threads[i],ReaderThread,&args[i])!=0 )
+            return -1;
+    }
+    StreamSleep(0.1);   // let the readers attach
+
+    t0 = StreamTimeNow();
+    for(b=first;b<first+numBlocks;++b) {
+        // Mark the ends of each channel with the block number.
+        for(c=0;c<NUM_CHANS;++c)
+            data[c*BLOCK_SIZE] = data[(c+1)*BLOCK_SIZE-1] = (double)(b*NUM_CHANS+c);
+        if( pace>0.0 )
+            while( StreamTimeNow()-t0<(b-first)/pace )
+                StreamCpuRelax();
+        ShmRingPublish(ring,data,BLOCK_SIZE,b*BLOCK_SIZE,0.0);
+    }
+    tWrite = StreamTimeNow()-t0;
+    writerDone = 1;
+
+    for(i=0;i<numReaders;++i) {
+        StreamThreadJoin(threads[i]);
+        readGBs += 1e-9*args[i].blocks*sizeof(data)/args[i].seconds/numReaders;
+        lost += args[i].lost;
+        torn += args[i].torn;
+    }
+    printf("%d\t%s\t%.2f\t\t%.2f\t\t%lld\t%lld\n",numReaders,pace>0.0 ? "paced" : "fast",
+        1e-9*numBlocks*sizeof(data)/tWrite,readGBs,lost,torn);
+    return 0;
+}
+
+int main(void)
+{
+    ShmRing *ring;
+    int     n;
+
+    if( ShmRingCreate(RING_NAME,NUM_CHANS,BLOCK_SIZE,NUM_SLOTS,1e6,&ring)!=0 ) {
+        printf("Could not create the shared memory ring\n");
+        return 1;
+    }
+    printf("%d channels x %d samples per block, %d slots\n",NUM_CHANS,BLOCK_SIZE,NUM_SLOTS);
+    printf("Readers\tWriter\tWrite (GB/s)\tRead (GB/s)\tLost\tTorn\n");
+    for(n=1;n<=MAX_READERS;n*=2) {
+        Run(ring,n,FAST_BLOCKS,0.0);
+        Run(ring,n,PACED_BLOCKS,PACED_RATE);
+    }
+    ShmRingClear(ring);
+    return 0;
+}
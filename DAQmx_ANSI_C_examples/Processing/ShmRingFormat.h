@@ -0,0 +1,176 @@
+/*********************************************************************
+*
+* Processing helper:
+*    ShmRingFormat.h
+*
+* Description:
+*    Layout of the shared memory ring written by ShmRing.c and read by
+*    ShmReader.c, and the platform code that maps it. Readers in
+*    other languages can map the same object and follow this layout.
+*    All fields are little-endian.
+*
+*    The object starts with a ShmRingHeader of SHMRING_HEADER_BYTES,
+*    followed by numSlots slots of slotBytes each. A slot is a
+*    ShmRingSlot of SHMRING_SLOT_HEADER_BYTES followed by room for
+*    slotSamples float64 samples of each of numChans channels. Channel
+*    c of the block starts at sample c*slotSamples of that area and
+*    holds numSampsPerChan samples.
+*
+*    Block b goes to slot b%numSlots. The writer sets the slot's seq
+*    to 2*b+1, writes the slot, sets seq to 2*b+2 and then sets head
+*    to b+1. A reader that wants block b loads seq, copies the slot
+*    and loads seq again. The copy is valid if both loads gave 2*b+2.
+*    Any other value means the writer has overwritten the slot.
+*
+*    The name is a POSIX shared memory name such as "/daqmx_ai". On
+*    Windows the leading '/' is dropped and the rest names a paging
+*    file mapping.
+*
+*********************************************************************/
+
+#ifndef SHMRINGFORMAT_H
+#define SHMRINGFORMAT_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdatomic.h>
+
+#if defined(WIN32) || defined(_WIN32)
+#include <windows.h>
+#elif defined(__APPLE__) || defined(__linux__)
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#define SHMRING_MAGIC               0x52534d44u     // "DMSR"
+#define SHMRING_VERSION             1
+#define SHMRING_HEADER_BYTES        128
+#define SHMRING_SLOT_HEADER_BYTES   64
+
+typedef struct ShmRingHeader {
+    uint32_t            magic;
+    uint32_t            version;
+    uint32_t            numChans;
+    uint32_t            slotSamples;    // per channel
+    uint32_t            numSlots;
+    uint32_t            slotBytes;      // header and data, a multiple of 64
+    double              sampleRate;
+    char                pad0[32];
+    atomic_ullong       head;           // offset 64: blocks published
+    char                pad1[56];
+} ShmRingHeader;
+
+typedef struct ShmRingSlot {
+    atomic_ullong       seq;
+    uint64_t            block;
+    int64_t             firstSample;    // index of the block's first sample in the stream
+    double              timestamp;      // writer's StreamTimeNow seconds, or 0
+    uint32_t            numSampsPerChan;
+    char                pad[28];
+} ShmRingSlot;
+
+typedef struct ShmMapping {
+    void                *base;
+    size_t              bytes;
+#if defined(WIN32) || defined(_WIN32)
+    HANDLE              handle;
+#endif
+} ShmMapping;
+
+static inline ShmRingSlot *ShmRingSlotAt(void *base, uint32_t slotBytes, uint64_t block, uint32_t numSlots)
+{
+    return (ShmRingSlot*)((char*)base+SHMRING_HEADER_BYTES+(size_t)slotBytes*(block%numSlots));
+}
+
+static inline double *ShmRingSlotData(ShmRingSlot *slot)
+{
+    return (double*)((char*)slot+SHMRING_SLOT_HEADER_BYTES);
+}
+
+// Creates, or replaces, a zeroed object of the given size and maps it.
+static inline int ShmMapCreate(const char *name, size_t bytes, ShmMapping *map)
+{
+#if defined(WIN32) || defined(_WIN32)
+    map->handle = CreateFileMappingA(INVALID_HANDLE_VALUE,NULL,PAGE_READWRITE,(DWORD)((unsigned long long)bytes>>32),(DWORD)bytes,name[0]=='/' ? name+1 : name);
+    if( !map->handle )
+        return -1;
+    map->base = MapViewOfFile(map->handle,FILE_MAP_ALL_ACCESS,0,0,bytes);
+    if( !map->base ) {
+        CloseHandle(map->handle);
+        return -1;
+    }
+#else
+    int fd;
+
+    shm_unlink(name);
+    fd = shm_open(name,O_CREAT|O_EXCL|O_RDWR,0644);
+    if( fd<0 )
+        return -1;
+    if( ftruncate(fd,(off_t)bytes)!=0 ) {
+        close(fd);
+        shm_unlink(name);
+        return -1;
+    }
+    map->base = mmap(NULL,bytes,PROT_READ|PROT_WRITE,MAP_SHARED,fd,0);
+    close(fd);
+    if( map->base==MAP_FAILED ) {
+        shm_unlink(name);
+        return -1;
+    }
+#endif
+    map->bytes = bytes;
+    return 0;
+}
+
+// Maps an existing object read-only. The size is taken from the object.
+static inline int ShmMapOpen(const char *name, ShmMapping *map)
+{
+#if defined(WIN32) || defined(_WIN32)
+    MEMORY_BASIC_INFORMATION info;
+
+    map->handle = OpenFileMappingA(FILE_MAP_READ,FALSE,name[0]=='/' ? name+1 : name);
+    if( !map->handle )
+        return -1;
+    map->base = MapViewOfFile(map->handle,FILE_MAP_READ,0,0,0);
+    if( !map->base ) {
+        CloseHandle(map->handle);
+        return -1;
+    }
+    VirtualQuery(map->base,&info,sizeof(info));
+    map->bytes = info.RegionSize;
+#else
+    struct stat st;
+    int         fd=shm_open(name,O_RDONLY,0);
+
+    if( fd<0 )
+        return -1;
+    if( fstat(fd,&st)!=0 || (size_t)st.st_size<SHMRING_HEADER_BYTES ) {
+        close(fd);
+        return -1;
+    }
+    map->bytes = (size_t)st.st_size;
+    map->base = mmap(NULL,map->bytes,PROT_READ,MAP_SHARED,fd,0);
+    close(fd);
+    if( map->base==MAP_FAILED )
+        return -1;
+#endif
+    return 0;
+}
+
+// Unmaps, and if name is not NULL removes the object's name.
+static inline void ShmMapClose(ShmMapping *map, const char *name)
+{
+#if defined(WIN32) || defined(_WIN32)
+    UnmapViewOfFile(map->base);
+    CloseHandle(map->handle);
+    (void)name;
+#else
+    munmap(map->base,map->bytes);
+    if( name )
+        shm_unlink(name);
+#endif
+}
+
+#endif
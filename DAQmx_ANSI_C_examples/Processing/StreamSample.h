@@ -0,0 +1,72 @@
+/*********************************************************************
+*
+* Processing helper:
+*    StreamSample.h
+*
+* Description:
+*    Sample type carried through a processing pipeline, from scaling
+*    through filtering, statistics and storage. It is double unless
+*    STREAM_SAMPLE_F32 is defined when the pipeline is compiled, in
+*    which case it is float: half the memory and cache footprint per
+*    sample and twice as many samples per SIMD register.
+*
+*    Every stage has an explicitly typed function for each type, such
+*    as ResamplerProcessF64 and ResamplerProcessF32. The names below
+*    map to the one that matches StreamSample, so the pipeline code
+*    is written once and specialised at compile time.
+*
+*    DAQmx reads and writes analog data as float64 or as raw
+*    integers. A float pipeline reads raw I16 and scales it with
+*    AIScale, and converts to float64 with StreamSampleToF64 only
+*    just before DAQmxWriteAnalogF64.
+*
+*********************************************************************/
+
+#ifndef STREAMSAMPLE_H
+#define STREAMSAMPLE_H
+
+#include <stddef.h>
+
+#if defined(STREAM_SAMPLE_F32)
+
+typedef float StreamSample;
+
+#define StreamSampleName            "f32"
+#define AIScaleToSample             AIScaleToF32
+#define ChanStatsAddSample          ChanStatsAddF32
+#define EnvelopeAddBlockSample      EnvelopeAddBlockF32
+#define ResamplerProcessSample      ResamplerProcessF32
+#define ToneSynthRenderSample       ToneSynthRenderF32
+
+#else
+
+typedef double StreamSample;
+
+#define StreamSampleName            "f64"
+#define AIScaleToSample             AIScaleToF64
+#define ChanStatsAddSample          ChanStatsAddF64
+#define EnvelopeAddBlockSample      EnvelopeAddBlock
+#define ResamplerProcessSample      ResamplerProcessF64
+#define ToneSynthRenderSample       ToneSynthRender
+
+#endif
+
+// The conversion for DAQmxWriteAnalogF64. With double samples the
+// data can be written directly instead.
+static inline void StreamSampleToF64(const StreamSample in[], double out[], size_t numSamples)
+{
+    size_t i;
+
+    for(i=0;i<numSamples;++i)
+        out[i] = (double)in[i];
+}
+
+static inline void StreamSampleFromF64(const double in[], StreamSample out[], size_t numSamples)
+{
+    size_t i;
+
+    for(i=0;i<numSamples;++i)
+        out[i] = (StreamSample)in[i];
+}
+
+#endif
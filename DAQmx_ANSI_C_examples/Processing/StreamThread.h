@@ -0,0 +1,116 @@
+/*********************************************************************
+*
+* Processing helper:
+*    StreamThread.h
+*
+* Description:
+*    Minimal threads, mutexes and condition variables for the
+*    examples that run work beside the DAQmx calls. Uses Win32 on
+*    Windows and pthreads on Linux and macOS.
+*
+*    Declare a thread function with STREAM_THREAD_PROC(name,arg) and
+*    end it with "return 0;".
+*
+*    StreamThreadPinCurrent and StreamThreadRaisePriority act on the
+*    calling thread and return -1 where the platform or the process
+*    privileges do not allow it. On Linux, pinning needs _GNU_SOURCE
+*    defined before the first system header.
+*
+*********************************************************************/
+
+#ifndef STREAMTHREAD_H
+#define STREAMTHREAD_H
+
+#if defined(WIN32) || defined(_WIN32)
+#include <windows.h>
+
+typedef HANDLE              StreamThread;
+typedef CRITICAL_SECTION    StreamMutex;
+typedef CONDITION_VARIABLE  StreamCond;
+
+#define STREAM_THREAD_PROC(name,arg)    DWORD WINAPI name(LPVOID arg)
+
+static inline int  StreamThreadCreate(StreamThread *t, LPTHREAD_START_ROUTINE proc, void *arg)
+{
+    *t = CreateThread(NULL,0,proc,arg,0,NULL);
+    return *t ? 0 : -1;
+}
+static inline void StreamThreadJoin(StreamThread t)     { WaitForSingleObject(t,INFINITE); CloseHandle(t); }
+static inline void StreamMutexInit(StreamMutex *m)      { InitializeCriticalSection(m); }
+static inline void StreamMutexDestroy(StreamMutex *m)   { DeleteCriticalSection(m); }
+static inline void StreamMutexLock(StreamMutex *m)      { EnterCriticalSection(m); }
+static inline void StreamMutexUnlock(StreamMutex *m)    { LeaveCriticalSection(m); }
+static inline void StreamCondInit(StreamCond *c)        { InitializeConditionVariable(c); }
+static inline void StreamCondDestroy(StreamCond *c)     { (void)c; }
+static inline void StreamCondWait(StreamCond *c, StreamMutex *m) { SleepConditionVariableCS(c,m,INFINITE); }
+static inline void StreamCondSignal(StreamCond *c)      { WakeConditionVariable(c); }
+static inline void StreamCondBroadcast(StreamCond *c)   { WakeAllConditionVariable(c); }
+static inline void StreamCpuRelax(void)                 { YieldProcessor(); }
+
+static inline int  StreamThreadPinCurrent(int cpu)
+{
+    return SetThreadAffinityMask(GetCurrentThread(),(DWORD_PTR)1<<cpu) ? 0 : -1;
+}
+static inline int  StreamThreadRaisePriority(void)
+{
+    return SetThreadPriority(GetCurrentThread(),THREAD_PRIORITY_TIME_CRITICAL) ? 0 : -1;
+}
+
+#elif defined(__APPLE__) || defined(__linux__)
+#include <pthread.h>
+
+typedef pthread_t           StreamThread;
+typedef pthread_mutex_t     StreamMutex;
+typedef pthread_cond_t      StreamCond;
+
+#define STREAM_THREAD_PROC(name,arg)    void *name(void *arg)
+
+static inline int  StreamThreadCreate(StreamThread *t, void *(*proc)(void*), void *arg)
+{
+    return pthread_create(t,NULL,proc,arg)==0 ? 0 : -1;
+}
+static inline void StreamThreadJoin(StreamThread t)     { pthread_join(t,NULL); }
+static inline void StreamMutexInit(StreamMutex *m)      { pthread_mutex_init(m,NULL); }
+static inline void StreamMutexDestroy(StreamMutex *m)   { pthread_mutex_destroy(m); }
+static inline void StreamMutexLock(StreamMutex *m)      { pthread_mutex_lock(m); }
+static inline void StreamMutexUnlock(StreamMutex *m)    { pthread_mutex_unlock(m); }
+static inline void StreamCondInit(StreamCond *c)        { pthread_cond_init(c,NULL); }
+static inline void StreamCondDestroy(StreamCond *c)     { pthread_cond_destroy(c); }
+static inline void StreamCondWait(StreamCond *c, StreamMutex *m) { pthread_cond_wait(c,m); }
+static inline void StreamCondSignal(StreamCond *c)      { pthread_cond_signal(c); }
+static inline void StreamCondBroadcast(StreamCond *c)   { pthread_cond_broadcast(c); }
+
+static inline void StreamCpuRelax(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#endif
+}
+
+static inline int  StreamThreadPinCurrent(int cpu)
+{
+#if defined(__linux__) && defined(CPU_SET)
+    cpu_set_t set;
+
+    CPU_ZERO(&set);
+    CPU_SET(cpu,&set);
+    return pthread_setaffinity_np(pthread_self(),sizeof(set),&set)==0 ? 0 : -1;
+#else
+    (void)cpu;
+    return -1;
+#endif
+}
+
+static inline int  StreamThreadRaisePriority(void)
+{
+    struct sched_param param;
+
+    param.sched_priority = sched_get_priority_max(SCHED_FIFO);
+    return pthread_setschedparam(pthread_self(),SCHED_FIFO,&param)==0 ? 0 : -1;
+}
+
+#else
+    #error - StreamThread.h requires Win32 or pthreads.
+#endif
+
+#endif
@@ -0,0 +1,74 @@
+/*********************************************************************
+*
+* Processing helper:
+*    StreamTime.h
+*
+* Description:
+*    Monotonic timer used by the processing stages and their
+*    benchmarks. StreamTimeNow returns seconds since an arbitrary
+*    fixed point. StreamCpuTime returns the CPU time used by the whole
+*    process so far, in seconds.
+*
+*********************************************************************/
+
+#ifndef STREAMTIME_H
+#define STREAMTIME_H
+
+#if defined(WIN32) || defined(_WIN32)
+#include <windows.h>
+#elif defined(__APPLE__) || defined(__linux__)
+#include <time.h>
+#endif
+
+static inline double StreamTimeNow(void)
+{
+#if defined(WIN32) || defined(_WIN32)
+    LARGE_INTEGER   count,freq;
+
+    QueryPerformanceCounter(&count);
+    QueryPerformanceFrequency(&freq);
+    return (double)count.QuadPart/(double)freq.QuadPart;
+#elif defined(__APPLE__) || defined(__linux__)
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC,&ts);
+    return (double)ts.tv_sec+1e-9*(double)ts.tv_nsec;
+#else
+    #error - StreamTimeNow requires a platform specific monotonic clock.
+#endif
+}
+
+static inline double StreamCpuTime(void)
+{
+#if defined(WIN32) || defined(_WIN32)
+    FILETIME        create,exit,kernel,user;
+    ULARGE_INTEGER  k,u;
+
+    GetProcessTimes(GetCurrentProcess(),&create,&exit,&kernel,&user);
+    k.LowPart = kernel.dwLowDateTime;
+    k.HighPart = kernel.dwHighDateTime;
+    u.LowPart = user.dwLowDateTime;
+    u.HighPart = user.dwHighDateTime;
+    return 1e-7*(double)(k.QuadPart+u.QuadPart);
+#else
+    struct timespec ts;
+
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID,&ts);
+    return (double)ts.tv_sec+1e-9*(double)ts.tv_nsec;
+#endif
+}
+
+static inline void StreamSleep(double seconds)
+{
+#if defined(WIN32) || defined(_WIN32)
+    Sleep((DWORD)(1e3*seconds));
+#else
+    struct timespec ts;
+
+    ts.tv_sec = (time_t)seconds;
+    ts.tv_nsec = (long)(1e9*(seconds-(double)ts.tv_sec));
+    nanosleep(&ts,NULL);
+#endif
+}
+
+#endif
@@ -0,0 +1,161 @@
+/*********************************************************************
+*
+* Processing helper:
+*    ThreadAffinity.c
+*
+* Description:
+*    Implementation of the thread affinity configuration. See
+*    ThreadAffinity.h.
+*
+*********************************************************************/
+
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE     // for pthread_setaffinity_np and sched_getcpu
+#endif
+
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "ThreadAffinity.h"
+#include "StreamThread.h"
+
+#if defined(__linux__)
+#include <dirent.h>
+#include <sched.h>
+#endif
+
+static const char *roleNames[ThreadNumRoles]={"callback","reader","processing","writer"};
+
+const char *ThreadAffinityRoleName(int role)
+{
+    return role>=0 && role<ThreadNumRoles ? roleNames[role] : "";
+}
+
+// Parses a CPU list such as 0,2,4-7 up to the end of the entry.
+static int ParseCpus(const char **p, ThreadAffinity *a, int role)
+{
+    const char *s=*p;
+
+    for(;;) {
+        char    *end;
+        long    first=strtol(s,&end,10),last=first,cpu;
+
+        if( end==s || first<0 )
+            return ThreadAffinityErrInvalidArg;
+        s = end;
+        if( *s=='-' ) {
+            last = strtol(++s,&end,10);
+            if( end==s || last<first )
+                return ThreadAffinityErrInvalidArg;
+            s = end;
+        }
+        for(cpu=first;cpu<=last;++cpu) {
+            if( cpu>=32768 || a->numCpus[role]>=ThreadAffinityMaxCpus )
+                return ThreadAffinityErrInvalidArg;
+            a->cpus[role][a->numCpus[role]++] = (short)cpu;
+        }
+        if( *s!=',' )
+            break;
+        ++s;
+    }
+    *p = s;
+    return 0;
+}
+
+int ThreadAffinityParse(const char *spec, ThreadAffinity *affinity)
+{
+    const char  *s=spec;
+
+    memset(affinity,0,sizeof(ThreadAffinity));
+    if( !s )
+        return 0;
+    for(;;) {
+        size_t  len;
+        int     role;
+
+        while( *s==' ' || *s=='\t' || *s==';' )
+            ++s;
+        if( !*s )
+            return 0;
+        for(len=0;isalpha((unsigned char)s[len]);++len)
+            ;
+        for(role=0;role<ThreadNumRoles;++role)
+            if( strlen(roleNames[role])==len && strncmp(s,roleNames[role],len)==0 )
+                break;
+        if( role==ThreadNumRoles || s[len]!='=' || affinity->numCpus[role]>0 ) {
+            memset(affinity,0,sizeof(ThreadAffinity));
+            return ThreadAffinityErrInvalidArg;
+        }
+        s += len+1;
+        if( ParseCpus(&s,affinity,role)!=0 || (*s && *s!=' ' && *s!='\t' && *s!=';') ) {
+            memset(affinity,0,sizeof(ThreadAffinity));
+            return ThreadAffinityErrInvalidArg;
+        }
+    }
+}
+
+int ThreadAffinityPin(const ThreadAffinity *affinity, int role, int index)
+{
+    int n;
+
+    if( role<0 || role>=ThreadNumRoles || index<0 )
+        return ThreadAffinityErrInvalidArg;
+    if( (n=affinity->numCpus[role])==0 )
+        return 0;
+    return StreamThreadPinCurrent(affinity->cpus[role][index%n])==0 ? 0 : ThreadAffinityErrPin;
+}
+
+int ThreadAffinityNode(const ThreadAffinity *affinity, int role)
+{
+    if( role<0 || role>=ThreadNumRoles || affinity->numCpus[role]==0 )
+        return -1;
+    return ThreadAffinityCpuNode(affinity->cpus[role][0]);
+}
+
+int ThreadAffinityCpuNode(int cpu)
+{
+#if defined(WIN32) || defined(_WIN32)
+    PROCESSOR_NUMBER    proc;
+    USHORT              node;
+
+    proc.Group = (WORD)(cpu/64);
+    proc.Number = (BYTE)(cpu%64);
+    proc.Reserved = 0;
+    return GetNumaProcessorNodeEx(&proc,&node) ? (int)node : -1;
+#elif defined(__linux__)
+    char            path[64];
+    DIR             *dir;
+    struct dirent   *entry;
+    int             node=-1;
+
+    // The CPU's directory links to its node as nodeN.
+    snprintf(path,sizeof(path),"/sys/devices/system/cpu/cpu%d",cpu);
+    if( !(dir=opendir(path)) )
+        return -1;
+    while( (entry=readdir(dir)) )
+        if( strncmp(entry->d_name,"node",4)==0 && isdigit((unsigned char)entry->d_name[4]) ) {
+            node = atoi(entry->d_name+4);
+            break;
+        }
+    closedir(dir);
+    return node;
+#else
+    (void)cpu;
+    return -1;
+#endif
+}
+
+int ThreadAffinityCurrentCpu(void)
+{
+#if defined(WIN32) || defined(_WIN32)
+    PROCESSOR_NUMBER    proc;
+
+    GetCurrentProcessorNumberEx(&proc);
+    return proc.Group*64+proc.Number;
+#elif defined(__linux__)
+    return sched_getcpu();
+#else
+    return -1;
+#endif
+}
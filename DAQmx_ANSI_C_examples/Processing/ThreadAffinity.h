@@ -0,0 +1,73 @@
+/*********************************************************************
+*
+* Processing helper:
+*    ThreadAffinity.h
+*
+* Description:
+*    Declares which CPUs each thread role of an acquisition pipeline
+*    runs on, in one line that can come from a command line or a
+*    configuration file:
+*
+*        "callback=1 reader=2 processing=4-7,12 writer=3"
+*
+*    Entries are separated by spaces or semicolons, CPU lists by
+*    commas, and a-b is a range. A role that is not named is left to
+*    the scheduler.
+*
+*    Each thread calls ThreadAffinityPin with its role once, when it
+*    starts. Thread i of a role with several CPUs is pinned to the
+*    (i mod n)th of them. The EveryN callback thread belongs to the
+*    driver, so the callback pins itself on its first call.
+*
+*    ThreadAffinityNode gives the NUMA node of a role's first CPU, so
+*    that the buffers the role works on can be placed there (see
+*    BufferPool.h). On Linux, the file that defines the threads must
+*    define _GNU_SOURCE before the first system header, as for
+*    StreamThreadPinCurrent.
+*
+*********************************************************************/
+
+#ifndef THREADAFFINITY_H
+#define THREADAFFINITY_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define ThreadAffinityErrInvalidArg     -1
+#define ThreadAffinityErrPin            -2
+
+#define ThreadAffinityMaxCpus           256
+
+#define ThreadRoleCallback              0
+#define ThreadRoleReader                1
+#define ThreadRoleProcessing            2
+#define ThreadRoleWriter                3
+#define ThreadNumRoles                  4
+
+typedef struct ThreadAffinity {
+    int     numCpus[ThreadNumRoles];    // 0: not pinned
+    short   cpus[ThreadNumRoles][ThreadAffinityMaxCpus];
+} ThreadAffinity;
+
+// An empty or NULL spec pins nothing.
+int  ThreadAffinityParse(const char *spec, ThreadAffinity *affinity);
+
+// Pins the calling thread, the index-th of its role. Returns 0 when
+// the role is not pinned.
+int  ThreadAffinityPin(const ThreadAffinity *affinity, int role, int index);
+
+// NUMA node of the role's first CPU, or -1 when the role is not
+// pinned or the node is unknown.
+int  ThreadAffinityNode(const ThreadAffinity *affinity, int role);
+
+int  ThreadAffinityCpuNode(int cpu);
+int  ThreadAffinityCurrentCpu(void);   // -1 where unknown
+
+const char *ThreadAffinityRoleName(int role);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
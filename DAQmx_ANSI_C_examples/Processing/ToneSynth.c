@@ -0,0 +1,277 @@
+/*********************************************************************
+*
+* Processing stage:
+*    ToneSynth.c
+*
+* Description:
+*    Implementation of the live-updatable sine generator. See
+*    ToneSynth.h for the calling conventions.
+*
+*    The command queue is a power-of-two ring. The control thread owns
+*    head and the refill thread owns tail, so each index has a single
+*    writer and no locks are needed. Latency results are published
+*    under a sequence lock, as in ChanStats.c.
+*
+*********************************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <stdatomic.h>
+#include "ToneSynth.h"
+
+#define PI  3.1415926535897932
+
+typedef struct Command {
+    int         param;
+    int         rampSamples;
+    double      value;
+    long long   applyAt;
+    long long   postPosition;
+} Command;
+
+typedef struct Ramp {
+    double      value;
+    double      step;
+    double      target;
+    long long   remaining;
+} Ramp;
+
+struct ToneSynth {
+    double          sampleRate;
+    Ramp            param[ToneSynthNumParams];
+    double          phase;
+    long long       nextSample;
+
+    Command         *queue;
+    unsigned        queueMask;
+    atomic_uint     head;
+    atomic_uint     tail;
+    atomic_llong    outputPosition;
+
+    atomic_uint     seq;
+    ToneSynthLatency latency;
+};
+
+int ToneSynthCreate(double sampleRate, double amplitude, double frequency, double offset, int queueSize, ToneSynth **synth)
+{
+    ToneSynth   *s;
+    unsigned    size=1;
+
+    *synth = NULL;
+    if( sampleRate<=0.0 || queueSize<1 )
+        return ToneSynthErrInvalidArg;
+    while( size<(unsigned)queueSize )
+        size <<= 1;
+    s = (ToneSynth*)calloc(1,sizeof(ToneSynth));
+    if( !s )
+        return ToneSynthErrOutOfMemory;
+    s->queue = (Command*)malloc(size*sizeof(Command));
+    if( !s->queue ) {
+        free(s);
+        return ToneSynthErrOutOfMemory;
+    }
+    s->queueMask = size-1;
+    s->sampleRate = sampleRate;
+    s->param[ToneSynthAmplitude].value = amplitude;
+    s->param[ToneSynthFrequency].value = frequency;
+    s->param[ToneSynthOffset].value = offset;
+    atomic_init(&s->head,0);
+    atomic_init(&s->tail,0);
+    atomic_init(&s->outputPosition,0);
+    atomic_init(&s->seq,0);
+    *synth = s;
+    return 0;
+}
+
+void ToneSynthClear(ToneSynth *synth)
+{
+    if( !synth )
+        return;
+    free(synth->queue);
+    free(synth);
+}
+
+int ToneSynthPost(ToneSynth *synth, int param, double value, long long applyAt, int rampSamples)
+{
+    unsigned    head=atomic_load_explicit(&synth->head,memory_order_relaxed);
+    unsigned    tail=atomic_load_explicit(&synth->tail,memory_order_acquire);
+    Command     *cmd;
+
+    if( param<0 || param>=ToneSynthNumParams || rampSamples<0 || (applyAt<0 && applyAt!=ToneSynthAsap) )
+        return ToneSynthErrInvalidArg;
+    if( head-tail>synth->queueMask )
+        return ToneSynthErrQueueFull;
+    cmd = &synth->queue[head&synth->queueMask];
+    cmd->param = param;
+    cmd->value = value;
+    cmd->applyAt = applyAt;
+    cmd->rampSamples = rampSamples;
+    cmd->postPosition = atomic_load_explicit(&synth->outputPosition,memory_order_relaxed);
+    atomic_store_explicit(&synth->head,head+1,memory_order_release);
+    return 0;
+}
+
+static void RecordLatency(ToneSynth *s, long long samples)
+{
+    unsigned            seq=atomic_load_explicit(&s->seq,memory_order_relaxed);
+    ToneSynthLatency    *l=&s->latency;
+
+    atomic_store_explicit(&s->seq,seq+1,memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    if( l->count==0 || samples<l->min )
+        l->min = samples;
+    if( l->count==0 || samples>l->max )
+        l->max = samples;
+    l->mean += (samples-l->mean)/(double)(l->count+1);
+    l->last = samples;
+    ++l->count;
+    atomic_store_explicit(&s->seq,seq+2,memory_order_release);
+}
+
+static void Apply(ToneSynth *s, const Command *cmd, long long at)
+{
+    Ramp    *r=&s->param[cmd->param];
+
+    if( cmd->param==ToneSynthPhase && cmd->rampSamples==0 ) {
+        // A phase step is folded into the accumulator at once.
+        s->phase += cmd->value;
+        r->remaining = 0;
+    }
+    else if( cmd->param==ToneSynthPhase ) {
+        // A ramped phase shift is a temporary frequency offset that
+        // adds up to value radians.
+        r->value = 0.0;
+        r->target = 0.0;
+        r->step = cmd->value/cmd->rampSamples;
+        r->remaining = cmd->rampSamples;
+    }
+    else if( cmd->rampSamples==0 ) {
+        r->value = cmd->value;
+        r->remaining = 0;
+    }
+    else {
+        r->target = cmd->value;
+        r->step = (cmd->value-r->value)/cmd->rampSamples;
+        r->remaining = cmd->rampSamples;
+    }
+    RecordLatency(s,at-cmd->postPosition);
+}
+
+// Samples until the head of the queue is due, or -1 if it is empty.
+static long long NextCommandDue(ToneSynth *s, long long at, const Command **cmd)
+{
+    unsigned    tail=atomic_load_explicit(&s->tail,memory_order_relaxed);
+    unsigned    head=atomic_load_explicit(&s->head,memory_order_acquire);
+
+    if( tail==head )
+        return -1;
+    *cmd = &s->queue[tail&s->queueMask];
+    if( (*cmd)->applyAt==ToneSynthAsap || (*cmd)->applyAt<=at )
+        return 0;
+    return (*cmd)->applyAt-at;
+}
+
+void ToneSynthRender(ToneSynth *s, double out[], int numSamples)
+{
+    double      twoPiOverRate=2.0*PI/s->sampleRate;
+    int         i=0;
+
+    while( i<numSamples ) {
+        const Command   *cmd=NULL;
+        long long       due,n=numSamples-i;
+        double          amp,freq,offset,phase;
+        int             p,ramping=0,k;
+
+        // Apply everything that is due at this sample.
+        while( (due=NextCommandDue(s,s->nextSample,&cmd))==0 ) {
+            Apply(s,cmd,s->nextSample);
+            atomic_store_explicit(&s->tail,atomic_load_explicit(&s->tail,memory_order_relaxed)+1,memory_order_release);
+        }
+        if( due>0 && due<n )
+            n = due;
+        for(p=0;p<ToneSynthNumParams;++p)
+            if( s->param[p].remaining>0 ) {
+                ramping = 1;
+                if( s->param[p].remaining<n )
+                    n = s->param[p].remaining;
+            }
+
+        amp = s->param[ToneSynthAmplitude].value;
+        freq = s->param[ToneSynthFrequency].value*twoPiOverRate;
+        offset = s->param[ToneSynthOffset].value;
+        phase = s->phase;
+        if( !ramping ) {
+            for(k=0;k<n;++k) {
+                out[i+k] = offset+amp*sin(phase);
+                phase += freq;
+            }
+        }
+        else {
+            double  dAmp=s->param[ToneSynthAmplitude].remaining>0 ? s->param[ToneSynthAmplitude].step : 0.0;
+            double  dFreq=s->param[ToneSynthFrequency].remaining>0 ? s->param[ToneSynthFrequency].step*twoPiOverRate : 0.0;
+            double  dOffset=s->param[ToneSynthOffset].remaining>0 ? s->param[ToneSynthOffset].step : 0.0;
+            double  dPhase=s->param[ToneSynthPhase].remaining>0 ? s->param[ToneSynthPhase].step : 0.0;
+
+            for(k=0;k<n;++k) {
+                out[i+k] = offset+amp*sin(phase);
+                amp += dAmp;
+                freq += dFreq;
+                offset += dOffset;
+                phase += freq+dPhase;
+            }
+            for(p=0;p<ToneSynthNumParams;++p) {
+                Ramp *r=&s->param[p];
+
+                if( r->remaining<=0 )
+                    continue;
+                r->remaining -= n;
+                // Land exactly on the target to avoid drift.
+                r->value = r->remaining==0 ? r->target : r->value+n*r->step;
+            }
+        }
+        s->phase = fmod(phase,2.0*PI);
+        s->nextSample += n;
+        i += (int)n;
+    }
+}
+
+// Renders chunks in double and narrows them. The phase has to be
+// accumulated in double either way, since a float phase would drift
+// over a long run.
+void ToneSynthRenderF32(ToneSynth *s, float out[], int numSamples)
+{
+    double  chunk[256];
+    int     i=0,k;
+
+    while( i<numSamples ) {
+        int n=numSamples-i<256 ? numSamples-i : 256;
+
+        ToneSynthRender(s,chunk,n);
+        for(k=0;k<n;++k)
+            out[i+k] = (float)chunk[k];
+        i += n;
+    }
+}
+
+long long ToneSynthNextSample(const ToneSynth *synth)
+{
+    return synth->nextSample;
+}
+
+void ToneSynthSetOutputPosition(ToneSynth *synth, long long sample)
+{
+    atomic_store_explicit(&synth->outputPosition,sample,memory_order_relaxed);
+}
+
+void ToneSynthGetLatency(ToneSynth *synth, ToneSynthLatency *latency)
+{
+    unsigned    before,after;
+
+    do {
+        before = atomic_load_explicit(&synth->seq,memory_order_acquire);
+        *latency = synth->latency;
+        atomic_thread_fence(memory_order_acquire);
+        after = atomic_load_explicit(&synth->seq,memory_order_relaxed);
+    } while( before!=after || (before&1) );
+}
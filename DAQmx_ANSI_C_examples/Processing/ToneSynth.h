@@ -0,0 +1,82 @@
+/*********************************************************************
+*
+* Processing stage:
+*    ToneSynth.h
+*
+* Description:
+*    Sine generator for continuous AO whose amplitude, frequency,
+*    offset and phase can be changed while it runs. A control thread
+*    posts changes into a lock-free single-producer queue. The refill
+*    path of the AO task drains the queue while rendering each block,
+*    so neither thread ever waits for the other.
+*
+*    Every change takes effect at an exact sample index: either the
+*    index given when posting, or the first sample rendered after the
+*    post for ToneSynthAsap. The phase is accumulated sample by
+*    sample, so frequency changes are phase-continuous. A change may
+*    ramp linearly over rampSamples instead of stepping.
+*
+*    ToneSynthSetOutputPosition tells the generator which sample the
+*    hardware is currently putting out. Each post is stamped with that
+*    position, and the post-to-output latency of a change is the
+*    sample it took effect at minus that stamp.
+*
+*********************************************************************/
+
+#ifndef TONESYNTH_H
+#define TONESYNTH_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define ToneSynthErrInvalidArg      -1
+#define ToneSynthErrOutOfMemory     -2
+#define ToneSynthErrQueueFull       -3
+
+#define ToneSynthAmplitude          0
+#define ToneSynthFrequency          1       // Hz
+#define ToneSynthOffset             2
+#define ToneSynthPhase              3       // radians, added to the running phase
+#define ToneSynthNumParams          4
+
+#define ToneSynthAsap               -1LL
+
+typedef struct ToneSynthLatency {
+    long long   count;
+    double      mean;       // samples
+    long long   min;
+    long long   max;
+    long long   last;
+} ToneSynthLatency;
+
+typedef struct ToneSynth ToneSynth;
+
+// queueSize is rounded up to a power of two.
+int  ToneSynthCreate(double sampleRate, double amplitude, double frequency, double offset, int queueSize, ToneSynth **synth);
+void ToneSynthClear(ToneSynth *synth);
+
+// Control thread. Only one thread may post. applyAt is an absolute
+// sample index or ToneSynthAsap. Changes take effect in the order
+// they are posted.
+int  ToneSynthPost(ToneSynth *synth, int param, double value, long long applyAt, int rampSamples);
+
+// Refill thread. Renders the next numSamples samples and applies any
+// posted change that falls within them.
+void ToneSynthRender(ToneSynth *synth, double out[], int numSamples);
+void ToneSynthRenderF32(ToneSynth *synth, float out[], int numSamples);
+
+// Index of the next sample ToneSynthRender will produce.
+long long ToneSynthNextSample(const ToneSynth *synth);
+
+// May be called from any thread, normally with the value of
+// DAQmxGetWriteTotalSampPerChanGenerated.
+void ToneSynthSetOutputPosition(ToneSynth *synth, long long sample);
+
+void ToneSynthGetLatency(ToneSynth *synth, ToneSynthLatency *latency);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,716 @@
+/*********************************************************************
+*
+* Processing helper:
+*    WaveformCache.c
+*
+* Description:
+*    Implementation of the persistent waveform cache. See
+*    WaveformCache.h.
+*
+*    The index of the files is kept in memory, in an array searched
+*    by key, and built from the directory when the cache is opened.
+*    One mutex guards the index and the prefetch queue; files are
+*    generated, mapped and read outside it.
+*
+*********************************************************************/
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "WaveformCache.h"
+#include "StreamThread.h"
+
+#if defined(WIN32) || defined(_WIN32)
+#include <sys/utime.h>
+#define utime   _utime
+#else
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <utime.h>
+#endif
+
+#define WAVEFORM_MAGIC      "DAQWFC1"
+#define DATA_ALIGN          4096
+
+typedef struct FileHeader {
+    char        magic[8];
+    uint64_t    key;
+    double      rate;
+    int32_t     numChans;
+    int32_t     numSampsPerChan;
+    int32_t     layout;
+    int32_t     paramBytes;         // the parameters follow the header
+    uint64_t    dataOffset;
+    char        name[WaveformCacheMaxName+1];
+} FileHeader;
+
+typedef struct Entry {
+    uint64_t    key;
+    long long   bytes;
+    long long   lastUse;
+    int         refs;               // maps open
+    int         pending;            // being generated
+} Entry;
+
+typedef struct Request {
+    WaveformSpec    spec;
+    char            name[WaveformCacheMaxName+1];
+} Request;
+
+struct WaveformCache {
+    char                *dir;
+    long long           maxBytes;
+    StreamMutex         mutex;
+    StreamCond          cond;
+    Entry               *entries;
+    int                 numEntries;
+    int                 maxEntries;
+    long long           totalBytes;
+    long long           clock;              // last use counter
+    WaveformCacheStats  stats;
+    // Prefetch queue and thread.
+    Request             queue[WaveformCacheQueueSize];
+    int                 queueHead;
+    int                 queueCount;
+    int                 busy;
+    int                 stop;
+    StreamThread        thread;
+};
+
+/*********************************************/
+// Files
+/*********************************************/
+typedef struct Mapping {
+    void        *base;
+    size_t      bytes;
+    void        *handle;
+} Mapping;
+
+static void MakePath(const WaveformCache *cache, uint64_t key, const char *suffix, char *path, size_t size)
+{
+    snprintf(path,size,"%s/%016llx.wfc%s",cache->dir,(unsigned long long)key,suffix);
+}
+
+#if defined(WIN32) || defined(_WIN32)
+
+static int MapFile(const char *path, size_t createBytes, Mapping *m)
+{
+    HANDLE          file,mapping;
+    LARGE_INTEGER   size;
+    int             create=createBytes>0;
+
+    file = CreateFileA(path,create ? GENERIC_READ|GENERIC_WRITE : GENERIC_READ,FILE_SHARE_READ|FILE_SHARE_DELETE,NULL,
+                       create ? CREATE_ALWAYS : OPEN_EXISTING,FILE_ATTRIBUTE_NORMAL,NULL);
+    if( file==INVALID_HANDLE_VALUE )
+        return -1;
+    if( create )
+        size.QuadPart = (LONGLONG)createBytes;
+    else if( !GetFileSizeEx(file,&size) || size.QuadPart<(LONGLONG)sizeof(FileHeader) ) {
+        CloseHandle(file);
+        return -1;
+    }
+    mapping = CreateFileMappingA(file,NULL,create ? PAGE_READWRITE : PAGE_READONLY,(DWORD)(size.QuadPart>>32),(DWORD)size.QuadPart,NULL);
+    CloseHandle(file);
+    if( !mapping )
+        return -1;
+    m->base = MapViewOfFile(mapping,create ? FILE_MAP_WRITE : FILE_MAP_READ,0,0,(SIZE_T)size.QuadPart);
+    if( !m->base ) {
+        CloseHandle(mapping);
+        return -1;
+    }
+    m->bytes = (size_t)size.QuadPart;
+    m->handle = mapping;
+    return 0;
+}
+
+static void UnmapFile(Mapping *m)
+{
+    UnmapViewOfFile(m->base);
+    CloseHandle((HANDLE)m->handle);
+}
+
+static int RenameFile(const char *from, const char *to)
+{
+    return MoveFileExA(from,to,MOVEFILE_REPLACE_EXISTING) ? 0 : -1;
+}
+
+#else
+
+static int MapFile(const char *path, size_t createBytes, Mapping *m)
+{
+    struct stat st;
+    int         fd,create=createBytes>0;
+
+    fd = create ? open(path,O_RDWR|O_CREAT|O_TRUNC,0644) : open(path,O_RDONLY);
+    if( fd<0 )
+        return -1;
+    if( create ? ftruncate(fd,(off_t)createBytes)!=0 : fstat(fd,&st)!=0 || (size_t)st.st_size<sizeof(FileHeader) ) {
+        close(fd);
+        return -1;
+    }
+    m->bytes = create ? createBytes : (size_t)st.st_size;
+    m->base = mmap(NULL,m->bytes,create ? PROT_READ|PROT_WRITE : PROT_READ,MAP_SHARED,fd,0);
+    close(fd);
+    if( m->base==MAP_FAILED )
+        return -1;
+    m->handle = NULL;
+    return 0;
+}
+
+static void UnmapFile(Mapping *m)
+{
+    munmap(m->base,m->bytes);
+}
+
+static int RenameFile(const char *from, const char *to)
+{
+    return rename(from,to);
+}
+
+#endif
+
+static size_t DataOffset(const WaveformSpec *spec)
+{
+    return (sizeof(FileHeader)+(size_t)spec->paramBytes+DATA_ALIGN-1)/DATA_ALIGN*DATA_ALIGN;
+}
+
+static size_t FileBytes(const WaveformSpec *spec)
+{
+    return DataOffset(spec)+sizeof(double)*(size_t)spec->numChans*spec->numSampsPerChan;
+}
+
+// Generates the waveform into a temporary file and renames it into place.
+static int Generate(const WaveformCache *cache, const WaveformSpec *spec, uint64_t key)
+{
+    char        path[1024],tmp[1024];
+    Mapping     m;
+    FileHeader  *h;
+    int         failed;
+
+    MakePath(cache,key,"",path,sizeof(path));
+    MakePath(cache,key,".tmp",tmp,sizeof(tmp));
+    if( MapFile(tmp,FileBytes(spec),&m)!=0 ) {
+        remove(tmp);
+        return WaveformCacheErrFile;
+    }
+    h = (FileHeader*)m.base;
+    memcpy(h->magic,WAVEFORM_MAGIC,sizeof(h->magic));
+    h->key = key;
+    h->rate = spec->rate;
+    h->numChans = spec->numChans;
+    h->numSampsPerChan = spec->numSampsPerChan;
+    h->layout = spec->layout;
+    h->paramBytes = spec->paramBytes;
+    h->dataOffset = DataOffset(spec);
+    strncpy(h->name,spec->name,WaveformCacheMaxName);
+    if( spec->paramBytes>0 )
+        memcpy(h+1,spec->params,(size_t)spec->paramBytes);
+    failed = spec->generator(spec->params,spec->rate,spec->numChans,spec->numSampsPerChan,spec->layout,(double*)((char*)m.base+h->dataOffset))!=0;
+    UnmapFile(&m);
+    if( failed ) {
+        remove(tmp);
+        return WaveformCacheErrGenerate;
+    }
+    if( RenameFile(tmp,path)!=0 ) {
+        remove(tmp);
+        return WaveformCacheErrFile;
+    }
+    return 0;
+}
+
+// Maps the file and checks that it holds exactly this waveform.
+static int Open(const WaveformCache *cache, const WaveformSpec *spec, uint64_t key, WaveformMap *map)
+{
+    char                path[1024];
+    Mapping             m;
+    const FileHeader    *h;
+
+    MakePath(cache,key,"",path,sizeof(path));
+    if( MapFile(path,0,&m)!=0 )
+        return WaveformCacheErrFile;
+    h = (const FileHeader*)m.base;
+    if( memcmp(h->magic,WAVEFORM_MAGIC,sizeof(h->magic))!=0 || h->key!=key || h->rate!=spec->rate || h->numChans!=spec->numChans
+        || h->numSampsPerChan!=spec->numSampsPerChan || h->layout!=spec->layout || h->paramBytes!=spec->paramBytes
+        || strncmp(h->name,spec->name,WaveformCacheMaxName)!=0 || h->dataOffset!=DataOffset(spec) || m.bytes<FileBytes(spec)
+        || (spec->paramBytes>0 && memcmp(h+1,spec->params,(size_t)spec->paramBytes)!=0) ) {
+        UnmapFile(&m);
+        return WaveformCacheErrFile;
+    }
+    map->data = (const double*)((const char*)m.base+h->dataOffset);
+    map->numChans = spec->numChans;
+    map->numSampsPerChan = spec->numSampsPerChan;
+    map->layout = spec->layout;
+    map->key = key;
+    map->base = m.base;
+    map->bytes = m.bytes;
+    map->handle = m.handle;
+    // The file time is the last use, for the order of eviction.
+    utime(path,NULL);
+    return 0;
+}
+
+/*********************************************/
+// Index
+/*********************************************/
+static Entry *Find(WaveformCache *cache, uint64_t key)
+{
+    int i;
+
+    for(i=0;i<cache->numEntries;++i)
+        if( cache->entries[i].key==key )
+            return &cache->entries[i];
+    return NULL;
+}
+
+static Entry *Add(WaveformCache *cache, uint64_t key, long long bytes, long long lastUse)
+{
+    Entry *e;
+
+    if( cache->numEntries==cache->maxEntries ) {
+        int     n=cache->maxEntries ? 2*cache->maxEntries : 64;
+        Entry   *grown=(Entry*)realloc(cache->entries,n*sizeof(Entry));
+
+        if( !grown )
+            return NULL;
+        cache->entries = grown;
+        cache->maxEntries = n;
+    }
+    e = &cache->entries[cache->numEntries++];
+    memset(e,0,sizeof(Entry));
+    e->key = key;
+    e->bytes = bytes;
+    e->lastUse = lastUse;
+    cache->totalBytes += bytes;
+    return e;
+}
+
+// Deletes the file too, unless it never got there.
+static void Remove(WaveformCache *cache, Entry *e, int deleteFile)
+{
+    char path[1024];
+
+    if( deleteFile ) {
+        MakePath(cache,e->key,"",path,sizeof(path));
+        remove(path);
+    }
+    cache->totalBytes -= e->bytes;
+    *e = cache->entries[--cache->numEntries];
+}
+
+static void Evict(WaveformCache *cache)
+{
+    while( cache->totalBytes>cache->maxBytes ) {
+        Entry   *oldest=NULL;
+        int     i;
+
+        for(i=0;i<cache->numEntries;++i) {
+            Entry *e=&cache->entries[i];
+
+            if( e->refs==0 && !e->pending && (!oldest || e->lastUse<oldest->lastUse) )
+                oldest = e;
+        }
+        if( !oldest )
+            return;
+        Remove(cache,oldest,1);
+        ++cache->stats.evictions;
+    }
+}
+
+typedef struct FoundFile {
+    uint64_t    key;
+    long long   bytes;
+    long long   mtime;
+} FoundFile;
+
+static int CompareTime(const void *a, const void *b)
+{
+    long long ta=((const FoundFile*)a)->mtime,tb=((const FoundFile*)b)->mtime;
+
+    return ta<tb ? -1 : ta>tb;
+}
+
+// Parses a file name of the form 0123456789abcdef.wfc, and deletes
+// temporary files left by a generation that did not finish.
+static int ParseName(const WaveformCache *cache, const char *name, uint64_t *key)
+{
+    char    *end;
+
+    if( strlen(name)==20+4 && strcmp(name+20,".tmp")==0 ) {
+        char path[1024];
+
+        snprintf(path,sizeof(path),"%s/%s",cache->dir,name);
+        remove(path);
+        return 0;
+    }
+    if( strlen(name)!=20 || strcmp(name+16,".wfc")!=0 )
+        return 0;
+    *key = (uint64_t)strtoull(name,&end,16);
+    return end==name+16;
+}
+
+// Builds the index from the directory, oldest use first.
+static int Scan(WaveformCache *cache)
+{
+    FoundFile   *found=NULL;
+    int         num=0,max=0,i;
+    uint64_t    key;
+#if defined(WIN32) || defined(_WIN32)
+    WIN32_FIND_DATAA    fd;
+    HANDLE              find;
+    char                pattern[1024];
+
+    snprintf(pattern,sizeof(pattern),"%s/*",cache->dir);
+    if( (find=FindFirstFileA(pattern,&fd))==INVALID_HANDLE_VALUE )
+        return WaveformCacheErrFile;
+    do {
+        if( ParseName(cache,fd.cFileName,&key) ) {
+#else
+    DIR             *dir;
+    struct dirent   *d;
+    struct stat     st;
+    char            path[1024];
+
+    if( !(dir=opendir(cache->dir)) )
+        return WaveformCacheErrFile;
+    while( (d=readdir(dir)) ) {
+        snprintf(path,sizeof(path),"%s/%s",cache->dir,d->d_name);
+        if( ParseName(cache,d->d_name,&key) && stat(path,&st)==0 ) {
+#endif
+            if( num==max ) {
+                FoundFile *grown=(FoundFile*)realloc(found,(max=max ? 2*max : 64)*sizeof(FoundFile));
+
+                if( !grown )
+                    break;
+                found = grown;
+            }
+            found[num].key = key;
+#if defined(WIN32) || defined(_WIN32)
+            found[num].bytes = ((long long)fd.nFileSizeHigh<<32)|fd.nFileSizeLow;
+            found[num].mtime = ((long long)fd.ftLastWriteTime.dwHighDateTime<<32)|fd.ftLastWriteTime.dwLowDateTime;
+#else
+            found[num].bytes = (long long)st.st_size;
+#if defined(__linux__)
+            found[num].mtime = (long long)st.st_mtim.tv_sec*1000000000+st.st_mtim.tv_nsec;
+#else
+            found[num].mtime = (long long)st.st_mtime;
+#endif
+#endif
+            ++num;
+        }
+#if defined(WIN32) || defined(_WIN32)
+    } while( FindNextFileA(find,&fd) );
+    FindClose(find);
+#else
+    }
+    closedir(dir);
+#endif
+    qsort(found,num,sizeof(FoundFile),CompareTime);
+    for(i=0;i<num;++i)
+        if( !Add(cache,found[i].key,found[i].bytes,++cache->clock) ) {
+            free(found);
+            return WaveformCacheErrOutOfMemory;
+        }
+    free(found);
+    return 0;
+}
+
+/*********************************************/
+// Lookup
+/*********************************************/
+// Makes sure the waveform is in the cache and, if map is not NULL,
+// maps it. *generated tells whether it was generated by this call.
+static int Obtain(WaveformCache *cache, const WaveformSpec *spec, WaveformMap *map, int *generated)
+{
+    uint64_t    key=WaveformCacheKey(spec);
+    Entry       *e;
+    int         error;
+
+    *generated = 0;
+    StreamMutexLock(&cache->mutex);
+    while( (e=Find(cache,key)) && e->pending )
+        StreamCondWait(&cache->cond,&cache->mutex);
+    if( e ) {
+        e->lastUse = ++cache->clock;
+        if( !map ) {
+            StreamMutexUnlock(&cache->mutex);
+            return 0;
+        }
+        ++e->refs;
+        StreamMutexUnlock(&cache->mutex);
+        if( Open(cache,spec,key,map)==0 ) {
+            map->hit = 1;
+            StreamMutexLock(&cache->mutex);
+            ++cache->stats.hits;
+            StreamMutexUnlock(&cache->mutex);
+            return 0;
+        }
+        // Missing or not this waveform: generate it again.
+        StreamMutexLock(&cache->mutex);
+        e = Find(cache,key);
+        if( --e->refs>0 ) {
+            StreamMutexUnlock(&cache->mutex);
+            return WaveformCacheErrFile;
+        }
+        Remove(cache,e,1);
+    }
+    if( !(e=Add(cache,key,0,++cache->clock)) ) {
+        StreamMutexUnlock(&cache->mutex);
+        return WaveformCacheErrOutOfMemory;
+    }
+    e->pending = 1;
+    StreamMutexUnlock(&cache->mutex);
+
+    error = Generate(cache,spec,key);
+
+    StreamMutexLock(&cache->mutex);
+    e = Find(cache,key);
+    if( error ) {
+        Remove(cache,e,0);
+        StreamCondBroadcast(&cache->cond);
+        StreamMutexUnlock(&cache->mutex);
+        return error;
+    }
+    e->pending = 0;
+    e->bytes = (long long)FileBytes(spec);
+    cache->totalBytes += e->bytes;
+    if( map )
+        ++e->refs;
+    *generated = 1;
+    Evict(cache);
+    StreamCondBroadcast(&cache->cond);
+    StreamMutexUnlock(&cache->mutex);
+
+    if( map ) {
+        if( (error=Open(cache,spec,key,map))!=0 ) {
+            StreamMutexLock(&cache->mutex);
+            if( (e=Find(cache,key)) )
+                --e->refs;
+            StreamMutexUnlock(&cache->mutex);
+            return error;
+        }
+        map->hit = 0;
+    }
+    return 0;
+}
+
+static STREAM_THREAD_PROC(PrefetchThread,arg)
+{
+    WaveformCache   *cache=(WaveformCache*)arg;
+    Request         r;
+    int             generated;
+
+    StreamMutexLock(&cache->mutex);
+    for(;;) {
+        while( cache->queueCount==0 && !cache->stop )
+            StreamCondWait(&cache->cond,&cache->mutex);
+        if( cache->stop )
+            break;
+        r = cache->queue[cache->queueHead];
+        r.spec.name = r.name;
+        cache->queueHead = (cache->queueHead+1)%WaveformCacheQueueSize;
+        --cache->queueCount;
+        cache->busy = 1;
+        StreamMutexUnlock(&cache->mutex);
+
+        Obtain(cache,&r.spec,NULL,&generated);
+        free((void*)r.spec.params);
+
+        StreamMutexLock(&cache->mutex);
+        cache->busy = 0;
+        cache->stats.prefetched += generated;
+        StreamCondBroadcast(&cache->cond);
+    }
+    StreamMutexUnlock(&cache->mutex);
+    return 0;
+}
+
+/*********************************************/
+// Interface
+/*********************************************/
+int WaveformCacheCreate(const char *directory, long long maxBytes, WaveformCache **cache)
+{
+    WaveformCache   *c;
+    int             error;
+
+    *cache = NULL;
+    if( !directory || !directory[0] || strlen(directory)>900 || maxBytes<0 )
+        return WaveformCacheErrInvalidArg;
+    c = (WaveformCache*)calloc(1,sizeof(WaveformCache));
+    if( !c )
+        return WaveformCacheErrOutOfMemory;
+    c->dir = (char*)malloc(strlen(directory)+1);
+    if( !c->dir ) {
+        free(c);
+        return WaveformCacheErrOutOfMemory;
+    }
+    strcpy(c->dir,directory);
+    c->maxBytes = maxBytes;
+    if( (error=Scan(c))!=0 ) {
+        free(c->entries);
+        free(c->dir);
+        free(c);
+        return error;
+    }
+    StreamMutexInit(&c->mutex);
+    StreamCondInit(&c->cond);
+    if( StreamThreadCreate(&c->thread,PrefetchThread,c)!=0 ) {
+        StreamCondDestroy(&c->cond);
+        StreamMutexDestroy(&c->mutex);
+        free(c->entries);
+        free(c->dir);
+        free(c);
+        return WaveformCacheErrThread;
+    }
+    StreamMutexLock(&c->mutex);
+    Evict(c);
+    StreamMutexUnlock(&c->mutex);
+    *cache = c;
+    return 0;
+}
+
+void WaveformCacheClear(WaveformCache *cache)
+{
+    if( !cache )
+        return;
+    StreamMutexLock(&cache->mutex);
+    cache->stop = 1;
+    for(;cache->queueCount>0;--cache->queueCount) {
+        free((void*)cache->queue[cache->queueHead].spec.params);
+        cache->queueHead = (cache->queueHead+1)%WaveformCacheQueueSize;
+    }
+    StreamCondBroadcast(&cache->cond);
+    StreamMutexUnlock(&cache->mutex);
+    StreamThreadJoin(cache->thread);
+    StreamCondDestroy(&cache->cond);
+    StreamMutexDestroy(&cache->mutex);
+    free(cache->entries);
+    free(cache->dir);
+    free(cache);
+}
+
+// 64 bit FNV-1a over the key material, then a final mix.
+static uint64_t Hash(uint64_t h, const void *data, size_t n)
+{
+    const unsigned char *p=(const unsigned char*)data;
+    size_t              i;
+
+    for(i=0;i<n;++i)
+        h = (h^p[i])*0x100000001b3ull;
+    return h;
+}
+
+unsigned long long WaveformCacheKey(const WaveformSpec *spec)
+{
+    uint64_t    h=0xcbf29ce484222325ull;
+    int32_t     shape[4]={spec->numChans,spec->numSampsPerChan,spec->layout,spec->paramBytes};
+
+    h = Hash(h,spec->name,strlen(spec->name)+1);
+    h = Hash(h,&spec->rate,sizeof(spec->rate));
+    h = Hash(h,shape,sizeof(shape));
+    if( spec->paramBytes>0 )
+        h = Hash(h,spec->params,(size_t)spec->paramBytes);
+    h ^= h>>33;
+    h *= 0xff51afd7ed558ccdull;
+    h ^= h>>33;
+    return h;
+}
+
+static int Valid(const WaveformSpec *spec)
+{
+    return spec && spec->name && strlen(spec->name)<=WaveformCacheMaxName && spec->generator && spec->rate>0.0
+        && spec->numChans>0 && spec->numSampsPerChan>0 && spec->paramBytes>=0 && (spec->params || spec->paramBytes==0)
+        && (spec->layout==WaveformCacheGroupByChannel || spec->layout==WaveformCacheGroupByScan);
+}
+
+int WaveformCacheGet(WaveformCache *cache, const WaveformSpec *spec, WaveformMap *map)
+{
+    int generated,error;
+
+    memset(map,0,sizeof(WaveformMap));
+    if( !Valid(spec) )
+        return WaveformCacheErrInvalidArg;
+    if( (error=Obtain(cache,spec,map,&generated))==0 && generated ) {
+        StreamMutexLock(&cache->mutex);
+        ++cache->stats.misses;
+        StreamMutexUnlock(&cache->mutex);
+    }
+    return error;
+}
+
+void WaveformCacheRelease(WaveformCache *cache, WaveformMap *map)
+{
+    Mapping m;
+    Entry   *e;
+
+    if( !map->base )
+        return;
+    m.base = map->base;
+    m.bytes = map->bytes;
+    m.handle = map->handle;
+    UnmapFile(&m);
+    StreamMutexLock(&cache->mutex);
+    if( (e=Find(cache,map->key)) && e->refs>0 )
+        --e->refs;
+    Evict(cache);
+    StreamMutexUnlock(&cache->mutex);
+    memset(map,0,sizeof(WaveformMap));
+}
+
+int WaveformCachePrefetch(WaveformCache *cache, const WaveformSpec *spec)
+{
+    Request *r;
+    void    *params=NULL;
+
+    if( !Valid(spec) )
+        return WaveformCacheErrInvalidArg;
+    if( spec->paramBytes>0 ) {
+        if( !(params=malloc((size_t)spec->paramBytes)) )
+            return WaveformCacheErrOutOfMemory;
+        memcpy(params,spec->params,(size_t)spec->paramBytes);
+    }
+    StreamMutexLock(&cache->mutex);
+    if( cache->queueCount==WaveformCacheQueueSize ) {
+        StreamMutexUnlock(&cache->mutex);
+        free(params);
+        return WaveformCacheErrQueueFull;
+    }
+    r = &cache->queue[(cache->queueHead+cache->queueCount++)%WaveformCacheQueueSize];
+    r->spec = *spec;
+    r->spec.params = params;
+    strcpy(r->name,spec->name);
+    StreamCondBroadcast(&cache->cond);
+    StreamMutexUnlock(&cache->mutex);
+    return 0;
+}
+
+void WaveformCacheWaitPrefetch(WaveformCache *cache)
+{
+    StreamMutexLock(&cache->mutex);
+    while( cache->queueCount>0 || cache->busy )
+        StreamCondWait(&cache->cond,&cache->mutex);
+    StreamMutexUnlock(&cache->mutex);
+}
+
+void WaveformCacheFlush(WaveformCache *cache)
+{
+    int i;
+
+    StreamMutexLock(&cache->mutex);
+    for(i=cache->numEntries-1;i>=0;--i)
+        if( cache->entries[i].refs==0 && !cache->entries[i].pending )
+            Remove(cache,&cache->entries[i],1);
+    StreamMutexUnlock(&cache->mutex);
+}
+
+void WaveformCacheGetStats(WaveformCache *cache, WaveformCacheStats *stats)
+{
+    StreamMutexLock(&cache->mutex);
+    *stats = cache->stats;
+    stats->numFiles = cache->numEntries;
+    stats->bytes = cache->totalBytes;
+    StreamMutexUnlock(&cache->mutex);
+}
@@ -0,0 +1,132 @@
+/*********************************************************************
+*
+* Processing helper:
+*    WaveformCache.h
+*
+* Description:
+*    Keeps generated AO waveforms on disk, so that a protocol whose
+*    waveforms take seconds to compute starts at once the next time.
+*    The AO examples compute their ramp or sine at every start; with
+*    large multi-channel scan or stimulus buffers that dominates the
+*    startup time.
+*
+*    A waveform is described by a WaveformSpec: a generator function
+*    with a name, the bytes of its parameters, the sample rate and the
+*    channel layout. The key is a 64 bit hash of all of these except
+*    the function pointer, so a generator whose output changes must
+*    change its name. The parameters must be plain data with no
+*    pointers or padding that is left uninitialized.
+*
+*    Each waveform is one file in the cache directory, named after
+*    its key. The file starts with a header that holds the full key
+*    material, which is compared on every lookup, and the samples
+*    start on a 4 kB boundary. WaveformCacheGet maps the file
+*    read-only, and the mapped samples can be passed straight to
+*    DAQmxWriteAnalogF64. A waveform that is not in the cache is
+*    generated directly into a new mapped file, which is renamed into
+*    place when complete, so a crash never leaves a partial waveform.
+*
+*    When the files add up to more than maxBytes, the least recently
+*    used ones are deleted, except those that are mapped. The last use
+*    is kept in the file time, so the order survives restarts.
+*
+*    WaveformCachePrefetch queues a waveform to be generated on a
+*    background thread, e.g. for the next step of a protocol while
+*    the current one plays. A Get for a waveform that is being
+*    generated waits for it rather than generating it twice.
+*
+*    All functions may be called from any thread. Only one process
+*    should use a cache directory at a time.
+*
+*********************************************************************/
+
+#ifndef WAVEFORMCACHE_H
+#define WAVEFORMCACHE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define WaveformCacheErrInvalidArg      -1
+#define WaveformCacheErrOutOfMemory     -2
+#define WaveformCacheErrFile            -3
+#define WaveformCacheErrGenerate        -4
+#define WaveformCacheErrThread          -5
+#define WaveformCacheErrQueueFull       -6
+
+// The values of DAQmx_Val_GroupByChannel and DAQmx_Val_GroupByScanNumber.
+#define WaveformCacheGroupByChannel     0
+#define WaveformCacheGroupByScan        1
+
+#define WaveformCacheMaxName            63
+#define WaveformCacheQueueSize          64
+
+// Fills data with numSampsPerChan samples of each of numChans
+// channels in the given layout. Returns 0, or nonzero on failure.
+typedef int (*WaveformGenerator)(const void *params, double rate, int numChans, int numSampsPerChan, int layout, double data[]);
+
+typedef struct WaveformSpec {
+    const char          *name;          // names the generator in the key
+    WaveformGenerator   generator;
+    const void          *params;
+    int                 paramBytes;
+    double              rate;
+    int                 numChans;
+    int                 numSampsPerChan;
+    int                 layout;
+} WaveformSpec;
+
+typedef struct WaveformMap {
+    const double        *data;          // page aligned
+    int                 numChans;
+    int                 numSampsPerChan;
+    int                 layout;
+    int                 hit;            // 1 if it was in the cache
+    unsigned long long  key;
+    // Private to WaveformCache.c.
+    void                *base;
+    size_t              bytes;
+    void                *handle;
+} WaveformMap;
+
+typedef struct WaveformCacheStats {
+    long long   hits;
+    long long   misses;                 // generated by Get
+    long long   prefetched;             // generated by the background thread
+    long long   evictions;
+    long long   numFiles;
+    long long   bytes;
+} WaveformCacheStats;
+
+typedef struct WaveformCache WaveformCache;
+
+// Opens, or creates, the cache in an existing directory.
+int  WaveformCacheCreate(const char *directory, long long maxBytes, WaveformCache **cache);
+
+// Waits for the waveform being generated, if any, and drops the
+// rest of the prefetch queue.
+void WaveformCacheClear(WaveformCache *cache);
+
+unsigned long long WaveformCacheKey(const WaveformSpec *spec);
+
+// Maps the waveform, generating it first if needed. Release every
+// map before clearing the cache.
+int  WaveformCacheGet(WaveformCache *cache, const WaveformSpec *spec, WaveformMap *map);
+void WaveformCacheRelease(WaveformCache *cache, WaveformMap *map);
+
+// Copies the spec and its parameters into the prefetch queue.
+int  WaveformCachePrefetch(WaveformCache *cache, const WaveformSpec *spec);
+
+// Waits until the prefetch queue is empty.
+void WaveformCacheWaitPrefetch(WaveformCache *cache);
+
+// Deletes every file that is not mapped.
+void WaveformCacheFlush(WaveformCache *cache);
+
+void WaveformCacheGetStats(WaveformCache *cache, WaveformCacheStats *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
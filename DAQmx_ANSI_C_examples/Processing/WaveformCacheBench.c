@@ -0,0 +1,209 @@
+/*********************************************************************
+*
+* Processing benchmark:
+*    WaveformCacheBench.c
+*
+* Description:
+*    Measures what the waveform cache saves at the start of a
+*    protocol, with scan waveforms of 16 channels by 262144 samples
+*    (32 MB), each channel a sum of 16 harmonics.
+*
+*    Cold start: the cache is empty, so the first waveform is
+*    generated into its file. Warm start: the cache is opened again
+*    and the waveform is mapped from the file. For both, the time to
+*    get the waveform and the time of a first pass over its samples,
+*    as the AO write makes, are reported, and the warm samples are
+*    compared with a fresh computation.
+*
+*    Protocol: four steps with different waveforms, each playing for
+*    2 s. Without prefetch every step waits for its waveform to be
+*    generated; with prefetch the next step's waveform is queued when
+*    a step starts playing. The wait at each step change is reported.
+*
+*    Eviction: the cache is opened again with a limit of 2.5
+*    waveforms, which keeps the two most recently used, steps 2 and 3.
+*    Steps 3, 2, 0, 2 and 3 are then fetched: the third fetch evicts
+*    step 3, the least recently used, and the fifth generates it
+*    again.
+*
+*    No DAQ hardware is needed. Build with WaveformCache.c, and on
+*    Linux with -lpthread -lm. The cache lives in the directory given
+*    as the argument, by default waveform_cache_bench, which is
+*    created if needed and emptied at the end.
+*
+*********************************************************************/
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "WaveformCache.h"
+#include "StreamTime.h"
+
+#if defined(WIN32) || defined(_WIN32)
+#include <direct.h>
+#define MakeDir(path)   _mkdir(path)
+#else
+#include <sys/stat.h>
+#define MakeDir(path)   mkdir(path,0755)
+#endif
+
+#define NUM_CHANS       16
+#define NUM_SAMPS       262144
+#define NUM_HARMONICS   16
+#define RATE            250000.0
+#define NUM_STEPS       4
+#define PLAY_TIME       2.0
+
+typedef struct ScanParams {
+    double      frequency;          // fundamental, Hz
+    double      amplitude;
+} ScanParams;
+
+static int GenScan(const void *params, double rate, int numChans, int numSampsPerChan, int layout, double data[])
+{
+    const ScanParams    *p=(const ScanParams*)params;
+    int                 c,i,h;
+
+    for(c=0;c<numChans;++c)
+        for(i=0;i<numSampsPerChan;++i) {
+            double t=(double)i/rate,sum=0.0;
+
+            for(h=1;h<=NUM_HARMONICS;++h)
+                sum += sin(2.0*3.14159265358979*h*p->frequency*t+0.1*c)/h;
+            data[layout==WaveformCacheGroupByChannel ? (size_t)c*numSampsPerChan+i : (size_t)i*numChans+c] = p->amplitude*sum;
+        }
+    return 0;
+}
+
+static volatile double  sink;   // keeps the first pass from being optimized away
+
+static ScanParams   steps[NUM_STEPS]={{100.0,1.0},{150.0,1.5},{200.0,2.0},{250.0,2.5}};
+
+static WaveformSpec Spec(int step)
+{
+    WaveformSpec spec={"scan-harmonics-v1",GenScan,&steps[step],sizeof(ScanParams),RATE,NUM_CHANS,NUM_SAMPS,WaveformCacheGroupByChannel};
+
+    return spec;
+}
+
+// A first pass over the samples, as the write to the device makes.
+static double Touch(const WaveformMap *w)
+{
+    double  t0=StreamTimeNow(),s=0.0;
+    size_t  i;
+
+    for(i=0;i<(size_t)w->numChans*w->numSampsPerChan;++i)
+        s += w->data[i];
+    sink = s;
+    return StreamTimeNow()-t0;
+}
+
+int main(int argc, char *argv[])
+{
+    const char          *dir=argc>1 ? argv[1] : "waveform_cache_bench";
+    long long           waveBytes=(long long)sizeof(double)*NUM_CHANS*NUM_SAMPS;
+    WaveformCache       *cache;
+    WaveformMap         w;
+    WaveformSpec        spec;
+    WaveformCacheStats  st;
+    double              t0,getTime,touchTime,maxDiff=0.0,wait,totalWait;
+    double              *fresh;
+    size_t              i;
+    int                 k,pass,order[5]={3,2,0,2,3};
+
+    MakeDir(dir);
+    if( WaveformCacheCreate(dir,16*waveBytes,&cache)!=0 ) {
+        printf("Could not open the cache in %s\n",dir);
+        return 2;
+    }
+    WaveformCacheFlush(cache);
+    printf("%d channels x %d samples, %.0f MB per waveform, cache in %s\n\n",NUM_CHANS,NUM_SAMPS,waveBytes/1048576.0,dir);
+
+    /*********************************************/
+    // Cold and warm start
+    /*********************************************/
+    printf("%-12s%14s%18s%14s\n","Start","get (ms)","first pass (ms)","source");
+    spec = Spec(0);
+    for(pass=0;pass<2;++pass) {
+        if( pass==1 ) {
+            // As a new run of the program.
+            WaveformCacheClear(cache);
+            if( WaveformCacheCreate(dir,16*waveBytes,&cache)!=0 )
+                return 2;
+        }
+        t0 = StreamTimeNow();
+        if( WaveformCacheGet(cache,&spec,&w)!=0 ) {
+            printf("Could not get the waveform\n");
+            return 2;
+        }
+        getTime = StreamTimeNow()-t0;
+        touchTime = Touch(&w);
+        printf("%-12s%14.1f%18.1f%14s\n",pass ? "warm" : "cold",1e3*getTime,1e3*touchTime,w.hit ? "cache" : "generated");
+        if( pass==1 ) {
+            if( !(fresh=(double*)malloc((size_t)waveBytes)) )
+                return 2;
+            GenScan(spec.params,spec.rate,spec.numChans,spec.numSampsPerChan,spec.layout,fresh);
+            for(i=0;i<(size_t)NUM_CHANS*NUM_SAMPS;++i)
+                maxDiff = fmax(maxDiff,fabs(fresh[i]-w.data[i]));
+            free(fresh);
+        }
+        WaveformCacheRelease(cache,&w);
+    }
+    printf("Largest difference between cached and fresh samples: %g\n",maxDiff);
+
+    /*********************************************/
+    // Protocol with and without prefetch
+    /*********************************************/
+    printf("\n%-12s","Protocol");
+    for(k=0;k<NUM_STEPS;++k)
+        printf("   step %d (ms)",k);
+    printf("%12s\n","total (s)");
+    for(pass=0;pass<2;++pass) {
+        WaveformCacheFlush(cache);
+        totalWait = 0.0;
+        printf("%-12s",pass ? "prefetch" : "on demand");
+        for(k=0;k<NUM_STEPS;++k) {
+            spec = Spec(k);
+            t0 = StreamTimeNow();
+            if( WaveformCacheGet(cache,&spec,&w)!=0 )
+                return 2;
+            wait = StreamTimeNow()-t0;
+            totalWait += wait;
+            printf("%14.1f",1e3*wait);
+            fflush(stdout);
+            if( pass==1 && k+1<NUM_STEPS ) {
+                spec = Spec(k+1);
+                WaveformCachePrefetch(cache,&spec);
+            }
+            Touch(&w);
+            StreamSleep(PLAY_TIME);
+            WaveformCacheRelease(cache,&w);
+        }
+        printf("%12.2f\n",totalWait);
+    }
+    WaveformCacheGetStats(cache,&st);
+    printf("hits %lld, generated on demand %lld, prefetched %lld\n",st.hits,st.misses,st.prefetched);
+
+    /*********************************************/
+    // Eviction
+    /*********************************************/
+    WaveformCacheClear(cache);
+    if( WaveformCacheCreate(dir,waveBytes*5/2,&cache)!=0 )
+        return 2;
+    WaveformCacheGetStats(cache,&st);
+    printf("\nReopened with a limit of 2.5 waveforms: %lld files, %lld evicted on opening\n",st.numFiles,st.evictions);
+    for(k=0;k<5;++k) {
+        spec = Spec(order[k]);
+        if( WaveformCacheGet(cache,&spec,&w)!=0 )
+            return 2;
+        printf("    step %d %s\n",order[k],w.hit ? "from the cache" : "generated");
+        WaveformCacheRelease(cache,&w);
+    }
+    WaveformCacheGetStats(cache,&st);
+    printf("%lld files, %.0f MB, %lld evictions\n",st.numFiles,st.bytes/1048576.0,st.evictions);
+
+    WaveformCacheFlush(cache);
+    WaveformCacheClear(cache);
+    return 0;
+}
@@ -0,0 +1,154 @@
+/*********************************************************************
+*
+* ANSI C Example program:
+*    SynchAI-AO-ClosedLoop.c
+*
+* Example Category:
+*    Sync
+*
+* Description:
+*    This example demonstrates how to run a PID control loop from an
+*    analog input to an analog output, one sample per clock tick.
+*    SynchAI-AO.c moves data through the driver's buffers, so an
+*    output can only react to inputs at least one buffer old. Here
+*    both tasks use hardware-timed single point mode on the AI sample
+*    clock, so the output written in one clock period reacts to the
+*    input sampled at the start of that period.
+*
+*    The setpoint steps between two levels every second. A loop
+*    thread pinned to one CPU reads the input, runs the controller
+*    and writes the output. When the loop finishes, the measured loop
+*    rate, the number of late iterations and the percentiles of the
+*    read, compute, write and total latencies are printed.
+*
+* Instructions for Running:
+*    1. Select the physical channel to correspond to where your
+*       signal is input on the DAQ device. Also, select the
+*       corresponding channel for where your signal is being
+*       generated.
+*    2. Enter the minimum and maximum voltage ranges.
+*    3. Set the loop rate, the number of iterations, the CPU for the
+*       loop thread and the controller gains.
+*    Note: Not all devices support hardware-timed single point mode.
+*          Run the loop thread on a CPU that is kept free of other
+*          work. Real-time priority needs administrator rights, or
+*          on Linux the CAP_SYS_NICE capability.
+*    4. Build this file together with Tasks/ControlLoop.c,
+*       Tasks/DevTopology.c and Processing/PIDControl.c.
+*
+* Steps:
+*    1. Create a task for the analog input and one for the analog
+*       output.
+*    2. Create an analog input voltage channel and an analog output
+*       voltage channel.
+*    3. Create the control loop, which sets both tasks to
+*       hardware-timed single point mode with the AO task clocked by
+*       the AI sample clock.
+*    4. Start the loop. The analog output is armed before the analog
+*       input, which generates the clock.
+*    5. Wait for the loop to complete its iterations.
+*    6. Print the loop statistics.
+*    7. Call the Clear Task function to clear the tasks.
+*    8. Display an error if any.
+*
+* I/O Connections Overview:
+*    Make sure your signal input terminal matches the Physical
+*    Channel I/O control and your output terminal matches the
+*    generation channel. Connect the output through the system being
+*    controlled to the input. For a first test, an RC low pass
+*    (for example 10 kOhm and 10 uF) from ao0 to ai0 makes a stable
+*    first-order plant.
+*
+*********************************************************************/
+
+#include <stdio.h>
+#include <NIDAQmx.h>
+#include "Tasks/ControlLoop.h"
+#include "Processing/PIDControl.h"
+
+#define DAQmxErrChk(functionCall) if( DAQmxFailed(error=(functionCall)) ) goto Error; else
+
+#define RATE            5000.0
+#define ITERATIONS      25000
+#define LOOP_CPU        1
+#define SETPOINT_HIGH   1.0
+#define SETPOINT_LOW    -1.0
+
+typedef struct StepperData {
+    PIDControl  pid;
+    long long   iteration;
+} StepperData;
+
+static int  StepSetpointPID(const float64 in[], uInt32 numIn, float64 out[], uInt32 numOut, void *stepData);
+static void PrintHist(const char *name, const LatencyHist *h);
+
+int main(void)
+{
+    int32               error=0;
+    char                errBuff[2048]={'\0'};
+    TaskHandle          AItaskHandle=0,AOtaskHandle=0;
+    ControlLoop         *loop=NULL;
+    ControlLoopConfig   config={RATE,ITERATIONS,LOOP_CPU,10.0};
+    ControlLoopStats    stats;
+    StepperData         stepper={{0},0};
+
+    PIDInit(&stepper.pid,0.5,200.0,0.0,1.0/RATE,-10.0,10.0);
+
+    /*********************************************/
+    // DAQmx Configure Code
+    /*********************************************/
+    DAQmxErrChk (DAQmxCreateTask("",&AItaskHandle));
+    DAQmxErrChk (DAQmxCreateAIVoltageChan(AItaskHandle,"Dev1/ai0","",DAQmx_Val_Cfg_Default,-10.0,10.0,DAQmx_Val_Volts,NULL));
+    DAQmxErrChk (DAQmxCreateTask("",&AOtaskHandle));
+    DAQmxErrChk (DAQmxCreateAOVoltageChan(AOtaskHandle,"Dev1/ao0","",-10.0,10.0,DAQmx_Val_Volts,NULL));
+    DAQmxErrChk (ControlLoopCreate(AItaskHandle,AOtaskHandle,&config,StepSetpointPID,&stepper,&loop));
+
+    /*********************************************/
+    // DAQmx Start Code
+    /*********************************************/
+    DAQmxErrChk (ControlLoopStart(loop,NULL));
+
+    printf("Running %d iterations at %.0f Hz...\n",ITERATIONS,RATE);
+    DAQmxErrChk (ControlLoopWait(loop));
+
+    ControlLoopGetStats(loop,&stats);
+    printf("Iterations: %lld, late: %lld, loop rate: %.1f Hz\n",stats.iterations,stats.lateIterations,stats.loopRate);
+    printf("\n\t\tMean (us)\tp50 (us)\tp99 (us)\tMax (us)\n");
+    PrintHist("Period",&stats.period);
+    PrintHist("Read",&stats.input);
+    PrintHist("Compute",&stats.compute);
+    PrintHist("Write",&stats.output);
+    PrintHist("Total",&stats.total);
+
+Error:
+    if( DAQmxFailed(error) )
+        DAQmxGetExtendedErrorInfo(errBuff,2048);
+    /*********************************************/
+    // DAQmx Stop Code
+    /*********************************************/
+    ControlLoopClear(loop);
+    if( AItaskHandle!=0 )
+        DAQmxClearTask(AItaskHandle);
+    if( AOtaskHandle!=0 )
+        DAQmxClearTask(AOtaskHandle);
+    if( DAQmxFailed(error) )
+        printf("DAQmx Error: %s\n",errBuff);
+    printf("End of program, press Enter key to quit\n");
+    getchar();
+    return 0;
+}
+
+// Toggles the setpoint once per second, then runs the controller.
+static int StepSetpointPID(const float64 in[], uInt32 numIn, float64 out[], uInt32 numOut, void *stepData)
+{
+    StepperData *s=(StepperData*)stepData;
+
+    s->pid.setpoint = (s->iteration++/(long long)RATE)%2 ? SETPOINT_LOW : SETPOINT_HIGH;
+    return ControlLoopPIDStep(in,numIn,out,numOut,&s->pid);
+}
+
+static void PrintHist(const char *name, const LatencyHist *h)
+{
+    printf("%-8s\t%.1f\t\t%.1f\t\t%.1f\t\t%.1f\n",name,1e6*LatencyHistMean(h),
+        1e6*LatencyHistPercentile(h,0.5),1e6*LatencyHistPercentile(h,0.99),1e6*h->max);
+}
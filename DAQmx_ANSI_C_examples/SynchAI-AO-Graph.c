@@ -0,0 +1,165 @@
+/*********************************************************************
+*
+* ANSI C Example program:
+*    SynchAI-AO-Graph.c
+*
+* Example Category:
+*    Sync
+*
+* Description:
+*    This example demonstrates how to bring up many synchronized
+*    tasks from a declaration of who triggers whom, instead of coding
+*    the start order by hand as in ContinuousAI.c and SynchAI-AO.c.
+*
+*    One analog input task per device is declared. The task on the
+*    first device is the master, and the others and an analog output
+*    task take their start trigger from its ai/StartTrigger. From
+*    these dependencies the start order is derived: every task that
+*    waits for the master's trigger is started before the master.
+*
+*    The tasks are brought up twice, first configuring and committing
+*    one task after another, then configuring and committing all
+*    tasks in parallel threads. For each run the time at which each
+*    task finished configuring, finished committing and was started
+*    is printed, with the total time until all tasks were armed.
+*
+* Instructions for Running:
+*    1. Select the devices and the channels of each analog input
+*       task, and the analog output channel.
+*    2. Enter the minimum and maximum voltage ranges.
+*    3. Set the sample rates.
+*    Note: The devices must share a trigger bus, e.g. a PXI chassis
+*          or a registered RTSI cable. For sample-accurate alignment
+*          share a reference clock as well, as in ContinuousAI.c.
+*    4. Build this file together with Tasks/TaskGraph.c and
+*       Tasks/DevTopology.c.
+*
+* Steps:
+*    1. Declare a configure function for each task, which creates
+*       its channels, sets its sample clock and, for the analog
+*       output, writes its buffer.
+*    2. Declare the start trigger dependencies.
+*    3. Arm the graph serially: create and configure each task, route
+*       the triggers, verify and commit each task and start the tasks
+*       in dependency order.
+*    4. Stop the tasks and print the timeline.
+*    5. Arm the graph again in parallel and print the timeline.
+*    6. Clear the tasks.
+*    7. Display an error if any.
+*
+* I/O Connections Overview:
+*    Make sure your signal input terminals match the Physical Channel
+*    I/O controls.
+*
+*********************************************************************/
+
+#include <stdio.h>
+#include <math.h>
+#include <NIDAQmx.h>
+#include "Tasks/TaskGraph.h"
+
+#define DAQmxErrChk(functionCall) if( DAQmxFailed(error=(functionCall)) ) goto Error; else
+
+#define NUM_DEVICES     8
+#define AI_RATE         10000.0
+#define AO_RATE         5000.0
+#define AO_SAMPLES      1000
+
+static const char   *devices[NUM_DEVICES]={"Dev1","Dev2","Dev3","Dev4","Dev5","Dev6","Dev7","Dev8"};
+
+static int32 ConfigureAI(TaskHandle taskHandle, void *configureData);
+static int32 ConfigureAO(TaskHandle taskHandle, void *configureData);
+static void  PrintTimeline(const char *title, const TaskGraph *graph);
+
+int main(void)
+{
+    int32       error=0;
+    char        errBuff[2048]={'\0'};
+    char        name[64];
+    TaskGraph   *graph=NULL;
+    int         i;
+
+    /*********************************************/
+    // Task Graph Declaration
+    /*********************************************/
+    if( TaskGraphCreate(&graph)!=0 ) {
+        printf("Could not create the task graph\n");
+        goto Error;
+    }
+    for(i=0;i<NUM_DEVICES;++i) {
+        sprintf(name,"AI %s",devices[i]);
+        TaskGraphAddTask(graph,name,ConfigureAI,(void*)devices[i]);
+        if( i>0 )
+            TaskGraphAddDependency(graph,name,"AI Dev1","ai/StartTrigger",TaskGraphStartTrigger);
+    }
+    TaskGraphAddTask(graph,"AO Dev1",ConfigureAO,NULL);
+    TaskGraphAddDependency(graph,"AO Dev1","AI Dev1","ai/StartTrigger",TaskGraphStartTrigger);
+
+    /*********************************************/
+    // DAQmx Configure and Start Code
+    /*********************************************/
+    DAQmxErrChk (TaskGraphArm(graph,0));
+    PrintTimeline("Serial",graph);
+    TaskGraphStop(graph);
+
+    DAQmxErrChk (TaskGraphArm(graph,1));
+    PrintTimeline("Parallel",graph);
+
+    printf("\nAcquiring samples continuously. Press Enter to interrupt\n");
+    getchar();
+
+Error:
+    if( DAQmxFailed(error) )
+        DAQmxGetExtendedErrorInfo(errBuff,2048);
+    /*********************************************/
+    // DAQmx Stop Code
+    /*********************************************/
+    TaskGraphClear(graph);
+    if( DAQmxFailed(error) )
+        printf("DAQmx Error: %s\n",errBuff);
+    printf("End of program, press Enter key to quit\n");
+    getchar();
+    return 0;
+}
+
+static int32 ConfigureAI(TaskHandle taskHandle, void *configureData)
+{
+    int32   error=0;
+    char    chan[64];
+
+    sprintf(chan,"%s/ai0:7",(const char*)configureData);
+    DAQmxErrChk (DAQmxCreateAIVoltageChan(taskHandle,chan,"",DAQmx_Val_Cfg_Default,-10.0,10.0,DAQmx_Val_Volts,NULL));
+    DAQmxErrChk (DAQmxCfgSampClkTiming(taskHandle,"",AI_RATE,DAQmx_Val_Rising,DAQmx_Val_ContSamps,(uInt64)AI_RATE));
+
+Error:
+    return error;
+}
+
+static int32 ConfigureAO(TaskHandle taskHandle, void *configureData)
+{
+    int32   error=0;
+    float64 data[AO_SAMPLES];
+    int     i;
+
+    for(i=0;i<AO_SAMPLES;++i)
+        data[i] = sin(2.0*3.1415926535*i/AO_SAMPLES);
+    DAQmxErrChk (DAQmxCreateAOVoltageChan(taskHandle,"Dev1/ao0","",-10.0,10.0,DAQmx_Val_Volts,NULL));
+    DAQmxErrChk (DAQmxCfgSampClkTiming(taskHandle,"",AO_RATE,DAQmx_Val_Rising,DAQmx_Val_ContSamps,AO_SAMPLES));
+    DAQmxErrChk (DAQmxWriteAnalogF64(taskHandle,AO_SAMPLES,FALSE,10.0,DAQmx_Val_GroupByChannel,data,NULL,NULL));
+
+Error:
+    return error;
+}
+
+static void PrintTimeline(const char *title, const TaskGraph *graph)
+{
+    TaskGraphTimes  t;
+    int             i;
+
+    printf("\n%s: all tasks armed after %.1f ms\n",title,1e3*TaskGraphTimeToArmed(graph));
+    printf("Task\t\tConfigured (ms)\tCommitted (ms)\tStarted (ms)\tOrder\n");
+    for(i=0;i<TaskGraphNumTasks(graph);++i) {
+        TaskGraphGetTimes(graph,i,&t);
+        printf("%-12s\t%.1f\t\t%.1f\t\t%.1f\t\t%d\n",t.name,1e3*t.configureEnd,1e3*t.commitEnd,1e3*t.started,t.startIndex);
+    }
+}
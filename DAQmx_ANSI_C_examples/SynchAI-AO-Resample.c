@@ -0,0 +1,312 @@
+/*********************************************************************
+*
+* ANSI C Example program:
+*    SynchAI-AO-Resample.c
+*
+* Example Category:
+*    Sync
+*
+* Description:
+*    This example extends SynchAI-AO.c. The analog input runs at
+*    10 kHz and the analog output at 5 kHz, so the commanded and the
+*    measured signals cannot be compared sample by sample. Each time
+*    a block of AI data arrives, the matching block of the AO
+*    waveform is passed through a polyphase resampler that brings it
+*    onto the AI timebase. The AI data are delayed by the group delay
+*    of the resampler so that both streams line up, and the RMS
+*    difference between command and measurement is printed, together
+*    with the RMS of the measured signal from ChanStats.
+*
+*    The processing runs in the sample type of Processing/StreamSample.h,
+*    double by default and float when STREAM_SAMPLE_F32 is defined. The
+*    AI data are read as 16-bit raw codes and scaled with the device's
+*    own calibration polynomial, and the AO waveform is converted to
+*    float64 only when it is written. Devices whose raw samples are
+*    wider than 16 bits are rejected at start-up.
+*
+*    The same Resampler stage can be used with upFactor=1 as a
+*    decimator to reduce the storage needed for oversampled channels.
+*
+* Instructions for Running:
+*    1. Connect Dev1/ao0 to Dev1/ai0.
+*    2. Select the physical channels and rates below. The resampling
+*       ratio is derived from the two sample rates.
+*    3. Build this file together with Processing/Resampler.c,
+*       Processing/AIScale.c, Processing/ChanStats.c and
+*       Tasks/DevTopology.c. Define STREAM_SAMPLE_F32 to process in
+*       float.
+*
+* Steps:
+*    1. Create an analog input and an analog output task and share
+*       the AI start trigger with the AO task, as in SynchAI-AO.c.
+*    2. Create a resampler that converts from the AO rate to the AI
+*       rate. Query how many coefficients DAQmxGetAIDevScalingCoeff
+*       returns and create the AI scaling from them.
+*    3. Convert the AO waveform to float64, write it and start the AO
+*       task before the AI task.
+*    4. In the EveryNCallback function read the raw AI block, scale
+*       it, resample the corresponding section of the AO waveform and
+*       compare the two.
+*    5. Call the Clear Task function to clear the tasks.
+*    6. Display an error if any.
+*
+* I/O Connections Overview:
+*    Make sure your signal input terminals match the Physical Channel
+*    I/O controls.
+*
+*********************************************************************/
+
+#include <string.h>
+#include <stdio.h>
+#include <math.h>
+#include <NIDAQmx.h>
+#include "Tasks/DevTopology.h"
+#include "Processing/Resampler.h"
+#include "Processing/AIScale.h"
+#include "Processing/ChanStats.h"
+#include "Processing/StreamSample.h"
+
+static TaskHandle  AItaskHandle=0,AOtaskHandle=0;
+static Resampler   *AOtoAI=NULL;
+static AIScale     *AIscaling=NULL;
+static ChanStats   *AIstats=NULL;
+
+
+#define PI  3.1415926535
+
+#define AI_RATE         10000.0
+#define AO_RATE         5000.0
+#define AI_BLOCK        1000
+#define AO_BUFFER       1000
+#define MAX_DELAY       64
+#define MAX_COEFFS      AIScaleMaxCoeffs
+#define AI_CHAN         "Dev1/ai0"     // also names the start trigger's device
+
+#define DAQmxErrChk(functionCall) if( DAQmxFailed(error=(functionCall)) ) goto Error; else
+
+static StreamSample AOdata[AO_BUFFER];
+static int          AOblock;        // AO samples that span one AI block
+static int          delay;          // resampler group delay in AI samples
+
+int GenSineWave(int numElements, double amplitude, double frequency, double *phase, StreamSample sineWave[]);
+
+int32 CVICALLBACK EveryNCallback(TaskHandle taskHandle, int32 everyNsamplesEventType, uInt32 nSamples, void *callbackData);
+int32 CVICALLBACK DoneCallback(TaskHandle taskHandle, int32 status, void *callbackData);
+
+int main(void)
+{
+    int32   error=0;
+    char    errBuff[2048]={'\0'};
+    char    trigName[256];
+    float64 phase=0.0;
+    float64 coeffs[MAX_COEFFS]={0.0};
+    int32   numCoeffs;
+    uInt32  rawSize=0;
+    float64 AOwrite[AO_BUFFER];
+
+    /*********************************************/
+    // Resampler Configure Code
+    /*********************************************/
+    // AI_BLOCK must correspond to a whole number of AO samples.
+    AOblock = (int)(AI_BLOCK*AO_RATE/AI_RATE);
+    if( ResamplerCreateRatio(1,AI_RATE/AO_RATE,64,16,AOblock,&AOtoAI)!=0 ) {
+        printf("Could not create the resampler\n");
+        goto Error;
+    }
+    delay = (int)floor(ResamplerGroupDelay(AOtoAI)+0.5);
+    if( delay>MAX_DELAY ) {
+        printf("Resampler delay of %d samples is too long\n",delay);
+        goto Error;
+    }
+
+    /*********************************************/
+    // DAQmx Configure Code
+    /*********************************************/
+
+    // Configure the analog input task
+    DAQmxErrChk (DAQmxCreateTask("",&AItaskHandle));
+    DAQmxErrChk (DAQmxCreateAIVoltageChan(AItaskHandle,AI_CHAN,"",DAQmx_Val_Cfg_Default,-10.0,10.0,DAQmx_Val_Volts,NULL));
+    DAQmxErrChk (DAQmxCfgSampClkTiming(AItaskHandle,"",AI_RATE,DAQmx_Val_Rising,DAQmx_Val_ContSamps,AI_BLOCK));
+    DAQmxErrChk (DevTopologyChannelTerminal(AI_CHAN,"ai/StartTrigger",trigName,sizeof(trigName)));
+    // The callback reads with DAQmxReadBinaryI16, which only holds raw
+    // samples of up to 16 bits.
+    DAQmxErrChk (DAQmxGetAIRawSampSize(AItaskHandle,AI_CHAN,&rawSize));
+    if( rawSize>16 ) {
+        printf("Raw samples of %u bits do not fit in int16\n",(unsigned)rawSize);
+        goto Error;
+    }
+    // Called with no buffer, the getter returns the number of coefficients.
+    DAQmxErrChk (numCoeffs=DAQmxGetAIDevScalingCoeff(AItaskHandle,AI_CHAN,NULL,0));
+    if( numCoeffs<1 || numCoeffs>MAX_COEFFS ) {
+        printf("Unsupported number of scaling coefficients: %d\n",(int)numCoeffs);
+        goto Error;
+    }
+    DAQmxErrChk (DAQmxGetAIDevScalingCoeff(AItaskHandle,AI_CHAN,coeffs,numCoeffs));
+    if( AIScaleCreate(1,coeffs,numCoeffs,&AIscaling)!=0 || ChanStatsCreate(1,-10.0,10.0,10,&AIstats)!=0 ) {
+        printf("Could not create the AI processing\n");
+        goto Error;
+    }
+
+    // Configure the analog output task
+    DAQmxErrChk (DAQmxCreateTask("",&AOtaskHandle));
+    DAQmxErrChk (DAQmxCreateAOVoltageChan(AOtaskHandle,"Dev1/ao0","",-10.0,10.0,DAQmx_Val_Volts,NULL));
+    DAQmxErrChk (DAQmxCfgSampClkTiming(AOtaskHandle,"",AO_RATE,DAQmx_Val_Rising,DAQmx_Val_ContSamps,AO_BUFFER));
+
+    // Define parameters for the start trigger
+    DAQmxErrChk (DAQmxCfgDigEdgeStartTrig(AOtaskHandle,trigName,DAQmx_Val_Rising));
+
+    // Set up the callback functions
+    DAQmxErrChk (DAQmxRegisterEveryNSamplesEvent(AItaskHandle,DAQmx_Val_Acquired_Into_Buffer,AI_BLOCK,0,EveryNCallback,NULL));
+    DAQmxErrChk (DAQmxRegisterDoneEvent(AItaskHandle,0,DoneCallback,NULL));
+
+    GenSineWave(AO_BUFFER,1.0,1.0/AO_BUFFER,&phase,AOdata);
+    StreamSampleToF64(AOdata,AOwrite,AO_BUFFER);
+
+    DAQmxErrChk (DAQmxWriteAnalogF64(AOtaskHandle, AO_BUFFER, FALSE, 10.0, DAQmx_Val_GroupByChannel, AOwrite, NULL, NULL));
+
+    /*********************************************/
+    // DAQmx Start Code
+    /*********************************************/
+    DAQmxErrChk (DAQmxStartTask(AOtaskHandle)); // Must be started first
+    DAQmxErrChk (DAQmxStartTask(AItaskHandle));
+
+    printf("Acquiring samples continuously in %s. Group delay is %d samples. Press Enter to interrupt\n",StreamSampleName,delay);
+    printf("\nRead:\tAI\tTotal:\tAI\tRMS error (V)\tAI RMS (V)\n");
+    getchar();
+
+Error:
+    if( DAQmxFailed(error) )
+        DAQmxGetExtendedErrorInfo(errBuff,2048);
+    if( AItaskHandle ) {
+        /*********************************************/
+        // DAQmx Stop Code
+        /*********************************************/
+        DAQmxStopTask(AItaskHandle);
+        DAQmxClearTask(AItaskHandle);
+        AItaskHandle = 0;
+    }
+    if( AOtaskHandle ) {
+        /*********************************************/
+        // DAQmx Stop Code
+        /*********************************************/
+        DAQmxStopTask(AOtaskHandle);
+        DAQmxClearTask(AOtaskHandle);
+        AOtaskHandle = 0;
+    }
+    ResamplerClear(AOtoAI);
+    AOtoAI = NULL;
+    AIScaleClear(AIscaling);
+    AIscaling = NULL;
+    ChanStatsClear(AIstats);
+    AIstats = NULL;
+    if( DAQmxFailed(error) )
+        printf("DAQmx Error: %s\n",errBuff);
+    printf("End of program, press Enter key to quit\n");
+    getchar();
+    return 0;
+}
+
+int32 CVICALLBACK EveryNCallback(TaskHandle taskHandle, int32 everyNsamplesEventType, uInt32 nSamples, void *callbackData)
+{
+    int32           error=0;
+    char            errBuff[2048]={'\0'};
+    static int          totalAI=0;
+    static int          AOpos=0;
+    static StreamSample AIdelayed[MAX_DELAY+AI_BLOCK];
+    int16               AIraw[AI_BLOCK];
+    int32               readAI;
+    StreamSample        AOref[AO_BUFFER],AOresampled[2*AI_BLOCK];
+    ChanStatsResult     AIresult;
+    float64             sumSq=0.0;
+    int                 i,numResampled,numCompared=0;
+
+    /*********************************************/
+    // DAQmx Read Code
+    /*********************************************/
+    DAQmxErrChk (DAQmxReadBinaryI16(AItaskHandle,AI_BLOCK,10.0,DAQmx_Val_GroupByChannel,AIraw,AI_BLOCK,&readAI,NULL));
+    AIScaleToSample(AIscaling,AIraw,readAI,0,AIdelayed+delay);
+    ChanStatsAddSample(AIstats,AIdelayed+delay,readAI,0);
+    ChanStatsQuery(AIstats,0,NULL,&AIresult);
+
+    /*********************************************/
+    // Resample Code
+    /*********************************************/
+    // The AO buffer regenerates, so the reference for this block is the
+    // next AOblock samples of AOdata taken modulo the buffer length.
+    for(i=0;i<AOblock;++i) {
+        AOref[i] = AOdata[AOpos];
+        if( ++AOpos>=AO_BUFFER )
+            AOpos = 0;
+    }
+    if( ResamplerProcessSample(AOtoAI,AOref,AOblock,AOresampled,2*AI_BLOCK,&numResampled)==0 ) {
+        // AIdelayed[i] holds the AI sample taken delay samples before
+        // AOresampled[i] was commanded.
+        for(i=0;i<numResampled && i<readAI;++i) {
+            if( totalAI+i<delay )
+                continue;
+            sumSq += (AOresampled[i]-AIdelayed[i])*(AOresampled[i]-AIdelayed[i]);
+            ++numCompared;
+        }
+    }
+    memmove(AIdelayed,AIdelayed+readAI,sizeof(StreamSample)*delay);
+
+    printf("\t%d\t\t%d\t%.4f\t\t%.4f\r",(int)readAI,(int)(totalAI+=readAI),numCompared ? sqrt(sumSq/numCompared) : 0.0,AIresult.rms);
+    fflush(stdout);
+
+Error:
+    if( DAQmxFailed(error) ) {
+        DAQmxGetExtendedErrorInfo(errBuff,2048);
+        /*********************************************/
+        // DAQmx Stop Code
+        /*********************************************/
+        if( AItaskHandle ) {
+            DAQmxStopTask(AItaskHandle);
+            DAQmxClearTask(AItaskHandle);
+            AItaskHandle = 0;
+        }
+        if( AOtaskHandle ) {
+            DAQmxStopTask(AOtaskHandle);
+            DAQmxClearTask(AOtaskHandle);
+            AOtaskHandle = 0;
+        }
+        printf("DAQmx Error: %s\n",errBuff);
+    }
+    return 0;
+}
+
+int32 CVICALLBACK DoneCallback(TaskHandle taskHandle, int32 status, void *callbackData)
+{
+    int32   error=0;
+    char    errBuff[2048]={'\0'};
+
+    // Check to see if an error stopped the task.
+    DAQmxErrChk (status);
+
+Error:
+    if( DAQmxFailed(error) ) {
+        DAQmxGetExtendedErrorInfo(errBuff,2048);
+        DAQmxClearTask(taskHandle);
+        if( AItaskHandle ) {
+            DAQmxStopTask(AItaskHandle);
+            DAQmxClearTask(AItaskHandle);
+            AItaskHandle = 0;
+        }
+        if( AOtaskHandle ) {
+            DAQmxStopTask(AOtaskHandle);
+            DAQmxClearTask(AOtaskHandle);
+            AOtaskHandle = 0;
+        }
+        printf("DAQmx Error: %s\n",errBuff);
+    }
+    return 0;
+}
+
+int GenSineWave(int numElements, double amplitude, double frequency, double *phase, StreamSample sineWave[])
+{
+    int i=0;
+
+    for(;i<numElements;++i)
+        sineWave[i] = (StreamSample)(amplitude*sin(PI/180.0*(*phase+360.0*frequency*i)));
+    *phase = fmod(*phase+frequency*360.0*numElements,360.0);
+    return 0;
+}
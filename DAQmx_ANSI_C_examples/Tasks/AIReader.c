@@ -0,0 +1,274 @@
+/*********************************************************************
+*
+* Task helper:
+*    AIReader.c
+*
+* Description:
+*    Implementation of the callback or polling AI reader. See
+*    AIReader.h for the calling conventions.
+*
+*    Statistics are updated by whichever thread delivers the data,
+*    the driver's callback thread or the reader thread, under a mutex
+*    that AIReaderGetStats also takes. Polling reads request exactly
+*    the number of samples available (up to maxBlock), with a zero
+*    timeout, so a read never waits.
+*
+*********************************************************************/
+
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE     // for pthread_setaffinity_np
+#endif
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "AIReader.h"
+#include "../Processing/StreamTime.h"
+#include "../Processing/StreamThread.h"
+
+#define DAQmxErrChk(functionCall) if( DAQmxFailed(error=(functionCall)) ) goto Error; else
+
+#define MAX_LATENCIES   65536
+
+struct AIReader {
+    AIReaderConfig      cfg;
+    TaskHandle          task;
+    uInt32              numChans;
+    AIReaderConsumer    consumer;
+    void                *consumerData;
+    float64             *data;
+
+    StreamThread        thread;
+    int                 threadRunning;
+    volatile int        stop;
+    int32               asyncError;
+
+    StreamMutex         lock;
+    long long           blocks;
+    long long           samples;
+    double              startEstimate;  // earliest acquisition start consistent with all deliveries
+    double              *latencies;     // delivery time minus index/rate, ring of the last MAX_LATENCIES blocks
+    double              wallStart;
+    double              cpuStart;
+};
+
+// Records a delivery of numRead samples per channel made at now.
+static void RecordDelivery(AIReader *r, int32 numRead, double now)
+{
+    double  offset;
+
+    StreamMutexLock(&r->lock);
+    r->blocks++;
+    r->samples += numRead;
+    offset = now-(double)r->samples/r->cfg.rate;
+    if( r->blocks==1 || offset<r->startEstimate )
+        r->startEstimate = offset;
+    r->latencies[(r->blocks-1)%MAX_LATENCIES] = offset;
+    StreamMutexUnlock(&r->lock);
+}
+
+static int32 ReadAndDeliver(AIReader *r, int32 numSamps, float64 timeout)
+{
+    int32   error=0;
+    int32   read=0;
+
+    /*********************************************/
+    // DAQmx Read Code
+    /*********************************************/
+    DAQmxErrChk (DAQmxReadAnalogF64(r->task,numSamps,timeout,DAQmx_Val_GroupByChannel,r->data,(uInt32)numSamps*r->numChans,&read,NULL));
+    if( read>0 ) {
+        RecordDelivery(r,read,StreamTimeNow());
+        r->consumer(r->data,read,r->numChans,r->consumerData);
+    }
+
+Error:
+    return error;
+}
+
+static int32 CVICALLBACK EveryNCallback(TaskHandle taskHandle, int32 everyNsamplesEventType, uInt32 nSamples, void *callbackData)
+{
+    AIReader    *r=(AIReader*)callbackData;
+    int32       error;
+
+    error = ReadAndDeliver(r,r->cfg.everyN,10.0);
+    if( DAQmxFailed(error) && !r->asyncError )
+        r->asyncError = error;
+    return 0;
+}
+
+static STREAM_THREAD_PROC(PollThread,arg)
+{
+    AIReader    *r=(AIReader*)arg;
+    int32       error=0;
+    double      idleSince=-1.0;
+
+    if( r->cfg.cpu>=0 )
+        StreamThreadPinCurrent(r->cfg.cpu);
+    while( !r->stop ) {
+        uInt32 avail=0;
+
+        DAQmxErrChk (DAQmxGetReadAvailSampPerChan(r->task,&avail));
+        if( avail>=(uInt32)r->cfg.minBlock ) {
+            DAQmxErrChk (ReadAndDeliver(r,avail<(uInt32)r->cfg.maxBlock ? (int32)avail : r->cfg.maxBlock,0.0));
+            idleSince = -1.0;
+            continue;
+        }
+        if( r->cfg.mode==AIReaderModeHybridPoll ) {
+            double now=StreamTimeNow();
+
+            if( idleSince<0.0 )
+                idleSince = now;
+            else if( now-idleSince>=r->cfg.spinTime ) {
+                StreamSleep(r->cfg.sleepTime);
+                continue;
+            }
+        }
+        StreamCpuRelax();
+    }
+
+Error:
+    if( DAQmxFailed(error) && !r->stop )
+        r->asyncError = error;
+    return 0;
+}
+
+int32 AIReaderCreate(TaskHandle taskHandle, const AIReaderConfig *config, AIReaderConsumer consumer, void *consumerData, AIReader **reader)
+{
+    int32       error=0;
+    AIReader    *r;
+    int         block;
+
+    *reader = NULL;
+    if( !consumer || config->rate<=0.0 || config->mode<AIReaderModeCallback || config->mode>AIReaderModeHybridPoll )
+        return AIReaderErrInvalidArg;
+    if( config->mode==AIReaderModeCallback ? config->everyN<1 : (config->minBlock<1 || config->maxBlock<config->minBlock) )
+        return AIReaderErrInvalidArg;
+    r = (AIReader*)calloc(1,sizeof(AIReader));
+    if( !r )
+        return AIReaderErrOutOfMemory;
+    r->cfg = *config;
+    r->task = taskHandle;
+    r->consumer = consumer;
+    r->consumerData = consumerData;
+    StreamMutexInit(&r->lock);
+
+    DAQmxErrChk (DAQmxGetTaskNumChans(taskHandle,&r->numChans));
+    block = config->mode==AIReaderModeCallback ? config->everyN : config->maxBlock;
+    r->data = (float64*)malloc((size_t)block*r->numChans*sizeof(float64));
+    r->latencies = (double*)malloc(MAX_LATENCIES*sizeof(double));
+    if( !r->data || !r->latencies ) {
+        error = AIReaderErrOutOfMemory;
+        goto Error;
+    }
+    if( config->mode==AIReaderModeCallback ) {
+        DAQmxErrChk (DAQmxRegisterEveryNSamplesEvent(taskHandle,DAQmx_Val_Acquired_Into_Buffer,config->everyN,0,EveryNCallback,r));
+    }
+    *reader = r;
+    return 0;
+
+Error:
+    AIReaderClear(r);
+    return error;
+}
+
+void AIReaderClear(AIReader *reader)
+{
+    if( !reader )
+        return;
+    AIReaderStop(reader);
+    if( reader->cfg.mode==AIReaderModeCallback )
+        DAQmxRegisterEveryNSamplesEvent(reader->task,DAQmx_Val_Acquired_Into_Buffer,reader->cfg.everyN,0,NULL,NULL);
+    StreamMutexDestroy(&reader->lock);
+    free(reader->data);
+    free(reader->latencies);
+    free(reader);
+}
+
+int32 AIReaderStart(AIReader *reader)
+{
+    int32   error=0;
+
+    if( reader->threadRunning )
+        return AIReaderErrInvalidArg;
+    reader->blocks = 0;
+    reader->samples = 0;
+    reader->asyncError = 0;
+    reader->stop = 0;
+    reader->wallStart = StreamTimeNow();
+    reader->cpuStart = StreamCpuTime();
+
+    /*********************************************/
+    // DAQmx Start Code
+    /*********************************************/
+    DAQmxErrChk (DAQmxStartTask(reader->task));
+
+    if( reader->cfg.mode!=AIReaderModeCallback ) {
+        if( StreamThreadCreate(&reader->thread,PollThread,reader)!=0 ) {
+            DAQmxStopTask(reader->task);
+            return AIReaderErrThread;
+        }
+        reader->threadRunning = 1;
+    }
+
+Error:
+    return error;
+}
+
+int32 AIReaderStop(AIReader *reader)
+{
+    int32   error;
+
+    reader->stop = 1;
+    if( reader->threadRunning ) {
+        StreamThreadJoin(reader->thread);
+        reader->threadRunning = 0;
+    }
+
+    /*********************************************/
+    // DAQmx Stop Code
+    /*********************************************/
+    DAQmxStopTask(reader->task);
+    error = reader->asyncError;
+    reader->asyncError = 0;
+    return error;
+}
+
+static int CompareDouble(const void *a, const void *b)
+{
+    double x=*(const double*)a,y=*(const double*)b;
+
+    return x<y ? -1 : x>y;
+}
+
+void AIReaderGetStats(AIReader *reader, AIReaderStats *stats)
+{
+    double      *sorted;
+    long long   n,i;
+
+    memset(stats,0,sizeof(AIReaderStats));
+    StreamMutexLock(&reader->lock);
+    stats->blocks = reader->blocks;
+    stats->samples = reader->samples;
+    n = reader->blocks<MAX_LATENCIES ? reader->blocks : MAX_LATENCIES;
+    sorted = n>0 ? (double*)malloc((size_t)n*sizeof(double)) : NULL;
+    // Latency is each delivery's offset above the earliest estimate.
+    for(i=0;sorted && i<n;++i)
+        sorted[i] = reader->latencies[i]-reader->startEstimate;
+    StreamMutexUnlock(&reader->lock);
+
+    if( sorted ) {
+        qsort(sorted,(size_t)n,sizeof(double),CompareDouble);
+        for(i=0;i<n;++i) {
+            double  us=1e6*sorted[i];
+            int     bin=us<1.0 ? 0 : (int)log2(us);
+
+            stats->meanLatency += sorted[i]/n;
+            stats->histogram[bin<AIReaderNumBins ? bin : AIReaderNumBins-1]++;
+        }
+        stats->p50Latency = sorted[n/2];
+        stats->p99Latency = sorted[(n*99)/100];
+        stats->maxLatency = sorted[n-1];
+        free(sorted);
+    }
+    stats->cpuLoad = (StreamCpuTime()-reader->cpuStart)/(StreamTimeNow()-reader->wallStart);
+}
@@ -0,0 +1,99 @@
+/*********************************************************************
+*
+* Task helper:
+*    AIReader.h
+*
+* Description:
+*    Delivers the data of a continuous analog input task to a consumer
+*    function, in one of three modes chosen per task:
+*
+*    AIReaderModeCallback    - DAQmxRegisterEveryNSamplesEvent with a
+*                              fixed block, as in ContAcq-IntClk.c.
+*    AIReaderModeBusyPoll    - a dedicated reader thread spins on
+*                              DAQmxGetReadAvailSampPerChan and reads
+*                              whatever is available.
+*    AIReaderModeHybridPoll  - as busy polling, but after spinTime
+*                              without data the thread sleeps for
+*                              sleepTime between polls.
+*
+*    The polling modes avoid the driver's event dispatch and can
+*    deliver blocks as small as minBlock samples. The reader thread
+*    can be pinned to one CPU, which should then be kept free of
+*    other work.
+*
+*    For every delivered block the latency of its newest sample is
+*    estimated as the time of delivery minus the time that sample was
+*    acquired. The acquisition time is taken as start+index/rate,
+*    where start is the earliest value consistent with all deliveries
+*    so far. The latencies are therefore relative to the fastest
+*    delivery seen and exclude any constant transfer delay. That is
+*    enough to compare modes. The latency statistics cover the most
+*    recent 65536 blocks.
+*
+*********************************************************************/
+
+#ifndef AIREADER_H
+#define AIREADER_H
+
+#include <NIDAQmx.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define AIReaderErrInvalidArg       -1
+#define AIReaderErrOutOfMemory      -2
+#define AIReaderErrThread           -3
+
+#define AIReaderModeCallback        0
+#define AIReaderModeBusyPoll        1
+#define AIReaderModeHybridPoll      2
+
+#define AIReaderNumBins             24      // latency histogram, bin k holds [2^k,2^(k+1)) us
+
+// data holds numSampsPerChan samples for each of numChans channels,
+// GroupByChannel.
+typedef void (*AIReaderConsumer)(const float64 data[], int32 numSampsPerChan, uInt32 numChans, void *consumerData);
+
+typedef struct AIReaderConfig {
+    int         mode;
+    float64     rate;           // the task's sample clock rate
+    int         everyN;         // callback mode block size
+    int         minBlock;       // polling modes: smallest read
+    int         maxBlock;       // polling modes: largest read
+    int         cpu;            // polling modes: CPU to pin the reader to, or -1
+    double      spinTime;       // hybrid mode, seconds
+    double      sleepTime;      // hybrid mode, seconds
+} AIReaderConfig;
+
+typedef struct AIReaderStats {
+    long long   blocks;
+    long long   samples;        // per channel
+    double      meanLatency;    // seconds
+    double      maxLatency;
+    double      p50Latency;
+    double      p99Latency;
+    long long   histogram[AIReaderNumBins];
+    double      cpuLoad;        // process CPU time per wall time since start
+} AIReaderStats;
+
+typedef struct AIReader AIReader;
+
+// taskHandle must be a configured, stopped continuous AI task.
+int32 AIReaderCreate(TaskHandle taskHandle, const AIReaderConfig *config, AIReaderConsumer consumer, void *consumerData, AIReader **reader);
+void  AIReaderClear(AIReader *reader);
+
+// Starts the task and the delivery.
+int32 AIReaderStart(AIReader *reader);
+
+// Stops the delivery and the task, and returns the first error seen
+// while reading.
+int32 AIReaderStop(AIReader *reader);
+
+void  AIReaderGetStats(AIReader *reader, AIReaderStats *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
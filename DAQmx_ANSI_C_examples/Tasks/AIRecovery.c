@@ -0,0 +1,280 @@
+/*********************************************************************
+*
+* Task helper:
+*    AIRecovery.c
+*
+* Description:
+*    Implementation of the overflow recovery. See AIRecovery.h.
+*
+*    The stream index of sample k of a task since its last start is
+*    base+k. A resync leaves base alone and moves the read positions;
+*    a restart sets base to the stream index the restarted tasks'
+*    first sample is taken to have.
+*
+*    A resync sets each task's read Offset, relative to its current
+*    read position, to reach the target sample. The offset applies to
+*    every later read, so it is set back to 0 after the next read.
+*
+*********************************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "AIRecovery.h"
+#include "../Processing/StreamTime.h"
+#include "../Processing/StreamThread.h"
+
+#define DAQmxErrChk(functionCall) if( DAQmxFailed(error=(functionCall)) ) goto Error; else
+
+#define MAX_ATTEMPTS    4       // recoveries within one read
+
+struct AIRecovery {
+    AIRecoveryConfig    cfg;
+    TaskHandle          tasks[AIRecoveryMaxTasks];
+    int                 numTasks;
+    StreamMutex         lock;
+    uInt64              position;       // stream index of the next sample delivered
+    uInt64              base;           // stream index of the tasks' first sample
+    int                 offsetSet;
+    AIRecoveryGap       pending;        // from AIRecoveryRestartTasks, for the next read
+    AIRecoveryStats     stats;
+    double              recoveryTimeSum;
+};
+
+int AIRecoveryIsRecoverable(int32 error)
+{
+    return error==AIRecoveryOverwritten || error==AIRecoveryOnboardOverflow;
+}
+
+int32 AIRecoveryCreate(const TaskHandle tasks[], int numTasks, const AIRecoveryConfig *config, AIRecovery **recovery)
+{
+    AIRecovery  *r;
+
+    *recovery = NULL;
+    if( numTasks<1 || numTasks>AIRecoveryMaxTasks || config->rate<=0.0 ||
+        (config->method!=AIRecoveryResync && config->method!=AIRecoveryRestart) )
+        return AIRecoveryErrInvalidArg;
+    r = (AIRecovery*)calloc(1,sizeof(AIRecovery));
+    if( !r )
+        return AIRecoveryErrOutOfMemory;
+    r->cfg = *config;
+    memcpy(r->tasks,tasks,(size_t)numTasks*sizeof(TaskHandle));
+    r->numTasks = numTasks;
+    StreamMutexInit(&r->lock);
+    *recovery = r;
+    return 0;
+}
+
+void AIRecoveryClear(AIRecovery *recovery)
+{
+    if( !recovery )
+        return;
+    StreamMutexDestroy(&recovery->lock);
+    free(recovery);
+}
+
+// Adds a recovery to the statistics and to the gap a read returns.
+static void AddGap(AIRecovery *r, const AIRecoveryGap *g, AIRecoveryGap *gap)
+{
+    r->stats.recoveries++;
+    if( g->method==AIRecoveryResync )
+        r->stats.resyncs++;
+    else
+        r->stats.restarts++;
+    r->stats.samplesLost += (long long)g->numLost;
+    r->recoveryTimeSum += g->recoveryTime;
+    if( g->recoveryTime>r->stats.maxRecoveryTime )
+        r->stats.maxRecoveryTime = g->recoveryTime;
+    if( gap->numLost==0 && gap->error==0 )
+        *gap = *g;
+    else {
+        // Consecutive gaps with nothing read in between are one gap.
+        gap->numLost += g->numLost;
+        gap->exact = gap->exact && g->exact;
+        gap->recoveryTime += g->recoveryTime;
+    }
+}
+
+static int32 Resync(AIRecovery *r, int32 failed, double failTime, AIRecoveryGap *g)
+{
+    int32   error=0;
+    uInt64  acquired[AIRecoveryMaxTasks],readPos[AIRecoveryMaxTasks];
+    uInt64  target=r->position-r->base;
+    int     i;
+
+    for(i=0;i<r->numTasks;++i) {
+        DAQmxErrChk (DAQmxGetReadTotalSampPerChanAcquired(r->tasks[i],&acquired[i]));
+        DAQmxErrChk (DAQmxGetReadCurrReadPos(r->tasks[i],&readPos[i]));
+        if( acquired[i]>target )
+            target = acquired[i];
+    }
+    for(i=0;i<r->numTasks;++i)
+        if( target-readPos[i]>0x7FFFFFFF )
+            return AIRecoveryOverwritten;
+    for(i=0;i<r->numTasks;++i)
+        if( DAQmxFailed(error=DAQmxSetReadOffset(r->tasks[i],(int32)(target-readPos[i]))) ) {
+            // Put back the tasks already moved, for the restart.
+            while( --i>=0 )
+                DAQmxSetReadOffset(r->tasks[i],0);
+            goto Error;
+        }
+    r->offsetSet = 1;
+    g->firstSample = r->position;
+    g->numLost = target-(r->position-r->base);
+    g->error = failed;
+    g->method = AIRecoveryResync;
+    g->exact = 1;
+    g->recoveryTime = StreamTimeNow()-failTime;
+    r->position += g->numLost;
+
+Error:
+    return error;
+}
+
+static int32 Restart(AIRecovery *r, int32 failed, double failTime, AIRecoveryGap *g)
+{
+    int32   error=0;
+    uInt64  next=r->position-r->base,acquired=0;
+    double  acquiredTime;
+    int     i;
+
+    if( DAQmxFailed(DAQmxGetReadTotalSampPerChanAcquired(r->tasks[0],&acquired)) || acquired<next )
+        acquired = next;
+    acquiredTime = StreamTimeNow();
+
+    /*********************************************/
+    // DAQmx Stop Code
+    /*********************************************/
+    for(i=0;i<r->numTasks;++i)
+        DAQmxStopTask(r->tasks[i]);
+    if( r->offsetSet ) {
+        for(i=0;i<r->numTasks;++i)
+            DAQmxSetReadOffset(r->tasks[i],0);
+        r->offsetSet = 0;
+    }
+
+    /*********************************************/
+    // DAQmx Start Code
+    /*********************************************/
+    // The slaves are armed before the master so that they do not miss
+    // its start trigger.
+    for(i=r->numTasks-1;i>=0;--i)
+        DAQmxErrChk (DAQmxStartTask(r->tasks[i]));
+
+    g->firstSample = r->position;
+    g->numLost = acquired-next+(uInt64)llround((StreamTimeNow()-acquiredTime)*r->cfg.rate);
+    g->error = failed;
+    g->method = AIRecoveryRestart;
+    g->exact = 0;
+    g->recoveryTime = StreamTimeNow()-failTime;
+    r->position += g->numLost;
+    r->base = r->position;
+
+Error:
+    return error;
+}
+
+static int32 Recover(AIRecovery *r, int32 failed, double failTime, AIRecoveryGap *g)
+{
+    if( failed==AIRecoveryOverwritten && r->cfg.method==AIRecoveryResync && Resync(r,failed,failTime,g)==0 )
+        return 0;
+    return Restart(r,failed,failTime,g);
+}
+
+static int32 ReadAll(AIRecovery *r, int32 numSampsPerChan, float64 timeout, float64 *const data[], uInt32 arraySizeInSamps, int32 *read)
+{
+    int32   error=0;
+    int32   slaveRead;
+    int     i;
+
+    /*********************************************/
+    // DAQmx Read Code
+    /*********************************************/
+    for(i=0;i<r->numTasks;++i)
+        DAQmxErrChk (DAQmxReadAnalogF64(r->tasks[i],numSampsPerChan,timeout,DAQmx_Val_GroupByChannel,data[i],arraySizeInSamps,i==0 ? read : &slaveRead,NULL));
+    if( r->offsetSet ) {
+        for(i=0;i<r->numTasks;++i)
+            DAQmxErrChk (DAQmxSetReadOffset(r->tasks[i],0));
+        r->offsetSet = 0;
+    }
+
+Error:
+    return error;
+}
+
+int32 AIRecoveryRead(AIRecovery *recovery, int32 numSampsPerChan, float64 timeout, float64 *const data[], uInt32 arraySizeInSamps, int32 *sampsPerChanRead, AIRecoveryGap *gap)
+{
+    AIRecovery      *r=recovery;
+    AIRecoveryGap   noGap;
+    int32           error,read=0;
+    int             attempt;
+
+    if( !gap )
+        gap = &noGap;
+    memset(gap,0,sizeof(AIRecoveryGap));
+    StreamMutexLock(&r->lock);
+    if( r->pending.numLost>0 || r->pending.error ) {
+        *gap = r->pending;
+        memset(&r->pending,0,sizeof(AIRecoveryGap));
+    }
+    for(attempt=0;;++attempt) {
+        AIRecoveryGap g;
+
+        error = ReadAll(r,numSampsPerChan,timeout,data,arraySizeInSamps,&read);
+        if( !AIRecoveryIsRecoverable(error) || attempt==MAX_ATTEMPTS )
+            break;
+        if( r->cfg.maxRecoveries>0 && r->stats.recoveries>=r->cfg.maxRecoveries )
+            break;
+        memset(&g,0,sizeof(g));
+        if( DAQmxFailed(Recover(r,error,StreamTimeNow(),&g)) )
+            break;
+        AddGap(r,&g,gap);
+    }
+    if( !DAQmxFailed(error) )
+        r->position += (uInt64)read;
+    StreamMutexUnlock(&r->lock);
+    if( sampsPerChanRead )
+        *sampsPerChanRead = DAQmxFailed(error) ? 0 : read;
+    return error;
+}
+
+// Whether all the tasks are running, so that a failure reported for
+// them has been recovered from since.
+static int Running(AIRecovery *r)
+{
+    bool32  done;
+    int     i;
+
+    for(i=0;i<r->numTasks;++i)
+        if( DAQmxFailed(DAQmxIsTaskDone(r->tasks[i],&done)) || done )
+            return 0;
+    return 1;
+}
+
+int32 AIRecoveryRestartTasks(AIRecovery *recovery, int32 error, AIRecoveryGap *gap)
+{
+    AIRecoveryGap   g;
+    int32           status=0;
+
+    memset(&g,0,sizeof(g));
+    StreamMutexLock(&recovery->lock);
+    // AIRecoveryRead may have restarted the tasks for the same failure
+    // before the Done event got here.
+    if( !Running(recovery) )
+        status = Restart(recovery,error,StreamTimeNow(),&g);
+    if( !DAQmxFailed(status) && g.error )
+        AddGap(recovery,&g,&recovery->pending);
+    StreamMutexUnlock(&recovery->lock);
+    if( gap )
+        *gap = g;
+    return status;
+}
+
+void AIRecoveryGetStats(AIRecovery *recovery, AIRecoveryStats *stats)
+{
+    StreamMutexLock(&recovery->lock);
+    *stats = recovery->stats;
+    stats->meanRecoveryTime = stats->recoveries ? recovery->recoveryTimeSum/(double)stats->recoveries : 0.0;
+    stats->position = recovery->position;
+    StreamMutexUnlock(&recovery->lock);
+}
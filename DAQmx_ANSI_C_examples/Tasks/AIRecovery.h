@@ -0,0 +1,121 @@
+/*********************************************************************
+*
+* Task helper:
+*    AIRecovery.h
+*
+* Description:
+*    Reads continuous analog input tasks and recovers from buffer
+*    overflows instead of stopping, for acquisitions that run for
+*    hours and should not end on one transient stall of the reader.
+*
+*    The tasks are read together, block by block, as the callback in
+*    ContinuousAI.c reads its master and slave. The first task is the
+*    master; the others take their start trigger or clock from it.
+*    Samples are numbered in a stream index that starts at 0 with the
+*    first sample of the first start and continues across recoveries.
+*
+*    When a read fails because unread samples were overwritten
+*    (-200279), the tasks are recovered in one of two ways:
+*
+*    AIRecoveryResync   - the tasks keep running and the read position
+*                         of each is moved to the newest sample
+*                         acquired by any of them, through the Offset
+*                         read property. Nothing is stopped, so there
+*                         is no dead time and the number of samples
+*                         lost is exact.
+*    AIRecoveryRestart  - the tasks are stopped and started again,
+*                         each slave before the master so that no
+*                         slave misses the master's start trigger. The
+*                         samples lost are the ones not read before the
+*                         stop plus the time until the restart times
+*                         the rate, which is an estimate.
+*
+*    An onboard memory overflow (-200361) stops the acquisition on the
+*    device and is always recovered by a restart, as is a failed
+*    resync. The read that hit the error is retried after the
+*    recovery, so AIRecoveryRead still returns the block it was asked
+*    for, together with a gap record of the samples skipped before it.
+*    A consumer writes the gap into its stream, so nothing downstream
+*    mistakes data on either side of it for contiguous samples.
+*
+*    If the driver stops a task and calls its Done callback,
+*    AIRecoveryRestartTasks can be called from there. It does nothing
+*    if the tasks are running, because AIRecoveryRead has already
+*    restarted them for the same failure.
+*
+*********************************************************************/
+
+#ifndef AIRECOVERY_H
+#define AIRECOVERY_H
+
+#include <NIDAQmx.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define AIRecoveryErrInvalidArg     -1
+#define AIRecoveryErrOutOfMemory    -2
+
+#define AIRecoveryResync            0
+#define AIRecoveryRestart           1
+
+#define AIRecoveryOverwritten       -200279     // DAQmxErrorSamplesNoLongerAvailable
+#define AIRecoveryOnboardOverflow   -200361     // onboard device memory overflow
+
+#define AIRecoveryMaxTasks          16
+
+typedef struct AIRecoveryConfig {
+    int         method;         // for overwrite errors
+    float64     rate;           // the tasks' sample clock rate
+    int         maxRecoveries;  // then the error is returned, 0 for no limit
+} AIRecoveryConfig;
+
+// Samples per channel skipped in the stream before the block a read
+// returns. numLost is 0 if there was no gap.
+typedef struct AIRecoveryGap {
+    uInt64      firstSample;    // stream index of the first sample lost
+    uInt64      numLost;
+    int32       error;          // that caused the gap
+    int         method;         // how it was recovered
+    int         exact;          // 0 if numLost is estimated
+    double      recoveryTime;   // s from the failed read until the tasks were running again
+} AIRecoveryGap;
+
+typedef struct AIRecoveryStats {
+    long long   recoveries;
+    long long   resyncs;
+    long long   restarts;
+    long long   samplesLost;    // per channel
+    double      meanRecoveryTime;
+    double      maxRecoveryTime;
+    uInt64      position;       // stream index of the next sample
+} AIRecoveryStats;
+
+typedef struct AIRecovery AIRecovery;
+
+// tasks[0] is the master. The tasks must be configured for continuous
+// samples with the same rate, and not yet started or just started.
+int32 AIRecoveryCreate(const TaskHandle tasks[], int numTasks, const AIRecoveryConfig *config, AIRecovery **recovery);
+void  AIRecoveryClear(AIRecovery *recovery);
+
+// Reads numSampsPerChan samples of each task, task i into data[i],
+// GroupByChannel, recovering from overflows as configured. gap may
+// be NULL. Other errors are returned as they are.
+int32 AIRecoveryRead(AIRecovery *recovery, int32 numSampsPerChan, float64 timeout, float64 *const data[], uInt32 arraySizeInSamps, int32 *sampsPerChanRead, AIRecoveryGap *gap);
+
+// Restarts the tasks after error, e.g. from a Done callback, unless
+// they are all running. The gap is returned with the next read as
+// well; its error is 0 if the tasks were not restarted.
+int32 AIRecoveryRestartTasks(AIRecovery *recovery, int32 error, AIRecoveryGap *gap);
+
+// Whether error is one that AIRecoveryRead recovers from.
+int   AIRecoveryIsRecoverable(int32 error);
+
+void  AIRecoveryGetStats(AIRecovery *recovery, AIRecoveryStats *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
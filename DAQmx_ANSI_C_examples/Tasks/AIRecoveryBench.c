@@ -0,0 +1,301 @@
+/*********************************************************************
+*
+* Task benchmark:
+*    AIRecoveryBench.c
+*
+* Description:
+*    Injects faults into a synchronized master and slave acquisition
+*    on the simulated driver and measures how AIRecovery recovers.
+*
+*    Both tasks acquire 4 channels at 100 kHz into a 5000 sample
+*    buffer. The slave takes its start trigger from the master. An
+*    EveryN callback on the master reads 1000 samples of both with
+*    AIRecoveryRead. Every 100 ms one of four faults is injected in
+*    turn: the master's buffer is overwritten, the slave's buffer is
+*    overwritten, the slave's onboard memory overflows, or the
+*    callback stalls for 75 ms, longer than the buffer lasts.
+*
+*    The run is made once with each recovery method, then once more
+*    with restarts and a Done callback on both tasks, which the
+*    simulated driver calls on an onboard overflow as the real one
+*    does. Every other time the reader is held off until the callback
+*    has restarted the tasks. The other times the callback waits 20
+*    ms first, so that the read has already restarted the tasks and
+*    the callback must not restart them again.
+*
+*    For each kind of fault the number of recoveries, the mean
+*    samples lost per recovery and the mean and maximum recovery time
+*    are printed. The
+*    simulated driver returns each sample's index since the start of
+*    the task as its value, which the callback uses to check that
+*    the master and the slave stay aligned, and that the samples of
+*    consecutive blocks follow on from each other, or are exactly
+*    numLost apart after an exact gap record.
+*
+*    No DAQ hardware or driver is needed. Build with AIRecovery.c and
+*    SimDAQmx.c instead of the NI-DAQmx library.
+*
+*********************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include "AIRecovery.h"
+#include "SimDAQmx.h"
+#include "../Processing/StreamTime.h"
+
+#define DAQmxErrChk(functionCall) if( DAQmxFailed(error=(functionCall)) ) goto Error; else
+
+#define NUM_CHANS       4
+#define RATE            100000.0
+#define BUFFER_SIZE     5000
+#define EVERY_N         1000
+#define RUN_TIME        4.0
+#define FAULT_INTERVAL  0.1
+#define STALL_TIME      0.075
+#define DONE_DELAY      0.02
+
+enum { FaultMasterOverwrite, FaultSlaveOverwrite, FaultSlaveOnboard, FaultStall, NumFaults };
+
+static const char *faultNames[NumFaults]={"Master overwritten","Slave overwritten","Slave onboard overflow","Reader stall"};
+
+typedef struct FaultStats {
+    long long   count;
+    long long   lost;
+    double      timeSum;
+    double      timeMax;
+} FaultStats;
+
+typedef struct Bench {
+    AIRecovery      *recovery;
+    float64         master[NUM_CHANS*EVERY_N];
+    float64         slave[NUM_CHANS*EVERY_N];
+    volatile int    fault;          // the last fault injected
+    volatile int    stall;
+    volatile int    hold;           // reader to wait before its next read
+    volatile int    held;
+    volatile int    doneDelay;
+    int32           error;
+    long long       blocks;
+    long long       misaligned;
+    long long       discontinuities;
+    long long       lastIndex;      // task sample index of the last sample read, or -1
+    FaultStats      faults[NumFaults];
+    long long       doneEvents;
+    long long       doneRestarts;   // by the Done callback
+    long long       doneSkipped;    // already restarted by the read
+} Bench;
+
+static long long SampleIndex(float64 value)
+{
+    return llround(1e3*value);
+}
+
+static int32 CVICALLBACK EveryNCallback(TaskHandle taskHandle, int32 everyNsamplesEventType, uInt32 nSamples, void *callbackData)
+{
+    Bench           *b=(Bench*)callbackData;
+    float64         *data[2]={b->master,b->slave};
+    AIRecoveryGap   gap;
+    int32           error,read=0;
+    long long       first;
+    bool32          done;
+
+    if( b->stall ) {
+        b->stall = 0;
+        StreamSleep(STALL_TIME);
+    }
+    // Holding off ends when the restart stops this task, which waits
+    // for this callback to return.
+    while( b->hold && !DAQmxFailed(DAQmxIsTaskDone(taskHandle,&done)) && !done ) {
+        b->held = 1;
+        StreamSleep(0.0005);
+    }
+    b->held = 0;
+    if( b->hold )
+        return 0;
+    error = AIRecoveryRead(b->recovery,EVERY_N,1.0,data,NUM_CHANS*EVERY_N,&read,&gap);
+    if( DAQmxFailed(error) ) {
+        if( !b->error )
+            b->error = error;
+        return 0;
+    }
+    first = SampleIndex(b->master[0]);
+    if( first!=SampleIndex(b->slave[0]) || SampleIndex(b->master[read-1])!=SampleIndex(b->slave[read-1]) )
+        b->misaligned++;
+    if( gap.numLost>0 ) {
+        FaultStats *f=&b->faults[b->fault];
+
+        f->count++;
+        f->lost += (long long)gap.numLost;
+        f->timeSum += gap.recoveryTime;
+        if( gap.recoveryTime>f->timeMax )
+            f->timeMax = gap.recoveryTime;
+    }
+    // After a restart the tasks count from 0 again.
+    if( b->lastIndex>=0 ) {
+        long long expected=gap.numLost==0 ? b->lastIndex+1 : gap.exact ? b->lastIndex+1+(long long)gap.numLost : 0;
+
+        if( first!=expected )
+            b->discontinuities++;
+    }
+    b->lastIndex = SampleIndex(b->master[read-1]);
+    b->blocks++;
+    return 0;
+}
+
+static int32 CVICALLBACK DoneCallback(TaskHandle taskHandle, int32 status, void *callbackData)
+{
+    Bench           *b=(Bench*)callbackData;
+    AIRecoveryGap   gap;
+
+    if( !AIRecoveryIsRecoverable(status) )
+        return 0;
+    b->doneEvents++;
+    if( b->doneDelay )
+        StreamSleep(DONE_DELAY);
+    if( DAQmxFailed(AIRecoveryRestartTasks(b->recovery,status,&gap)) )
+        b->error = status;
+    else if( gap.error )
+        b->doneRestarts++;
+    else
+        b->doneSkipped++;
+    return 0;
+}
+
+static int32 Configure(TaskHandle taskHandle, const char channels[], const char trigger[])
+{
+    int32   error=0;
+
+    DAQmxErrChk (DAQmxCreateAIVoltageChan(taskHandle,channels,"",DAQmx_Val_Cfg_Default,-10.0,10.0,DAQmx_Val_Volts,NULL));
+    DAQmxErrChk (DAQmxCfgSampClkTiming(taskHandle,"",RATE,DAQmx_Val_Rising,DAQmx_Val_ContSamps,EVERY_N));
+    DAQmxErrChk (DAQmxCfgInputBuffer(taskHandle,BUFFER_SIZE));
+    if( trigger ) {
+        DAQmxErrChk (DAQmxCfgDigEdgeStartTrig(taskHandle,trigger,DAQmx_Val_Rising));
+    }
+
+Error:
+    return error;
+}
+
+static int32 Run(int method, int useDone, Bench *b)
+{
+    int32               error=0;
+    TaskHandle          tasks[2]={0,0};
+    AIRecoveryConfig    cfg={0};
+    AIRecoveryStats     stats;
+    double              t0,nextFault,until;
+    int                 k=0,i;
+
+    memset(b,0,sizeof(Bench));
+    b->lastIndex = -1;
+
+    /*********************************************/
+    // DAQmx Configure Code
+    /*********************************************/
+    DAQmxErrChk (DAQmxCreateTask("",&tasks[0]));
+    DAQmxErrChk (Configure(tasks[0],"PXI1Slot2/ai0:3",NULL));
+    DAQmxErrChk (DAQmxCreateTask("",&tasks[1]));
+    DAQmxErrChk (Configure(tasks[1],"PXI1Slot3/ai0:3","/PXI1Slot2/ai/StartTrigger"));
+    cfg.method = method;
+    cfg.rate = RATE;
+    DAQmxErrChk (AIRecoveryCreate(tasks,2,&cfg,&b->recovery));
+    DAQmxErrChk (DAQmxRegisterEveryNSamplesEvent(tasks[0],DAQmx_Val_Acquired_Into_Buffer,EVERY_N,0,EveryNCallback,b));
+    if( useDone ) {
+        DAQmxErrChk (DAQmxRegisterDoneEvent(tasks[0],0,DoneCallback,b));
+        DAQmxErrChk (DAQmxRegisterDoneEvent(tasks[1],0,DoneCallback,b));
+    }
+
+    /*********************************************/
+    // DAQmx Start Code
+    /*********************************************/
+    DAQmxErrChk (DAQmxStartTask(tasks[1]));
+    DAQmxErrChk (DAQmxStartTask(tasks[0]));
+
+    t0 = StreamTimeNow();
+    nextFault = t0+FAULT_INTERVAL;
+    while( StreamTimeNow()-t0<RUN_TIME && !b->error ) {
+        StreamSleep(0.001);
+        if( StreamTimeNow()<nextFault )
+            continue;
+        nextFault += FAULT_INTERVAL;
+        b->fault = k%NumFaults;
+        switch( b->fault ) {
+            case FaultMasterOverwrite:
+                SimDAQmxInjectFault(tasks[0],SimDAQmxErrOverwritten);
+                break;
+            case FaultSlaveOverwrite:
+                SimDAQmxInjectFault(tasks[1],SimDAQmxErrOverwritten);
+                break;
+            case FaultSlaveOnboard:
+                b->doneDelay = k/NumFaults%2;
+                if( useDone && !b->doneDelay ) {
+                    // Let the Done callback get to the tasks first.
+                    b->hold = 1;
+                    for(until=StreamTimeNow()+0.1;!b->held && StreamTimeNow()<until;)
+                        StreamSleep(0.0005);
+                }
+                SimDAQmxInjectFault(tasks[1],SimDAQmxErrOnboardOverflow);
+                b->hold = 0;
+                break;
+            case FaultStall:
+                b->stall = 1;
+                break;
+        }
+        ++k;
+    }
+    error = b->error;
+
+    printf("\n%s%s: %lld blocks, %d faults\n",method==AIRecoveryResync ? "Resync" : "Restart",useDone ? " with Done callback" : "",b->blocks,k);
+    printf("%-26s%12s%14s%14s%14s\n","Fault","Recoveries","Lost/recovery","Mean (us)","Max (us)");
+    for(i=0;i<NumFaults;++i) {
+        FaultStats *f=&b->faults[i];
+
+        printf("%-26s%12lld%14.0f%14.1f%14.1f\n",faultNames[i],f->count,f->count ? (double)f->lost/f->count : 0.0,
+               f->count ? 1e6*f->timeSum/f->count : 0.0,1e6*f->timeMax);
+    }
+    AIRecoveryGetStats(b->recovery,&stats);
+    printf("Total: %lld recoveries (%lld resyncs, %lld restarts), %lld samples lost, %.1f%% of %.0f\n",
+           stats.recoveries,stats.resyncs,stats.restarts,stats.samplesLost,
+           100.0*(double)stats.samplesLost/(double)stats.position,(double)stats.position);
+    printf("Blocks misaligned between master and slave: %lld, discontinuities not covered by a gap: %lld\n",
+           b->misaligned,b->discontinuities);
+    if( useDone )
+        printf("Done events: %lld, restarts by the callback: %lld, skipped as already restarted: %lld\n",
+               b->doneEvents,b->doneRestarts,b->doneSkipped);
+
+Error:
+    if( tasks[0] ) {
+        DAQmxStopTask(tasks[0]);
+        DAQmxClearTask(tasks[0]);
+    }
+    if( tasks[1] ) {
+        DAQmxStopTask(tasks[1]);
+        DAQmxClearTask(tasks[1]);
+    }
+    AIRecoveryClear(b->recovery);
+    return error;
+}
+
+static Bench bench;
+
+int main(void)
+{
+    int32           error=0;
+    char            errBuff[2048]={'\0'};
+    SimDAQmxSystem  sys={0,0,2,0.0};
+
+    SimDAQmxSetSystem(&sys);
+    printf("2 tasks, %d channels each, %.0f kHz, %d sample buffer, %d sample blocks, a fault every %.0f ms\n",
+           NUM_CHANS,1e-3*RATE,BUFFER_SIZE,EVERY_N,1e3*FAULT_INTERVAL);
+    DAQmxErrChk (Run(AIRecoveryResync,0,&bench));
+    DAQmxErrChk (Run(AIRecoveryRestart,0,&bench));
+    DAQmxErrChk (Run(AIRecoveryRestart,1,&bench));
+
+Error:
+    if( DAQmxFailed(error) ) {
+        DAQmxGetExtendedErrorInfo(errBuff,2048);
+        printf("DAQmx Error %d: %s\n",(int)error,errBuff);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,420 @@
+/*********************************************************************
+*
+* Task helper:
+*    AOSequencer.c
+*
+* Description:
+*    Implementation of the retriggered AO segment sequencer. See
+*    AOSequencer.h for the calling conventions.
+*
+*    Position k in the sequence is staged into slot k%prefetchSegments
+*    of the staging ring and written into the device buffer after
+*    position k-1. The prefetch thread stays at most prefetchSegments
+*    ahead of the writer. If the writer finds position k not yet
+*    staged it stages it itself and counts the segment as late.
+*
+*    Transferred_From_Buffer events come in a burst while the device
+*    FIFO fills, so their spacing is not that of the triggers. The
+*    callback therefore also reads the number of samples generated
+*    and times the segments by when that count has moved on.
+*
+*********************************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+#include "AOSequencer.h"
+#include "../Processing/StreamTime.h"
+#include "../Processing/StreamThread.h"
+
+#define DAQmxErrChk(functionCall) if( DAQmxFailed(error=(functionCall)) ) goto Error; else
+
+struct AOSequencer {
+    AOSequencerConfig   cfg;
+    TaskHandle          aoTask;
+    TaskHandle          coTask;
+    uInt32              numChans;
+
+    const float64       *const *segments;
+    const int           *lengths;
+    int                 numSegments;
+    int                 *order;
+    int                 orderLength;
+    int                 loop;
+
+    float64             *staging;       // prefetchSegments slots of numChans*segmentLength
+    float64             *scratch;       // one slot for late segments
+    long long           nextToStage;
+    long long           nextToWrite;
+
+    StreamMutex         lock;
+    StreamCond          changed;
+    StreamThread        prefetcher;
+    int                 prefetchRunning;
+    int                 stop;
+    int32               asyncError;
+
+    long long           lateSegments;
+    double              startTime;
+    long long           lastPlayed;     // segments generated when last seen, under lock
+    double              lastPlayedTime;
+    double              minInterval;
+};
+
+static int32 CVICALLBACK SegmentConsumedCallback(TaskHandle taskHandle, int32 everyNsamplesEventType, uInt32 nSamples, void *callbackData);
+static int32 CVICALLBACK SequencerDoneCallback(TaskHandle taskHandle, int32 status, void *callbackData);
+static STREAM_THREAD_PROC(PrefetchThread,arg);
+
+// Index of the segment played at sequence position k. Past the end of a
+// non-looping sequence the last segment's final value is held, which is
+// signalled by -1.
+static int SegmentAt(const AOSequencer *s, long long k)
+{
+    if( s->orderLength==0 )
+        return -1;
+    if( s->loop )
+        return s->order[k%s->orderLength];
+    return k<s->orderLength ? s->order[k] : -1;
+}
+
+static void StageSegment(const AOSequencer *s, long long k, float64 slot[])
+{
+    int         segLen=s->cfg.segmentLength;
+    int         seg=SegmentAt(s,k);
+    uInt32      c;
+    int         i,len;
+
+    if( seg<0 ) {
+        // Hold the final value of the last segment in the sequence.
+        int last=s->orderLength>0 ? s->order[s->orderLength-1] : -1;
+
+        for(c=0;c<s->numChans;++c) {
+            float64 v=last>=0 && s->lengths[last]>0 ? s->segments[last][(size_t)c*s->lengths[last]+s->lengths[last]-1] : 0.0;
+
+            for(i=0;i<segLen;++i)
+                slot[(size_t)c*segLen+i] = v;
+        }
+        return;
+    }
+    len = s->lengths[seg];
+    for(c=0;c<s->numChans;++c) {
+        const float64   *src=s->segments[seg]+(size_t)c*len;
+        float64         *dst=slot+(size_t)c*segLen;
+
+        memcpy(dst,src,len*sizeof(float64));
+        for(i=len;i<segLen;++i)
+            dst[i] = len>0 ? src[len-1] : 0.0;
+    }
+}
+
+// Writes sequence position nextToWrite into the device buffer.
+static int32 WriteNextSegment(AOSequencer *s)
+{
+    int32           error=0;
+    int32           written;
+    size_t          slotSize=(size_t)s->numChans*s->cfg.segmentLength;
+    const float64   *data;
+    long long       k;
+
+    StreamMutexLock(&s->lock);
+    k = s->nextToWrite;
+    if( k<s->nextToStage )
+        data = s->staging+(k%s->cfg.prefetchSegments)*slotSize;
+    else {
+        // The prefetch thread fell behind. Stage this one here and let
+        // the thread skip it.
+        ++s->lateSegments;
+        StageSegment(s,k,s->scratch);
+        data = s->scratch;
+        s->nextToStage = k+1;
+    }
+    StreamMutexUnlock(&s->lock);
+
+    /*********************************************/
+    // DAQmx Write Code
+    /*********************************************/
+    // The slot is not restaged until nextToWrite has moved past it.
+    DAQmxErrChk (DAQmxWriteAnalogF64(s->aoTask,s->cfg.segmentLength,0,10.0,DAQmx_Val_GroupByChannel,data,&written,NULL));
+
+    StreamMutexLock(&s->lock);
+    s->nextToWrite = k+1;
+    StreamCondBroadcast(&s->changed);
+    StreamMutexUnlock(&s->lock);
+
+Error:
+    return error;
+}
+
+int32 AOSequencerCreate(const AOSequencerConfig *config, AOSequencer **sequencer)
+{
+    int32       error=0;
+    AOSequencer *s;
+    size_t      slotSize;
+
+    *sequencer = NULL;
+    if( config->segmentLength<2 || config->bufferSegments<2 || config->prefetchSegments<1 || config->rate<=0.0 )
+        return AOSequencerErrInvalidArg;
+    s = (AOSequencer*)calloc(1,sizeof(AOSequencer));
+    if( !s )
+        return AOSequencerErrOutOfMemory;
+    s->cfg = *config;
+    StreamMutexInit(&s->lock);
+    StreamCondInit(&s->changed);
+
+    /*********************************************/
+    // DAQmx Configure Code
+    /*********************************************/
+    // The counter emits segmentLength pulses per trigger and is rearmed
+    // by the next trigger.
+    DAQmxErrChk (DAQmxCreateTask("",&s->coTask));
+    DAQmxErrChk (DAQmxCreateCOPulseChanFreq(s->coTask,config->counter,"",DAQmx_Val_Hz,DAQmx_Val_Low,0.0,config->rate,0.5));
+    DAQmxErrChk (DAQmxCfgImplicitTiming(s->coTask,DAQmx_Val_FiniteSamps,config->segmentLength));
+    DAQmxErrChk (DAQmxCfgDigEdgeStartTrig(s->coTask,config->triggerSource,DAQmx_Val_Rising));
+    DAQmxErrChk (DAQmxSetStartTrigRetriggerable(s->coTask,1));
+
+    // The AO task runs continuously on the counter output, so it only
+    // advances while a segment is being played.
+    DAQmxErrChk (DAQmxCreateTask("",&s->aoTask));
+    DAQmxErrChk (DAQmxCreateAOVoltageChan(s->aoTask,config->aoChannels,"",config->minVal,config->maxVal,DAQmx_Val_Volts,NULL));
+    DAQmxErrChk (DAQmxCfgSampClkTiming(s->aoTask,config->counterOutput,config->rate,DAQmx_Val_Rising,DAQmx_Val_ContSamps,(uInt64)config->segmentLength*config->bufferSegments));
+    DAQmxErrChk (DAQmxCfgOutputBuffer(s->aoTask,(uInt32)config->segmentLength*config->bufferSegments));
+    DAQmxErrChk (DAQmxSetWriteRegenMode(s->aoTask,DAQmx_Val_DoNotAllowRegen));
+    DAQmxErrChk (DAQmxGetTaskNumChans(s->aoTask,&s->numChans));
+
+    DAQmxErrChk (DAQmxRegisterEveryNSamplesEvent(s->aoTask,DAQmx_Val_Transferred_From_Buffer,config->segmentLength,0,SegmentConsumedCallback,s));
+    DAQmxErrChk (DAQmxRegisterDoneEvent(s->aoTask,0,SequencerDoneCallback,s));
+
+    slotSize = (size_t)s->numChans*config->segmentLength;
+    s->staging = (float64*)malloc(config->prefetchSegments*slotSize*sizeof(float64));
+    s->scratch = (float64*)malloc(slotSize*sizeof(float64));
+    if( !s->staging || !s->scratch ) {
+        error = AOSequencerErrOutOfMemory;
+        goto Error;
+    }
+    *sequencer = s;
+    return 0;
+
+Error:
+    AOSequencerClear(s);
+    return error;
+}
+
+void AOSequencerClear(AOSequencer *sequencer)
+{
+    if( !sequencer )
+        return;
+    AOSequencerStop(sequencer);
+    if( sequencer->coTask )
+        DAQmxClearTask(sequencer->coTask);
+    if( sequencer->aoTask )
+        DAQmxClearTask(sequencer->aoTask);
+    StreamCondDestroy(&sequencer->changed);
+    StreamMutexDestroy(&sequencer->lock);
+    free(sequencer->order);
+    free(sequencer->staging);
+    free(sequencer->scratch);
+    free(sequencer);
+}
+
+int AOSequencerSetSegments(AOSequencer *sequencer, const float64 *const segments[], const int lengths[], int numSegments)
+{
+    int i;
+
+    if( sequencer->prefetchRunning || numSegments<1 )
+        return AOSequencerErrInvalidArg;
+    for(i=0;i<numSegments;++i)
+        if( lengths[i]<0 || lengths[i]>sequencer->cfg.segmentLength || (lengths[i]>0 && !segments[i]) )
+            return AOSequencerErrInvalidArg;
+    sequencer->segments = segments;
+    sequencer->lengths = lengths;
+    sequencer->numSegments = numSegments;
+    sequencer->orderLength = 0;
+    return 0;
+}
+
+int AOSequencerSetSequence(AOSequencer *sequencer, const int order[], int length, int loop)
+{
+    int *copy;
+    int i;
+
+    if( sequencer->prefetchRunning || length<1 )
+        return AOSequencerErrInvalidArg;
+    for(i=0;i<length;++i)
+        if( order[i]<0 || order[i]>=sequencer->numSegments )
+            return AOSequencerErrInvalidArg;
+    copy = (int*)malloc(length*sizeof(int));
+    if( !copy )
+        return AOSequencerErrOutOfMemory;
+    memcpy(copy,order,length*sizeof(int));
+    free(sequencer->order);
+    sequencer->order = copy;
+    sequencer->orderLength = length;
+    sequencer->loop = loop;
+    return 0;
+}
+
+int32 AOSequencerStart(AOSequencer *sequencer)
+{
+    int32       error=0;
+    int         i;
+
+    if( sequencer->prefetchRunning || sequencer->orderLength==0 )
+        return AOSequencerErrInvalidArg;
+    sequencer->nextToStage = 0;
+    sequencer->nextToWrite = 0;
+    sequencer->stop = 0;
+    sequencer->asyncError = 0;
+    sequencer->lateSegments = 0;
+    sequencer->lastPlayed = 0;
+    sequencer->lastPlayedTime = -1.0;
+    sequencer->minInterval = 1e30;
+
+    // Fill the whole device buffer before the first trigger. These
+    // initial writes are not late, so they stage their own data.
+    for(i=0;i<sequencer->cfg.bufferSegments;++i) {
+        StageSegment(sequencer,i,sequencer->staging+(i%sequencer->cfg.prefetchSegments)*(size_t)sequencer->numChans*sequencer->cfg.segmentLength);
+        sequencer->nextToStage = i+1;
+        DAQmxErrChk (WriteNextSegment(sequencer));
+    }
+
+    if( StreamThreadCreate(&sequencer->prefetcher,PrefetchThread,sequencer)!=0 ) {
+        error = AOSequencerErrThread;
+        goto Error;
+    }
+    sequencer->prefetchRunning = 1;
+
+    /*********************************************/
+    // DAQmx Start Code
+    /*********************************************/
+    // Start the AO task first so that it is armed before the counter
+    // produces its first clock edge.
+    DAQmxErrChk (DAQmxStartTask(sequencer->aoTask));
+    DAQmxErrChk (DAQmxStartTask(sequencer->coTask));
+    sequencer->startTime = StreamTimeNow();
+    return 0;
+
+Error:
+    AOSequencerStop(sequencer);
+    return error;
+}
+
+int32 AOSequencerStop(AOSequencer *sequencer)
+{
+    int32   error;
+
+    /*********************************************/
+    // DAQmx Stop Code
+    /*********************************************/
+    // Stopping the counter first leaves the AO output at the last
+    // value played.
+    if( sequencer->coTask )
+        DAQmxStopTask(sequencer->coTask);
+    if( sequencer->aoTask )
+        DAQmxStopTask(sequencer->aoTask);
+
+    if( sequencer->prefetchRunning ) {
+        StreamMutexLock(&sequencer->lock);
+        sequencer->stop = 1;
+        StreamCondBroadcast(&sequencer->changed);
+        StreamMutexUnlock(&sequencer->lock);
+        StreamThreadJoin(sequencer->prefetcher);
+        sequencer->prefetchRunning = 0;
+    }
+    error = sequencer->asyncError;
+    sequencer->asyncError = 0;
+    return error;
+}
+
+void AOSequencerGetStats(AOSequencer *sequencer, AOSequencerStats *stats)
+{
+    uInt64  generated=0;
+    double  elapsed;
+
+    memset(stats,0,sizeof(AOSequencerStats));
+    if( sequencer->aoTask )
+        DAQmxGetWriteTotalSampPerChanGenerated(sequencer->aoTask,&generated);
+
+    StreamMutexLock(&sequencer->lock);
+    stats->segmentsWritten = sequencer->nextToWrite;
+    stats->lateSegments = sequencer->lateSegments;
+    stats->minInterval = sequencer->minInterval<1e30 ? sequencer->minInterval : 0.0;
+    StreamMutexUnlock(&sequencer->lock);
+
+    stats->segmentsPlayed = (long long)(generated/(uInt64)sequencer->cfg.segmentLength);
+    elapsed = sequencer->startTime>0.0 ? StreamTimeNow()-sequencer->startTime : 0.0;
+    stats->segmentsPerSec = elapsed>0.0 ? stats->segmentsPlayed/elapsed : 0.0;
+    stats->segmentDuration = sequencer->cfg.segmentLength/sequencer->cfg.rate;
+}
+
+static int32 CVICALLBACK SegmentConsumedCallback(TaskHandle taskHandle, int32 everyNsamplesEventType, uInt32 nSamples, void *callbackData)
+{
+    AOSequencer *s=(AOSequencer*)callbackData;
+    int32       error=0;
+    uInt64      generated;
+    long long   played;
+    double      now;
+
+    // One segment has left the buffer, so one slot is free.
+    DAQmxErrChk (WriteNextSegment(s));
+
+    // Segments played so far. Where more than one was played since the
+    // last callback only their mean interval is known.
+    DAQmxErrChk (DAQmxGetWriteTotalSampPerChanGenerated(taskHandle,&generated));
+    now = StreamTimeNow();
+    played = (long long)(generated/(uInt64)s->cfg.segmentLength);
+    StreamMutexLock(&s->lock);
+    if( played>s->lastPlayed ) {
+        if( s->lastPlayedTime>=0.0 && (now-s->lastPlayedTime)/(played-s->lastPlayed)<s->minInterval )
+            s->minInterval = (now-s->lastPlayedTime)/(played-s->lastPlayed);
+        s->lastPlayed = played;
+        s->lastPlayedTime = now;
+    }
+    StreamMutexUnlock(&s->lock);
+
+Error:
+    if( DAQmxFailed(error) && !s->asyncError )
+        s->asyncError = error;
+    return 0;
+}
+
+static int32 CVICALLBACK SequencerDoneCallback(TaskHandle taskHandle, int32 status, void *callbackData)
+{
+    AOSequencer *s=(AOSequencer*)callbackData;
+
+    // A non-regenerating task stops itself on underflow, i.e. when a
+    // trigger arrived before its segment was written.
+    if( DAQmxFailed(status) && !s->asyncError )
+        s->asyncError = status;
+    return 0;
+}
+
+static STREAM_THREAD_PROC(PrefetchThread,arg)
+{
+    AOSequencer *s=(AOSequencer*)arg;
+    size_t      slotSize=(size_t)s->numChans*s->cfg.segmentLength;
+
+    for(;;) {
+        long long k;
+
+        StreamMutexLock(&s->lock);
+        while( !s->stop && s->nextToStage-s->nextToWrite>=s->cfg.prefetchSegments )
+            StreamCondWait(&s->changed,&s->lock);
+        if( s->stop ) {
+            StreamMutexUnlock(&s->lock);
+            break;
+        }
+        k = s->nextToStage;
+        StreamMutexUnlock(&s->lock);
+
+        // Slot k%prefetchSegments held position k-prefetchSegments, which
+        // has already been written.
+        StageSegment(s,k,s->staging+(k%s->cfg.prefetchSegments)*slotSize);
+
+        StreamMutexLock(&s->lock);
+        // The writer may have staged k itself in the meantime.
+        if( s->nextToStage==k )
+            s->nextToStage = k+1;
+        StreamCondBroadcast(&s->changed);
+        StreamMutexUnlock(&s->lock);
+    }
+    return 0;
+}
@@ -0,0 +1,86 @@
+/*********************************************************************
+*
+* Task helper:
+*    AOSequencer.h
+*
+* Description:
+*    Plays a different waveform segment on every trigger without
+*    stopping the task. MultVoltUpdates-IntClk-Retrig.c replays the
+*    same buffer on every PFI0 edge. Here a retriggerable finite
+*    counter pulse train produces exactly segmentLength sample clocks
+*    per trigger. Those clocks drive a continuous, non-regenerating AO
+*    task, so trigger k consumes the k-th segment that was written.
+*
+*    The output buffer holds bufferSegments slots of segmentLength
+*    samples. Each time a slot has been transferred to the device the
+*    EveryN callback writes the next segment of the sequence into it.
+*    A prefetch thread copies upcoming segments from host memory into
+*    a staging ring, padding short segments by holding their last
+*    value. The callback therefore only has to write.
+*
+*    A segment is counted as late when its slot became free but it had
+*    not been staged. Sustained segments/s and the shortest interval
+*    between two triggers are reported as well. The interval is taken
+*    from the samples generated as seen by the EveryN callback, so it
+*    includes the jitter of the callback.
+*
+*********************************************************************/
+
+#ifndef AOSEQUENCER_H
+#define AOSEQUENCER_H
+
+#include <NIDAQmx.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define AOSequencerErrInvalidArg    -1
+#define AOSequencerErrOutOfMemory   -2
+#define AOSequencerErrThread        -3
+
+typedef struct AOSequencerConfig {
+    char        aoChannels[256];        // e.g. "Dev1/ao0:1"
+    float64     minVal;
+    float64     maxVal;
+    char        counter[256];           // e.g. "Dev1/ctr0"
+    char        counterOutput[256];     // e.g. "/Dev1/Ctr0InternalOutput"
+    char        triggerSource[256];     // e.g. "/Dev1/PFI0"
+    float64     rate;
+    int         segmentLength;          // samples per channel played per trigger
+    int         bufferSegments;         // slots in the device buffer
+    int         prefetchSegments;       // slots in the host staging ring
+} AOSequencerConfig;
+
+typedef struct AOSequencerStats {
+    long long   segmentsWritten;
+    long long   segmentsPlayed;
+    long long   lateSegments;
+    double      segmentsPerSec;
+    double      minInterval;            // shortest seen gap between triggers, s
+    double      segmentDuration;        // segmentLength/rate, the lower bound of minInterval
+} AOSequencerStats;
+
+typedef struct AOSequencer AOSequencer;
+
+int32 AOSequencerCreate(const AOSequencerConfig *config, AOSequencer **sequencer);
+void  AOSequencerClear(AOSequencer *sequencer);
+
+// Registers the segments. Segment i holds lengths[i]<=segmentLength
+// samples for each channel, GroupByChannel. The data are not copied
+// and must stay valid while the sequencer runs.
+int   AOSequencerSetSegments(AOSequencer *sequencer, const float64 *const segments[], const int lengths[], int numSegments);
+
+// Trigger k plays segment order[k]. With loop set the order repeats.
+int   AOSequencerSetSequence(AOSequencer *sequencer, const int order[], int length, int loop);
+
+int32 AOSequencerStart(AOSequencer *sequencer);
+int32 AOSequencerStop(AOSequencer *sequencer);
+
+void  AOSequencerGetStats(AOSequencer *sequencer, AOSequencerStats *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
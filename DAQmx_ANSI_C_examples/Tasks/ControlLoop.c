@@ -0,0 +1,244 @@
+/*********************************************************************
+*
+* Task helper:
+*    ControlLoop.c
+*
+* Description:
+*    Implementation of the hardware-timed single point control loop.
+*    See ControlLoop.h for the calling conventions.
+*
+*    The loop thread owns the statistics while it runs and publishes
+*    a copy under the mutex every PUBLISH_EVERY iterations and when
+*    it ends, so ControlLoopGetStats never holds up an iteration for
+*    longer than the copy.
+*
+*********************************************************************/
+
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE     // for pthread_setaffinity_np
+#endif
+
+#include <stdlib.h>
+#include <string.h>
+#include "ControlLoop.h"
+#include "DevTopology.h"
+#include "../Processing/PIDControl.h"
+#include "../Processing/StreamTime.h"
+#include "../Processing/StreamThread.h"
+
+#define DAQmxErrChk(functionCall) if( DAQmxFailed(error=(functionCall)) ) goto Error; else
+
+#define PUBLISH_EVERY   1024
+
+struct ControlLoop {
+    ControlLoopConfig   cfg;
+    TaskHandle          aiTask;
+    TaskHandle          aoTask;
+    uInt32              numIn;
+    uInt32              numOut;
+    ControlLoopStep     step;
+    void                *stepData;
+    float64             *in;
+    float64             *out;
+
+    StreamThread        thread;
+    int                 threadRunning;
+    int                 tasksRunning;
+    volatile int        stop;
+    int32               asyncError;
+
+    StreamMutex         lock;
+    ControlLoopStats    published;
+};
+
+static void Publish(ControlLoop *l, const ControlLoopStats *stats, double firstClock, double lastClock)
+{
+    StreamMutexLock(&l->lock);
+    l->published = *stats;
+    if( stats->iterations>1 && lastClock>firstClock )
+        l->published.loopRate = (stats->iterations-1)/(lastClock-firstClock);
+    StreamMutexUnlock(&l->lock);
+}
+
+static STREAM_THREAD_PROC(LoopThread,arg)
+{
+    ControlLoop         *l=(ControlLoop*)arg;
+    int32               error=0;
+    ControlLoopStats    s;
+    double              t0,t1,t2,t3,firstClock=0.0,prevClock=0.0;
+    bool32              isLate;
+    int32               read;
+
+    memset(&s,0,sizeof(s));
+    if( l->cfg.cpu>=0 )
+        StreamThreadPinCurrent(l->cfg.cpu);
+    StreamThreadRaisePriority();
+    while( !l->stop && (l->cfg.iterations==0 || s.iterations<l->cfg.iterations) ) {
+        isLate = 0;
+        // A late tick comes back as a warning, see ControlLoopCreate.
+        DAQmxErrChk (DAQmxWaitForNextSampleClock(l->aiTask,l->cfg.timeout,&isLate));
+        error = 0;
+        t0 = StreamTimeNow();
+        DAQmxErrChk (DAQmxReadAnalogF64(l->aiTask,1,l->cfg.timeout,DAQmx_Val_GroupByScanNumber,l->in,l->numIn,&read,NULL));
+        t1 = StreamTimeNow();
+        if( l->step(l->in,l->numIn,l->out,l->numOut,l->stepData) )
+            l->stop = 1;
+        t2 = StreamTimeNow();
+        DAQmxErrChk (DAQmxWriteAnalogF64(l->aoTask,1,0,l->cfg.timeout,DAQmx_Val_GroupByScanNumber,l->out,NULL,NULL));
+        t3 = StreamTimeNow();
+
+        if( isLate )
+            s.lateIterations++;
+        if( s.iterations==0 )
+            firstClock = t0;
+        else
+            LatencyHistAdd(&s.period,t0-prevClock);
+        prevClock = t0;
+        LatencyHistAdd(&s.input,t1-t0);
+        LatencyHistAdd(&s.compute,t2-t1);
+        LatencyHistAdd(&s.output,t3-t2);
+        LatencyHistAdd(&s.total,t3-t0);
+        if( ++s.iterations%PUBLISH_EVERY==0 )
+            Publish(l,&s,firstClock,prevClock);
+    }
+
+Error:
+    Publish(l,&s,firstClock,prevClock);
+    if( DAQmxFailed(error) )
+        l->asyncError = error;
+    return 0;
+}
+
+int32 ControlLoopCreate(TaskHandle aiTask, TaskHandle aoTask, const ControlLoopConfig *config, ControlLoopStep step, void *stepData, ControlLoop **loop)
+{
+    int32       error=0;
+    ControlLoop *l;
+    char        clockName[256];
+
+    *loop = NULL;
+    if( !step || config->rate<=0.0 || config->iterations<0 || config->timeout<=0.0 )
+        return ControlLoopErrInvalidArg;
+    l = (ControlLoop*)calloc(1,sizeof(ControlLoop));
+    if( !l )
+        return ControlLoopErrOutOfMemory;
+    l->cfg = *config;
+    l->aiTask = aiTask;
+    l->aoTask = aoTask;
+    l->step = step;
+    l->stepData = stepData;
+    StreamMutexInit(&l->lock);
+
+    /*********************************************/
+    // DAQmx Configure Code
+    /*********************************************/
+    DAQmxErrChk (DAQmxGetTaskNumChans(aiTask,&l->numIn));
+    DAQmxErrChk (DAQmxGetTaskNumChans(aoTask,&l->numOut));
+    DAQmxErrChk (DAQmxCfgSampClkTiming(aiTask,"",config->rate,DAQmx_Val_Rising,DAQmx_Val_HWTimedSinglePoint,1));
+    DAQmxErrChk (DevTopologyTaskTerminal(aiTask,"ai/SampleClock",clockName,sizeof(clockName)));
+    DAQmxErrChk (DAQmxCfgSampClkTiming(aoTask,clockName,config->rate,DAQmx_Val_Rising,DAQmx_Val_HWTimedSinglePoint,1));
+    // Otherwise the first late iteration is an error that ends the loop.
+    DAQmxErrChk (DAQmxSetRealTimeConvLateErrorsToWarnings(aiTask,1));
+
+    l->in = (float64*)calloc(l->numIn,sizeof(float64));
+    l->out = (float64*)calloc(l->numOut,sizeof(float64));
+    if( !l->in || !l->out ) {
+        error = ControlLoopErrOutOfMemory;
+        goto Error;
+    }
+    *loop = l;
+    return 0;
+
+Error:
+    ControlLoopClear(l);
+    return error;
+}
+
+void ControlLoopClear(ControlLoop *loop)
+{
+    if( !loop )
+        return;
+    ControlLoopStop(loop);
+    StreamMutexDestroy(&loop->lock);
+    free(loop->in);
+    free(loop->out);
+    free(loop);
+}
+
+int32 ControlLoopStart(ControlLoop *loop, const float64 initial[])
+{
+    int32   error=0;
+
+    if( loop->threadRunning || loop->tasksRunning )
+        return ControlLoopErrInvalidArg;
+    if( initial )
+        memcpy(loop->out,initial,loop->numOut*sizeof(float64));
+    else
+        memset(loop->out,0,loop->numOut*sizeof(float64));
+    memset(&loop->published,0,sizeof(ControlLoopStats));
+    loop->asyncError = 0;
+    loop->stop = 0;
+
+    DAQmxErrChk (DAQmxWriteAnalogF64(loop->aoTask,1,0,loop->cfg.timeout,DAQmx_Val_GroupByScanNumber,loop->out,NULL,NULL));
+
+    /*********************************************/
+    // DAQmx Start Code
+    /*********************************************/
+    loop->tasksRunning = 1;
+    DAQmxErrChk (DAQmxStartTask(loop->aoTask)); // Must be started first, it runs on the AI clock
+    DAQmxErrChk (DAQmxStartTask(loop->aiTask));
+
+    if( StreamThreadCreate(&loop->thread,LoopThread,loop)!=0 ) {
+        error = ControlLoopErrThread;
+        goto Error;
+    }
+    loop->threadRunning = 1;
+    return 0;
+
+Error:
+    ControlLoopWait(loop);
+    return error;
+}
+
+int32 ControlLoopWait(ControlLoop *loop)
+{
+    int32   error;
+
+    if( loop->threadRunning ) {
+        StreamThreadJoin(loop->thread);
+        loop->threadRunning = 0;
+    }
+    if( loop->tasksRunning ) {
+        /*********************************************/
+        // DAQmx Stop Code
+        /*********************************************/
+        DAQmxStopTask(loop->aiTask);
+        DAQmxStopTask(loop->aoTask);
+        loop->tasksRunning = 0;
+    }
+    error = loop->asyncError;
+    loop->asyncError = 0;
+    return error;
+}
+
+int32 ControlLoopStop(ControlLoop *loop)
+{
+    loop->stop = 1;
+    return ControlLoopWait(loop);
+}
+
+void ControlLoopGetStats(ControlLoop *loop, ControlLoopStats *stats)
+{
+    StreamMutexLock(&loop->lock);
+    *stats = loop->published;
+    StreamMutexUnlock(&loop->lock);
+}
+
+int ControlLoopPIDStep(const float64 in[], uInt32 numIn, float64 out[], uInt32 numOut, void *stepData)
+{
+    PIDControl  *pid=(PIDControl*)stepData;
+    uInt32      i;
+
+    for(i=0;i<numIn && i<numOut;++i)
+        out[i] = PIDStep(&pid[i],in[i]);
+    return 0;
+}
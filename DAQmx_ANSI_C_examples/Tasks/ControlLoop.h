@@ -0,0 +1,99 @@
+/*********************************************************************
+*
+* Task helper:
+*    ControlLoop.h
+*
+* Description:
+*    Runs a closed control loop from analog input to analog output,
+*    one sample per sample clock tick, using hardware-timed single
+*    point mode. The loop does not go through the driver's buffers,
+*    so each output depends on the input of the same tick rather
+*    than on data one buffer old.
+*
+*    The AI task's sample clock also clocks the AO task. On each tick
+*    a dedicated thread waits for the clock, reads one sample per AI
+*    channel, calls the step function and writes one sample per AO
+*    channel. The thread can be pinned to one CPU and is run at
+*    real-time priority where the process is allowed to.
+*
+*    The step function is either ControlLoopPIDStep, with an array of
+*    PIDControl controllers as its data, or a user function. It
+*    should run well within one clock period. Iterations that did not
+*    finish before the next tick are counted as late; the driver is
+*    told to report them as warnings, so the loop carries on.
+*
+*    Histograms of the loop period and of the time spent reading,
+*    stepping and writing are kept for every iteration. See
+*    ../Processing/LatencyHist.h for their binning.
+*
+*********************************************************************/
+
+#ifndef CONTROLLOOP_H
+#define CONTROLLOOP_H
+
+#include <NIDAQmx.h>
+#include "../Processing/LatencyHist.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define ControlLoopErrInvalidArg    -1
+#define ControlLoopErrOutOfMemory   -2
+#define ControlLoopErrThread        -3
+
+// in holds one sample per AI channel and out one sample per AO
+// channel, both in channel order. out keeps the previous iteration's
+// values on entry. Return nonzero to end the loop.
+typedef int (*ControlLoopStep)(const float64 in[], uInt32 numIn, float64 out[], uInt32 numOut, void *stepData);
+
+typedef struct ControlLoopConfig {
+    float64     rate;           // loop rate, Hz
+    long long   iterations;     // 0 runs until ControlLoopStop
+    int         cpu;            // CPU to pin the loop thread to, or -1
+    float64     timeout;        // per wait, read and write, seconds
+} ControlLoopConfig;
+
+typedef struct ControlLoopStats {
+    long long   iterations;
+    long long   lateIterations;
+    double      loopRate;       // measured, Hz
+    LatencyHist period;         // between consecutive clock waits
+    LatencyHist input;          // clock wait returned to read done
+    LatencyHist compute;        // step function
+    LatencyHist output;         // write
+    LatencyHist total;          // clock wait returned to write done
+} ControlLoopStats;
+
+typedef struct ControlLoop ControlLoop;
+
+// aiTask and aoTask must have their channels created and no timing
+// configured. The loop configures both for hardware-timed single
+// point mode, the AO task on the AI sample clock.
+int32 ControlLoopCreate(TaskHandle aiTask, TaskHandle aoTask, const ControlLoopConfig *config, ControlLoopStep step, void *stepData, ControlLoop **loop);
+void  ControlLoopClear(ControlLoop *loop);
+
+// Writes initial, one value per AO channel or NULL for zeros, starts
+// the AO task, then the AI task and the loop thread.
+int32 ControlLoopStart(ControlLoop *loop, const float64 initial[]);
+
+// Waits for the loop thread to end, because the iteration count was
+// reached, the step function returned nonzero or an error occurred,
+// then stops the tasks. Returns the first error seen by the loop.
+int32 ControlLoopWait(ControlLoop *loop);
+
+// Ends the loop after the current iteration, then as ControlLoopWait.
+int32 ControlLoopStop(ControlLoop *loop);
+
+void  ControlLoopGetStats(ControlLoop *loop, ControlLoopStats *stats);
+
+// Step function running one PIDControl per channel: out[i] is the
+// output of ((PIDControl*)stepData)[i] for in[i]. numIn and numOut
+// must be equal.
+int   ControlLoopPIDStep(const float64 in[], uInt32 numIn, float64 out[], uInt32 numOut, void *stepData);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
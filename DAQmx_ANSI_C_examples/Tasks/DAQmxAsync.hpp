@@ -0,0 +1,491 @@
+/*********************************************************************
+*
+* Task helper:
+*    DAQmxAsync.hpp
+*
+* Description:
+*    C++20 coroutines over the typed tasks of DAQmxTask.hpp, so that
+*    many tasks can be served by a few threads and each acquisition
+*    or generation reads as one straight loop instead of a pair of
+*    EveryN and Done callbacks:
+*
+*        DAQmx::Job Acquire(DAQmx::AsyncAITask<8> &ai, Block &block)
+*        {
+*            for(;;) {
+*                int32 error=co_await ai.Read(block.Span(),0.0);
+*                if( DAQmxFailed(error) )
+*                    co_return;
+*                ...
+*            }
+*        }
+*
+*        executor.Spawn(Acquire(ai,block));
+*
+*    co_await Read suspends the coroutine until the task's EveryN
+*    event has fired, then reads the block on an executor thread. The
+*    driver's callback does nothing but count the event and, if a
+*    coroutine is waiting for it, push that coroutine onto the ready
+*    queue. co_await Write on an AsyncAOTask waits the same way for
+*    the Transferred From Buffer event before it writes. A Done event
+*    with an error ends the wait with that error. A Done event without
+*    one, as at the end of a finite task, lets the events already
+*    counted be taken and then ends the wait with DAQmx::ErrFinished.
+*    Close ends it with DAQmx::ErrClosed.
+*
+*    DAQmx::Executor runs the ready coroutines on a small pool of
+*    threads. The ready queue is a bounded lock-free multi-producer,
+*    multi-consumer ring; idle threads spin briefly and then sleep on
+*    an atomic wait. Spawn starts a Job on the executor, and WaitIdle
+*    returns when every spawned Job has finished.
+*
+*    Only one coroutine may wait on a task at a time. An async task
+*    must not be moved while its events are registered. The event is
+*    declared before the task, so it outlives the task and the driver
+*    callbacks that use it.
+*
+*********************************************************************/
+
+#ifndef DAQMXASYNC_HPP
+#define DAQMXASYNC_HPP
+
+#include <atomic>
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <memory>
+#include <thread>
+#include <vector>
+#include "DAQmxTask.hpp"
+#include "../Processing/StreamThread.h"
+
+namespace DAQmx {
+
+inline constexpr int32 ErrClosed=-2;       // the task was closed while a coroutine waited on it
+inline constexpr int32 ErrFinished=-3;     // the task finished without error and no events are left
+
+// Bounded lock-free MPMC queue of coroutine handles, after Vyukov.
+class ReadyQueue {
+public:
+    explicit ReadyQueue(std::size_t size)
+    {
+        std::size_t n=2;
+
+        while( n<size )
+            n *= 2;
+        cells_ = std::make_unique<Cell[]>(n);
+        mask_ = n-1;
+        for(std::size_t i=0;i<n;++i)
+            cells_[i].seq.store(i,std::memory_order_relaxed);
+    }
+
+    bool Push(std::coroutine_handle<> h) noexcept
+    {
+        std::size_t pos=tail_.load(std::memory_order_relaxed);
+
+        for(;;) {
+            Cell        &cell=cells_[pos&mask_];
+            std::size_t seq=cell.seq.load(std::memory_order_acquire);
+
+            if( seq==pos ) {
+                if( tail_.compare_exchange_weak(pos,pos+1,std::memory_order_relaxed) ) {
+                    cell.handle = h;
+                    cell.seq.store(pos+1,std::memory_order_release);
+                    return true;
+                }
+            }
+            else if( seq<pos )
+                return false;
+            else
+                pos = tail_.load(std::memory_order_relaxed);
+        }
+    }
+
+    bool Pop(std::coroutine_handle<> &h) noexcept
+    {
+        std::size_t pos=head_.load(std::memory_order_relaxed);
+
+        for(;;) {
+            Cell        &cell=cells_[pos&mask_];
+            std::size_t seq=cell.seq.load(std::memory_order_acquire);
+
+            if( seq==pos+1 ) {
+                if( head_.compare_exchange_weak(pos,pos+1,std::memory_order_relaxed) ) {
+                    h = cell.handle;
+                    cell.seq.store(pos+mask_+1,std::memory_order_release);
+                    return true;
+                }
+            }
+            else if( seq<pos+1 )
+                return false;
+            else
+                pos = head_.load(std::memory_order_relaxed);
+        }
+    }
+
+private:
+    struct Cell {
+        std::atomic<std::size_t>    seq;
+        std::coroutine_handle<>     handle;
+    };
+
+    std::unique_ptr<Cell[]>             cells_;
+    std::size_t                         mask_;
+    alignas(64) std::atomic<std::size_t> tail_{0};
+    alignas(64) std::atomic<std::size_t> head_{0};
+};
+
+class Executor;
+
+// A coroutine started with Executor::Spawn. It runs until it returns
+// and then frees itself.
+class Job {
+public:
+    struct promise_type {
+        Executor    *executor=nullptr;
+
+        Job get_return_object() noexcept { return Job(std::coroutine_handle<promise_type>::from_promise(*this)); }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        auto final_suspend() noexcept;
+        void return_void() noexcept {}
+        void unhandled_exception() noexcept { std::terminate(); }
+    };
+
+    Job(Job &&other) noexcept : handle_(std::exchange(other.handle_,nullptr)) {}
+    Job(const Job &) = delete;
+    ~Job()
+    {
+        if( handle_ )
+            handle_.destroy();
+    }
+
+private:
+    friend class Executor;
+    explicit Job(std::coroutine_handle<promise_type> h) noexcept : handle_(h) {}
+
+    std::coroutine_handle<promise_type> handle_;
+};
+
+class Executor {
+public:
+    explicit Executor(int numThreads, std::size_t queueSize=4096)
+        : queue_(queueSize)
+    {
+        for(int i=0;i<numThreads;++i)
+            threads_.emplace_back([this]{ Run(); });
+    }
+
+    ~Executor()
+    {
+        stop_.store(true);
+        signal_.fetch_add(1);
+        signal_.notify_all();
+        for(auto &t : threads_)
+            t.join();
+    }
+
+    Executor(const Executor &) = delete;
+    Executor &operator=(const Executor &) = delete;
+
+    // Safe from any thread, including a driver callback.
+    void Post(std::coroutine_handle<> h) noexcept
+    {
+        while( !queue_.Push(h) )
+            std::this_thread::yield();
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if( sleeping_.load(std::memory_order_relaxed)>0 ) {
+            signal_.fetch_add(1,std::memory_order_release);
+            signal_.notify_one();
+        }
+    }
+
+    void Spawn(Job job)
+    {
+        auto h=std::exchange(job.handle_,nullptr);
+
+        h.promise().executor = this;
+        jobs_.fetch_add(1);
+        Post(h);
+    }
+
+    void WaitIdle()
+    {
+        for(int n=jobs_.load();n>0;n=jobs_.load())
+            jobs_.wait(n);
+    }
+
+    int NumThreads() const noexcept { return int(threads_.size()); }
+    long long NumResumed() const noexcept { return resumed_.load(std::memory_order_relaxed); }
+
+private:
+    friend struct Job::promise_type;
+
+    void JobDone() noexcept
+    {
+        if( jobs_.fetch_sub(1)==1 )
+            jobs_.notify_all();
+    }
+
+    void Run()
+    {
+        std::coroutine_handle<> h;
+
+        while( !stop_.load(std::memory_order_relaxed) ) {
+            int spin;
+
+            for(spin=0;spin<spinCount;++spin) {
+                if( queue_.Pop(h) )
+                    break;
+                StreamCpuRelax();
+            }
+            if( spin==spinCount ) {
+                unsigned seen;
+
+                sleeping_.fetch_add(1);
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                seen = signal_.load(std::memory_order_acquire);
+                if( !queue_.Pop(h) ) {
+                    if( !stop_.load() )
+                        signal_.wait(seen);
+                    sleeping_.fetch_sub(1);
+                    continue;
+                }
+                sleeping_.fetch_sub(1);
+            }
+            resumed_.fetch_add(1,std::memory_order_relaxed);
+            h.resume();
+        }
+    }
+
+    static constexpr int            spinCount=100;
+
+    ReadyQueue                      queue_;
+    std::vector<std::thread>        threads_;
+    std::atomic<bool>               stop_{false};
+    std::atomic<unsigned>           signal_{0};
+    std::atomic<int>                sleeping_{0};
+    std::atomic<int>                jobs_{0};
+    std::atomic<long long>          resumed_{0};
+};
+
+inline auto Job::promise_type::final_suspend() noexcept
+{
+    struct Final {
+        bool await_ready() noexcept { return false; }
+        void await_suspend(std::coroutine_handle<promise_type> h) noexcept
+        {
+            Executor *executor=h.promise().executor;
+
+            h.destroy();
+            executor->JobDone();
+        }
+        void await_resume() noexcept {}
+    };
+    return Final{};
+}
+
+// The events of one task and the coroutine waiting for them. Signal
+// and Finish are called from the driver's callback thread.
+class AsyncEvent {
+public:
+    explicit AsyncEvent(Executor &executor) noexcept : executor_(executor) {}
+
+    void Signal() noexcept
+    {
+        count_.fetch_add(1);
+        Wake();
+    }
+
+    void Finish(int32 status) noexcept
+    {
+        status_.store(status,std::memory_order_relaxed);
+        done_.store(true);
+        Wake();
+    }
+
+    bool Ready() const noexcept
+    {
+        return count_.load(std::memory_order_acquire)>0 || done_.load(std::memory_order_acquire);
+    }
+
+    // Returns false if the event came in meanwhile, and the caller
+    // should not suspend after all.
+    bool Suspend(std::coroutine_handle<> h) noexcept
+    {
+        waiter_.store(h.address());
+        if( (count_.load()>0 || done_.load()) && waiter_.exchange(nullptr)!=nullptr )
+            return false;
+        return true;
+    }
+
+    // Takes one event. Returns 0, or the error the task finished with,
+    // in which case the events still counted are dropped. After a
+    // clean finish the counted events are taken first, then it
+    // returns ErrFinished.
+    int32 Take() noexcept
+    {
+        if( done_.load(std::memory_order_acquire) ) {
+            int32 status=status_.load(std::memory_order_relaxed);
+
+            if( DAQmxFailed(status) )
+                return status;
+            if( count_.load(std::memory_order_relaxed)==0 )
+                return ErrFinished;
+        }
+        count_.fetch_sub(1,std::memory_order_relaxed);
+        return 0;
+    }
+
+    void Reset() noexcept
+    {
+        count_.store(0);
+        done_.store(false);
+        status_.store(0);
+    }
+
+private:
+    void Wake() noexcept
+    {
+        if( void *w=waiter_.exchange(nullptr) )
+            executor_.Post(std::coroutine_handle<>::from_address(w));
+    }
+
+    Executor                &executor_;
+    std::atomic<int>        count_{0};
+    std::atomic<bool>       done_{false};
+    std::atomic<void*>      waiter_{nullptr};
+    std::atomic<int32>      status_{0};
+};
+
+template<std::size_t NumChans, class Sample=float64, Layout L=Layout::GroupByChannel>
+class AsyncAITask {
+public:
+    // The task must already have its timing configured; everyN is the
+    // number of samples per channel each Read waits for.
+    AsyncAITask(AITask<NumChans,Sample,L> &&task, Executor &executor, uInt32 everyN)
+        : event_(executor), task_(std::move(task))
+    {
+        task_.template EveryN<&AsyncAITask::OnEveryN>(*this,everyN);
+        task_.template Done<&AsyncAITask::OnDone>(*this);
+    }
+
+    AsyncAITask(const AsyncAITask &) = delete;
+    AsyncAITask &operator=(const AsyncAITask &) = delete;
+
+    AITask<NumChans,Sample,L> &Task() noexcept { return task_; }
+
+    void Start()
+    {
+        event_.Reset();
+        task_.Start();
+    }
+
+    // Ends a pending Read, and every later one, with ErrClosed. The
+    // task keeps running: stop it once the coroutine is done with it,
+    // since a read on a stopped task starts it again.
+    void Close() noexcept { event_.Finish(ErrClosed); }
+
+    template<std::size_t Size>
+    auto Read(std::span<Sample,Size> data, float64 timeout, int32 *sampsPerChanRead=nullptr) noexcept
+    {
+        struct Awaiter {
+            AsyncAITask             *self;
+            std::span<Sample,Size>  data;
+            float64                 timeout;
+            int32                   *read;
+
+            bool  await_ready() const noexcept { return self->event_.Ready(); }
+            bool  await_suspend(std::coroutine_handle<> h) noexcept { return self->event_.Suspend(h); }
+            int32 await_resume() noexcept
+            {
+                int32 error=self->event_.Take();
+
+                return error ? error : self->task_.Read(data,timeout,read);
+            }
+        };
+        return Awaiter{this,data,timeout,sampsPerChanRead};
+    }
+
+private:
+    int32 OnEveryN(int32, uInt32)
+    {
+        event_.Signal();
+        return 0;
+    }
+
+    int32 OnDone(int32 status)
+    {
+        event_.Finish(status);
+        return 0;
+    }
+
+    AsyncEvent                  event_;
+    AITask<NumChans,Sample,L>   task_;
+};
+
+template<std::size_t NumChans, class Sample=float64, Layout L=Layout::GroupByChannel>
+class AsyncAOTask {
+public:
+    // Write the first blocks through Task() before starting; each
+    // co_await Write then waits until everyN more samples per channel
+    // have been generated.
+    AsyncAOTask(AOTask<NumChans,Sample,L> &&task, Executor &executor, uInt32 everyN)
+        : event_(executor), task_(std::move(task))
+    {
+        task_.template EveryN<&AsyncAOTask::OnEveryN>(*this,everyN,DAQmx_Val_Transferred_From_Buffer);
+        task_.template Done<&AsyncAOTask::OnDone>(*this);
+    }
+
+    AsyncAOTask(const AsyncAOTask &) = delete;
+    AsyncAOTask &operator=(const AsyncAOTask &) = delete;
+
+    AOTask<NumChans,Sample,L> &Task() noexcept { return task_; }
+
+    void Start()
+    {
+        event_.Reset();
+        task_.Start();
+    }
+
+    void Close() noexcept { event_.Finish(ErrClosed); }
+
+    template<class S, std::size_t Size> requires std::is_same_v<std::remove_const_t<S>,Sample>
+    auto Write(std::span<S,Size> data, float64 timeout, int32 *sampsPerChanWritten=nullptr) noexcept
+    {
+        struct Awaiter {
+            AsyncAOTask         *self;
+            std::span<S,Size>   data;
+            float64             timeout;
+            int32               *written;
+
+            bool  await_ready() const noexcept { return self->event_.Ready(); }
+            bool  await_suspend(std::coroutine_handle<> h) noexcept { return self->event_.Suspend(h); }
+            int32 await_resume() noexcept
+            {
+                int32 error=self->event_.Take();
+
+                return error ? error : self->task_.Write(data,false,timeout,written);
+            }
+        };
+        return Awaiter{this,data,timeout,sampsPerChanWritten};
+    }
+
+private:
+    int32 OnEveryN(int32, uInt32)
+    {
+        event_.Signal();
+        return 0;
+    }
+
+    int32 OnDone(int32 status)
+    {
+        event_.Finish(status);
+        return 0;
+    }
+
+    AsyncEvent                  event_;
+    AOTask<NumChans,Sample,L>   task_;
+};
+
+} // namespace DAQmx
+
+#endif
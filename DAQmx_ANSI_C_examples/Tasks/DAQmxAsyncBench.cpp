@@ -0,0 +1,311 @@
+/*********************************************************************
+*
+* Task benchmark:
+*    DAQmxAsyncBench.cpp
+*
+* Description:
+*    Serves 1 to 64 continuous AI tasks on the simulated driver in
+*    three ways and compares them:
+*
+*      callback    each task reads its blocks in its own EveryN
+*                  callback, as the C examples do
+*      threads     one thread per task loops on a blocking read
+*      coroutine   one coroutine per task loops on co_await Read,
+*                  on an executor of 2 threads (DAQmxAsync.hpp)
+*
+*    Each task has 8 channels at 100 kHz on one of 8 PXI devices and
+*    reads blocks of 1000 samples per channel for 1 s. The table gives
+*    the blocks read per second, the CPU time of the whole process per
+*    second, the threads the application creates, and the mean and
+*    largest delay from the time a block was complete to the time it
+*    had been read. Every block is checked to follow on from the one
+*    before it.
+*
+*    The simulated driver runs the EveryN events of each task on a
+*    thread of its own, so the callback and coroutine runs also have
+*    one driver thread per task, as they would not on hardware. Their
+*    CPU time includes those threads.
+*
+*    Last, one AO task is written from a coroutine for 1 s.
+*
+*    No DAQ hardware or driver is needed. Compile this file as C++20
+*    and link it with SimDAQmx.c, compiled as C, instead of the
+*    NI-DAQmx library.
+*
+*********************************************************************/
+
+#include <cstdio>
+#include <cmath>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+#include "DAQmxAsync.hpp"
+#include "SimDAQmx.h"
+#include "../Processing/StreamTime.h"
+
+constexpr std::size_t   numChans=8;
+constexpr std::size_t   everyN=1000;
+constexpr double        rate=100000.0;
+constexpr double        duration=1.0;
+constexpr int           numDevices=8;
+constexpr int           numExecutorThreads=2;
+
+using AITask = DAQmx::AITask<numChans>;
+using Block = DAQmx::Block<numChans,everyN,float64>;
+
+struct Stats {
+    long long   blocks=0;
+    long long   discontinuities=0;
+    double      latencySum=0.0;
+    double      latencyMax=0.0;
+    int32       error=0;
+    double      startTime=0.0;
+    long long   next=0;
+
+    // Called after each read of one block.
+    void Add(int32 status, const Block &block)
+    {
+        double late;
+
+        if( DAQmxFailed(status) ) {
+            error = status;
+            return;
+        }
+        // The simulated samples are 1e-3 times their index.
+        if( std::llround(1e3*block.At(0,0))!=next || std::llround(1e3*block.At(numChans-1,everyN-1))!=next+long(everyN)-1 )
+            ++discontinuities;
+        next += everyN;
+        late = StreamTimeNow()-(startTime+double(next)/rate);
+        latencySum += late;
+        latencyMax = std::fmax(latencyMax,late);
+        ++blocks;
+    }
+};
+
+static AITask MakeTask(int i)
+{
+    char    channels[64];
+
+    std::snprintf(channels,sizeof(channels),"PXI1Slot%d/ai0:7",2+i%numDevices);
+    AITask task(channels,-10.0,10.0);
+    task.CfgSampClkTiming(rate,DAQmx_Val_ContSamps,10*everyN);
+    return task;
+}
+
+/*********************************************/
+// Reads in the EveryN callback
+/*********************************************/
+class CallbackAcquisition {
+public:
+    explicit CallbackAcquisition(int i) : task_(MakeTask(i))
+    {
+        task_.EveryN<&CallbackAcquisition::OnEveryN>(*this,everyN);
+    }
+
+    void Start()
+    {
+        stats.startTime = StreamTimeNow();
+        task_.Start();
+    }
+    void Stop() { task_.Stop(); }
+
+    Stats   stats;
+
+private:
+    int32 OnEveryN(int32, uInt32)
+    {
+        stats.Add(task_.Read(block_,10.0),block_);
+        return 0;
+    }
+
+    AITask  task_;
+    Block   block_;
+};
+
+/*********************************************/
+// One thread per task
+/*********************************************/
+class ThreadAcquisition {
+public:
+    explicit ThreadAcquisition(int i) : task_(MakeTask(i)) {}
+
+    void Start()
+    {
+        stats.startTime = StreamTimeNow();
+        task_.Start();
+        thread_ = std::thread([this]{
+            while( !stop_.load(std::memory_order_relaxed) && !stats.error )
+                stats.Add(task_.Read(block_,10.0),block_);
+        });
+    }
+    void Stop()
+    {
+        stop_.store(true);
+        thread_.join();
+        task_.Stop();
+    }
+
+    Stats   stats;
+
+private:
+    AITask              task_;
+    Block               block_;
+    std::thread         thread_;
+    std::atomic<bool>   stop_{false};
+};
+
+/*********************************************/
+// One coroutine per task
+/*********************************************/
+static DAQmx::Job Acquire(DAQmx::AsyncAITask<numChans> &ai, Block &block, Stats &stats)
+{
+    for(;;) {
+        int32 error=co_await ai.Read(block.Span(),10.0);
+
+        if( error==DAQmx::ErrClosed || error==DAQmx::ErrFinished )
+            co_return;
+        stats.Add(error,block);
+        if( DAQmxFailed(error) )
+            co_return;
+    }
+}
+
+class CoroutineAcquisition {
+public:
+    CoroutineAcquisition(int i, DAQmx::Executor &executor)
+        : executor_(executor), ai_(MakeTask(i),executor,everyN) {}
+
+    void Start()
+    {
+        stats.startTime = StreamTimeNow();
+        ai_.Start();
+        executor_.Spawn(Acquire(ai_,block_,stats));
+    }
+    void Stop()
+    {
+        ai_.Close();
+    }
+    // After the executor is idle.
+    void Finish() { ai_.Task().Stop(); }
+
+    Stats   stats;
+
+private:
+    DAQmx::Executor                 &executor_;
+    DAQmx::AsyncAITask<numChans>    ai_;
+    Block                           block_;
+};
+
+/*********************************************/
+// Runs
+/*********************************************/
+template<class Acquisition>
+static void Report(const char *mode, int numTasks, int threads, std::vector<std::unique_ptr<Acquisition>> &acqs, double cpu, double elapsed)
+{
+    Stats       total;
+    int32       error=0;
+
+    for(auto &a : acqs) {
+        total.blocks += a->stats.blocks;
+        total.discontinuities += a->stats.discontinuities;
+        total.latencySum += a->stats.latencySum;
+        total.latencyMax = std::fmax(total.latencyMax,a->stats.latencyMax);
+        if( a->stats.error )
+            error = a->stats.error;
+    }
+    std::printf("%-10s%6d%12.0f%12.1f%9d%12.3f%12.3f%8lld",mode,numTasks,total.blocks/elapsed,1e3*cpu/elapsed,threads,
+                total.blocks ? 1e3*total.latencySum/total.blocks : 0.0,1e3*total.latencyMax,total.discontinuities);
+    if( error )
+        std::printf("   error %d",int(error));
+    std::printf("\n");
+}
+
+template<class Acquisition, class... Args>
+static void Run(const char *mode, int numTasks, int threads, Args&... args)
+{
+    std::vector<std::unique_ptr<Acquisition>>   acqs;
+    double                                      t0,cpu0;
+
+    for(int i=0;i<numTasks;++i)
+        acqs.push_back(std::make_unique<Acquisition>(i,args...));
+    t0 = StreamTimeNow();
+    cpu0 = StreamCpuTime();
+    for(auto &a : acqs)
+        a->Start();
+    StreamSleep(duration);
+    for(auto &a : acqs)
+        a->Stop();
+    if constexpr( sizeof...(Args)>0 ) {
+        (args.WaitIdle(),...);
+        for(auto &a : acqs)
+            a->Finish();
+    }
+    Report(mode,numTasks,threads,acqs,StreamCpuTime()-cpu0,StreamTimeNow()-t0);
+}
+
+/*********************************************/
+// AO from a coroutine
+/*********************************************/
+static DAQmx::Job Generate(DAQmx::AsyncAOTask<1> &ao, DAQmx::Block<1,everyN,float64> &block, long long &blocks, int32 &status)
+{
+    for(;;) {
+        int32 error=co_await ao.Write(block.Span(),10.0);
+
+        if( DAQmxFailed(error) ) {
+            if( error!=DAQmx::ErrClosed && error!=DAQmx::ErrFinished )
+                status = error;
+            co_return;
+        }
+        ++blocks;
+    }
+}
+
+static void RunAO(DAQmx::Executor &executor)
+{
+    DAQmx::AOTask<1>                    task("PXI1Slot2/ao0",-10.0,10.0);
+    DAQmx::Block<1,everyN,float64>      block;
+    long long                           blocks=0;
+    int32                               status=0;
+
+    for(std::size_t i=0;i<everyN;++i)
+        block.At(0,i) = std::sin(2.0*M_PI*double(i)/everyN);
+    task.CfgSampClkTiming(rate,DAQmx_Val_ContSamps,4*everyN);
+
+    DAQmx::AsyncAOTask<1>   ao(std::move(task),executor,everyN);
+
+    for(int i=0;i<2;++i)
+        DAQmx::Check(ao.Task().Write(block,false,10.0));
+    ao.Start();
+    executor.Spawn(Generate(ao,block,blocks,status));
+    StreamSleep(duration);
+    ao.Close();
+    executor.WaitIdle();
+    ao.Task().Stop();
+    std::printf("\nAO coroutine: %lld blocks written in %.0f s, %.0f expected, status %d\n",
+                blocks,duration,duration*rate/everyN,int(status));
+}
+
+int main()
+{
+    SimDAQmxSystem  sys={0,0,numDevices,0.0};
+
+    SimDAQmxSetSystem(&sys);
+    try {
+        DAQmx::Executor executor(numExecutorThreads);
+
+        std::printf("%-10s%6s%12s%12s%9s%12s%12s%8s\n","mode","tasks","blocks/s","CPU ms/s","threads","mean (ms)","max (ms)","gaps");
+        for(int n=1;n<=64;n*=2) {
+            Run<CallbackAcquisition>("callback",n,0);
+            Run<ThreadAcquisition>("threads",n,n);
+            Run<CoroutineAcquisition>("coroutine",n,numExecutorThreads,executor);
+        }
+        RunAO(executor);
+        std::printf("Executor resumed %lld coroutines\n",executor.NumResumed());
+    }
+    catch( const DAQmx::Error &e ) {
+        std::printf("DAQmx Error %d: %s\n",int(e.Code()),e.what());
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,500 @@
+/*********************************************************************
+*
+* Task helper:
+*    DAQmxReplay.c
+*
+* Description:
+*    Implementation of the trace replayer. See DAQmxReplay.h.
+*
+*    The records of all threads are loaded into one array sorted by
+*    start time, and each replay thread walks a list of the indices
+*    of its own records. Recorded task handles are mapped to replayed
+*    ones in a small table under a mutex, since a task is usually
+*    created on one thread and read on another. An entry is dropped
+*    when its task is cleared, because the driver may hand the same
+*    handle to the next task created.
+*
+*********************************************************************/
+
+#define DAQMX_TRACE_NO_WRAPPERS
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+#include "DAQmxReplay.h"
+#include "../Processing/StreamTime.h"
+#include "../Processing/StreamThread.h"
+
+#define MAX_TASKS       256
+#define SPIN_TIME       200e-6      // s, spun rather than slept before a call
+#define AUTO_SAMPLES    1000000     // read buffer for DAQmx_Val_Auto reads
+
+typedef struct Entry {
+    DAQmxTraceRecord    rec;
+    int                 thread;
+    int                 replayed;
+    atomic_int          done;
+    int32               status;
+    double              seconds;
+    double              lag;
+} Entry;
+
+typedef struct TaskMap {
+    uInt64      recorded;
+    TaskHandle  replayed;
+    int         numChans;
+} TaskMap;
+
+typedef struct ReplayThread {
+    DAQmxReplay     *owner;
+    long long       *indices;
+    long long       count;
+    StreamThread    thread;
+    float64         *buffer;
+    size_t          bufferSize;
+} ReplayThread;
+
+struct DAQmxReplay {
+    DAQmxTraceFileHeader    header;
+    Entry                   *entries;
+    long long               numEntries;
+    int                     numThreads;
+    const char              *device;
+    double                  speed;
+    double                  startTime;
+    double                  endTime;
+    TaskMap                 tasks[MAX_TASKS];
+    int                     numTasks;
+    StreamMutex             lock;
+};
+
+static const char *callNames[]={
+#define DAQMX_TRACE_CALL_NAME(name) #name,
+    DAQMX_TRACE_CALLS(DAQMX_TRACE_CALL_NAME)
+#undef DAQMX_TRACE_CALL_NAME
+};
+
+const char *DAQmxReplayCallName(int call)
+{
+    return call>=0 && call<DAQmxTraceNumCalls ? callNames[call] : "Unknown";
+}
+
+static int CompareStart(const void *a, const void *b)
+{
+    const Entry *x=(const Entry*)a,*y=(const Entry*)b;
+
+    return x->rec.start<y->rec.start ? -1 : x->rec.start>y->rec.start;
+}
+
+int32 DAQmxReplayLoad(const char fileName[], DAQmxReplay **replay)
+{
+    DAQmxReplay     *r;
+    FILE            *f;
+    DAQmxTraceChunk chunk;
+    long long       max;
+    int32           error=0;
+
+    *replay = NULL;
+    if( !fileName )
+        return DAQmxReplayErrInvalidArg;
+    f = fopen(fileName,"rb");
+    if( !f )
+        return DAQmxReplayErrFile;
+    r = (DAQmxReplay*)calloc(1,sizeof(DAQmxReplay));
+    if( !r ) {
+        fclose(f);
+        return DAQmxReplayErrOutOfMemory;
+    }
+    if( fread(&r->header,sizeof(r->header),1,f)!=1 || memcmp(r->header.magic,DAQMX_TRACE_MAGIC,8)!=0 ||
+        r->header.version!=DAQMX_TRACE_VERSION || r->header.recordSize!=sizeof(DAQmxTraceRecord) ||
+        r->header.ticksPerSecond<=0.0 ) {
+        error = DAQmxReplayErrFormat;
+        goto Error;
+    }
+    max = (long long)r->header.numRecords;
+    r->entries = (Entry*)calloc((size_t)(max>0 ? max : 1),sizeof(Entry));
+    if( !r->entries ) {
+        error = DAQmxReplayErrOutOfMemory;
+        goto Error;
+    }
+    while( fread(&chunk,sizeof(chunk),1,f)==1 ) {
+        uInt32 i;
+
+        if( r->numEntries+chunk.count>max || chunk.thread>=r->header.numThreads ) {
+            error = DAQmxReplayErrFormat;
+            goto Error;
+        }
+        for(i=0;i<chunk.count;++i) {
+            Entry *e=&r->entries[r->numEntries++];
+
+            if( fread(&e->rec,sizeof(DAQmxTraceRecord),1,f)!=1 ) {
+                error = DAQmxReplayErrFormat;
+                goto Error;
+            }
+            e->thread = (int)chunk.thread;
+            if( e->thread>=r->numThreads )
+                r->numThreads = e->thread+1;
+        }
+    }
+    qsort(r->entries,(size_t)r->numEntries,sizeof(Entry),CompareStart);
+    StreamMutexInit(&r->lock);
+    fclose(f);
+    *replay = r;
+    return 0;
+
+Error:
+    fclose(f);
+    free(r->entries);
+    free(r);
+    return error;
+}
+
+void DAQmxReplayClear(DAQmxReplay *replay)
+{
+    if( !replay )
+        return;
+    StreamMutexDestroy(&replay->lock);
+    free(replay->entries);
+    free(replay);
+}
+
+long long DAQmxReplayNumRecords(const DAQmxReplay *replay)
+{
+    return replay->numEntries;
+}
+
+const DAQmxTraceRecord *DAQmxReplayGetRecord(const DAQmxReplay *replay, long long index, int *thread)
+{
+    if( thread )
+        *thread = replay->entries[index].thread;
+    return &replay->entries[index].rec;
+}
+
+double DAQmxReplayTicksPerSecond(const DAQmxReplay *replay)
+{
+    return replay->header.ticksPerSecond;
+}
+
+/*********************************************/
+// Replay
+/*********************************************/
+static TaskMap *FindTask(DAQmxReplay *r, uInt64 recorded)
+{
+    int i;
+
+    for(i=0;i<r->numTasks;++i)
+        if( r->tasks[i].recorded==recorded )
+            return &r->tasks[i];
+    return NULL;
+}
+
+static void DropTask(DAQmxReplay *r, uInt64 recorded)
+{
+    TaskMap *map;
+
+    StreamMutexLock(&r->lock);
+    if( (map=FindTask(r,recorded))!=NULL )
+        *map = r->tasks[--r->numTasks];
+    StreamMutexUnlock(&r->lock);
+}
+
+// Replays one record. Returns 0 if the call was skipped.
+static int Dispatch(ReplayThread *t, const DAQmxTraceRecord *rec, int32 *status)
+{
+    DAQmxReplay *r=t->owner;
+    TaskMap     *map;
+    TaskHandle  task=0;
+    int         numChans=0;
+    char        chan[256];
+    int32       done;
+    uInt32      u32;
+    uInt64      u64;
+    bool32      b32;
+    size_t      needed;
+
+    StreamMutexLock(&r->lock);
+    // The entry may move once the lock is released, so copy it out.
+    map = rec->task ? FindTask(r,rec->task) : NULL;
+    if( map ) {
+        task = map->replayed;
+        numChans = map->numChans;
+    }
+    StreamMutexUnlock(&r->lock);
+    // Only a task being created may be unknown. A record of another
+    // call without a task, or on a task whose creation was not
+    // replayed, is skipped.
+    if( !map && rec->call!=DAQmxTraceCall_CreateTask && rec->call!=DAQmxTraceCall_Mark )
+        return 0;
+    *status = 0;
+    switch( rec->call ) {
+        case DAQmxTraceCall_Mark:
+            return 1;
+        case DAQmxTraceCall_CreateTask:
+            *status = DAQmxCreateTask("",&task);
+            if( *status==0 ) {
+                StreamMutexLock(&r->lock);
+                // A recorded handle that was reused without a traced
+                // clear now names the new task.
+                if( (map=FindTask(r,rec->task))==NULL && r->numTasks<MAX_TASKS )
+                    map = &r->tasks[r->numTasks++];
+                if( map ) {
+                    map->recorded = rec->task;
+                    map->replayed = task;
+                    map->numChans = 0;
+                }
+                StreamMutexUnlock(&r->lock);
+            }
+            return 1;
+        case DAQmxTraceCall_ClearTask:
+            *status = DAQmxClearTask(task);
+            if( *status==0 )
+                DropTask(r,rec->task);
+            return 1;
+        case DAQmxTraceCall_StartTask:
+            *status = DAQmxStartTask(task);
+            return 1;
+        case DAQmxTraceCall_StopTask:
+            *status = DAQmxStopTask(task);
+            return 1;
+        case DAQmxTraceCall_TaskControl:
+            *status = DAQmxTaskControl(task,(int32)rec->arg);
+            return 1;
+        case DAQmxTraceCall_WaitUntilTaskDone:
+            *status = DAQmxWaitUntilTaskDone(task,rec->value);
+            return 1;
+        case DAQmxTraceCall_CreateAIVoltageChan:
+        case DAQmxTraceCall_CreateAOVoltageChan:
+            if( snprintf(chan,sizeof(chan),"%s/%s0:%d",r->device,rec->call==DAQmxTraceCall_CreateAIVoltageChan ? "ai" : "ao",
+                         (int)(rec->arg>1 ? rec->arg-1 : 0))>=(int)sizeof(chan) )
+                return 0;
+            if( rec->call==DAQmxTraceCall_CreateAIVoltageChan )
+                *status = DAQmxCreateAIVoltageChan(task,chan,"",DAQmx_Val_Cfg_Default,-rec->value,rec->value,DAQmx_Val_Volts,NULL);
+            else
+                *status = DAQmxCreateAOVoltageChan(task,chan,"",-rec->value,rec->value,DAQmx_Val_Volts,NULL);
+            if( *status==0 ) {
+                StreamMutexLock(&r->lock);
+                if( (map=FindTask(r,rec->task))!=NULL )
+                    map->numChans += rec->arg>1 ? (int)rec->arg : 1;
+                StreamMutexUnlock(&r->lock);
+            }
+            return 1;
+        case DAQmxTraceCall_CfgSampClkTiming:
+            *status = DAQmxCfgSampClkTiming(task,"",rec->value,DAQmx_Val_Rising,rec->arg<0 ? DAQmx_Val_ContSamps : DAQmx_Val_FiniteSamps,
+                                            (uInt64)(rec->arg<0 ? -rec->arg : rec->arg));
+            return 1;
+        case DAQmxTraceCall_CfgOutputBuffer:
+            *status = DAQmxCfgOutputBuffer(task,(uInt32)rec->arg);
+            return 1;
+        case DAQmxTraceCall_ReadAnalogF64:
+        case DAQmxTraceCall_ReadBinaryI16:
+        case DAQmxTraceCall_WriteAnalogF64:
+            needed = (size_t)(rec->arg>0 ? rec->arg : AUTO_SAMPLES)*(size_t)(numChans>0 ? numChans : 1);
+            if( needed>t->bufferSize ) {
+                float64 *buffer=(float64*)realloc(t->buffer,needed*sizeof(float64));
+
+                if( !buffer )
+                    return 0;
+                memset(buffer,0,needed*sizeof(float64));
+                t->buffer = buffer;
+                t->bufferSize = needed;
+            }
+            if( rec->call==DAQmxTraceCall_ReadAnalogF64 )
+                *status = DAQmxReadAnalogF64(task,(int32)rec->arg,rec->value,DAQmx_Val_GroupByChannel,t->buffer,(uInt32)t->bufferSize,&done,NULL);
+            else if( rec->call==DAQmxTraceCall_ReadBinaryI16 )
+                *status = DAQmxReadBinaryI16(task,(int32)rec->arg,rec->value,DAQmx_Val_GroupByChannel,(int16*)t->buffer,(uInt32)t->bufferSize,&done,NULL);
+            else
+                *status = DAQmxWriteAnalogF64(task,(int32)rec->arg,0,rec->value,DAQmx_Val_GroupByChannel,t->buffer,&done,NULL);
+            return 1;
+        case DAQmxTraceCall_GetReadAvailSampPerChan:
+            *status = DAQmxGetReadAvailSampPerChan(task,&u32);
+            return 1;
+        case DAQmxTraceCall_GetReadTotalSampPerChanAcquired:
+            *status = DAQmxGetReadTotalSampPerChanAcquired(task,&u64);
+            return 1;
+        case DAQmxTraceCall_GetWriteTotalSampPerChanGenerated:
+            *status = DAQmxGetWriteTotalSampPerChanGenerated(task,&u64);
+            return 1;
+        case DAQmxTraceCall_GetTaskNumChans:
+            *status = DAQmxGetTaskNumChans(task,&u32);
+            return 1;
+        case DAQmxTraceCall_GetReadCurrReadPos:
+            *status = DAQmxGetReadCurrReadPos(task,&u64);
+            return 1;
+        case DAQmxTraceCall_SetReadOffset:
+            *status = DAQmxSetReadOffset(task,(int32)rec->arg);
+            return 1;
+        case DAQmxTraceCall_IsTaskDone:
+            *status = DAQmxIsTaskDone(task,&b32);
+            return 1;
+        default:
+            return 0;
+    }
+}
+
+// Waits until a time, sleeping until shortly before it.
+static void WaitUntil(double when)
+{
+    double now=StreamTimeNow();
+
+    if( when-now>SPIN_TIME )
+        StreamSleep(when-now-SPIN_TIME);
+    while( StreamTimeNow()<when )
+        StreamCpuRelax();
+}
+
+static STREAM_THREAD_PROC(ReplayProc, arg)
+{
+    ReplayThread    *t=(ReplayThread*)arg;
+    DAQmxReplay     *r=t->owner;
+    uInt64          first=r->entries[0].rec.start;
+    double          tps=r->header.ticksPerSecond;
+    long long       k;
+
+    for(k=0;k<t->count;++k) {
+        long long   index=t->indices[k];
+        Entry       *e=&r->entries[index];
+        double      due=r->startTime,start;
+
+        if( r->speed>0.0 )
+            due += (double)(e->rec.start-first)/tps/r->speed;
+        WaitUntil(due);
+        if( r->speed==0.0 && index>0 )
+            while( !atomic_load_explicit(&r->entries[index-1].done,memory_order_acquire) )
+                StreamCpuRelax();
+        start = StreamTimeNow();
+        e->lag = r->speed>0.0 ? start-due : 0.0;
+        e->replayed = Dispatch(t,&e->rec,&e->status);
+        e->seconds = StreamTimeNow()-start;
+        atomic_store_explicit(&e->done,1,memory_order_release);
+    }
+    return 0;
+}
+
+int32 DAQmxReplayRun(DAQmxReplay *replay, const char device[], double speed)
+{
+    ReplayThread    *threads;
+    long long       k;
+    int             i,started=0;
+    int32           error=0;
+
+    if( !replay || !device || speed<0.0 )
+        return DAQmxReplayErrInvalidArg;
+    if( replay->numEntries==0 )
+        return 0;
+    threads = (ReplayThread*)calloc((size_t)replay->numThreads,sizeof(ReplayThread));
+    if( !threads )
+        return DAQmxReplayErrOutOfMemory;
+    for(k=0;k<replay->numEntries;++k)
+        threads[replay->entries[k].thread].count++;
+    for(i=0;i<replay->numThreads;++i) {
+        threads[i].owner = replay;
+        threads[i].indices = (long long*)malloc((size_t)(threads[i].count+1)*sizeof(long long));
+        if( !threads[i].indices ) {
+            error = DAQmxReplayErrOutOfMemory;
+            goto Error;
+        }
+        threads[i].count = 0;
+    }
+    for(k=0;k<replay->numEntries;++k) {
+        ReplayThread *t=&threads[replay->entries[k].thread];
+
+        t->indices[t->count++] = k;
+        replay->entries[k].replayed = 0;
+        atomic_init(&replay->entries[k].done,0);
+    }
+    replay->device = device;
+    replay->speed = speed;
+    replay->numTasks = 0;
+    // Leave time for the threads to start before the first call.
+    replay->startTime = StreamTimeNow()+0.01;
+    for(started=0;started<replay->numThreads;++started)
+        if( StreamThreadCreate(&threads[started].thread,ReplayProc,&threads[started])!=0 ) {
+            error = DAQmxReplayErrOutOfMemory;
+            break;
+        }
+    for(i=0;i<started;++i)
+        StreamThreadJoin(threads[i].thread);
+    replay->endTime = StreamTimeNow();
+
+Error:
+    for(i=0;i<replay->numThreads;++i) {
+        free(threads[i].indices);
+        free(threads[i].buffer);
+    }
+    free(threads);
+    return error;
+}
+
+void DAQmxReplayGetSummary(const DAQmxReplay *replay, DAQmxReplaySummary *summary)
+{
+    double      tps=replay->header.ticksPerSecond,end=0.0,lagSum=0.0;
+    long long   k,replayed=0;
+
+    memset(summary,0,sizeof(*summary));
+    summary->records = replay->numEntries;
+    summary->dropped = (long long)replay->header.numDropped;
+    summary->threads = replay->numThreads;
+    for(k=0;k<replay->numEntries;++k) {
+        const Entry *e=&replay->entries[k];
+        double      t=(double)(e->rec.start-replay->entries[0].rec.start+e->rec.ticks)/tps;
+
+        if( t>end )
+            end = t;
+        if( !e->replayed )
+            continue;
+        replayed++;
+        lagSum += e->lag;
+        if( e->lag>summary->maxLag )
+            summary->maxLag = e->lag;
+        if( e->status!=e->rec.status )
+            summary->statusMismatches++;
+    }
+    summary->recordedDuration = end;
+    summary->replayedDuration = replay->endTime>replay->startTime ? replay->endTime-replay->startTime : 0.0;
+    summary->meanLag = replayed ? lagSum/(double)replayed : 0.0;
+}
+
+void DAQmxReplayGetCallStats(const DAQmxReplay *replay, int call, DAQmxReplayCallStats *stats)
+{
+    double      tps=replay->header.ticksPerSecond;
+    long long   k;
+
+    memset(stats,0,sizeof(*stats));
+    for(k=0;k<replay->numEntries;++k) {
+        const Entry *e=&replay->entries[k];
+        double      recorded=(double)e->rec.ticks/tps;
+
+        if( e->rec.call!=call )
+            continue;
+        stats->count++;
+        stats->recordedMean += recorded;
+        if( recorded>stats->recordedMax )
+            stats->recordedMax = recorded;
+        if( !e->replayed ) {
+            stats->skipped++;
+            continue;
+        }
+        stats->replayed++;
+        stats->replayedMean += e->seconds;
+        if( e->seconds>stats->replayedMax )
+            stats->replayedMax = e->seconds;
+        if( e->status!=e->rec.status )
+            stats->statusMismatches++;
+    }
+    if( stats->count )
+        stats->recordedMean /= (double)stats->count;
+    if( stats->replayed )
+        stats->replayedMean /= (double)stats->replayed;
+}
+
+int DAQmxReplayGetResult(const DAQmxReplay *replay, long long index, int32 *status, double *seconds)
+{
+    const Entry *e=&replay->entries[index];
+
+    if( status )
+        *status = e->status;
+    if( seconds )
+        *seconds = e->seconds;
+    return e->replayed;
+}
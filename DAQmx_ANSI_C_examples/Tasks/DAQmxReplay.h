@@ -0,0 +1,95 @@
+/*********************************************************************
+*
+* Task helper:
+*    DAQmxReplay.h
+*
+* Description:
+*    Reads a trace written by DAQmxTrace.c and drives the recorded
+*    calls again with their original timing, to reproduce and
+*    profile an incident away from the system where it happened.
+*    Link SimDAQmx.c to replay against the simulated driver, or the
+*    NI-DAQmx library to replay against simulated devices in NI MAX.
+*
+*    Each recorded thread is replayed by a thread of its own. Each
+*    call is issued at its recorded time relative to the first call,
+*    divided by the speed, or as soon as the previous call of the
+*    thread returned if that is later. Tasks are created again and
+*    the recorded task handles mapped to the new ones. Channels are
+*    created on the given device, with the recorded number of
+*    channels. Calls whose arguments the trace does not hold, such as
+*    terminal names, are not replayed but counted as skipped, and
+*    EveryN callbacks are not registered because the calls the
+*    callback made are replayed on the callback's recorded thread.
+*
+*    For each call the status and the duration of the replay can be
+*    compared with the recording.
+*
+*********************************************************************/
+
+#ifndef DAQMXREPLAY_H
+#define DAQMXREPLAY_H
+
+#include <NIDAQmx.h>
+#include "DAQmxTraceFormat.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define DAQmxReplayErrInvalidArg    -1
+#define DAQmxReplayErrOutOfMemory   -2
+#define DAQmxReplayErrFile          -3
+#define DAQmxReplayErrFormat        -4
+
+typedef struct DAQmxReplay DAQmxReplay;
+
+typedef struct DAQmxReplayCallStats {
+    long long   count;
+    long long   replayed;
+    long long   skipped;
+    long long   statusMismatches;   // replayed calls that returned another status
+    double      recordedMean;       // s
+    double      recordedMax;
+    double      replayedMean;
+    double      replayedMax;
+} DAQmxReplayCallStats;
+
+typedef struct DAQmxReplaySummary {
+    long long   records;
+    long long   dropped;            // lost while recording
+    int         threads;
+    double      recordedDuration;   // s, first call to last return
+    double      replayedDuration;
+    long long   statusMismatches;
+    double      meanLag;            // s, issue time behind schedule
+    double      maxLag;
+} DAQmxReplaySummary;
+
+int32 DAQmxReplayLoad(const char fileName[], DAQmxReplay **replay);
+void  DAQmxReplayClear(DAQmxReplay *replay);
+
+// Records in order of their start time. thread may be NULL.
+long long DAQmxReplayNumRecords(const DAQmxReplay *replay);
+const DAQmxTraceRecord *DAQmxReplayGetRecord(const DAQmxReplay *replay, long long index, int *thread);
+double DAQmxReplayTicksPerSecond(const DAQmxReplay *replay);
+
+// Replays the trace. speed 1 keeps the recorded timing, 2 runs twice
+// as fast, 0 issues every call as soon as the call recorded before it,
+// on any thread, has returned.
+int32 DAQmxReplayRun(DAQmxReplay *replay, const char device[], double speed);
+
+void  DAQmxReplayGetSummary(const DAQmxReplay *replay, DAQmxReplaySummary *summary);
+void  DAQmxReplayGetCallStats(const DAQmxReplay *replay, int call, DAQmxReplayCallStats *stats);
+
+// Replay status of a record, after DAQmxReplayRun: 1 replayed, 0
+// skipped. status and seconds may be NULL.
+int   DAQmxReplayGetResult(const DAQmxReplay *replay, long long index, int32 *status, double *seconds);
+
+// Name of a call id, without the DAQmx prefix.
+const char *DAQmxReplayCallName(int call);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
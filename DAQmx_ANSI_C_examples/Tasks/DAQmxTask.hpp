@@ -0,0 +1,272 @@
+/*********************************************************************
+*
+* Task helper:
+*    DAQmxTask.hpp
+*
+* Description:
+*    Header-only C++20 layer over the NI-DAQmx C calls that the
+*    examples use, in place of static TaskHandle globals, goto Error
+*    cleanup and arrays sized by hand to match the read arguments.
+*
+*    DAQmx::Task owns a task handle. It can be moved but not copied,
+*    and stops and clears the task when it goes out of scope. Setting
+*    a task up throws DAQmx::Error with the code and the extended
+*    error information when a call fails.
+*
+*    DAQmx::AITask<NumChans,Sample,Layout> and DAQmx::AOTask<...> fix
+*    the number of channels, the sample type (float64 for scaled data,
+*    int16 for raw codes) and the layout at compile time. Reads and
+*    writes take a std::span with a static extent of NumChans*N
+*    samples, so the array size passed to the driver and the stride of
+*    each channel are constants, and nothing is checked, allocated or
+*    thrown on the data path: Read and Write return the DAQmx status
+*    as the C calls do. DAQmx::Block<NumChans,N,Sample,Layout> is a
+*    buffer of the matching size with per-channel access. The number
+*    of channels is checked once, when they are created or when a
+*    handle made with the C calls is taken over.
+*
+*    EveryN<&Class::Method>(object,...) and Done<&Class::Method>(object)
+*    register a member function as the callback. The function pointer
+*    is a template argument, so each registration compiles to its own
+*    small trampoline, and the object is passed as the callbackData;
+*    no static state is needed. The trampolines are noexcept, so a
+*    callback that throws terminates the program rather than unwinding
+*    through the driver.
+*
+*********************************************************************/
+
+#ifndef DAQMXTASK_HPP
+#define DAQMXTASK_HPP
+
+#include <NIDAQmx.h>
+#include <array>
+#include <cstddef>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+namespace DAQmx {
+
+inline constexpr int32 ErrNumChans=-1;     // the task has other than NumChans channels
+
+class Error : public std::runtime_error {
+public:
+    Error(int32 code, const std::string &what) : std::runtime_error(what), code_(code) {}
+    int32 Code() const noexcept { return code_; }
+
+private:
+    int32   code_;
+};
+
+// Throws Error for a failed setup call.
+inline void Check(int32 error)
+{
+    if( DAQmxFailed(error) ) {
+        char errBuff[2048]={'\0'};
+
+        DAQmxGetExtendedErrorInfo(errBuff,sizeof(errBuff));
+        throw Error(error,errBuff);
+    }
+}
+
+enum class Layout : bool32 {
+    GroupByChannel = DAQmx_Val_GroupByChannel,
+    GroupByScan = DAQmx_Val_GroupByScanNumber
+};
+
+// NumSamps samples per channel of NumChans channels.
+template<std::size_t NumChans, std::size_t NumSamps, class Sample, Layout L=Layout::GroupByChannel>
+struct Block {
+    static constexpr std::size_t    numChans=NumChans;
+    static constexpr std::size_t    sampsPerChan=NumSamps;
+    static constexpr std::size_t    size=NumChans*NumSamps;
+    static constexpr std::size_t    chanStride=L==Layout::GroupByChannel ? NumSamps : 1;
+    static constexpr std::size_t    sampStride=L==Layout::GroupByChannel ? 1 : NumChans;
+
+    std::array<Sample,size>         data;
+
+    Sample       &At(std::size_t chan, std::size_t samp)       { return data[chan*chanStride+samp*sampStride]; }
+    const Sample &At(std::size_t chan, std::size_t samp) const { return data[chan*chanStride+samp*sampStride]; }
+
+    std::span<Sample,size>       Span()       { return std::span<Sample,size>(data); }
+    std::span<const Sample,size> Span() const { return std::span<const Sample,size>(data); }
+
+    // The samples of one channel, which are contiguous only when
+    // grouped by channel.
+    std::span<Sample,NumSamps> Channel(std::size_t chan) requires (L==Layout::GroupByChannel)
+    {
+        return std::span<Sample,NumSamps>(data.data()+chan*NumSamps,NumSamps);
+    }
+};
+
+class Task {
+public:
+    Task() = default;
+    explicit Task(const char *name) { Check(DAQmxCreateTask(name,&handle_)); }
+    // Takes over a handle created with the C calls.
+    explicit Task(TaskHandle handle) noexcept : handle_(handle) {}
+    ~Task() { Clear(); }
+
+    Task(Task &&other) noexcept : handle_(std::exchange(other.handle_,TaskHandle(0))) {}
+    Task &operator=(Task &&other) noexcept
+    {
+        if( this!=&other ) {
+            Clear();
+            handle_ = std::exchange(other.handle_,TaskHandle(0));
+        }
+        return *this;
+    }
+    Task(const Task &) = delete;
+    Task &operator=(const Task &) = delete;
+
+    TaskHandle Handle() const noexcept { return handle_; }
+    explicit operator bool() const noexcept { return handle_!=0; }
+
+    // Gives up ownership without clearing the task.
+    TaskHandle Release() noexcept { return std::exchange(handle_,TaskHandle(0)); }
+
+    void Clear() noexcept
+    {
+        if( handle_ ) {
+            DAQmxStopTask(handle_);
+            DAQmxClearTask(handle_);
+            handle_ = 0;
+        }
+    }
+
+    void  Start() { Check(DAQmxStartTask(handle_)); }
+    int32 Stop() noexcept { return DAQmxStopTask(handle_); }
+
+    void CfgSampClkTiming(float64 rate, int32 sampleMode, uInt64 sampsPerChan, const char *source="", int32 activeEdge=DAQmx_Val_Rising)
+    {
+        Check(DAQmxCfgSampClkTiming(handle_,source,rate,activeEdge,sampleMode,sampsPerChan));
+    }
+
+    void CfgDigEdgeStartTrig(const char *source, int32 edge=DAQmx_Val_Rising)
+    {
+        Check(DAQmxCfgDigEdgeStartTrig(handle_,source,edge));
+    }
+
+    uInt32 GetNumChans() const
+    {
+        uInt32 n=0;
+
+        Check(DAQmxGetTaskNumChans(handle_,&n));
+        return n;
+    }
+
+    // Method is called as (object.*Method)(eventType,nSamples) and
+    // returns int32 as a DAQmx callback does.
+    template<auto Method, class T>
+    void EveryN(T &object, uInt32 nSamples, int32 eventType=DAQmx_Val_Acquired_Into_Buffer, uInt32 options=0)
+    {
+        Check(DAQmxRegisterEveryNSamplesEvent(handle_,eventType,nSamples,options,&EveryNTrampoline<Method,T>,&object));
+    }
+
+    // Method is called as (object.*Method)(status).
+    template<auto Method, class T>
+    void Done(T &object, uInt32 options=0)
+    {
+        Check(DAQmxRegisterDoneEvent(handle_,options,&DoneTrampoline<Method,T>,&object));
+    }
+
+    template<auto Method, class T>
+    static int32 CVICALLBACK EveryNTrampoline(TaskHandle, int32 eventType, uInt32 nSamples, void *callbackData) noexcept
+    {
+        return (static_cast<T*>(callbackData)->*Method)(eventType,nSamples);
+    }
+
+    template<auto Method, class T>
+    static int32 CVICALLBACK DoneTrampoline(TaskHandle, int32 status, void *callbackData) noexcept
+    {
+        return (static_cast<T*>(callbackData)->*Method)(status);
+    }
+
+protected:
+    void CheckNumChans(std::size_t expected)
+    {
+        if( GetNumChans()!=expected )
+            throw Error(ErrNumChans,"The task does not have the number of channels it was declared with");
+    }
+
+private:
+    TaskHandle  handle_=0;
+};
+
+template<std::size_t NumChans, class Sample=float64, Layout L=Layout::GroupByChannel>
+class AITask : public Task {
+    static_assert(std::is_same_v<Sample,float64> || std::is_same_v<Sample,int16>,"AI samples are float64 or int16");
+
+public:
+    // Takes over a handle created with the C calls. If it does not have
+    // NumChans channels, the task is cleared and Error is thrown.
+    explicit AITask(TaskHandle handle) : Task(handle) { CheckNumChans(NumChans); }
+
+    // Creates the task with NumChans voltage channels.
+    AITask(const char *physicalChannels, float64 minVal, float64 maxVal, int32 terminalConfig=DAQmx_Val_Cfg_Default, const char *name="")
+        : Task(name)
+    {
+        Check(DAQmxCreateAIVoltageChan(Handle(),physicalChannels,"",terminalConfig,minVal,maxVal,DAQmx_Val_Volts,nullptr));
+        CheckNumChans(NumChans);
+    }
+
+    template<std::size_t Size>
+    [[nodiscard]] int32 Read(std::span<Sample,Size> data, float64 timeout, int32 *sampsPerChanRead=nullptr) noexcept
+    {
+        static_assert(Size!=std::dynamic_extent && Size%NumChans==0,"the span must hold whole scans");
+        constexpr int32     sampsPerChan=int32(Size/NumChans);
+        constexpr uInt32    arraySize=uInt32(Size);
+
+        if constexpr( std::is_same_v<Sample,float64> )
+            return DAQmxReadAnalogF64(Handle(),sampsPerChan,timeout,bool32(L),data.data(),arraySize,sampsPerChanRead,nullptr);
+        else
+            return DAQmxReadBinaryI16(Handle(),sampsPerChan,timeout,bool32(L),data.data(),arraySize,sampsPerChanRead,nullptr);
+    }
+
+    template<std::size_t N>
+    [[nodiscard]] int32 Read(Block<NumChans,N,Sample,L> &block, float64 timeout, int32 *sampsPerChanRead=nullptr) noexcept
+    {
+        return Read(block.Span(),timeout,sampsPerChanRead);
+    }
+};
+
+template<std::size_t NumChans, class Sample=float64, Layout L=Layout::GroupByChannel>
+class AOTask : public Task {
+    static_assert(std::is_same_v<Sample,float64> || std::is_same_v<Sample,int16>,"AO samples are float64 or int16");
+
+public:
+    // Takes over a handle created with the C calls. If it does not have
+    // NumChans channels, the task is cleared and Error is thrown.
+    explicit AOTask(TaskHandle handle) : Task(handle) { CheckNumChans(NumChans); }
+
+    AOTask(const char *physicalChannels, float64 minVal, float64 maxVal, const char *name="")
+        : Task(name)
+    {
+        Check(DAQmxCreateAOVoltageChan(Handle(),physicalChannels,"",minVal,maxVal,DAQmx_Val_Volts,nullptr));
+        CheckNumChans(NumChans);
+    }
+
+    template<class S, std::size_t Size> requires std::is_same_v<std::remove_const_t<S>,Sample>
+    [[nodiscard]] int32 Write(std::span<S,Size> data, bool32 autoStart, float64 timeout, int32 *sampsPerChanWritten=nullptr) noexcept
+    {
+        static_assert(Size!=std::dynamic_extent && Size%NumChans==0,"the span must hold whole scans");
+        constexpr int32 sampsPerChan=int32(Size/NumChans);
+
+        if constexpr( std::is_same_v<Sample,float64> )
+            return DAQmxWriteAnalogF64(Handle(),sampsPerChan,autoStart,timeout,bool32(L),data.data(),sampsPerChanWritten,nullptr);
+        else
+            return DAQmxWriteBinaryI16(Handle(),sampsPerChan,autoStart,timeout,bool32(L),data.data(),sampsPerChanWritten,nullptr);
+    }
+
+    template<std::size_t N>
+    [[nodiscard]] int32 Write(const Block<NumChans,N,Sample,L> &block, bool32 autoStart, float64 timeout, int32 *sampsPerChanWritten=nullptr) noexcept
+    {
+        return Write(block.Span(),autoStart,timeout,sampsPerChanWritten);
+    }
+};
+
+} // namespace DAQmx
+
+#endif
@@ -0,0 +1,395 @@
+/*********************************************************************
+*
+* Task helper:
+*    DAQmxTrace.c
+*
+* Description:
+*    Implementation of the DAQmx call trace. See DAQmxTrace.h and
+*    DAQmxTraceFormat.h.
+*
+*    Each thread that makes a call while recording gets a ring of
+*    records on its first call. The ring has one writer, the thread,
+*    and one reader, the flush thread, which publish their positions
+*    with release stores. Rings are kept for the life of the process,
+*    so a thread's ring is still valid in a later recording. When a
+*    thread ends its ring is released, through a thread-specific key
+*    with a destructor, and handed to the next thread that registers,
+*    which also takes over its thread number. Records of the ended
+*    thread still in the ring are written as usual. So at
+*    most MAX_THREADS rings exist, and only threads that would need
+*    more at the same time go untraced.
+*
+*    The time stamp counter is calibrated against the monotonic clock
+*    over the whole recording, and the result stored in the header.
+*
+*********************************************************************/
+
+#define DAQMX_TRACE_NO_WRAPPERS
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+#include "DAQmxTrace.h"
+#include "../Processing/StreamTime.h"
+#include "../Processing/StreamThread.h"
+
+#define MAX_THREADS         256
+#define RING_SIZE           16384       // records, a power of two
+#define FLUSH_INTERVAL      0.005       // s
+#define CALIBRATION_TIME    0.01        // s
+
+#if defined(_MSC_VER)
+#define TRACE_TLS __declspec(thread)
+#else
+#define TRACE_TLS _Thread_local
+#endif
+
+enum { Unchecked, Idle, Recording, Checking };
+
+typedef struct Ring {
+    atomic_ullong       head;           // written by the thread
+    char                pad1[56];
+    atomic_ullong       tail;           // written by the flush thread
+    atomic_llong        dropped;
+    char                pad2[48];
+    uInt32              thread;
+    atomic_int          owned;          // 0 once the thread has ended
+    DAQmxTraceRecord    records[RING_SIZE];
+} Ring;
+
+static Ring *_Atomic    rings[MAX_THREADS];
+static atomic_int       numRings;
+static atomic_llong     untraced;
+static TRACE_TLS Ring   *threadRing;
+static TRACE_TLS int    threadUntraced;
+static atomic_int       keyState;       // 0 none, 1 creating, 2 created, 3 failed
+static atomic_int       state=Unchecked;
+static atomic_int       flushing;
+static atomic_int       adding;         // calls between the state check and their record
+static StreamThread     flushThread;
+static FILE             *file;
+static uInt64           startTicks;
+static double           startTime;
+static long long        written;
+static long long        droppedBefore;
+static long long        untracedBefore;
+
+volatile int            DAQmxTraceEnabled=1;
+
+static void ReleaseRing(void *ring)
+{
+    threadRing = NULL;
+    atomic_store_explicit(&((Ring*)ring)->owned,0,memory_order_release);
+}
+
+#if defined(WIN32) || defined(_WIN32)
+static DWORD            ringKey;
+
+static void WINAPI RingKeyDestructor(void *ring)
+{
+    if( ring )
+        ReleaseRing(ring);
+}
+
+static int  CreateRingKey(void)     { ringKey=FlsAlloc(RingKeyDestructor); return ringKey!=FLS_OUT_OF_INDEXES ? 0 : -1; }
+static void SetRingKey(Ring *r)     { FlsSetValue(ringKey,r); }
+#else
+static pthread_key_t    ringKey;
+
+static int  CreateRingKey(void)     { return pthread_key_create(&ringKey,ReleaseRing); }
+static void SetRingKey(Ring *r)     { pthread_setspecific(ringKey,r); }
+#endif
+
+// Has the ring released when the calling thread ends. Without the key
+// the ring stays with the thread for the life of the process.
+static void ReleaseAtThreadExit(Ring *r)
+{
+    int none=0;
+
+    if( atomic_compare_exchange_strong(&keyState,&none,1) )
+        atomic_store(&keyState,CreateRingKey()==0 ? 2 : 3);
+    while( atomic_load(&keyState)==1 )
+        StreamCpuRelax();
+    if( atomic_load(&keyState)==2 )
+        SetRingKey(r);
+}
+
+static Ring *Register(void)
+{
+    int     n=atomic_load(&numRings),i;
+    Ring    *r=NULL;
+
+    if( threadUntraced )
+        return NULL;
+    for(i=0;i<n && !r;++i) {
+        Ring    *c=atomic_load_explicit(&rings[i],memory_order_acquire);
+        int     released=0;
+
+        if( c && atomic_load_explicit(&c->owned,memory_order_relaxed)==0
+              && atomic_compare_exchange_strong(&c->owned,&released,1) )
+            r = c;
+    }
+    if( !r ) {
+        while( n<MAX_THREADS && !atomic_compare_exchange_weak(&numRings,&n,n+1) )
+            ;
+        if( n<MAX_THREADS )
+            r = (Ring*)calloc(1,sizeof(Ring));
+        if( !r ) {
+            threadUntraced = 1;
+            atomic_fetch_add(&untraced,1);
+            return NULL;
+        }
+        atomic_init(&r->head,0);
+        atomic_init(&r->tail,0);
+        atomic_init(&r->dropped,0);
+        atomic_init(&r->owned,1);
+        r->thread = (uInt32)n;
+        atomic_store_explicit(&rings[n],r,memory_order_release);
+    }
+    ReleaseAtThreadExit(r);
+    threadRing = r;
+    return r;
+}
+
+// Writes the records the thread has added since the last drain.
+static void Drain(Ring *r)
+{
+    uInt64  tail=atomic_load_explicit(&r->tail,memory_order_relaxed);
+    uInt64  head=atomic_load_explicit(&r->head,memory_order_acquire);
+
+    while( tail!=head ) {
+        uInt32          first=(uInt32)(tail&(RING_SIZE-1));
+        uInt32          count=(uInt32)(head-tail<RING_SIZE-first ? head-tail : RING_SIZE-first);
+        DAQmxTraceChunk chunk;
+
+        chunk.thread = r->thread;
+        chunk.count = count;
+        fwrite(&chunk,sizeof(chunk),1,file);
+        fwrite(&r->records[first],sizeof(DAQmxTraceRecord),count,file);
+        written += count;
+        tail += count;
+    }
+    atomic_store_explicit(&r->tail,tail,memory_order_release);
+}
+
+static void DrainAll(void)
+{
+    int i,n=atomic_load(&numRings);
+
+    for(i=0;i<n;++i) {
+        Ring *r=atomic_load_explicit(&rings[i],memory_order_acquire);
+
+        if( r )
+            Drain(r);
+    }
+}
+
+static STREAM_THREAD_PROC(FlushThread, arg)
+{
+    while( atomic_load(&flushing) ) {
+        DrainAll();
+        StreamSleep(FLUSH_INTERVAL);
+    }
+    return 0;
+}
+
+static long long Dropped(void)
+{
+    long long   sum=0;
+    int         i,n=atomic_load(&numRings);
+
+    for(i=0;i<n;++i) {
+        Ring *r=atomic_load_explicit(&rings[i],memory_order_acquire);
+
+        if( r )
+            sum += atomic_load(&r->dropped);
+    }
+    return sum;
+}
+
+static void WriteHeader(double ticksPerSecond)
+{
+    DAQmxTraceFileHeader h;
+
+    memset(&h,0,sizeof(h));
+    memcpy(h.magic,DAQMX_TRACE_MAGIC,8);
+    h.version = DAQMX_TRACE_VERSION;
+    h.recordSize = sizeof(DAQmxTraceRecord);
+    h.ticksPerSecond = ticksPerSecond;
+    h.startTicks = startTicks;
+    h.numRecords = (uInt64)written;
+    h.numDropped = (uInt64)(Dropped()-droppedBefore);
+    h.numThreads = (uInt32)atomic_load(&numRings);
+    fseek(file,0,SEEK_SET);
+    fwrite(&h,sizeof(h),1,file);
+}
+
+static double TicksPerSecond(void)
+{
+    double elapsed=StreamTimeNow()-startTime;
+
+    return (double)(DAQmxTraceNow()-startTicks)/elapsed;
+}
+
+int32 DAQmxTraceStart(const char fileName[])
+{
+    int expected=Idle;
+
+    if( !fileName || !fileName[0] )
+        return DAQmxTraceErrInvalidArg;
+    if( atomic_load(&state)==Recording )
+        return DAQmxTraceErrRunning;
+    file = fopen(fileName,"wb");
+    if( !file )
+        return DAQmxTraceErrFile;
+    written = 0;
+    droppedBefore = Dropped();
+    untracedBefore = atomic_load(&untraced);
+    startTime = StreamTimeNow();
+    startTicks = DAQmxTraceNow();
+    while( StreamTimeNow()-startTime<CALIBRATION_TIME )
+        ;
+    WriteHeader(TicksPerSecond());
+    atomic_store(&flushing,1);
+    if( StreamThreadCreate(&flushThread,FlushThread,NULL)!=0 ) {
+        fclose(file);
+        file = NULL;
+        return DAQmxTraceErrOutOfMemory;
+    }
+    // From Unchecked or Checking as well as Idle.
+    if( !atomic_compare_exchange_strong(&state,&expected,Recording) )
+        atomic_store(&state,Recording);
+    DAQmxTraceEnabled = 1;
+    return 0;
+}
+
+int32 DAQmxTraceStop(void)
+{
+    double ticksPerSecond;
+
+    if( atomic_load(&state)!=Recording )
+        return 0;
+    atomic_store(&state,Idle);
+    DAQmxTraceEnabled = 0;
+    // Let calls that saw the recording state finish their record, so
+    // none lands in the rings after the last drain.
+    while( atomic_load(&adding)>0 )
+        StreamCpuRelax();
+    atomic_store(&flushing,0);
+    StreamThreadJoin(flushThread);
+    DrainAll();
+    ticksPerSecond = TicksPerSecond();
+    WriteHeader(ticksPerSecond);
+    fclose(file);
+    file = NULL;
+    return 0;
+}
+
+void DAQmxTraceGetStats(DAQmxTraceStats *stats)
+{
+    stats->records = written;
+    stats->dropped = Dropped()-droppedBefore;
+    stats->threads = atomic_load(&numRings);
+    stats->untraced = atomic_load(&untraced)-untracedBefore;
+}
+
+static void StopAtExit(void)
+{
+    DAQmxTraceStop();
+}
+
+// Starts recording if DAQMX_TRACE names a file. Runs once.
+static void CheckEnvironment(void)
+{
+    int         expected=Unchecked;
+    const char  *fileName;
+
+    if( !atomic_compare_exchange_strong(&state,&expected,Checking) )
+        return;
+    fileName = getenv("DAQMX_TRACE");
+    if( fileName && fileName[0] && DAQmxTraceStart(fileName)==0 ) {
+        atexit(StopAtExit);
+        return;
+    }
+    expected = Checking;
+    if( atomic_compare_exchange_strong(&state,&expected,Idle) )
+        DAQmxTraceEnabled = 0;
+}
+
+void DAQmxTraceAdd(int call, TaskHandle task, int64 arg, float64 value, uInt64 start, int32 status)
+{
+    uInt64              end=DAQmxTraceNow();
+    Ring                *r;
+    uInt64              head;
+    DAQmxTraceRecord    *rec;
+    int                 s=atomic_load_explicit(&state,memory_order_relaxed);
+
+    if( s!=Recording ) {
+        if( s!=Unchecked )
+            return;
+        CheckEnvironment();
+        if( atomic_load(&state)!=Recording )
+            return;
+    }
+    // Announce the record before checking the state again, so that
+    // DAQmxTraceStop either waits for it or is seen here.
+    atomic_fetch_add(&adding,1);
+    if( atomic_load(&state)!=Recording ) {
+        atomic_fetch_sub(&adding,1);
+        return;
+    }
+    r = threadRing;
+    if( !r && !(r=Register()) ) {
+        atomic_fetch_sub(&adding,1);
+        return;
+    }
+    head = atomic_load_explicit(&r->head,memory_order_relaxed);
+    if( head-atomic_load_explicit(&r->tail,memory_order_acquire)>=RING_SIZE ) {
+        atomic_fetch_add_explicit(&r->dropped,1,memory_order_relaxed);
+        atomic_fetch_sub(&adding,1);
+        return;
+    }
+    rec = &r->records[head&(RING_SIZE-1)];
+    rec->start = start;
+    rec->task = (uInt64)(size_t)task;
+    rec->arg = arg;
+    rec->value = value;
+    rec->ticks = end-start>0xFFFFFFFFu ? 0xFFFFFFFFu : (uInt32)(end-start);
+    rec->status = status;
+    rec->call = (uInt16)call;
+    rec->reserved = 0;
+    rec->reserved2 = 0;
+    atomic_store_explicit(&r->head,head+1,memory_order_release);
+    atomic_fetch_sub_explicit(&adding,1,memory_order_release);
+}
+
+void DAQmxTraceMark(int64 value)
+{
+    DAQmxTraceAdd(DAQmxTraceCall_Mark,0,value,0.0,DAQmxTraceNow(),0);
+}
+
+int64 DAQmxTraceCountChans(const char channels[])
+{
+    const char  *p=channels;
+    int64       n=0;
+
+    while( p && *p ) {
+        size_t      len=strcspn(p,",");
+        const char  *colon=(const char*)memchr(p,':',len);
+
+        if( colon ) {
+            const char *first=colon;
+
+            while( first>p && first[-1]>='0' && first[-1]<='9' )
+                --first;
+            n += llabs(atoll(colon+1)-atoll(first))+1;
+        }
+        else if( strspn(p," ")<len )
+            n++;
+        p += len;
+        if( *p )
+            ++p;
+    }
+    return n;
+}
@@ -0,0 +1,798 @@
+/*********************************************************************
+*
+* Task helper:
+*    DAQmxTrace.h
+*
+* Description:
+*    Binary trace of the DAQmx calls a program makes, for finding out
+*    after the fact what each thread was doing when a run failed, for
+*    example what the EveryN callback thread was waiting on when the
+*    buffer overflowed.
+*
+*    Including this header after NIDAQmx.h replaces each DAQmx function
+*    that the examples use by an inline wrapper that calls it and
+*    records the call: which function, the task, a summary of the
+*    arguments (see DAQmxTraceFormat.h), the return value, and the
+*    time stamp counter before and after. To trace a program and its
+*    helpers without editing them, force-include the header in every
+*    file (gcc -include Tasks/DAQmxTrace.h, MSVC /FI) and link
+*    DAQmxTrace.c, which is compiled without it, as are DAQmxReplay.c
+*    and SimDAQmx.c. Defining DAQMX_TRACE_NO_WRAPPERS before the
+*    include leaves out the wrappers.
+*
+*    Recording starts with DAQmxTraceStart, or on the first DAQmx call
+*    if the DAQMX_TRACE environment variable names a file, in which
+*    case it stops when the program exits. When not recording a
+*    wrapper costs a load and a branch. While recording, each thread
+*    appends to a buffer of its own without locks, and a background
+*    thread writes the buffers to the file every few milliseconds. A
+*    call costs two reads of the time stamp counter and a 48 byte
+*    store, some tens of ns. If a thread makes calls faster than they
+*    are written its buffer fills and further records are dropped and
+*    counted.
+*
+*    The buffer of a thread that ends is reused by the next new
+*    thread. Threads beyond 256 running at once are not traced, and
+*    are counted.
+*
+*    Stop recording with DAQmxTraceStop after the tasks are cleared.
+*    DAQmxReplay.h reads the file back.
+*
+*********************************************************************/
+
+#ifndef DAQMXTRACE_H
+#define DAQMXTRACE_H
+
+#include <NIDAQmx.h>
+#include "DAQmxTraceFormat.h"
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#else
+#include "../Processing/StreamTime.h"
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define DAQmxTraceErrInvalidArg     -1
+#define DAQmxTraceErrOutOfMemory    -2
+#define DAQmxTraceErrFile           -3
+#define DAQmxTraceErrRunning        -4
+
+typedef struct DAQmxTraceStats {
+    long long   records;        // written to the file
+    long long   dropped;
+    int         threads;        // buffers, each used by one thread at a time
+    long long   untraced;       // threads that found no free buffer
+} DAQmxTraceStats;
+
+int32 DAQmxTraceStart(const char fileName[]);
+int32 DAQmxTraceStop(void);
+void  DAQmxTraceGetStats(DAQmxTraceStats *stats);
+
+// Records a marker with a value of the caller's choosing, e.g. on
+// entry to a callback.
+void  DAQmxTraceMark(int64 value);
+
+// Used by the wrappers. DAQmxTraceEnabled is set while recording,
+// and before the environment has been checked.
+extern volatile int DAQmxTraceEnabled;
+void  DAQmxTraceAdd(int call, TaskHandle task, int64 arg, float64 value, uInt64 start, int32 status);
+int64 DAQmxTraceCountChans(const char channels[]);
+
+static inline uInt64 DAQmxTraceNow(void)
+{
+#if (defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))) || defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return (uInt64)(1e9*StreamTimeNow());
+#endif
+}
+
+#ifndef DAQMX_TRACE_NO_WRAPPERS
+
+static inline int32 DAQmxTracedCreateTask(const char taskName[], TaskHandle *taskHandle)
+{
+    uInt64  start=DAQmxTraceEnabled ? DAQmxTraceNow() : 0;
+    int32   status=DAQmxCreateTask(taskName,taskHandle);
+
+    if( start )
+        DAQmxTraceAdd(DAQmxTraceCall_CreateTask,status==0 ? *taskHandle : 0,0,0.0,start,status);
+    return status;
+}
+
+static inline int32 DAQmxTracedClearTask(TaskHandle taskHandle)
+{
+    uInt64  start=DAQmxTraceEnabled ? DAQmxTraceNow() : 0;
+    int32   status=DAQmxClearTask(taskHandle);
+
+    if( start )
+        DAQmxTraceAdd(DAQmxTraceCall_ClearTask,taskHandle,0,0.0,start,status);
+    return status;
+}
+
+static inline int32 DAQmxTracedStartTask(TaskHandle taskHandle)
+{
+    uInt64  start=DAQmxTraceEnabled ? DAQmxTraceNow() : 0;
+    int32   status=DAQmxStartTask(taskHandle);
+
+    if( start )
+        DAQmxTraceAdd(DAQmxTraceCall_StartTask,taskHandle,0,0.0,start,status);
+    return status;
+}
+
+static inline int32 DAQmxTracedStopTask(TaskHandle taskHandle)
+{
+    uInt64  start=DAQmxTraceEnabled ? DAQmxTraceNow() : 0;
+    int32   status=DAQmxStopTask(taskHandle);
+
+    if( start )
+        DAQmxTraceAdd(DAQmxTraceCall_StopTask,taskHandle,0,0.0,start,status);
+    return status;
+}
+
+static inline int32 DAQmxTracedTaskControl(TaskHandle taskHandle, int32 action)
+{
+    uInt64  start=DAQmxTraceEnabled ? DAQmxTraceNow() : 0;
+    int32   status=DAQmxTaskControl(taskHandle,action);
+
+    if( start )
+        DAQmxTraceAdd(DAQmxTraceCall_TaskControl,taskHandle,action,0.0,start,status);
+    return status;
+}
+
+static inline int32 DAQmxTracedWaitUntilTaskDone(TaskHandle taskHandle, float64 timeToWait)
+{
+    uInt64  start=DAQmxTraceEnabled ? DAQmxTraceNow() : 0;
+    int32   status=DAQmxWaitUntilTaskDone(taskHandle,timeToWait);
+
+    if( start )
+        DAQmxTraceAdd(DAQmxTraceCall_WaitUntilTaskDone,taskHandle,0,timeToWait,start,status);
+    return status;
+}
+
+static inline int32 DAQmxTracedCreateAIVoltageChan(TaskHandle taskHandle, const char physicalChannel[], const char nameToAssignToChannel[], int32 terminalConfig, float64 minVal, float64 maxVal, int32 units, const char customScaleName[])
+{
+    uInt64  start=DAQmxTraceEnabled ? DAQmxTraceNow() : 0;
+    int32   status=DAQmxCreateAIVoltageChan(taskHandle,physicalChannel,nameToAssignToChannel,terminalConfig,minVal,maxVal,units,customScaleName);
+
+    if( start )
+        DAQmxTraceAdd(DAQmxTraceCall_CreateAIVoltageChan,taskHandle,DAQmxTraceCountChans(physicalChannel),maxVal,start,status);
+    return status;
+}
+
+static inline int32 DAQmxTracedCreateAOVoltageChan(TaskHandle taskHandle, const char physicalChannel[], const char nameToAssignToChannel[], float64 minVal, float64 maxVal, int32 units, const char customScaleName[])
+{
+    uInt64  start=DAQmxTraceEnabled ? DAQmxTraceNow() : 0;
+    int32   status=DAQmxCreateAOVoltageChan(taskHandle,physicalChannel,nameToAssignToChannel,minVal,maxVal,units,customScaleName);
+
+    if( start )
+        DAQmxTraceAdd(DAQmxTraceCall_CreateAOVoltageChan,taskHandle,DAQmxTraceCountChans(physicalChannel),maxVal,start,status);
+    return status;
+}
+
+static inline int32 DAQmxTracedCreateDOChan(TaskHandle taskHandle, const char lines[], const char nameToAssignToLines[], int32 lineGrouping)
+{
+    uInt64  start=DAQmxTraceEnabled ? DAQmxTraceNow() : 0;
+    int32   status=DAQmxCreateDOChan(taskHandle,lines,nameToAssignToLines,lineGrouping);
+
+    if( start )
+        DAQmxTraceAdd(DAQmxTraceCall_CreateDOChan,taskHandle,DAQmxTraceCountChans(lines),0.0,start,status);
+    return status;
+}
+
+static inline int32 DAQmxTracedCreateCOPulseChanTime(TaskHandle taskHandle, const char counter[], const char nameToAssignToChannel[], int32 units, int32 idleState, float64 initialDelay, float64 lowTime, float64 highTime)
+{
+    uInt64  start=DAQmxTraceEnabled ? DAQmxTraceNow() : 0;
+    int32   status=DAQmxCreateCOPulseChanTime(taskHandle,counter,nameToAssignToChannel,units,idleState,initialDelay,lowTime,highTime);
+
+    if( start )
+        DAQmxTraceAdd(DAQmxTraceCall_CreateCOPulseChanTime,taskHandle,1,highTime,start,status);
+    return status;
+}
+
+static inline int32 DAQmxTracedCreateCOPulseChanTicks(TaskHandle taskHandle, const char counter[], const char nameToAssignToChannel[], const char sourceTerminal[], int32 idleState, int32 initialDelay, int32 lowTicks, int32 highTicks)
+{
+    uInt64  start=DAQmxTraceEnabled ? DAQmxTraceNow() : 0;
+    int32   status=DAQmxCreateCOPulseChanTicks(taskHandle,counter,nameToAssignToChannel,sourceTerminal,idleState,initialDelay,lowTicks,highTicks);
+
+    if( start )
+        DAQmxTraceAdd(DAQmxTraceCall_CreateCOPulseChanTicks,taskHandle,highTicks,0.0,start,status);
+    return status;
+}
+
+static inline int32 DAQmxTracedCreateCOPulseChanFreq(TaskHandle taskHandle, const char counter[], const char nameToAssignToChannel[], int32 units, int32 idleState, float64 initialDelay, float64 freq, float64 dutyCycle)
+{
+    uInt64  start=DAQmxTraceEnabled ? DAQmxTraceNow() : 0;
+    int32   status=DAQmxCreateCOPulseChanFreq(taskHandle,counter,nameToAssignToChannel,units,idleState,initialDelay,freq,dutyCycle);
+
+    if( start )
+        DAQmxTraceAdd(DAQmxTraceCall_CreateCOPulseChanFreq,taskHandle,1,freq,start,status);
+    return status;
+}
+
+static inline int32 DAQmxTracedCfgSampClkTiming(TaskHandle taskHandle, const char source[], float64 rate, int32 activeEdge, int32 sampleMode, uInt64 sampsPerChan)
+{
+    uInt64  start=DAQmxTraceEnabled ? DAQmxTraceNow() : 0;
+    int32   status=DAQmxCfgSampClkTiming(taskHandle,source,rate,activeEdge,sampleMode,sampsPerChan);
+
+    if( start )
+        DAQmxTraceAdd(DAQmxTraceCall_CfgSampClkTiming,taskHandle,sampleMode==DAQmx_Val_ContSamps ? -(int64)sampsPerChan : (int64)sampsPerChan,rate,start,status);
+    return status;
+}
+
+static inline int32 DAQmxTracedCfgImplicitTiming(TaskHandle taskHandle, int32 sampleMode, uInt64 sampsPerChan)
+{
+    uInt64  start=DAQmxTraceEnabled ? DAQmxTraceNow() : 0;
+    int32   status=DAQmxCfgImplicitTiming(taskHandle,sampleMode,sampsPerChan);
+
+    if( start )
+        DAQmxTraceAdd(DAQmxTraceCall_CfgImplicitTiming,taskHandle,(int64)sampsPerChan,0.0,start,status);
+    return status;
+}
+
+static inline int32 DAQmxTracedCfgDigEdgeStartTrig(TaskHandle taskHandle, const char triggerSource[], int32 triggerEdge)
+{
+    uInt64  start=DAQmxTraceEnabled ? DAQmxTraceNow() : 0;
+    int32   status=DAQmxCfgDigEdgeStartTrig(taskHandle,triggerSource,triggerEdge);
+
+    if( start )
+        DAQmxTraceAdd(DAQmxTraceCall_CfgDigEdgeStartTrig,taskHandle,triggerEdge,0.0,start,status);
+    return status;
+}
+
+static inline int32 DAQmxTracedCfgOutputBuffer(TaskHandle taskHandle, uInt32 numSampsPerChan)
+{
+    uInt64  start=DAQmxTraceEnabled ? DAQmxTraceNow() : 0;
+    int32   status=DAQmxCfgOutputBuffer(taskHandle,numSampsPerChan);
+
+    if( start )
+        DAQmxTraceAdd(DAQmxTraceCall_CfgOutputBuffer,taskHandle,numSampsPerChan,0.0,start,status);
+    return status;
+}
+
+static inline int32 DAQmxTracedRegisterEveryNSamplesEvent(TaskHandle taskHandle, int32 everyNsamplesEventType, uInt32 nSamples, uInt32 options, DAQmxEveryNSamplesEventCallbackPtr callbackFunction, void *callbackData)
+{
+    uInt64  start=DAQmxTraceEnabled ? DAQmxTraceNow() : 0;
+    int32   status=DAQmxRegisterEveryNSamplesEvent(taskHandle,everyNsamplesEventType,nSamples,options,callbackFunction,callbackData);
+
+    if( start )
+        DAQmxTraceAdd(DAQmxTraceCall_RegisterEveryNSamplesEvent,taskHandle,nSamples,0.0,start,status);
+    return status;
+}
+
+static inline int32 DAQmxTracedRegisterDoneEvent(TaskHandle taskHandle, uInt32 options, DAQmxDoneEventCallbackPtr callbackFunction, void *callbackData)
+{
+    uInt64  start=DAQmxTraceEnabled ? DAQmxTraceNow() : 0;
+    int32   status=DAQmxRegisterDoneEvent(taskHandle,options,callbackFunction,callbackData);
+
+    if( start )
+        DAQmxTraceAdd(DAQmxTraceCall_RegisterDoneEvent,taskHandle,0,0.0,start,status);
+    return status;
+}
+
+static inline int32 DAQmxTracedReadAnalogF64(TaskHandle taskHandle, int32 numSampsPerChan, float64 timeout, bool32 fillMode, float64 readArray[], uInt32 arraySizeInSamps, int32 *sampsPerChanRead, bool32 *reserved)
+{
+    uInt64  start=DAQmxTraceEnabled ? DAQmxTraceNow() : 0;
+    int32   status=DAQmxReadAnalogF64(taskHandle,numSampsPerChan,timeout,fillMode,readArray,arraySizeInSamps,sampsPerChanRead,reserved);
+
+    if( start )
+        DAQmxTraceAdd(DAQmxTraceCall_ReadAnalogF64,taskHandle,numSampsPerChan,timeout,start,status);
+    return status;
+}
+
+static inline int32 DAQmxTracedReadBinaryI16(TaskHandle taskHandle, int32 numSampsPerChan, float64 timeout, bool32 fillMode, int16 readArray[], uInt32 arraySizeInSamps, int32 *sampsPerChanRead, bool32 *reserved)
+{
+    uInt64  start=DAQmxTraceEnabled ? DAQmxTraceNow() : 0;
+    int32   status=DAQmxReadBinaryI16(taskHandle,numSampsPerChan,timeout,fillMode,readArray,arraySizeInSamps,sampsPerChanRead,reserved);
+
+    if( start )
+        DAQmxTraceAdd(DAQmxTraceCall_ReadBinaryI16,taskHandle,numSampsPerChan,timeout,start,status);
+    return status;
+}
+
+static inline int32 DAQmxTracedWriteAnalogF64(TaskHandle taskHandle, int32 numSampsPerChan, bool32 autoStart, float64 timeout, bool32 dataLayout, const float64 writeArray[], int32 *sampsPerChanWritten, bool32 *reserved)
+{
+    uInt64  start=DAQmxTraceEnabled ? DAQmxTraceNow() : 0;
+    int32   status=DAQmxWriteAnalogF64(taskHandle,numSampsPerChan,autoStart,timeout,dataLayout,writeArray,sampsPerChanWritten,reserved);
+
+    if( start )
+        DAQmxTraceAdd(DAQmxTraceCall_WriteAnalogF64,taskHandle,numSampsPerChan,timeout,start,status);
+    return status;
+}
+
+static inline int32 DAQmxTracedWriteAnalogScalarF64(TaskHandle taskHandle, bool32 autoStart, float64 timeout, float64 value, bool32 *reserved)
+{
+    uInt64  start=DAQmxTraceEnabled ? DAQmxTraceNow() : 0;
+    int32   status=DAQmxWriteAnalogScalarF64(taskHandle,autoStart,timeout,value,reserved);
+
+    if( start )
+        DAQmxTraceAdd(DAQmxTraceCall_WriteAnalogScalarF64,taskHandle,1,value,start,status);
+    return status;
+}
+
+static inline int32 DAQmxTracedWriteDigitalU32(TaskHandle taskHandle, int32 numSampsPerChan, bool32 autoStart, float64 timeout, bool32 dataLayout, const uInt32 writeArray[], int32 *sampsPerChanWritten, bool32 *reserved)
+{
+    uInt64  start=DAQmxTraceEnabled ? DAQmxTraceNow() : 0;
+    int32   status=DAQmxWriteDigitalU32(taskHandle,numSampsPerChan,autoStart,timeout,dataLayout,writeArray,sampsPerChanWritten,reserved);
+
+    if( start )
+        DAQmxTraceAdd(DAQmxTraceCall_WriteDigitalU32,taskHandle,numSampsPerChan,timeout,start,status);
+    return status;
+}
+
+static inline int32 DAQmxTracedWriteDigitalLines(TaskHandle taskHandle, int32 numSampsPerChan, bool32 autoStart, float64 timeout, bool32 dataLayout, const uInt8 writeArray[], int32 *sampsPerChanWritten, bool32 *reserved)
+{
+    uInt64  start=DAQmxTraceEnabled ? DAQmxTraceNow() : 0;
+    int32   status=DAQmxWriteDigitalLines(taskHandle,numSampsPerChan,autoStart,timeout,dataLayout,writeArray,sampsPerChanWritten,reserved);
+
+    if( start )
+        DAQmxTraceAdd(DAQmxTraceCall_WriteDigitalLines,taskHandle,numSampsPerChan,timeout,start,status);
+    return status;
+}
+
+static inline int32 DAQmxTracedWriteCtrTicks(TaskHandle taskHandle, int32 numSampsPerChan, bool32 autoStart, float64 timeout, bool32 dataLayout, const uInt32 highTicks[], const uInt32 lowTicks[], int32 *numSampsPerChanWritten, bool32 *reserved)
+{
+    uInt64  start=DAQmxTraceEnabled ? DAQmxTraceNow() : 0;
+    int32   status=DAQmxWriteCtrTicks(taskHandle,numSampsPerChan,autoStart,timeout,dataLayout,highTicks,lowTicks,numSampsPerChanWritten,reserved);
+
+    if( start )
+        DAQmxTraceAdd(DAQmxTraceCall_WriteCtrTicks,taskHandle,numSampsPerChan,timeout,start,status);
+    return status;
+}
+
+static inline int32 DAQmxTracedWaitForNextSampleClock(TaskHandle taskHandle, float64 timeout, bool32 *isLate)
+{
+    uInt64  start=DAQmxTraceEnabled ? DAQmxTraceNow() : 0;
+    int32   status=DAQmxWaitForNextSampleClock(taskHandle,timeout,isLate);
+
+    if( start )
+        DAQmxTraceAdd(DAQmxTraceCall_WaitForNextSampleClock,taskHandle,status==0 && isLate ? (int64)*isLate : 0,timeout,start,status);
+    return status;
+}
+
+static inline int32 DAQmxTracedIsTaskDone(TaskHandle taskHandle, bool32 *isTaskDone)
+{
+    uInt64  start=DAQmxTraceEnabled ? DAQmxTraceNow() : 0;
+    int32   status=DAQmxIsTaskDone(taskHandle,isTaskDone);
+
+    if( start )
+        DAQmxTraceAdd(DAQmxTraceCall_IsTaskDone,taskHandle,status==0 ? (int64)*isTaskDone : 0,0.0,start,status);
+    return status;
+}
+
+static inline int32 DAQmxTracedGetReadAvailSampPerChan(TaskHandle taskHandle, uInt32 *data)
+{
+    uInt64  start=DAQmxTraceEnabled ? DAQmxTraceNow() : 0;
+    int32   status=DAQmxGetReadAvailSampPerChan(taskHandle,data);
+
+    if( start )
+        DAQmxTraceAdd(DAQmxTraceCall_GetReadAvailSampPerChan,taskHandle,status==0 ? (int64)*data : 0,0.0,start,status);
+    return status;
+}
+
+static inline int32 DAQmxTracedGetReadTotalSampPerChanAcquired(TaskHandle taskHandle, uInt64 *data)
+{
+    uInt64  start=DAQmxTraceEnabled ? DAQmxTraceNow() : 0;
+    int32   status=DAQmxGetReadTotalSampPerChanAcquired(taskHandle,data);
+
+    if( start )
+        DAQmxTraceAdd(DAQmxTraceCall_GetReadTotalSampPerChanAcquired,taskHandle,status==0 ? (int64)*data : 0,0.0,start,status);
+    return status;
+}
+
+static inline int32 DAQmxTracedGetReadCurrReadPos(TaskHandle taskHandle, uInt64 *data)
+{
+    uInt64  start=DAQmxTraceEnabled ? DAQmxTraceNow() : 0;
+    int32   status=DAQmxGetReadCurrReadPos(taskHandle,data);
+
+    if( start )
+        DAQmxTraceAdd(DAQmxTraceCall_GetReadCurrReadPos,taskHandle,status==0 ? (int64)*data : 0,0.0,start,status);
+    return status;
+}
+
+static inline int32 DAQmxTracedGetWriteTotalSampPerChanGenerated(TaskHandle taskHandle, uInt64 *data)
+{
+    uInt64  start=DAQmxTraceEnabled ? DAQmxTraceNow() : 0;
+    int32   status=DAQmxGetWriteTotalSampPerChanGenerated(taskHandle,data);
+
+    if( start )
+        DAQmxTraceAdd(DAQmxTraceCall_GetWriteTotalSampPerChanGenerated,taskHandle,status==0 ? (int64)*data : 0,0.0,start,status);
+    return status;
+}
+
+static inline int32 DAQmxTracedGetTaskNumChans(TaskHandle taskHandle, uInt32 *data)
+{
+    uInt64  start=DAQmxTraceEnabled ? DAQmxTraceNow() : 0;
+    int32   status=DAQmxGetTaskNumChans(taskHandle,data);
+
+    if( start )
+        DAQmxTraceAdd(DAQmxTraceCall_GetTaskNumChans,taskHandle,status==0 ? (int64)*data : 0,0.0,start,status);
+    return status;
+}
+
+static inline int32 DAQmxTracedGetAIDevScalingCoeff(TaskHandle taskHandle, const char channel[], float64 *data, uInt32 arraySizeInElements)
+{
+    uInt64  start=DAQmxTraceEnabled ? DAQmxTraceNow() : 0;
+    int32   status=DAQmxGetAIDevScalingCoeff(taskHandle,channel,data,arraySizeInElements);
+
+    if( start )
+        DAQmxTraceAdd(DAQmxTraceCall_GetAIDevScalingCoeff,taskHandle,arraySizeInElements,0.0,start,status);
+    return status;
+}
+
+static inline int32 DAQmxTracedGetAIRawSampSize(TaskHandle taskHandle, const char channel[], uInt32 *data)
+{
+    uInt64  start=DAQmxTraceEnabled ? DAQmxTraceNow() : 0;
+    int32   status=DAQmxGetAIRawSampSize(taskHandle,channel,data);
+
+    if( start )
+        DAQmxTraceAdd(DAQmxTraceCall_GetAIRawSampSize,taskHandle,status==0 ? (int64)*data : 0,0.0,start,status);
+    return status;
+}
+
+static inline int32 DAQmxTracedGetTaskNumDevices(TaskHandle taskHandle, uInt32 *data)
+{
+    uInt64  start=DAQmxTraceEnabled ? DAQmxTraceNow() : 0;
+    int32   status=DAQmxGetTaskNumDevices(taskHandle,data);
+
+    if( start )
+        DAQmxTraceAdd(DAQmxTraceCall_GetTaskNumDevices,taskHandle,status==0 ? (int64)*data : 0,0.0,start,status);
+    return status;
+}
+
+static inline int32 DAQmxTracedGetNthTaskDevice(TaskHandle taskHandle, uInt32 index, char buffer[], int32 bufferSize)
+{
+    uInt64  start=DAQmxTraceEnabled ? DAQmxTraceNow() : 0;
+    int32   status=DAQmxGetNthTaskDevice(taskHandle,index,buffer,bufferSize);
+
+    if( start )
+        DAQmxTraceAdd(DAQmxTraceCall_GetNthTaskDevice,taskHandle,index,0.0,start,status);
+    return status;
+}
+
+static inline int32 DAQmxTracedGetSysDevNames(char *data, uInt32 bufferSize)
+{
+    uInt64  start=DAQmxTraceEnabled ? DAQmxTraceNow() : 0;
+    int32   status=DAQmxGetSysDevNames(data,bufferSize);
+
+    if( start )
+        DAQmxTraceAdd(DAQmxTraceCall_GetSysDevNames,0,bufferSize,0.0,start,status);
+    return status;
+}
+
+static inline int32 DAQmxTracedGetDevProductCategory(const char device[], int32 *data)
+{
+    uInt64  start=DAQmxTraceEnabled ? DAQmxTraceNow() : 0;
+    int32   status=DAQmxGetDevProductCategory(device,data);
+
+    if( start )
+        DAQmxTraceAdd(DAQmxTraceCall_GetDevProductCategory,0,status==0 ? *data : 0,0.0,start,status);
+    return status;
+}
+
+static inline int32 DAQmxTracedGetDevProductType(const char device[], char *data, uInt32 bufferSize)
+{
+    uInt64  start=DAQmxTraceEnabled ? DAQmxTraceNow() : 0;
+    int32   status=DAQmxGetDevProductType(device,data,bufferSize);
+
+    if( start )
+        DAQmxTraceAdd(DAQmxTraceCall_GetDevProductType,0,bufferSize,0.0,start,status);
+    return status;
+}
+
+static inline int32 DAQmxTracedGetDevCompactDAQChassisDevName(const char device[], char *data, uInt32 bufferSize)
+{
+    uInt64  start=DAQmxTraceEnabled ? DAQmxTraceNow() : 0;
+    int32   status=DAQmxGetDevCompactDAQChassisDevName(device,data,bufferSize);
+
+    if( start )
+        DAQmxTraceAdd(DAQmxTraceCall_GetDevCompactDAQChassisDevName,0,bufferSize,0.0,start,status);
+    return status;
+}
+
+static inline int32 DAQmxTracedGetDevTerminals(const char device[], char *data, uInt32 bufferSize)
+{
+    uInt64  start=DAQmxTraceEnabled ? DAQmxTraceNow() : 0;
+    int32   status=DAQmxGetDevTerminals(device,data,bufferSize);
+
+    if( start )
+        DAQmxTraceAdd(DAQmxTraceCall_GetDevTerminals,0,bufferSize,0.0,start,status);
+    return status;
+}
+
+static inline int32 DAQmxTracedGetExtendedErrorInfo(char errorString[], uInt32 bufferSize)
+{
+    uInt64  start=DAQmxTraceEnabled ? DAQmxTraceNow() : 0;
+    int32   status=DAQmxGetExtendedErrorInfo(errorString,bufferSize);
+
+    if( start )
+        DAQmxTraceAdd(DAQmxTraceCall_GetExtendedErrorInfo,0,bufferSize,0.0,start,status);
+    return status;
+}
+
+static inline int32 DAQmxTracedGetCOCtrTimebaseRate(TaskHandle taskHandle, const char channel[], float64 *data)
+{
+    uInt64  start=DAQmxTraceEnabled ? DAQmxTraceNow() : 0;
+    int32   status=DAQmxGetCOCtrTimebaseRate(taskHandle,channel,data);
+
+    if( start )
+        DAQmxTraceAdd(DAQmxTraceCall_GetCOCtrTimebaseRate,taskHandle,0,status==0 ? *data : 0.0,start,status);
+    return status;
+}
+
+static inline int32 DAQmxTracedGetMasterTimebaseSrc(TaskHandle taskHandle, char *data, uInt32 bufferSize)
+{
+    uInt64  start=DAQmxTraceEnabled ? DAQmxTraceNow() : 0;
+    int32   status=DAQmxGetMasterTimebaseSrc(taskHandle,data,bufferSize);
+
+    if( start )
+        DAQmxTraceAdd(DAQmxTraceCall_GetMasterTimebaseSrc,taskHandle,bufferSize,0.0,start,status);
+    return status;
+}
+
+static inline int32 DAQmxTracedGetMasterTimebaseRate(TaskHandle taskHandle, float64 *data)
+{
+    uInt64  start=DAQmxTraceEnabled ? DAQmxTraceNow() : 0;
+    int32   status=DAQmxGetMasterTimebaseRate(taskHandle,data);
+
+    if( start )
+        DAQmxTraceAdd(DAQmxTraceCall_GetMasterTimebaseRate,taskHandle,0,status==0 ? *data : 0.0,start,status);
+    return status;
+}
+
+static inline int32 DAQmxTracedSetMasterTimebaseSrc(TaskHandle taskHandle, const char *data)
+{
+    uInt64  start=DAQmxTraceEnabled ? DAQmxTraceNow() : 0;
+    int32   status=DAQmxSetMasterTimebaseSrc(taskHandle,data);
+
+    if( start )
+        DAQmxTraceAdd(DAQmxTraceCall_SetMasterTimebaseSrc,taskHandle,0,0.0,start,status);
+    return status;
+}
+
+static inline int32 DAQmxTracedSetMasterTimebaseRate(TaskHandle taskHandle, float64 data)
+{
+    uInt64  start=DAQmxTraceEnabled ? DAQmxTraceNow() : 0;
+    int32   status=DAQmxSetMasterTimebaseRate(taskHandle,data);
+
+    if( start )
+        DAQmxTraceAdd(DAQmxTraceCall_SetMasterTimebaseRate,taskHandle,0,data,start,status);
+    return status;
+}
+
+static inline int32 DAQmxTracedGetRefClkSrc(TaskHandle taskHandle, char *data, uInt32 bufferSize)
+{
+    uInt64  start=DAQmxTraceEnabled ? DAQmxTraceNow() : 0;
+    int32   status=DAQmxGetRefClkSrc(taskHandle,data,bufferSize);
+
+    if( start )
+        DAQmxTraceAdd(DAQmxTraceCall_GetRefClkSrc,taskHandle,bufferSize,0.0,start,status);
+    return status;
+}
+
+static inline int32 DAQmxTracedGetRefClkRate(TaskHandle taskHandle, float64 *data)
+{
+    uInt64  start=DAQmxTraceEnabled ? DAQmxTraceNow() : 0;
+    int32   status=DAQmxGetRefClkRate(taskHandle,data);
+
+    if( start )
+        DAQmxTraceAdd(DAQmxTraceCall_GetRefClkRate,taskHandle,0,status==0 ? *data : 0.0,start,status);
+    return status;
+}
+
+static inline int32 DAQmxTracedSetRefClkSrc(TaskHandle taskHandle, const char *data)
+{
+    uInt64  start=DAQmxTraceEnabled ? DAQmxTraceNow() : 0;
+    int32   status=DAQmxSetRefClkSrc(taskHandle,data);
+
+    if( start )
+        DAQmxTraceAdd(DAQmxTraceCall_SetRefClkSrc,taskHandle,0,0.0,start,status);
+    return status;
+}
+
+static inline int32 DAQmxTracedSetRefClkRate(TaskHandle taskHandle, float64 data)
+{
+    uInt64  start=DAQmxTraceEnabled ? DAQmxTraceNow() : 0;
+    int32   status=DAQmxSetRefClkRate(taskHandle,data);
+
+    if( start )
+        DAQmxTraceAdd(DAQmxTraceCall_SetRefClkRate,taskHandle,0,data,start,status);
+    return status;
+}
+
+static inline int32 DAQmxTracedSetSampClkSrc(TaskHandle taskHandle, const char *data)
+{
+    uInt64  start=DAQmxTraceEnabled ? DAQmxTraceNow() : 0;
+    int32   status=DAQmxSetSampClkSrc(taskHandle,data);
+
+    if( start )
+        DAQmxTraceAdd(DAQmxTraceCall_SetSampClkSrc,taskHandle,0,0.0,start,status);
+    return status;
+}
+
+static inline int32 DAQmxTracedSetSampClkTimebaseSrc(TaskHandle taskHandle, const char *data)
+{
+    uInt64  start=DAQmxTraceEnabled ? DAQmxTraceNow() : 0;
+    int32   status=DAQmxSetSampClkTimebaseSrc(taskHandle,data);
+
+    if( start )
+        DAQmxTraceAdd(DAQmxTraceCall_SetSampClkTimebaseSrc,taskHandle,0,0.0,start,status);
+    return status;
+}
+
+static inline int32 DAQmxTracedSetSyncPulseSrc(TaskHandle taskHandle, const char *data)
+{
+    uInt64  start=DAQmxTraceEnabled ? DAQmxTraceNow() : 0;
+    int32   status=DAQmxSetSyncPulseSrc(taskHandle,data);
+
+    if( start )
+        DAQmxTraceAdd(DAQmxTraceCall_SetSyncPulseSrc,taskHandle,0,0.0,start,status);
+    return status;
+}
+
+static inline int32 DAQmxTracedSetStartTrigRetriggerable(TaskHandle taskHandle, bool32 data)
+{
+    uInt64  start=DAQmxTraceEnabled ? DAQmxTraceNow() : 0;
+    int32   status=DAQmxSetStartTrigRetriggerable(taskHandle,data);
+
+    if( start )
+        DAQmxTraceAdd(DAQmxTraceCall_SetStartTrigRetriggerable,taskHandle,data,0.0,start,status);
+    return status;
+}
+
+static inline int32 DAQmxTracedSetWriteRegenMode(TaskHandle taskHandle, int32 data)
+{
+    uInt64  start=DAQmxTraceEnabled ? DAQmxTraceNow() : 0;
+    int32   status=DAQmxSetWriteRegenMode(taskHandle,data);
+
+    if( start )
+        DAQmxTraceAdd(DAQmxTraceCall_SetWriteRegenMode,taskHandle,data,0.0,start,status);
+    return status;
+}
+
+static inline int32 DAQmxTracedSetWriteRelativeTo(TaskHandle taskHandle, int32 data)
+{
+    uInt64  start=DAQmxTraceEnabled ? DAQmxTraceNow() : 0;
+    int32   status=DAQmxSetWriteRelativeTo(taskHandle,data);
+
+    if( start )
+        DAQmxTraceAdd(DAQmxTraceCall_SetWriteRelativeTo,taskHandle,data,0.0,start,status);
+    return status;
+}
+
+static inline int32 DAQmxTracedSetWriteOffset(TaskHandle taskHandle, int32 data)
+{
+    uInt64  start=DAQmxTraceEnabled ? DAQmxTraceNow() : 0;
+    int32   status=DAQmxSetWriteOffset(taskHandle,data);
+
+    if( start )
+        DAQmxTraceAdd(DAQmxTraceCall_SetWriteOffset,taskHandle,data,0.0,start,status);
+    return status;
+}
+
+static inline int32 DAQmxTracedSetReadOffset(TaskHandle taskHandle, int32 data)
+{
+    uInt64  start=DAQmxTraceEnabled ? DAQmxTraceNow() : 0;
+    int32   status=DAQmxSetReadOffset(taskHandle,data);
+
+    if( start )
+        DAQmxTraceAdd(DAQmxTraceCall_SetReadOffset,taskHandle,data,0.0,start,status);
+    return status;
+}
+
+static inline int32 DAQmxTracedSetRealTimeConvLateErrorsToWarnings(TaskHandle taskHandle, bool32 data)
+{
+    uInt64  start=DAQmxTraceEnabled ? DAQmxTraceNow() : 0;
+    int32   status=DAQmxSetRealTimeConvLateErrorsToWarnings(taskHandle,data);
+
+    if( start )
+        DAQmxTraceAdd(DAQmxTraceCall_SetRealTimeConvLateErrorsToWarnings,taskHandle,data,0.0,start,status);
+    return status;
+}
+
+static inline int32 DAQmxTracedSetAODataXferReqCond(TaskHandle taskHandle, const char channel[], int32 data)
+{
+    uInt64  start=DAQmxTraceEnabled ? DAQmxTraceNow() : 0;
+    int32   status=DAQmxSetAODataXferReqCond(taskHandle,channel,data);
+
+    if( start )
+        DAQmxTraceAdd(DAQmxTraceCall_SetAODataXferReqCond,taskHandle,data,0.0,start,status);
+    return status;
+}
+
+static inline int32 DAQmxTracedSetCOPulseHighTime(TaskHandle taskHandle, const char channel[], float64 data)
+{
+    uInt64  start=DAQmxTraceEnabled ? DAQmxTraceNow() : 0;
+    int32   status=DAQmxSetCOPulseHighTime(taskHandle,channel,data);
+
+    if( start )
+        DAQmxTraceAdd(DAQmxTraceCall_SetCOPulseHighTime,taskHandle,0,data,start,status);
+    return status;
+}
+
+static inline int32 DAQmxTracedSetCOPulseLowTime(TaskHandle taskHandle, const char channel[], float64 data)
+{
+    uInt64  start=DAQmxTraceEnabled ? DAQmxTraceNow() : 0;
+    int32   status=DAQmxSetCOPulseLowTime(taskHandle,channel,data);
+
+    if( start )
+        DAQmxTraceAdd(DAQmxTraceCall_SetCOPulseLowTime,taskHandle,0,data,start,status);
+    return status;
+}
+
+#define DAQmxCreateTask(taskName,taskHandle) DAQmxTracedCreateTask(taskName,taskHandle)
+#define DAQmxClearTask(taskHandle) DAQmxTracedClearTask(taskHandle)
+#define DAQmxStartTask(taskHandle) DAQmxTracedStartTask(taskHandle)
+#define DAQmxStopTask(taskHandle) DAQmxTracedStopTask(taskHandle)
+#define DAQmxTaskControl(taskHandle,action) DAQmxTracedTaskControl(taskHandle,action)
+#define DAQmxWaitUntilTaskDone(taskHandle,timeToWait) DAQmxTracedWaitUntilTaskDone(taskHandle,timeToWait)
+#define DAQmxCreateAIVoltageChan(taskHandle,physicalChannel,nameToAssignToChannel,terminalConfig,minVal,maxVal,units,customScaleName) DAQmxTracedCreateAIVoltageChan(taskHandle,physicalChannel,nameToAssignToChannel,terminalConfig,minVal,maxVal,units,customScaleName)
+#define DAQmxCreateAOVoltageChan(taskHandle,physicalChannel,nameToAssignToChannel,minVal,maxVal,units,customScaleName) DAQmxTracedCreateAOVoltageChan(taskHandle,physicalChannel,nameToAssignToChannel,minVal,maxVal,units,customScaleName)
+#define DAQmxCreateDOChan(taskHandle,lines,nameToAssignToLines,lineGrouping) DAQmxTracedCreateDOChan(taskHandle,lines,nameToAssignToLines,lineGrouping)
+#define DAQmxCreateCOPulseChanTime(taskHandle,counter,nameToAssignToChannel,units,idleState,initialDelay,lowTime,highTime) DAQmxTracedCreateCOPulseChanTime(taskHandle,counter,nameToAssignToChannel,units,idleState,initialDelay,lowTime,highTime)
+#define DAQmxCreateCOPulseChanTicks(taskHandle,counter,nameToAssignToChannel,sourceTerminal,idleState,initialDelay,lowTicks,highTicks) DAQmxTracedCreateCOPulseChanTicks(taskHandle,counter,nameToAssignToChannel,sourceTerminal,idleState,initialDelay,lowTicks,highTicks)
+#define DAQmxCreateCOPulseChanFreq(taskHandle,counter,nameToAssignToChannel,units,idleState,initialDelay,freq,dutyCycle) DAQmxTracedCreateCOPulseChanFreq(taskHandle,counter,nameToAssignToChannel,units,idleState,initialDelay,freq,dutyCycle)
+#define DAQmxCfgSampClkTiming(taskHandle,source,rate,activeEdge,sampleMode,sampsPerChan) DAQmxTracedCfgSampClkTiming(taskHandle,source,rate,activeEdge,sampleMode,sampsPerChan)
+#define DAQmxCfgImplicitTiming(taskHandle,sampleMode,sampsPerChan) DAQmxTracedCfgImplicitTiming(taskHandle,sampleMode,sampsPerChan)
+#define DAQmxCfgDigEdgeStartTrig(taskHandle,triggerSource,triggerEdge) DAQmxTracedCfgDigEdgeStartTrig(taskHandle,triggerSource,triggerEdge)
+#define DAQmxCfgOutputBuffer(taskHandle,numSampsPerChan) DAQmxTracedCfgOutputBuffer(taskHandle,numSampsPerChan)
+#define DAQmxRegisterEveryNSamplesEvent(taskHandle,everyNsamplesEventType,nSamples,options,callbackFunction,callbackData) DAQmxTracedRegisterEveryNSamplesEvent(taskHandle,everyNsamplesEventType,nSamples,options,callbackFunction,callbackData)
+#define DAQmxRegisterDoneEvent(taskHandle,options,callbackFunction,callbackData) DAQmxTracedRegisterDoneEvent(taskHandle,options,callbackFunction,callbackData)
+#define DAQmxReadAnalogF64(taskHandle,numSampsPerChan,timeout,fillMode,readArray,arraySizeInSamps,sampsPerChanRead,reserved) DAQmxTracedReadAnalogF64(taskHandle,numSampsPerChan,timeout,fillMode,readArray,arraySizeInSamps,sampsPerChanRead,reserved)
+#define DAQmxReadBinaryI16(taskHandle,numSampsPerChan,timeout,fillMode,readArray,arraySizeInSamps,sampsPerChanRead,reserved) DAQmxTracedReadBinaryI16(taskHandle,numSampsPerChan,timeout,fillMode,readArray,arraySizeInSamps,sampsPerChanRead,reserved)
+#define DAQmxWriteAnalogF64(taskHandle,numSampsPerChan,autoStart,timeout,dataLayout,writeArray,sampsPerChanWritten,reserved) DAQmxTracedWriteAnalogF64(taskHandle,numSampsPerChan,autoStart,timeout,dataLayout,writeArray,sampsPerChanWritten,reserved)
+#define DAQmxWriteAnalogScalarF64(taskHandle,autoStart,timeout,value,reserved) DAQmxTracedWriteAnalogScalarF64(taskHandle,autoStart,timeout,value,reserved)
+#define DAQmxWriteDigitalU32(taskHandle,numSampsPerChan,autoStart,timeout,dataLayout,writeArray,sampsPerChanWritten,reserved) DAQmxTracedWriteDigitalU32(taskHandle,numSampsPerChan,autoStart,timeout,dataLayout,writeArray,sampsPerChanWritten,reserved)
+#define DAQmxWriteDigitalLines(taskHandle,numSampsPerChan,autoStart,timeout,dataLayout,writeArray,sampsPerChanWritten,reserved) DAQmxTracedWriteDigitalLines(taskHandle,numSampsPerChan,autoStart,timeout,dataLayout,writeArray,sampsPerChanWritten,reserved)
+#define DAQmxWriteCtrTicks(taskHandle,numSampsPerChan,autoStart,timeout,dataLayout,highTicks,lowTicks,numSampsPerChanWritten,reserved) DAQmxTracedWriteCtrTicks(taskHandle,numSampsPerChan,autoStart,timeout,dataLayout,highTicks,lowTicks,numSampsPerChanWritten,reserved)
+#define DAQmxWaitForNextSampleClock(taskHandle,timeout,isLate) DAQmxTracedWaitForNextSampleClock(taskHandle,timeout,isLate)
+#define DAQmxIsTaskDone(taskHandle,isTaskDone) DAQmxTracedIsTaskDone(taskHandle,isTaskDone)
+#define DAQmxGetReadAvailSampPerChan(taskHandle,data) DAQmxTracedGetReadAvailSampPerChan(taskHandle,data)
+#define DAQmxGetReadTotalSampPerChanAcquired(taskHandle,data) DAQmxTracedGetReadTotalSampPerChanAcquired(taskHandle,data)
+#define DAQmxGetReadCurrReadPos(taskHandle,data) DAQmxTracedGetReadCurrReadPos(taskHandle,data)
+#define DAQmxGetWriteTotalSampPerChanGenerated(taskHandle,data) DAQmxTracedGetWriteTotalSampPerChanGenerated(taskHandle,data)
+#define DAQmxGetTaskNumChans(taskHandle,data) DAQmxTracedGetTaskNumChans(taskHandle,data)
+#define DAQmxGetAIDevScalingCoeff(taskHandle,channel,data,arraySizeInElements) DAQmxTracedGetAIDevScalingCoeff(taskHandle,channel,data,arraySizeInElements)
+#define DAQmxGetAIRawSampSize(taskHandle,channel,data) DAQmxTracedGetAIRawSampSize(taskHandle,channel,data)
+#define DAQmxGetTaskNumDevices(taskHandle,data) DAQmxTracedGetTaskNumDevices(taskHandle,data)
+#define DAQmxGetNthTaskDevice(taskHandle,index,buffer,bufferSize) DAQmxTracedGetNthTaskDevice(taskHandle,index,buffer,bufferSize)
+#define DAQmxGetSysDevNames(data,bufferSize) DAQmxTracedGetSysDevNames(data,bufferSize)
+#define DAQmxGetDevProductCategory(device,data) DAQmxTracedGetDevProductCategory(device,data)
+#define DAQmxGetDevProductType(device,data,bufferSize) DAQmxTracedGetDevProductType(device,data,bufferSize)
+#define DAQmxGetDevCompactDAQChassisDevName(device,data,bufferSize) DAQmxTracedGetDevCompactDAQChassisDevName(device,data,bufferSize)
+#define DAQmxGetDevTerminals(device,data,bufferSize) DAQmxTracedGetDevTerminals(device,data,bufferSize)
+#define DAQmxGetExtendedErrorInfo(errorString,bufferSize) DAQmxTracedGetExtendedErrorInfo(errorString,bufferSize)
+#define DAQmxGetCOCtrTimebaseRate(taskHandle,channel,data) DAQmxTracedGetCOCtrTimebaseRate(taskHandle,channel,data)
+#define DAQmxGetMasterTimebaseSrc(taskHandle,data,bufferSize) DAQmxTracedGetMasterTimebaseSrc(taskHandle,data,bufferSize)
+#define DAQmxGetMasterTimebaseRate(taskHandle,data) DAQmxTracedGetMasterTimebaseRate(taskHandle,data)
+#define DAQmxSetMasterTimebaseSrc(taskHandle,data) DAQmxTracedSetMasterTimebaseSrc(taskHandle,data)
+#define DAQmxSetMasterTimebaseRate(taskHandle,data) DAQmxTracedSetMasterTimebaseRate(taskHandle,data)
+#define DAQmxGetRefClkSrc(taskHandle,data,bufferSize) DAQmxTracedGetRefClkSrc(taskHandle,data,bufferSize)
+#define DAQmxGetRefClkRate(taskHandle,data) DAQmxTracedGetRefClkRate(taskHandle,data)
+#define DAQmxSetRefClkSrc(taskHandle,data) DAQmxTracedSetRefClkSrc(taskHandle,data)
+#define DAQmxSetRefClkRate(taskHandle,data) DAQmxTracedSetRefClkRate(taskHandle,data)
+#define DAQmxSetSampClkSrc(taskHandle,data) DAQmxTracedSetSampClkSrc(taskHandle,data)
+#define DAQmxSetSampClkTimebaseSrc(taskHandle,data) DAQmxTracedSetSampClkTimebaseSrc(taskHandle,data)
+#define DAQmxSetSyncPulseSrc(taskHandle,data) DAQmxTracedSetSyncPulseSrc(taskHandle,data)
+#define DAQmxSetStartTrigRetriggerable(taskHandle,data) DAQmxTracedSetStartTrigRetriggerable(taskHandle,data)
+#define DAQmxSetWriteRegenMode(taskHandle,data) DAQmxTracedSetWriteRegenMode(taskHandle,data)
+#define DAQmxSetWriteRelativeTo(taskHandle,data) DAQmxTracedSetWriteRelativeTo(taskHandle,data)
+#define DAQmxSetWriteOffset(taskHandle,data) DAQmxTracedSetWriteOffset(taskHandle,data)
+#define DAQmxSetReadOffset(taskHandle,data) DAQmxTracedSetReadOffset(taskHandle,data)
+#define DAQmxSetRealTimeConvLateErrorsToWarnings(taskHandle,data) DAQmxTracedSetRealTimeConvLateErrorsToWarnings(taskHandle,data)
+#define DAQmxSetAODataXferReqCond(taskHandle,channel,data) DAQmxTracedSetAODataXferReqCond(taskHandle,channel,data)
+#define DAQmxSetCOPulseHighTime(taskHandle,channel,data) DAQmxTracedSetCOPulseHighTime(taskHandle,channel,data)
+#define DAQmxSetCOPulseLowTime(taskHandle,channel,data) DAQmxTracedSetCOPulseLowTime(taskHandle,channel,data)
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,217 @@
+/*********************************************************************
+*
+* Task benchmark:
+*    DAQmxTraceBench.c
+*
+* Description:
+*    Measures what the DAQmx call trace costs, then records a short
+*    session and replays it.
+*
+*    First times a cheap driver call, DAQmxGetReadAvailSampPerChan on
+*    a running task, called directly, through the trace wrapper while
+*    not recording, and through the wrapper while recording. Then
+*    starts and ends 1000 threads one after another, each making one
+*    call, to check that their buffers are reused.
+*
+*    Then records a session like ContinuousAI.c: an 8 channel analog
+*    input task at 10 kHz whose EveryN callback reads 1000 samples,
+*    an analog output task that is written once, and a main thread
+*    that polls the number of samples acquired every 10 ms, for 2 s.
+*    The trace is replayed against the simulated driver, at the
+*    recorded speed and as fast as possible, and the recorded and
+*    replayed durations of each function are listed.
+*
+*    A trace file given on the command line is replayed instead.
+*
+*    No DAQ hardware or driver is needed. Build with DAQmxTrace.c,
+*    DAQmxReplay.c and SimDAQmx.c instead of the NI-DAQmx library.
+*
+*********************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+#include <NIDAQmx.h>
+#include "DAQmxTrace.h"
+#include "DAQmxReplay.h"
+#include "SimDAQmx.h"
+#include "../Processing/StreamTime.h"
+#include "../Processing/StreamThread.h"
+
+#define DAQmxErrChk(functionCall) if( DAQmxFailed(error=(functionCall)) ) goto Error; else
+
+#define NUM_CALLS       1000000
+#define NUM_CHANS       8
+#define RATE            10000.0
+#define EVERY_N         1000
+#define SESSION_TIME    2.0
+#define POLL_INTERVAL   0.01
+#define NUM_SHORT_LIVED 1000
+#define TRACE_FILE      "DAQmxTraceBench.trace"
+
+static float64  data[NUM_CHANS*EVERY_N];
+
+static int32 CVICALLBACK EveryNCallback(TaskHandle taskHandle, int32 everyNsamplesEventType, uInt32 nSamples, void *callbackData)
+{
+    int32   read=0;
+    int32   *count=(int32*)callbackData;
+
+    DAQmxTraceMark(++*count);
+    return DAQmxReadAnalogF64(taskHandle,EVERY_N,10.0,DAQmx_Val_GroupByScanNumber,data,NUM_CHANS*EVERY_N,&read,NULL);
+}
+
+// Average time of a call, in ns, with the given way of calling it.
+static double TimeCalls(TaskHandle task, int traced)
+{
+    uInt32  avail;
+    double  t0=StreamTimeNow();
+    int     i;
+
+    if( traced )
+        for(i=0;i<NUM_CALLS;++i)
+            DAQmxGetReadAvailSampPerChan(task,&avail);
+    else
+        for(i=0;i<NUM_CALLS;++i)
+            (DAQmxGetReadAvailSampPerChan)(task,&avail);
+    return 1e9*(StreamTimeNow()-t0)/NUM_CALLS;
+}
+
+static STREAM_THREAD_PROC(ShortLivedThread,arg)
+{
+    uInt32 avail;
+
+    DAQmxGetReadAvailSampPerChan((TaskHandle)arg,&avail);
+    return 0;
+}
+
+static int32 MeasureOverhead(void)
+{
+    int32           error=0;
+    TaskHandle      task=0;
+    double          direct,idle,recording;
+    DAQmxTraceStats stats;
+    StreamThread    thread;
+    int             i;
+
+    DAQmxErrChk (DAQmxCreateTask("",&task));
+    DAQmxErrChk (DAQmxCreateAIVoltageChan(task,"PXI1Slot2/ai0:7","",DAQmx_Val_Cfg_Default,-10.0,10.0,DAQmx_Val_Volts,NULL));
+    DAQmxErrChk (DAQmxCfgSampClkTiming(task,"",RATE,DAQmx_Val_Rising,DAQmx_Val_ContSamps,EVERY_N));
+    DAQmxErrChk (DAQmxStartTask(task));
+    direct = TimeCalls(task,0);
+    idle = TimeCalls(task,1);
+    DAQmxErrChk (DAQmxTraceStart(TRACE_FILE));
+    recording = TimeCalls(task,1);
+    for(i=0;i<NUM_SHORT_LIVED;++i)
+        if( StreamThreadCreate(&thread,ShortLivedThread,task)==0 )
+            StreamThreadJoin(thread);
+    DAQmxTraceStop();
+    DAQmxTraceGetStats(&stats);
+    printf("DAQmxGetReadAvailSampPerChan, ns per call\n");
+    printf("  direct              %8.1f\n",direct);
+    printf("  wrapper, idle       %8.1f  (+%.1f)\n",idle,idle-direct);
+    printf("  wrapper, recording  %8.1f  (+%.1f)\n",recording,recording-direct);
+    printf("  %lld records written, %lld dropped\n",stats.records,stats.dropped);
+    printf("  %d short-lived threads: %d buffers, %lld threads untraced\n\n",NUM_SHORT_LIVED,stats.threads,stats.untraced);
+
+Error:
+    if( task!=0 )
+        DAQmxClearTask(task);
+    return error;
+}
+
+static int32 RecordSession(void)
+{
+    int32           error=0;
+    TaskHandle      aiTask=0,aoTask=0;
+    int32           callbacks=0,written;
+    uInt64          acquired=0;
+    double          t0;
+    DAQmxTraceStats stats;
+
+    DAQmxErrChk (DAQmxTraceStart(TRACE_FILE));
+    DAQmxErrChk (DAQmxCreateTask("",&aiTask));
+    DAQmxErrChk (DAQmxCreateAIVoltageChan(aiTask,"PXI1Slot2/ai0:7","",DAQmx_Val_Cfg_Default,-10.0,10.0,DAQmx_Val_Volts,NULL));
+    DAQmxErrChk (DAQmxCfgSampClkTiming(aiTask,"",RATE,DAQmx_Val_Rising,DAQmx_Val_ContSamps,EVERY_N));
+    DAQmxErrChk (DAQmxRegisterEveryNSamplesEvent(aiTask,DAQmx_Val_Acquired_Into_Buffer,EVERY_N,0,EveryNCallback,&callbacks));
+    DAQmxErrChk (DAQmxCreateTask("",&aoTask));
+    DAQmxErrChk (DAQmxCreateAOVoltageChan(aoTask,"PXI1Slot2/ao0:1","",-10.0,10.0,DAQmx_Val_Volts,NULL));
+    DAQmxErrChk (DAQmxCfgSampClkTiming(aoTask,"",RATE,DAQmx_Val_Rising,DAQmx_Val_ContSamps,EVERY_N));
+    DAQmxErrChk (DAQmxWriteAnalogF64(aoTask,EVERY_N/2,0,10.0,DAQmx_Val_GroupByChannel,data,&written,NULL));
+    DAQmxErrChk (DAQmxStartTask(aoTask));
+    DAQmxErrChk (DAQmxStartTask(aiTask));
+    t0 = StreamTimeNow();
+    while( StreamTimeNow()-t0<SESSION_TIME ) {
+        DAQmxErrChk (DAQmxGetReadTotalSampPerChanAcquired(aiTask,&acquired));
+        StreamSleep(POLL_INTERVAL);
+    }
+
+Error:
+    if( aiTask!=0 ) {
+        DAQmxStopTask(aiTask);
+        DAQmxClearTask(aiTask);
+    }
+    if( aoTask!=0 ) {
+        DAQmxStopTask(aoTask);
+        DAQmxClearTask(aoTask);
+    }
+    DAQmxTraceStop();
+    DAQmxTraceGetStats(&stats);
+    printf("Recorded %.1f s: %d callbacks, %llu samples per channel, %lld records from %d threads\n\n",
+           SESSION_TIME,(int)callbacks,(unsigned long long)acquired,stats.records,stats.threads);
+    return error;
+}
+
+static void Report(DAQmxReplay *replay, double speed)
+{
+    DAQmxReplaySummary  summary;
+    int                 call;
+
+    DAQmxReplayGetSummary(replay,&summary);
+    printf("Replay at %s: %.3f s recorded, %.3f s replayed, lag %.1f us mean %.1f us max, %lld status mismatches\n",
+           speed>0.0 ? "recorded speed" : "full speed",summary.recordedDuration,summary.replayedDuration,
+           1e6*summary.meanLag,1e6*summary.maxLag,summary.statusMismatches);
+    if( speed>0.0 )
+        return;
+    printf("\n%-34s%8s%8s%8s%14s%14s\n","Function","Calls","Replay","Skip","Recorded (us)","Replayed (us)");
+    for(call=0;call<DAQmxTraceNumCalls;++call) {
+        DAQmxReplayCallStats stats;
+
+        DAQmxReplayGetCallStats(replay,call,&stats);
+        if( stats.count==0 )
+            continue;
+        printf("%-34s%8lld%8lld%8lld%14.2f%14.2f\n",DAQmxReplayCallName(call),stats.count,stats.replayed,stats.skipped,
+               1e6*stats.recordedMean,1e6*stats.replayedMean);
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    int32           error=0;
+    char            errBuff[2048]={'\0'};
+    SimDAQmxSystem  sys={0,0,2,0.0};
+    DAQmxReplay     *replay=NULL;
+    const char      *fileName=argc>1 ? argv[1] : TRACE_FILE;
+
+    SimDAQmxSetSystem(&sys);
+    if( argc<=1 ) {
+        DAQmxErrChk (MeasureOverhead());
+        DAQmxErrChk (RecordSession());
+    }
+    if( (error=DAQmxReplayLoad(fileName,&replay))!=0 ) {
+        printf("Cannot read trace %s: error %d\n",fileName,(int)error);
+        return 1;
+    }
+    printf("%s: %lld records, %.3f GHz time stamp counter\n",fileName,DAQmxReplayNumRecords(replay),1e-9*DAQmxReplayTicksPerSecond(replay));
+    DAQmxErrChk (DAQmxReplayRun(replay,"PXI1Slot2",1.0));
+    Report(replay,1.0);
+    DAQmxErrChk (DAQmxReplayRun(replay,"PXI1Slot2",0.0));
+    Report(replay,0.0);
+
+Error:
+    DAQmxReplayClear(replay);
+    if( DAQmxFailed(error) ) {
+        DAQmxGetExtendedErrorInfo(errBuff,2048);
+        printf("DAQmx Error %d: %s\n",(int)error,errBuff);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,105 @@
+/*********************************************************************
+*
+* Task helper:
+*    DAQmxTraceFormat.h
+*
+* Description:
+*    File format of the traces written by DAQmxTrace.c and read by
+*    DAQmxReplay.c.
+*
+*    A trace starts with a DAQmxTraceFileHeader. Then come chunks,
+*    each a DAQmxTraceChunk followed by count records of one thread
+*    in the order they were made. Chunks of different threads are
+*    interleaved in the order they were flushed, so a reader sorts
+*    the records by their start time.
+*
+*    Times are in ticks of the time stamp counter, or nanoseconds on
+*    processors without one, counted from an arbitrary origin.
+*    ticksPerSecond converts them to seconds. All fields are in the
+*    byte order of the computer that wrote the trace.
+*
+*    Each traced function has a call id. The list below fixes the ids
+*    of a trace format version: add new functions at the end only.
+*
+*********************************************************************/
+
+#ifndef DAQMXTRACEFORMAT_H
+#define DAQMXTRACEFORMAT_H
+
+#include <NIDAQmx.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define DAQMX_TRACE_MAGIC       "DAQTRACE"
+#define DAQMX_TRACE_VERSION     1
+
+#define DAQMX_TRACE_CALLS(X) \
+    X(Mark) \
+    X(CreateTask) X(ClearTask) X(StartTask) X(StopTask) X(TaskControl) X(WaitUntilTaskDone) \
+    X(CreateAIVoltageChan) X(CreateAOVoltageChan) X(CreateDOChan) \
+    X(CreateCOPulseChanTime) X(CreateCOPulseChanTicks) X(CreateCOPulseChanFreq) \
+    X(CfgSampClkTiming) X(CfgImplicitTiming) X(CfgDigEdgeStartTrig) X(CfgOutputBuffer) \
+    X(RegisterEveryNSamplesEvent) X(RegisterDoneEvent) \
+    X(ReadAnalogF64) X(WriteAnalogF64) X(WriteAnalogScalarF64) X(WriteDigitalU32) \
+    X(WriteDigitalLines) X(WriteCtrTicks) X(WaitForNextSampleClock) \
+    X(GetReadAvailSampPerChan) X(GetReadTotalSampPerChanAcquired) X(GetWriteTotalSampPerChanGenerated) \
+    X(GetTaskNumChans) X(GetTaskNumDevices) X(GetNthTaskDevice) X(GetSysDevNames) \
+    X(GetDevProductCategory) X(GetDevProductType) X(GetDevCompactDAQChassisDevName) X(GetDevTerminals) \
+    X(GetExtendedErrorInfo) X(GetCOCtrTimebaseRate) \
+    X(GetMasterTimebaseSrc) X(GetMasterTimebaseRate) X(SetMasterTimebaseSrc) X(SetMasterTimebaseRate) \
+    X(GetRefClkSrc) X(GetRefClkRate) X(SetRefClkSrc) X(SetRefClkRate) \
+    X(SetSampClkSrc) X(SetSampClkTimebaseSrc) X(SetSyncPulseSrc) X(SetStartTrigRetriggerable) \
+    X(SetWriteRegenMode) X(SetWriteRelativeTo) X(SetWriteOffset) X(SetAODataXferReqCond) \
+    X(SetCOPulseHighTime) X(SetCOPulseLowTime) \
+    X(ReadBinaryI16) X(GetReadCurrReadPos) X(SetReadOffset) X(GetAIDevScalingCoeff) \
+    X(IsTaskDone) X(SetRealTimeConvLateErrorsToWarnings) X(GetAIRawSampSize)
+
+#define DAQMX_TRACE_CALL_ID(name)   DAQmxTraceCall_##name,
+
+enum {
+    DAQMX_TRACE_CALLS(DAQMX_TRACE_CALL_ID)
+    DAQmxTraceNumCalls
+};
+
+typedef struct DAQmxTraceFileHeader {
+    char        magic[8];
+    uInt32      version;
+    uInt32      recordSize;
+    float64     ticksPerSecond;
+    uInt64      startTicks;         // when recording started
+    uInt64      numRecords;
+    uInt64      numDropped;         // records lost because a thread's buffer was full
+    uInt32      numThreads;
+    uInt32      reserved;
+} DAQmxTraceFileHeader;
+
+typedef struct DAQmxTraceChunk {
+    uInt32      thread;             // 0 for the first thread that made a call. The
+                                    // number of a thread that ended may be reused
+    uInt32      count;
+} DAQmxTraceChunk;
+
+// arg and value summarise the arguments: for reads and writes the
+// number of samples per channel and the timeout, for timing the
+// samples per channel, negated for continuous samples, and the rate,
+// for channels the number of channels created and the maximum, for
+// setters the value set. See DAQmxTrace.h.
+typedef struct DAQmxTraceRecord {
+    uInt64      start;              // ticks
+    uInt64      task;               // the task handle, 0 for none
+    int64       arg;
+    float64     value;
+    uInt32      ticks;              // duration, saturated
+    int32       status;             // return value
+    uInt16      call;
+    uInt16      reserved;
+    uInt32      reserved2;
+} DAQmxTraceRecord;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,507 @@
+/*********************************************************************
+*
+* Task helper:
+*    DevTopology.c
+*
+* Description:
+*    Implementation of the device topology cache. See DevTopology.h
+*    for the calling conventions.
+*
+*    The strings returned by the driver are kept as they came, split
+*    in place into device and terminal names. These are indexed by
+*    open-addressing hash tables with at least twice as many slots as
+*    entries.
+*
+*    The cache is a snapshot with a reference count. The process-wide
+*    pointer holds one reference and every DevTopologyGet another, so
+*    a snapshot that is replaced or invalidated is freed only when its
+*    last reader releases it. The mutex guards the pointer and is held
+*    while a snapshot is built, so concurrent first lookups build it
+*    once.
+*
+*********************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+#include "DevTopology.h"
+#include "../Processing/StreamThread.h"
+
+#define DAQmxErrChk(functionCall) if( DAQmxFailed(error=(functionCall)) ) goto Error; else
+
+#define MAX_NAME    512
+
+typedef struct Device {
+    const char  *name;
+    int32       productCategory;
+    const char  *productType;
+    const char  *chassis;
+    int         numTerminals;
+    char        *terminals;     // DAQmx list, split when indexed
+    int         route;          // device whose terminals this device uses
+} Device;
+
+struct DevTopology {
+    char        *sysDevNames;
+    Device      *devices;
+    int         numDevices;
+    int         *deviceHash;    // device index+1, or 0 for empty
+    unsigned    deviceMask;
+    const char  **terminalHash;
+    unsigned    terminalMask;
+    char        **strings;      // every allocated string, for freeing
+    int         numStrings;
+    int         maxStrings;
+    atomic_int  refs;
+};
+
+static DevTopology  *cache=NULL;
+static StreamMutex  cacheLock;
+static atomic_int   cacheLockState=0;  // 0 none, 1 initializing, 2 ready
+
+// StreamMutex has no static initializer. Only the first callers can
+// spin here, and only while the mutex is initialized.
+static void Lock(void)
+{
+    int none=0;
+
+    if( atomic_load_explicit(&cacheLockState,memory_order_acquire)!=2 ) {
+        if( atomic_compare_exchange_strong(&cacheLockState,&none,1) ) {
+            StreamMutexInit(&cacheLock);
+            atomic_store_explicit(&cacheLockState,2,memory_order_release);
+        }
+        else
+            while( atomic_load_explicit(&cacheLockState,memory_order_acquire)!=2 )
+                StreamCpuRelax();
+    }
+    StreamMutexLock(&cacheLock);
+}
+
+static void Unlock(void)
+{
+    StreamMutexUnlock(&cacheLock);
+}
+
+static unsigned Hash(const char *s)
+{
+    unsigned h=2166136261u;
+
+    while( *s )
+        h = (h^(unsigned char)*s++)*16777619u;
+    return h;
+}
+
+static unsigned TableSize(int count)
+{
+    unsigned size=16;
+
+    while( size<2u*(unsigned)count )
+        size *= 2;
+    return size;
+}
+
+static void Free(DevTopology *t)
+{
+    int i;
+
+    if( !t )
+        return;
+    for(i=0;i<t->numStrings;++i)
+        free(t->strings[i]);
+    free(t->strings);
+    free(t->devices);
+    free(t->deviceHash);
+    free(t->terminalHash);
+    free(t);
+}
+
+// Keeps s for freeing with the cache. Returns s, or NULL if s is NULL
+// or out of memory, in which case s is freed.
+static char *Keep(DevTopology *t, char *s)
+{
+    if( !s )
+        return NULL;
+    if( t->numStrings==t->maxStrings ) {
+        int     max=t->maxStrings ? 2*t->maxStrings : 64;
+        char    **strings=(char**)realloc(t->strings,max*sizeof(char*));
+
+        if( !strings ) {
+            free(s);
+            return NULL;
+        }
+        t->strings = strings;
+        t->maxStrings = max;
+    }
+    t->strings[t->numStrings++] = s;
+    return s;
+}
+
+// Calls a DAQmx string getter twice, once for the size. An empty
+// string is returned if the property is not supported.
+typedef int32 (*DevStringGetter)(const char device[], char *data, uInt32 bufferSize);
+
+static char *GetDevString(DevTopology *t, DevStringGetter getter, const char device[])
+{
+    int32   size=getter(device,NULL,0);
+    char    *s;
+
+    if( size<=0 )
+        return Keep(t,(char*)calloc(1,1));
+    s = (char*)malloc((size_t)size);
+    if( s && DAQmxFailed(getter(device,s,(uInt32)size)) )
+        s[0] = '\0';
+    return Keep(t,s);
+}
+
+// Splits a DAQmx list "a, b, c" in place. Returns the number of items.
+static int SplitList(char *list, char **items, int maxItems)
+{
+    int     n=0;
+    char    *p=list;
+
+    while( *p ) {
+        while( *p==' ' || *p==',' )
+            ++p;
+        if( !*p )
+            break;
+        if( items && n<maxItems )
+            items[n] = p;
+        ++n;
+        while( *p && *p!=',' )
+            ++p;
+        if( *p && items )
+            *p++ = '\0';
+        else if( *p )
+            ++p;
+    }
+    return n;
+}
+
+static int FindDevice(const DevTopology *t, const char device[])
+{
+    unsigned i;
+
+    for(i=Hash(device)&t->deviceMask;t->deviceHash[i];i=(i+1)&t->deviceMask)
+        if( strcmp(t->devices[t->deviceHash[i]-1].name,device)==0 )
+            return t->deviceHash[i]-1;
+    return -1;
+}
+
+static int32 Build(DevTopology **topology)
+{
+    int32       error=0;
+    DevTopology *t;
+    char        *names,**items=NULL,**terminals=NULL;
+    int         numTerminals=0,i,j;
+    int32       size;
+
+    *topology = NULL;
+    t = (DevTopology*)calloc(1,sizeof(DevTopology));
+    if( !t )
+        return DevTopologyErrOutOfMemory;
+    atomic_init(&t->refs,1);
+
+    size = DAQmxGetSysDevNames(NULL,0);
+    DAQmxErrChk (size);
+    t->sysDevNames = Keep(t,(char*)calloc((size_t)size+1,1));
+    names = Keep(t,(char*)calloc((size_t)size+1,1));
+    if( !t->sysDevNames || !names ) {
+        error = DevTopologyErrOutOfMemory;
+        goto Error;
+    }
+    if( size>0 ) {
+        DAQmxErrChk (DAQmxGetSysDevNames(t->sysDevNames,(uInt32)size));
+        strcpy(names,t->sysDevNames);
+    }
+
+    t->numDevices = SplitList(names,NULL,0);
+    items = (char**)malloc((t->numDevices+1)*sizeof(char*));
+    t->devices = (Device*)calloc(t->numDevices+1,sizeof(Device));
+    t->deviceMask = TableSize(t->numDevices)-1;
+    t->deviceHash = (int*)calloc(t->deviceMask+1,sizeof(int));
+    if( !items || !t->devices || !t->deviceHash ) {
+        error = DevTopologyErrOutOfMemory;
+        goto Error;
+    }
+    SplitList(names,items,t->numDevices);
+
+    for(i=0;i<t->numDevices;++i) {
+        Device      *d=&t->devices[i];
+        unsigned    h;
+
+        d->name = items[i];
+        d->route = i;
+        DAQmxErrChk (DAQmxGetDevProductCategory(d->name,&d->productCategory));
+        d->productType = GetDevString(t,DAQmxGetDevProductType,d->name);
+        d->chassis = NULL;
+        if( d->productCategory==DAQmx_Val_CSeriesModule ) {
+            d->chassis = GetDevString(t,DAQmxGetDevCompactDAQChassisDevName,d->name);
+            if( d->chassis && !d->chassis[0] )
+                d->chassis = NULL;
+        }
+        d->terminals = GetDevString(t,DAQmxGetDevTerminals,d->name);
+        if( !d->productType || !d->terminals ) {
+            error = DevTopologyErrOutOfMemory;
+            goto Error;
+        }
+        d->numTerminals = SplitList(d->terminals,NULL,0);
+        numTerminals += d->numTerminals;
+        for(h=Hash(d->name)&t->deviceMask;t->deviceHash[h];h=(h+1)&t->deviceMask)
+            ;
+        t->deviceHash[h] = i+1;
+    }
+    for(i=0;i<t->numDevices;++i)
+        if( t->devices[i].chassis ) {
+            j = FindDevice(t,t->devices[i].chassis);
+            if( j>=0 )
+                t->devices[i].route = j;
+        }
+
+    // Index every terminal by its full name.
+    t->terminalMask = TableSize(numTerminals)-1;
+    t->terminalHash = (const char**)calloc(t->terminalMask+1,sizeof(char*));
+    terminals = (char**)malloc((numTerminals+1)*sizeof(char*));
+    if( !t->terminalHash || !terminals ) {
+        error = DevTopologyErrOutOfMemory;
+        goto Error;
+    }
+    for(i=0;i<t->numDevices;++i) {
+        int n=SplitList(t->devices[i].terminals,terminals,numTerminals);
+
+        for(j=0;j<n;++j) {
+            unsigned h;
+
+            for(h=Hash(terminals[j])&t->terminalMask;t->terminalHash[h];h=(h+1)&t->terminalMask)
+                if( strcmp(t->terminalHash[h],terminals[j])==0 )
+                    break;
+            t->terminalHash[h] = terminals[j];
+        }
+    }
+    free(items);
+    free(terminals);
+    *topology = t;
+    return 0;
+
+Error:
+    free(items);
+    free(terminals);
+    Free(t);
+    return error;
+}
+
+static void Release(DevTopology *t)
+{
+    if( t && atomic_fetch_sub_explicit(&t->refs,1,memory_order_acq_rel)==1 )
+        Free(t);
+}
+
+int32 DevTopologyGet(const DevTopology **topology)
+{
+    int32   error=0;
+
+    Lock();
+    if( !cache )
+        error = Build(&cache);
+    if( cache )
+        atomic_fetch_add_explicit(&cache->refs,1,memory_order_relaxed);
+    *topology = cache;
+    Unlock();
+    return error;
+}
+
+void DevTopologyRelease(const DevTopology *topology)
+{
+    Release((DevTopology*)topology);
+}
+
+void DevTopologyInvalidate(void)
+{
+    DevTopology *old;
+
+    Lock();
+    old = cache;
+    cache = NULL;
+    Unlock();
+    Release(old);
+}
+
+// Releases *topology, which is missing a device, and returns a
+// reference to a snapshot built after it, building one unless another
+// thread already has.
+static int32 Renew(const DevTopology **topology)
+{
+    int32       error=0;
+    DevTopology *mine=(DevTopology*)*topology,*old=NULL;
+
+    Lock();
+    if( cache==mine ) {
+        old = cache;
+        cache = NULL;
+        error = Build(&cache);
+    }
+    if( cache )
+        atomic_fetch_add_explicit(&cache->refs,1,memory_order_relaxed);
+    *topology = cache;
+    Unlock();
+    Release(mine);
+    Release(old);
+    return error;
+}
+
+int32 DevTopologyRefresh(int *changed)
+{
+    int32   error=0;
+    int32   size=DAQmxGetSysDevNames(NULL,0);
+    char    *names;
+    int     differ;
+
+    if( changed )
+        *changed = 0;
+    if( DAQmxFailed(size) )
+        return size;
+    names = (char*)calloc((size_t)size+1,1);
+    if( !names )
+        return DevTopologyErrOutOfMemory;
+    if( size>0 ) {
+        DAQmxErrChk (DAQmxGetSysDevNames(names,(uInt32)size));
+    }
+    Lock();
+    differ = cache && strcmp(cache->sysDevNames,names)!=0;
+    Unlock();
+    if( differ )
+        DevTopologyInvalidate();
+    if( changed )
+        *changed = differ;
+
+Error:
+    free(names);
+    return error;
+}
+
+int DevTopologyNumDevices(const DevTopology *topology)
+{
+    return topology->numDevices;
+}
+
+void DevTopologyGetDevice(const DevTopology *topology, int index, DevTopologyDevice *device)
+{
+    const Device *d=&topology->devices[index];
+
+    device->name = d->name;
+    device->productCategory = d->productCategory;
+    device->productType = d->productType;
+    device->chassis = d->chassis;
+    device->numTerminals = d->numTerminals;
+}
+
+int DevTopologyFindDevice(const DevTopology *topology, const char device[])
+{
+    return FindDevice(topology,device);
+}
+
+const char *DevTopologyTerminal(const DevTopology *topology, const char device[], const char terminal[])
+{
+    const DevTopology   *t=topology;
+    char                key[MAX_NAME];
+    int                 i=FindDevice(t,device);
+    unsigned            h;
+
+    if( i<0 )
+        return NULL;
+    if( snprintf(key,sizeof(key),"/%s/%s",t->devices[t->devices[i].route].name,terminal)>=(int)sizeof(key) )
+        return NULL;
+    for(h=Hash(key)&t->terminalMask;t->terminalHash[h];h=(h+1)&t->terminalMask)
+        if( strcmp(t->terminalHash[h],key)==0 )
+            return t->terminalHash[h];
+    return NULL;
+}
+
+// Full name of terminal of device index into name. Returns 1 if the
+// device has no terminals of its own, an SCXI module or a C Series
+// module outside a chassis.
+static int32 DeviceTerminal(const DevTopology *t, int index, const char terminal[], char name[], int32 nameSize)
+{
+    const Device    *d=&t->devices[index];
+    const char      *full;
+
+    if( d->productCategory==DAQmx_Val_SCXIModule || (d->productCategory==DAQmx_Val_CSeriesModule && !d->chassis) )
+        return 1;
+    full = DevTopologyTerminal(t,d->name,terminal);
+    if( full ) {
+        if( (int32)strlen(full)>=nameSize )
+            return DevTopologyErrBufferTooSmall;
+        strcpy(name,full);
+    }
+    else if( snprintf(name,(size_t)nameSize,"/%s/%s",t->devices[d->route].name,terminal)>=nameSize )
+        return DevTopologyErrBufferTooSmall;
+    return 0;
+}
+
+// Index of device in *topology, renewing the snapshot once if the
+// device is not in it, since then the system has changed.
+static int32 FindOrRenew(const DevTopology **topology, const char device[], int *renewed, int *index)
+{
+    int32   error=0;
+
+    *index = FindDevice(*topology,device);
+    if( *index<0 && !*renewed ) {
+        error = Renew(topology);
+        *renewed = 1;
+        if( *topology )
+            *index = FindDevice(*topology,device);
+    }
+    return error;
+}
+
+int32 DevTopologyTaskTerminal(TaskHandle taskHandle, const char terminal[], char name[], int32 nameSize)
+{
+    int32               error=0;
+    const DevTopology   *t=NULL;
+    char                device[256];
+    uInt32              numDevices,i;
+    int                 index,renewed=0;
+
+    DAQmxErrChk (DAQmxGetTaskNumDevices(taskHandle,&numDevices));
+    DAQmxErrChk (DevTopologyGet(&t));
+    for(i=1;i<=numDevices;++i) {
+        DAQmxErrChk (DAQmxGetNthTaskDevice(taskHandle,i,device,sizeof(device)));
+        DAQmxErrChk (FindOrRenew(&t,device,&renewed,&index));
+        if( index<0 )
+            break;
+        // Skip the devices without terminals of their own.
+        if( (error=DeviceTerminal(t,index,terminal,name,nameSize))!=1 )
+            goto Error;
+    }
+    error = DevTopologyErrNotFound;
+
+Error:
+    DevTopologyRelease(t);
+    return error;
+}
+
+int32 DevTopologyChannelTerminal(const char physicalChannel[], const char terminal[], char name[], int32 nameSize)
+{
+    int32               error=0;
+    const DevTopology   *t=NULL;
+    char                device[256];
+    size_t              n;
+    int                 index,renewed=0;
+
+    while( *physicalChannel=='/' || *physicalChannel==' ' )
+        ++physicalChannel;
+    n = strcspn(physicalChannel,"/,");
+    if( n==0 || n>=sizeof(device) )
+        return DevTopologyErrInvalidArg;
+    memcpy(device,physicalChannel,n);
+    device[n] = '\0';
+    DAQmxErrChk (DevTopologyGet(&t));
+    DAQmxErrChk (FindOrRenew(&t,device,&renewed,&index));
+    error = index<0 ? DevTopologyErrNotFound : DeviceTerminal(t,index,terminal,name,nameSize);
+    if( error==1 )
+        error = DevTopologyErrNotFound;
+
+Error:
+    DevTopologyRelease(t);
+    return error;
+}
@@ -0,0 +1,99 @@
+/*********************************************************************
+*
+* Task helper:
+*    DevTopology.h
+*
+* Description:
+*    Process-wide cache of the DAQ devices in the system and of their
+*    terminals, and a replacement for the GetTerminalNameWithDevPrefix
+*    function that the examples used to copy.
+*
+*    The cache is built on first use. It queries each device's product
+*    category and type, the chassis of a C Series module, and the
+*    list of terminals. After that, looking up the full name of a
+*    terminal such as /Dev1/ai/StartTrigger is a hash lookup that
+*    makes no driver calls.
+*
+*    Call DevTopologyInvalidate when devices are added, removed or
+*    renamed, for example after a driver error that names an unknown
+*    device. The next lookup then rebuilds the cache. DevTopologyRefresh
+*    does the same if the system's device list has changed, at the
+*    cost of one driver call. A lookup of a device the cache does not
+*    know rebuilds it once by itself.
+*
+*    DevTopologyGet returns a snapshot that stays valid, with every
+*    pointer looked up in it, until it is passed to
+*    DevTopologyRelease, even if the cache is invalidated or rebuilt
+*    meanwhile. Building the cache is serialized. All functions are
+*    safe from any thread.
+*
+*    DevTopologyTaskTerminal queries the task for its devices on every
+*    call. Where the physical channel is at hand,
+*    DevTopologyChannelTerminal gives the same name without any
+*    driver call once the cache is built.
+*
+*********************************************************************/
+
+#ifndef DEVTOPOLOGY_H
+#define DEVTOPOLOGY_H
+
+#include <NIDAQmx.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define DevTopologyErrInvalidArg        -1
+#define DevTopologyErrOutOfMemory       -2
+#define DevTopologyErrNotFound          -3
+#define DevTopologyErrBufferTooSmall    -4
+
+typedef struct DevTopologyDevice {
+    const char  *name;
+    int32       productCategory;
+    const char  *productType;
+    const char  *chassis;       // chassis of a C Series module, or NULL
+    int         numTerminals;
+} DevTopologyDevice;
+
+typedef struct DevTopology DevTopology;
+
+// Returns the cache, building it if needed. Pass it to
+// DevTopologyRelease when done with it.
+int32 DevTopologyGet(const DevTopology **topology);
+void  DevTopologyRelease(const DevTopology *topology);
+void  DevTopologyInvalidate(void);
+
+// Compares the system's device list with the cached one and
+// invalidates the cache if they differ. changed may be NULL.
+int32 DevTopologyRefresh(int *changed);
+
+int   DevTopologyNumDevices(const DevTopology *topology);
+void  DevTopologyGetDevice(const DevTopology *topology, int index, DevTopologyDevice *device);
+
+// Index of the named device, or -1.
+int   DevTopologyFindDevice(const DevTopology *topology, const char device[]);
+
+// Full name of a terminal, e.g. "/Dev1/ai/StartTrigger" for device
+// "Dev1" and terminal "ai/StartTrigger". For a C Series module the
+// chassis terminal is returned. NULL if the device or the terminal is
+// unknown.
+const char *DevTopologyTerminal(const DevTopology *topology, const char device[], const char terminal[]);
+
+// Full name of a terminal of the device that times taskHandle: the
+// first device of the task, or the chassis if that is a C Series
+// module. Replaces GetTerminalNameWithDevPrefix with a bounded copy.
+// A terminal the device does not list, such as one its driver does
+// not report, is named all the same and checked by DAQmx when used.
+int32 DevTopologyTaskTerminal(TaskHandle taskHandle, const char terminal[], char name[], int32 nameSize);
+
+// As DevTopologyTaskTerminal for the device of the first channel in
+// physicalChannel, e.g. "Dev1/ai0:3". The device cannot be an SCXI
+// module.
+int32 DevTopologyChannelTerminal(const char physicalChannel[], const char terminal[], char name[], int32 nameSize);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,183 @@
+/*********************************************************************
+*
+* Task benchmark:
+*    DevTopologyBench.c
+*
+* Description:
+*    Simulates a system of 8 CompactDAQ chassis with 8 modules each
+*    and 16 PXI Express devices, where each device property query
+*    costs 20 us. Creates 256 tasks on the PXI devices and looks up
+*    three terminals of each, as the synchronization examples do,
+*    first with the GetTerminalNameWithDevPrefix function that the
+*    examples used to copy, then with DevTopologyTaskTerminal, then
+*    with DevTopologyChannelTerminal given the physical channels.
+*
+*    Reports the time until the first terminal name is known, which
+*    for the cache includes building it, the total time and the
+*    number of driver queries, and checks that the old and the new
+*    functions return the same names. Then times DevTopologyTerminal
+*    alone, resolves a terminal of a task on a C Series module, which
+*    the old function could not do, checks that DevTopologyRefresh
+*    notices an added device and that a snapshot still held stays
+*    usable after the cache is rebuilt.
+*
+*    No DAQ hardware or driver is needed. Build with DevTopology.c
+*    and SimDAQmx.c instead of the NI-DAQmx library.
+*
+*********************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+#include "DevTopology.h"
+#include "SimDAQmx.h"
+#include "../Processing/StreamTime.h"
+
+#define DAQmxErrChk(functionCall) if( DAQmxFailed(error=(functionCall)) ) goto Error; else
+
+#define NUM_TASKS       256
+#define NUM_TERMINALS   3
+#define NUM_LOOKUPS     1000000
+#define QUERY_LATENCY   20e-6
+
+static const char   *terminals[NUM_TERMINALS]={"ai/StartTrigger","ai/SampleClockTimebase","SyncPulse"};
+static char         oldNames[NUM_TASKS][NUM_TERMINALS][256];
+static char         newNames[NUM_TASKS][NUM_TERMINALS][256];
+static char         chanNames[NUM_TASKS][NUM_TERMINALS][256];
+
+// The function as it was copied into ContinuousAI.c and SynchAI-AO.c.
+static int32 GetTerminalNameWithDevPrefix(TaskHandle taskHandle, const char terminalName[], char triggerName[])
+{
+    int32   error=0;
+    char    device[256];
+    int32   productCategory;
+    uInt32  numDevices,i=1;
+
+    DAQmxErrChk (DAQmxGetTaskNumDevices(taskHandle,&numDevices));
+    while( i<=numDevices ) {
+        DAQmxErrChk (DAQmxGetNthTaskDevice(taskHandle,i++,device,256));
+        DAQmxErrChk (DAQmxGetDevProductCategory(device,&productCategory));
+        if( productCategory!=DAQmx_Val_CSeriesModule && productCategory!=DAQmx_Val_SCXIModule ) {
+            *triggerName++ = '/';
+            strcat(strcat(strcpy(triggerName,device),"/"),terminalName);
+            break;
+        }
+    }
+
+Error:
+    return error;
+}
+
+static void Report(const char *title, double first, double total, long long queries)
+{
+    printf("%-30s%10.2f%12.2f%12lld%12.1f\n",title,1e3*first,1e3*total,queries,(double)queries/(NUM_TASKS*NUM_TERMINALS));
+}
+
+int main(void)
+{
+    int32               error=0;
+    char                errBuff[2048]={'\0'};
+    SimDAQmxSystem      sys={8,8,16,QUERY_LATENCY};
+    TaskHandle          tasks[NUM_TASKS]={0};
+    TaskHandle          moduleTask=0;
+    char                chan[64],name[256]={'\0'};
+    const DevTopology   *topo=NULL,*held=NULL;
+    double              t0,first=0.0,total;
+    int                 i,j,changed,mismatches=0;
+
+    SimDAQmxSetSystem(&sys);
+    for(i=0;i<NUM_TASKS;++i) {
+        sprintf(chan,"PXI1Slot%d/ai0:7",2+i%sys.numPlugIn);
+        DAQmxErrChk (DAQmxCreateTask("",&tasks[i]));
+        DAQmxErrChk (DAQmxCreateAIVoltageChan(tasks[i],chan,"",DAQmx_Val_Cfg_Default,-10.0,10.0,DAQmx_Val_Volts,NULL));
+    }
+    printf("%d tasks, %d terminals each, %.0f us per driver query\n\n",NUM_TASKS,NUM_TERMINALS,1e6*QUERY_LATENCY);
+    printf("%-30s%10s%12s%12s%12s\n","","First (ms)","Total (ms)","Queries","Per lookup");
+
+    SimDAQmxResetQueryCount();
+    t0 = StreamTimeNow();
+    for(i=0;i<NUM_TASKS;++i)
+        for(j=0;j<NUM_TERMINALS;++j) {
+            DAQmxErrChk (GetTerminalNameWithDevPrefix(tasks[i],terminals[j],oldNames[i][j]));
+            if( i==0 && j==0 )
+                first = StreamTimeNow()-t0;
+        }
+    total = StreamTimeNow()-t0;
+    Report("GetTerminalNameWithDevPrefix",first,total,SimDAQmxQueryCount());
+
+    SimDAQmxResetQueryCount();
+    t0 = StreamTimeNow();
+    for(i=0;i<NUM_TASKS;++i)
+        for(j=0;j<NUM_TERMINALS;++j) {
+            DAQmxErrChk (DevTopologyTaskTerminal(tasks[i],terminals[j],newNames[i][j],256));
+            if( i==0 && j==0 )
+                first = StreamTimeNow()-t0;
+        }
+    total = StreamTimeNow()-t0;
+    Report("DevTopologyTaskTerminal",first,total,SimDAQmxQueryCount());
+
+    // When the physical channels are known no task query is needed.
+    // Start from an empty cache again.
+    DevTopologyInvalidate();
+    SimDAQmxResetQueryCount();
+    t0 = StreamTimeNow();
+    for(i=0;i<NUM_TASKS;++i) {
+        sprintf(chan,"PXI1Slot%d/ai0:7",2+i%sys.numPlugIn);
+        for(j=0;j<NUM_TERMINALS;++j) {
+            DAQmxErrChk (DevTopologyChannelTerminal(chan,terminals[j],chanNames[i][j],256));
+            if( i==0 && j==0 )
+                first = StreamTimeNow()-t0;
+        }
+    }
+    total = StreamTimeNow()-t0;
+    Report("DevTopologyChannelTerminal",first,total,SimDAQmxQueryCount());
+
+    for(i=0;i<NUM_TASKS;++i)
+        for(j=0;j<NUM_TERMINALS;++j)
+            if( strcmp(oldNames[i][j],newNames[i][j])!=0 || strcmp(oldNames[i][j],chanNames[i][j])!=0 )
+                mismatches++;
+    printf("\nNames that differ: %d\n",mismatches);
+
+    // The time of the lookup alone, without the task queries.
+    DAQmxErrChk (DevTopologyGet(&topo));
+    t0 = StreamTimeNow();
+    for(i=0;i<NUM_LOOKUPS;++i)
+        if( !DevTopologyTerminal(topo,"PXI1Slot9",terminals[i%NUM_TERMINALS]) )
+            mismatches++;
+    printf("DevTopologyTerminal: %.1f ns per lookup\n",1e9*(StreamTimeNow()-t0)/NUM_LOOKUPS);
+    held = topo;
+    topo = NULL;
+
+    DAQmxErrChk (DAQmxCreateTask("",&moduleTask));
+    DAQmxErrChk (DAQmxCreateAIVoltageChan(moduleTask,"cDAQ3Mod2/ai0:3","",DAQmx_Val_Cfg_Default,-10.0,10.0,DAQmx_Val_Volts,NULL));
+    DAQmxErrChk (DevTopologyTaskTerminal(moduleTask,"ai/StartTrigger",name,sizeof(name)));
+    printf("Task on cDAQ3Mod2: %s\n",name);
+
+    sys.numPlugIn++;
+    SimDAQmxSetSystem(&sys);
+    DAQmxErrChk (DevTopologyRefresh(&changed));
+    printf("Device added, cache %s\n",changed ? "invalidated" : "NOT invalidated");
+    DAQmxErrChk (DAQmxCreateAIVoltageChan(tasks[0],"PXI1Slot18/ai0","",DAQmx_Val_Cfg_Default,-10.0,10.0,DAQmx_Val_Volts,NULL));
+    // A device added without a refresh is found by rebuilding.
+    sys.numPlugIn++;
+    SimDAQmxSetSystem(&sys);
+    DAQmxErrChk (DevTopologyChannelTerminal("PXI1Slot19/ai0","ai/StartTrigger",name,sizeof(name)));
+    printf("Task on a device added since: %s\n",name);
+    DAQmxErrChk (DevTopologyGet(&topo));
+    printf("Devices in cache: %d, in the snapshot held since before: %d\n",DevTopologyNumDevices(topo),DevTopologyNumDevices(held));
+    if( !DevTopologyTerminal(held,"PXI1Slot9","ai/StartTrigger") )
+        mismatches++;
+
+Error:
+    if( DAQmxFailed(error) ) {
+        DAQmxGetExtendedErrorInfo(errBuff,2048);
+        printf("DAQmx Error %d: %s\n",(int)error,errBuff);
+    }
+    DevTopologyRelease(topo);
+    DevTopologyRelease(held);
+    for(i=0;i<NUM_TASKS;++i)
+        if( tasks[i] )
+            DAQmxClearTask(tasks[i]);
+    if( moduleTask )
+        DAQmxClearTask(moduleTask);
+    return mismatches!=0 || DAQmxFailed(error);
+}
@@ -0,0 +1,255 @@
+/*********************************************************************
+*
+* Task helper:
+*    PulseScheduler.c
+*
+* Description:
+*    Implementation of the buffered counter pulse scheduler. See
+*    PulseScheduler.h for the calling conventions.
+*
+*    The producer thread blocks in DAQmxWriteCtrTicks until the device
+*    has freed space for the next block. Stopping the task makes that
+*    write return, so PulseSchedulerStop stops the task before joining
+*    the thread.
+*
+*********************************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+#include "PulseScheduler.h"
+#include "../Processing/StreamTime.h"
+#include "../Processing/StreamThread.h"
+
+#define DAQmxErrChk(functionCall) if( DAQmxFailed(error=(functionCall)) ) goto Error; else
+
+struct PulseScheduler {
+    PulseSchedulerConfig    cfg;
+    PulseSchedulerSource    source;
+    void                    *sourceData;
+    TaskHandle              task;
+    PulseTicks              *ticks;
+    double                  *highTime;
+    double                  *lowTime;
+    uInt32                  *highTicks;
+    uInt32                  *lowTicks;
+
+    StreamMutex             lock;           // guards ticks and the counters below
+    StreamThread            producer;
+    int                     producerRunning;
+    volatile int            stop;
+    int32                   asyncError;
+    long long               pulsesWritten;
+    double                  startTime;
+};
+
+// Converts and writes the next block. Returns 0 with *numWritten 0 at
+// the end of the schedule.
+static int32 WriteNextBlock(PulseScheduler *s, int *numWritten)
+{
+    int32       error=0;
+    int32       written;
+    long long   remaining=(long long)s->cfg.totalPulses-s->pulsesWritten;
+    int         n=s->cfg.blockSize;
+
+    *numWritten = 0;
+    if( remaining<=0 )
+        return 0;
+    if( remaining<n )
+        n = (int)remaining;
+    n = s->source(s->highTime,s->lowTime,n,s->sourceData);
+    if( n<=0 )
+        return 0;
+
+    StreamMutexLock(&s->lock);
+    error = PulseTicksConvert(s->ticks,s->highTime,s->lowTime,n,s->highTicks,s->lowTicks);
+    StreamMutexUnlock(&s->lock);
+    if( error!=0 )
+        return error;
+
+    /*********************************************/
+    // DAQmx Write Code
+    /*********************************************/
+    DAQmxErrChk (DAQmxWriteCtrTicks(s->task,n,0,10.0,DAQmx_Val_GroupByChannel,s->highTicks,s->lowTicks,&written,NULL));
+
+    StreamMutexLock(&s->lock);
+    s->pulsesWritten += written;
+    StreamMutexUnlock(&s->lock);
+    *numWritten = written;
+
+Error:
+    return error;
+}
+
+static STREAM_THREAD_PROC(ProducerThread,arg)
+{
+    PulseScheduler  *s=(PulseScheduler*)arg;
+    int32           error=0;
+    int             n=1;
+
+    while( !s->stop && n>0 ) {
+        error = WriteNextBlock(s,&n);
+        if( error!=0 ) {
+            if( !s->stop )
+                s->asyncError = error;
+            break;
+        }
+    }
+    return 0;
+}
+
+int32 PulseSchedulerCreate(const PulseSchedulerConfig *config, PulseSchedulerSource source, void *sourceData, PulseScheduler **scheduler)
+{
+    int32           error=0;
+    PulseScheduler  *s;
+    size_t          n;
+
+    *scheduler = NULL;
+    if( !source || config->blockSize<1 || config->bufferBlocks<2 || config->totalPulses<1 )
+        return PulseSchedulerErrInvalidArg;
+    s = (PulseScheduler*)calloc(1,sizeof(PulseScheduler));
+    if( !s )
+        return PulseSchedulerErrOutOfMemory;
+    s->cfg = *config;
+    s->source = source;
+    s->sourceData = sourceData;
+    StreamMutexInit(&s->lock);
+
+    n = (size_t)config->blockSize;
+    s->highTime = (double*)malloc(n*sizeof(double));
+    s->lowTime = (double*)malloc(n*sizeof(double));
+    s->highTicks = (uInt32*)malloc(n*sizeof(uInt32));
+    s->lowTicks = (uInt32*)malloc(n*sizeof(uInt32));
+    if( !s->highTime || !s->lowTime || !s->highTicks || !s->lowTicks ) {
+        error = PulseSchedulerErrOutOfMemory;
+        goto Error;
+    }
+
+    /*********************************************/
+    // DAQmx Configure Code
+    /*********************************************/
+    // The initial 2 tick high and low times are replaced by the buffer.
+    DAQmxErrChk (DAQmxCreateTask("",&s->task));
+    DAQmxErrChk (DAQmxCreateCOPulseChanTicks(s->task,config->counter,"",config->timebase,config->idleState,0,2,2));
+    DAQmxErrChk (DAQmxCfgImplicitTiming(s->task,DAQmx_Val_FiniteSamps,config->totalPulses));
+    DAQmxErrChk (DAQmxCfgOutputBuffer(s->task,(uInt32)config->blockSize*config->bufferBlocks));
+    DAQmxErrChk (DAQmxSetWriteRegenMode(s->task,DAQmx_Val_DoNotAllowRegen));
+    if( s->cfg.timebaseRate<=0.0 ) {
+        DAQmxErrChk (DAQmxGetCOCtrTimebaseRate(s->task,config->counter,&s->cfg.timebaseRate));
+    }
+
+    error = PulseTicksCreate(s->cfg.timebaseRate,2,config->blockSize,&s->ticks);
+    if( error!=0 )
+        goto Error;
+    *scheduler = s;
+    return 0;
+
+Error:
+    PulseSchedulerClear(s);
+    return error;
+}
+
+void PulseSchedulerClear(PulseScheduler *scheduler)
+{
+    if( !scheduler )
+        return;
+    PulseSchedulerStop(scheduler);
+    if( scheduler->task )
+        DAQmxClearTask(scheduler->task);
+    PulseTicksClear(scheduler->ticks);
+    StreamMutexDestroy(&scheduler->lock);
+    free(scheduler->highTime);
+    free(scheduler->lowTime);
+    free(scheduler->highTicks);
+    free(scheduler->lowTicks);
+    free(scheduler);
+}
+
+int32 PulseSchedulerStart(PulseScheduler *scheduler)
+{
+    int32   error=0;
+    int     k,n;
+
+    if( scheduler->producerRunning )
+        return PulseSchedulerErrInvalidArg;
+    PulseTicksReset(scheduler->ticks);
+    scheduler->pulsesWritten = 0;
+    scheduler->stop = 0;
+    scheduler->asyncError = 0;
+
+    // A non-regenerating task must have data in its buffer to start.
+    for(k=0;k<scheduler->cfg.bufferBlocks;++k) {
+        DAQmxErrChk (WriteNextBlock(scheduler,&n));
+        if( n==0 )
+            break;
+    }
+
+    /*********************************************/
+    // DAQmx Start Code
+    /*********************************************/
+    DAQmxErrChk (DAQmxStartTask(scheduler->task));
+    scheduler->startTime = StreamTimeNow();
+
+    if( StreamThreadCreate(&scheduler->producer,ProducerThread,scheduler)!=0 ) {
+        error = PulseSchedulerErrThread;
+        goto Error;
+    }
+    scheduler->producerRunning = 1;
+    return 0;
+
+Error:
+    DAQmxStopTask(scheduler->task);
+    return error;
+}
+
+int32 PulseSchedulerWait(PulseScheduler *scheduler, float64 timeout)
+{
+    int32   error=0;
+
+    if( scheduler->producerRunning ) {
+        StreamThreadJoin(scheduler->producer);
+        scheduler->producerRunning = 0;
+    }
+    DAQmxErrChk (scheduler->asyncError);
+
+    /*********************************************/
+    // DAQmx Wait Code
+    /*********************************************/
+    DAQmxErrChk (DAQmxWaitUntilTaskDone(scheduler->task,timeout));
+
+Error:
+    return error;
+}
+
+int32 PulseSchedulerStop(PulseScheduler *scheduler)
+{
+    int32   error;
+
+    /*********************************************/
+    // DAQmx Stop Code
+    /*********************************************/
+    scheduler->stop = 1;
+    error = scheduler->task ? DAQmxStopTask(scheduler->task) : 0;
+    if( scheduler->producerRunning ) {
+        StreamThreadJoin(scheduler->producer);
+        scheduler->producerRunning = 0;
+    }
+    return error;
+}
+
+void PulseSchedulerGetStats(PulseScheduler *scheduler, PulseSchedulerStats *stats)
+{
+    uInt64  generated=0;
+    double  elapsed;
+
+    memset(stats,0,sizeof(PulseSchedulerStats));
+    DAQmxGetWriteTotalSampPerChanGenerated(scheduler->task,&generated);
+    elapsed = scheduler->startTime>0.0 ? StreamTimeNow()-scheduler->startTime : 0.0;
+
+    StreamMutexLock(&scheduler->lock);
+    stats->pulsesWritten = scheduler->pulsesWritten;
+    PulseTicksGetStats(scheduler->ticks,&stats->quantisation);
+    StreamMutexUnlock(&scheduler->lock);
+
+    stats->pulsesGenerated = (long long)generated;
+    stats->pulsesPerSec = elapsed>0.0 ? generated/elapsed : 0.0;
+}
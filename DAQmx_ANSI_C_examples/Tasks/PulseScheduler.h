@@ -0,0 +1,76 @@
+/*********************************************************************
+*
+* Task helper:
+*    PulseScheduler.h
+*
+* Description:
+*    Generates a long train of pulses, each with its own high and low
+*    time, from one counter. DigPulse.c configures a single pulse in
+*    seconds and would need a restart for every further pulse. Here
+*    the counter uses buffered implicit timing. Pulses are written as
+*    tick counts with DAQmxWriteCtrTicks into a small
+*    non-regenerating buffer while the train is running.
+*
+*    Pulse times come from a source callback, one block at a time.
+*    PulseSchedulerStart converts and writes enough blocks to fill the
+*    buffer, then starts the task. A producer thread writes the rest.
+*    Times are converted with PulseTicks.c, which keeps every edge
+*    within half a timebase tick of its ideal time.
+*
+*********************************************************************/
+
+#ifndef PULSESCHEDULER_H
+#define PULSESCHEDULER_H
+
+#include <NIDAQmx.h>
+#include "../Processing/PulseTicks.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define PulseSchedulerErrInvalidArg     -1
+#define PulseSchedulerErrOutOfMemory    -2
+#define PulseSchedulerErrThread         -3
+
+// Fills up to maxPulses high and low times, in seconds, and returns
+// the number filled. Returning 0 ends the schedule.
+typedef int (*PulseSchedulerSource)(double highTime[], double lowTime[], int maxPulses, void *sourceData);
+
+typedef struct PulseSchedulerConfig {
+    char        counter[256];           // e.g. "Dev1/ctr0"
+    char        timebase[256];          // e.g. "/Dev1/100MHzTimebase"
+    float64     timebaseRate;           // 0 to query the driver
+    int32       idleState;              // DAQmx_Val_Low or DAQmx_Val_High
+    uInt64      totalPulses;
+    int         blockSize;              // pulses per write
+    int         bufferBlocks;
+} PulseSchedulerConfig;
+
+typedef struct PulseSchedulerStats {
+    long long       pulsesWritten;
+    long long       pulsesGenerated;
+    double          pulsesPerSec;       // generated since the start
+    PulseTicksStats quantisation;
+} PulseSchedulerStats;
+
+typedef struct PulseScheduler PulseScheduler;
+
+int32 PulseSchedulerCreate(const PulseSchedulerConfig *config, PulseSchedulerSource source, void *sourceData, PulseScheduler **scheduler);
+void  PulseSchedulerClear(PulseScheduler *scheduler);
+
+int32 PulseSchedulerStart(PulseScheduler *scheduler);
+
+// Waits for the producer thread and then for the last pulse, and
+// returns the first error of either.
+int32 PulseSchedulerWait(PulseScheduler *scheduler, float64 timeout);
+
+int32 PulseSchedulerStop(PulseScheduler *scheduler);
+
+void  PulseSchedulerGetStats(PulseScheduler *scheduler, PulseSchedulerStats *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
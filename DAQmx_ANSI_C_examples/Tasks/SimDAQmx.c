@@ -0,0 +1,827 @@
+/*********************************************************************
+*
+* Task helper:
+*    SimDAQmx.c
+*
+* Description:
+*    Implementation of the simulated NI-DAQmx driver. See SimDAQmx.h.
+*
+*    Task handles are indices into a fixed table of tasks. A slot is
+*    claimed with a compare-exchange on its state, so tasks can be
+*    created and cleared from several threads at once. A task
+*    records the devices named in the physical channels of its
+*    channels, in order of first use, and the number of channels.
+*
+*    A started task with a sample clock acquires or generates at its
+*    rate from the time it was started. Nothing is buffered: reads
+*    fill the array with a ramp, and the number of samples available
+*    follows from the time elapsed. EveryN callbacks run on one thread
+*    per task, at the time the Nth sample is due. A task restarted from
+*    its own callback keeps that thread.
+*
+*    A task with a digital edge start trigger on another task's
+*    ai/StartTrigger is armed when started and begins acquiring when
+*    that task starts. The read position and the samples lost to an
+*    overwrite are kept per task, so a read can be moved with the
+*    RelativeTo and Offset properties as on hardware.
+*
+*********************************************************************/
+
+#define DAQMX_TRACE_NO_WRAPPERS
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdatomic.h>
+#include "SimDAQmx.h"
+#include "../Processing/StreamTime.h"
+#include "../Processing/StreamThread.h"
+
+#define MAX_TASKS           4096
+#define MAX_TASK_DEVICES    16
+#define NAME_LEN            64
+
+// States of a slot in the task table.
+#define TASK_FREE           0
+#define TASK_CLAIMED        1       // being set up by DAQmxCreateTask
+#define TASK_USED           2
+
+#if defined(_MSC_VER)
+#define SIM_TLS __declspec(thread)
+#else
+#define SIM_TLS _Thread_local
+#endif
+
+typedef struct SimDevice {
+    char        name[NAME_LEN];
+    int32       productCategory;
+    const char  *productType;
+    int         chassis;        // index of the chassis of a module, or -1
+    char        *terminals;
+} SimDevice;
+
+typedef struct SimTask {
+    atomic_int  state;          // first, kept when the rest is reset
+    char        name[NAME_LEN];
+    int         devices[MAX_TASK_DEVICES];
+    int         numDevices;
+    int         numChans;
+    int         output;
+    float64     rate;           // 0 without a sample clock
+    int32       sampleMode;
+    uInt64      bufferSize;     // samples per channel
+    atomic_int  running;
+    double      startTime;
+    uInt64      transferred;    // samples per channel read or written
+    char        trigger[2*NAME_LEN];    // start trigger source, or empty
+    int         waiting;        // armed, waiting for the trigger
+    int         generation;     // starts, so a callback thread notices a restart
+    int32       relativeTo;
+    int32       offset;
+    uInt64      lostTo;         // samples before this were overwritten
+    int32       fault;          // error injected into the next read
+    DAQmxEveryNSamplesEventCallbackPtr everyN;
+    uInt32      everyNSamples;
+    void        *everyNData;
+    DAQmxDoneEventCallbackPtr done;
+    void        *doneData;
+    StreamThread thread;
+    int         hasThread;
+} SimTask;
+
+static SimDAQmxSystem   sys;
+static SimDevice        *devices=NULL;
+static int              numDevices=0;
+static char             *sysDevNames=NULL;
+static SimTask          tasks[MAX_TASKS];
+static atomic_llong     queryCount=0;
+static SIM_TLS SimTask  *callbackTask;  // task whose callback this thread runs
+
+static const char *plugInTerminals[]={
+    "PFI0","PFI1","PFI2","PFI3","PFI4","PFI5","PFI6","PFI7","PFI8","PFI9","PFI10","PFI11","PFI12","PFI13","PFI14","PFI15",
+    "PXI_Trig0","PXI_Trig1","PXI_Trig2","PXI_Trig3","PXI_Trig4","PXI_Trig5","PXI_Trig6","PXI_Trig7","PXI_Star","PXIe_DStarB",
+    "ai/StartTrigger","ai/ReferenceTrigger","ai/PauseTrigger","ai/SampleClock","ai/SampleClockTimebase","ai/ConvertClock",
+    "ao/StartTrigger","ao/PauseTrigger","ao/SampleClock","ao/SampleClockTimebase",
+    "di/StartTrigger","di/SampleClock","do/StartTrigger","do/SampleClock",
+    "Ctr0Out","Ctr1Out","Ctr2Out","Ctr3Out","Ctr0Gate","Ctr1Gate","Ctr2Gate","Ctr3Gate",
+    "10MHzRefClock","20MHzTimebase","100MHzTimebase","100kHzTimebase","SyncPulse",NULL
+};
+
+static const char *chassisTerminals[]={
+    "PFI0","PFI1","ai/StartTrigger","ai/ReferenceTrigger","ai/PauseTrigger","ai/SampleClock","ai/SampleClockTimebase",
+    "ao/StartTrigger","ao/PauseTrigger","ao/SampleClock","di/SampleClock","do/SampleClock",
+    "te0/SampleClock","te1/SampleClock","te2/SampleClock",
+    "Ctr0Out","Ctr1Out","Ctr2Out","Ctr3Out","80MHzTimebase","20MHzTimebase","100kHzTimebase","SyncPulse",NULL
+};
+
+// Costs one driver round trip.
+static void Query(void)
+{
+    double until;
+
+    ++queryCount;
+    if( sys.queryLatency<=0.0 )
+        return;
+    until = StreamTimeNow()+sys.queryLatency;
+    while( StreamTimeNow()<until )
+        ;
+}
+
+static char *TerminalList(const char *device, const char **terms)
+{
+    size_t  size=1,len=0;
+    char    *list;
+    int     i;
+
+    for(i=0;terms[i];++i)
+        size += strlen(device)+strlen(terms[i])+4;
+    list = (char*)malloc(size);
+    if( !list )
+        return NULL;
+    list[0] = '\0';
+    for(i=0;terms[i];++i)
+        len += (size_t)sprintf(list+len,"%s/%s/%s",i ? ", " : "",device,terms[i]);
+    return list;
+}
+
+static void AddDevice(const char *name, int32 category, const char *type, int chassis, const char **terms)
+{
+    SimDevice *d=&devices[numDevices++];
+
+    strcpy(d->name,name);
+    d->productCategory = category;
+    d->productType = type;
+    d->chassis = chassis;
+    d->terminals = terms ? TerminalList(name,terms) : NULL;
+}
+
+void SimDAQmxSetSystem(const SimDAQmxSystem *system)
+{
+    int     c,m,p,i;
+    size_t  len=0;
+
+    for(i=0;i<numDevices;++i)
+        free(devices[i].terminals);
+    free(devices);
+    free(sysDevNames);
+    sys = *system;
+    numDevices = 0;
+    devices = (SimDevice*)calloc((size_t)(sys.numChassis*(1+sys.modulesPerChassis)+sys.numPlugIn+1),sizeof(SimDevice));
+    for(c=1;devices && c<=sys.numChassis;++c) {
+        char    name[NAME_LEN];
+        int     chassis=numDevices;
+
+        sprintf(name,"cDAQ%d",c);
+        AddDevice(name,DAQmx_Val_CompactDAQChassis,"cDAQ-9189",-1,chassisTerminals);
+        for(m=1;m<=sys.modulesPerChassis;++m) {
+            sprintf(name,"cDAQ%dMod%d",c,m);
+            AddDevice(name,DAQmx_Val_CSeriesModule,"NI 9205",chassis,NULL);
+        }
+    }
+    for(p=0;devices && p<sys.numPlugIn;++p) {
+        char name[NAME_LEN];
+
+        sprintf(name,"PXI1Slot%d",p+2);
+        AddDevice(name,DAQmx_Val_PXIeDAQ,"PXIe-6363",-1,plugInTerminals);
+    }
+    sysDevNames = (char*)malloc((size_t)numDevices*(NAME_LEN+2)+1);
+    if( sysDevNames ) {
+        sysDevNames[0] = '\0';
+        for(i=0;i<numDevices;++i)
+            len += (size_t)sprintf(sysDevNames+len,"%s%s",i ? ", " : "",devices[i].name);
+    }
+}
+
+long long SimDAQmxQueryCount(void)
+{
+    return atomic_load(&queryCount);
+}
+
+void SimDAQmxResetQueryCount(void)
+{
+    atomic_store(&queryCount,0);
+}
+
+static int FindDevice(const char *name, size_t len)
+{
+    int i;
+
+    for(i=0;i<numDevices;++i)
+        if( strlen(devices[i].name)==len && strncmp(devices[i].name,name,len)==0 )
+            return i;
+    return -1;
+}
+
+static SimTask *GetTask(TaskHandle taskHandle)
+{
+    size_t i=(size_t)taskHandle;
+
+    return i>=1 && i<=MAX_TASKS && atomic_load(&tasks[i-1].state)==TASK_USED ? &tasks[i-1] : NULL;
+}
+
+// DAQmx string properties: with no buffer, return the size needed.
+static int32 CopyString(const char *s, char *data, uInt32 bufferSize)
+{
+    if( !data || bufferSize==0 )
+        return (int32)strlen(s)+1;
+    strncpy(data,s,bufferSize-1);
+    data[bufferSize-1] = '\0';
+    return 0;
+}
+
+/*********************************************/
+// System and device properties
+/*********************************************/
+int32 DAQmxGetSysDevNames(char *data, uInt32 bufferSize)
+{
+    Query();
+    return CopyString(sysDevNames ? sysDevNames : "",data,bufferSize);
+}
+
+int32 DAQmxGetDevProductCategory(const char device[], int32 *data)
+{
+    int i=FindDevice(device,strlen(device));
+
+    Query();
+    if( i<0 )
+        return SimDAQmxErrDeviceNotFound;
+    *data = devices[i].productCategory;
+    return 0;
+}
+
+int32 DAQmxGetDevProductType(const char device[], char *data, uInt32 bufferSize)
+{
+    int i=FindDevice(device,strlen(device));
+
+    Query();
+    return i<0 ? SimDAQmxErrDeviceNotFound : CopyString(devices[i].productType,data,bufferSize);
+}
+
+int32 DAQmxGetDevCompactDAQChassisDevName(const char device[], char *data, uInt32 bufferSize)
+{
+    int i=FindDevice(device,strlen(device));
+
+    Query();
+    if( i<0 )
+        return SimDAQmxErrDeviceNotFound;
+    return CopyString(devices[i].chassis>=0 ? devices[devices[i].chassis].name : "",data,bufferSize);
+}
+
+int32 DAQmxGetDevTerminals(const char device[], char *data, uInt32 bufferSize)
+{
+    int i=FindDevice(device,strlen(device));
+
+    Query();
+    if( i<0 )
+        return SimDAQmxErrDeviceNotFound;
+    return CopyString(devices[i].terminals ? devices[i].terminals : "",data,bufferSize);
+}
+
+/*********************************************/
+// Tasks and channels
+/*********************************************/
+int32 DAQmxCreateTask(const char taskName[], TaskHandle *taskHandle)
+{
+    int i;
+
+    for(i=0;i<MAX_TASKS;++i) {
+        SimTask *t=&tasks[i];
+        int     state=TASK_FREE;
+
+        if( atomic_load(&t->state)!=TASK_FREE || !atomic_compare_exchange_strong(&t->state,&state,TASK_CLAIMED) )
+            continue;
+        memset((char*)t+offsetof(SimTask,name),0,sizeof(SimTask)-offsetof(SimTask,name));
+        atomic_init(&t->running,0);
+        t->relativeTo = DAQmx_Val_CurrReadPos;
+        strncpy(t->name,taskName,NAME_LEN-1);
+        atomic_store(&t->state,TASK_USED);
+        *taskHandle = (TaskHandle)(size_t)(i+1);
+        return 0;
+    }
+    return SimDAQmxErrOutOfMemory;
+}
+
+int32 DAQmxClearTask(TaskHandle taskHandle)
+{
+    SimTask *t=GetTask(taskHandle);
+
+    if( !t )
+        return SimDAQmxErrInvalidTask;
+    DAQmxStopTask(taskHandle);
+    if( t->hasThread )
+        StreamThreadJoin(t->thread);
+    atomic_store(&t->state,TASK_FREE);
+    return 0;
+}
+
+// Number of channels in "/ai0:3" or "/ai0".
+static int CountChannels(const char *p, size_t len)
+{
+    const char  *colon=memchr(p,':',len);
+    const char  *first;
+
+    if( !colon )
+        return 1;
+    for(first=colon;first>p && first[-1]>='0' && first[-1]<='9';--first)
+        ;
+    return abs(atoi(colon+1)-atoi(first))+1;
+}
+
+// Records the devices of a list of physical channels, "Dev1/ai0:3, Dev2/ai0".
+static int32 AddChannels(TaskHandle taskHandle, const char physicalChannel[])
+{
+    SimTask     *t=GetTask(taskHandle);
+    const char  *p=physicalChannel;
+
+    if( !t )
+        return SimDAQmxErrInvalidTask;
+    while( *p ) {
+        size_t  len;
+        int     d,k;
+
+        while( *p==' ' || *p==',' || *p=='/' )
+            ++p;
+        len = strcspn(p,"/");
+        if( !*p )
+            break;
+        d = FindDevice(p,len);
+        if( d<0 )
+            return SimDAQmxErrDeviceNotFound;
+        for(k=0;k<t->numDevices && t->devices[k]!=d;++k)
+            ;
+        if( k==t->numDevices && k<MAX_TASK_DEVICES )
+            t->devices[t->numDevices++] = d;
+        t->numChans += CountChannels(p+len,strcspn(p+len,","));
+        p += strcspn(p,",");
+    }
+    return 0;
+}
+
+int32 DAQmxCreateAIVoltageChan(TaskHandle taskHandle, const char physicalChannel[], const char nameToAssignToChannel[], int32 terminalConfig, float64 minVal, float64 maxVal, int32 units, const char customScaleName[])
+{
+    return AddChannels(taskHandle,physicalChannel);
+}
+
+int32 DAQmxCreateAOVoltageChan(TaskHandle taskHandle, const char physicalChannel[], const char nameToAssignToChannel[], float64 minVal, float64 maxVal, int32 units, const char customScaleName[])
+{
+    SimTask *t=GetTask(taskHandle);
+
+    if( t )
+        t->output = 1;
+    return AddChannels(taskHandle,physicalChannel);
+}
+
+int32 DAQmxGetTaskNumDevices(TaskHandle taskHandle, uInt32 *data)
+{
+    SimTask *t=GetTask(taskHandle);
+
+    Query();
+    if( !t )
+        return SimDAQmxErrInvalidTask;
+    *data = (uInt32)t->numDevices;
+    return 0;
+}
+
+int32 DAQmxGetNthTaskDevice(TaskHandle taskHandle, uInt32 index, char buffer[], int32 bufferSize)
+{
+    SimTask *t=GetTask(taskHandle);
+
+    Query();
+    if( !t )
+        return SimDAQmxErrInvalidTask;
+    if( index<1 || index>(uInt32)t->numDevices )
+        return SimDAQmxErrDeviceNotFound;
+    return CopyString(devices[t->devices[index-1]].name,buffer,(uInt32)bufferSize);
+}
+
+int32 DAQmxGetExtendedErrorInfo(char errorString[], uInt32 bufferSize)
+{
+    return CopyString("Simulated NI-DAQmx error",errorString,bufferSize);
+}
+
+/*********************************************/
+// Timing, start and stop
+/*********************************************/
+int32 DAQmxCfgSampClkTiming(TaskHandle taskHandle, const char source[], float64 rate, int32 activeEdge, int32 sampleMode, uInt64 sampsPerChan)
+{
+    SimTask *t=GetTask(taskHandle);
+    uInt64  minBuffer;
+
+    if( !t )
+        return SimDAQmxErrInvalidTask;
+    t->rate = rate;
+    t->sampleMode = sampleMode;
+    // The input buffer sizes that DAQmx picks for continuous acquisitions.
+    minBuffer = rate<=100.0 ? 1000 : rate<=10000.0 ? 10000 : rate<=1e6 ? 100000 : 1000000;
+    t->bufferSize = sampleMode==DAQmx_Val_ContSamps && !t->output && sampsPerChan<minBuffer ? minBuffer : sampsPerChan;
+    return 0;
+}
+
+int32 DAQmxCfgOutputBuffer(TaskHandle taskHandle, uInt32 numSampsPerChan)
+{
+    SimTask *t=GetTask(taskHandle);
+
+    if( !t )
+        return SimDAQmxErrInvalidTask;
+    t->bufferSize = numSampsPerChan;
+    return 0;
+}
+
+int32 DAQmxCfgInputBuffer(TaskHandle taskHandle, uInt32 numSampsPerChan)
+{
+    return DAQmxCfgOutputBuffer(taskHandle,numSampsPerChan);
+}
+
+int32 DAQmxCfgDigEdgeStartTrig(TaskHandle taskHandle, const char triggerSource[], int32 triggerEdge)
+{
+    SimTask *t=GetTask(taskHandle);
+
+    if( !t )
+        return SimDAQmxErrInvalidTask;
+    strncpy(t->trigger,triggerSource,sizeof(t->trigger)-1);
+    return 0;
+}
+
+int32 DAQmxRegisterEveryNSamplesEvent(TaskHandle taskHandle, int32 everyNsamplesEventType, uInt32 nSamples, uInt32 options, DAQmxEveryNSamplesEventCallbackPtr callbackFunction, void *callbackData)
+{
+    SimTask *t=GetTask(taskHandle);
+
+    if( !t )
+        return SimDAQmxErrInvalidTask;
+    t->everyN = callbackFunction;
+    t->everyNSamples = nSamples;
+    t->everyNData = callbackData;
+    return 0;
+}
+
+int32 DAQmxRegisterDoneEvent(TaskHandle taskHandle, uInt32 options, DAQmxDoneEventCallbackPtr callbackFunction, void *callbackData)
+{
+    SimTask *t=GetTask(taskHandle);
+
+    if( !t )
+        return SimDAQmxErrInvalidTask;
+    t->done = callbackFunction;
+    t->doneData = callbackData;
+    return 0;
+}
+
+// Samples per channel acquired or generated since the start.
+static uInt64 Elapsed(const SimTask *t)
+{
+    uInt64 n;
+
+    if( !atomic_load(&t->running) || t->waiting || t->rate<=0.0 )
+        return 0;
+    n = (uInt64)((StreamTimeNow()-t->startTime)*t->rate);
+    return t->sampleMode==DAQmx_Val_FiniteSamps && n>t->bufferSize ? t->bufferSize : n;
+}
+
+static STREAM_THREAD_PROC(EveryNThread, arg)
+{
+    SimTask *t=(SimTask*)arg;
+    uInt64  next=t->everyNSamples;
+    int     generation=t->generation;
+
+    callbackTask = t;
+    while( atomic_load(&t->running) ) {
+        double due=t->startTime+(double)next/t->rate;
+        double now=StreamTimeNow();
+
+        if( generation!=t->generation ) {
+            generation = t->generation;
+            next = t->everyNSamples;
+            continue;
+        }
+        if( t->waiting ) {
+            StreamSleep(0.001);
+            continue;
+        }
+        if( now<due ) {
+            StreamSleep(due-now>0.001 ? 0.001 : due-now);
+            continue;
+        }
+        if( t->sampleMode==DAQmx_Val_FiniteSamps && next>t->bufferSize )
+            break;
+        t->everyN((TaskHandle)(size_t)(t-tasks+1),t->output ? DAQmx_Val_Transferred_From_Buffer : DAQmx_Val_Acquired_Into_Buffer,t->everyNSamples,t->everyNData);
+        next += t->everyNSamples;
+    }
+    return 0;
+}
+
+// Starts the armed tasks whose start trigger is t's ai/StartTrigger.
+static void Trigger(const SimTask *t)
+{
+    char    terminal[2*NAME_LEN];
+    int     i,k;
+
+    if( t->waiting )
+        return;
+    for(k=0;k<t->numDevices;++k) {
+        sprintf(terminal,"/%s/ai/StartTrigger",devices[t->devices[k]].name);
+        for(i=0;i<MAX_TASKS;++i)
+            if( atomic_load(&tasks[i].state)==TASK_USED && tasks[i].waiting && atomic_load(&tasks[i].running) && strcmp(tasks[i].trigger,terminal)==0 ) {
+                tasks[i].startTime = t->startTime;
+                tasks[i].waiting = 0;
+            }
+    }
+}
+
+int32 DAQmxStartTask(TaskHandle taskHandle)
+{
+    SimTask *t=GetTask(taskHandle);
+
+    if( !t )
+        return SimDAQmxErrInvalidTask;
+    if( atomic_load(&t->running) )
+        return 0;
+    // A callback restarting its own task keeps its thread.
+    if( t->hasThread && callbackTask!=t ) {
+        StreamThreadJoin(t->thread);
+        t->hasThread = 0;
+    }
+    t->startTime = StreamTimeNow();
+    t->transferred = 0;
+    t->lostTo = 0;
+    t->fault = 0;
+    t->waiting = t->trigger[0]!='\0';
+    t->generation++;
+    atomic_store(&t->running,1);
+    Trigger(t);
+    if( !t->hasThread && t->everyN && t->everyNSamples>0 && t->rate>0.0 )
+        t->hasThread = StreamThreadCreate(&t->thread,EveryNThread,t)==0;
+    return 0;
+}
+
+int32 DAQmxStopTask(TaskHandle taskHandle)
+{
+    SimTask *t=GetTask(taskHandle);
+
+    if( !t )
+        return SimDAQmxErrInvalidTask;
+    atomic_store(&t->running,0);
+    // A callback that stops its own task is joined later.
+    if( t->hasThread && callbackTask!=t ) {
+        StreamThreadJoin(t->thread);
+        t->hasThread = 0;
+    }
+    return 0;
+}
+
+int32 DAQmxTaskControl(TaskHandle taskHandle, int32 action)
+{
+    return GetTask(taskHandle) ? 0 : SimDAQmxErrInvalidTask;
+}
+
+// A task stopped by an onboard overflow is done, as on hardware.
+int32 DAQmxIsTaskDone(TaskHandle taskHandle, bool32 *isTaskDone)
+{
+    SimTask *t=GetTask(taskHandle);
+
+    if( !t )
+        return SimDAQmxErrInvalidTask;
+    Query();
+    *isTaskDone = !atomic_load(&t->running) || t->fault==SimDAQmxErrOnboardOverflow;
+    return 0;
+}
+
+int32 DAQmxWaitUntilTaskDone(TaskHandle taskHandle, float64 timeToWait)
+{
+    SimTask *t=GetTask(taskHandle);
+    double  end;
+
+    if( !t )
+        return SimDAQmxErrInvalidTask;
+    if( t->sampleMode!=DAQmx_Val_FiniteSamps || t->rate<=0.0 )
+        return 0;
+    end = t->startTime+(double)t->bufferSize/t->rate;
+    if( timeToWait>=0.0 && end-StreamTimeNow()>timeToWait ) {
+        StreamSleep(timeToWait);
+        return SimDAQmxErrTimeout;
+    }
+    if( end>StreamTimeNow() )
+        StreamSleep(end-StreamTimeNow());
+    return 0;
+}
+
+/*********************************************/
+// Read and write
+/*********************************************/
+// Waits for the samples of a read and returns the read position and
+// the number of samples per channel that fit into the array.
+static int32 ReadWait(SimTask *t, TaskHandle taskHandle, int32 numSampsPerChan, float64 timeout, uInt32 arraySizeInSamps, uInt64 *first, uInt64 *count)
+{
+    double  deadline;
+    uInt64  avail,n,acquired;
+    int64   pos;
+
+    if( t->fault ) {
+        int32 fault=t->fault;
+
+        // An onboard overflow stops the acquisition until a restart.
+        if( fault!=SimDAQmxErrOnboardOverflow )
+            t->fault = 0;
+        return fault;
+    }
+    // A read starts a stopped task, unless it is made by the task's
+    // own callback after the task was stopped.
+    if( !atomic_load(&t->running) && callbackTask!=t )
+        DAQmxStartTask(taskHandle);
+    deadline = StreamTimeNow()+timeout;
+    for(;;) {
+        if( !atomic_load(&t->running) )
+            return SimDAQmxErrTimeout;
+        acquired = Elapsed(t);
+        pos = t->relativeTo==DAQmx_Val_FirstSample ? 0 : t->relativeTo==DAQmx_Val_MostRecentSamp ? (int64)acquired : (int64)t->transferred;
+        pos += t->offset;
+        if( pos<0 || (uInt64)pos<t->lostTo || (int64)acquired-pos>(int64)t->bufferSize )
+            return SimDAQmxErrOverwritten;
+        avail = (int64)acquired>pos ? acquired-(uInt64)pos : 0;
+        if( numSampsPerChan==DAQmx_Val_Auto ) {
+            n = avail;
+            break;
+        }
+        n = (uInt64)numSampsPerChan;
+        if( avail>=n )
+            break;
+        if( timeout>=0.0 && StreamTimeNow()>=deadline )
+            return SimDAQmxErrTimeout;
+        StreamSleep((double)(n-avail)/t->rate);
+    }
+    if( n*(uInt64)t->numChans>arraySizeInSamps )
+        n = arraySizeInSamps/(t->numChans>0 ? t->numChans : 1);
+    t->transferred = (uInt64)pos+n;
+    *first = (uInt64)pos;
+    *count = n;
+    return 0;
+}
+
+int32 DAQmxReadAnalogF64(TaskHandle taskHandle, int32 numSampsPerChan, float64 timeout, bool32 fillMode, float64 readArray[], uInt32 arraySizeInSamps, int32 *sampsPerChanRead, bool32 *reserved)
+{
+    SimTask *t=GetTask(taskHandle);
+    uInt64  pos,n,i;
+    int32   error;
+    int     c;
+
+    if( sampsPerChanRead )
+        *sampsPerChanRead = 0;
+    if( !t )
+        return SimDAQmxErrInvalidTask;
+    if( (error=ReadWait(t,taskHandle,numSampsPerChan,timeout,arraySizeInSamps,&pos,&n))!=0 )
+        return error;
+    for(c=0;c<t->numChans;++c)
+        for(i=0;i<n;++i)
+            readArray[fillMode==DAQmx_Val_GroupByChannel ? c*n+i : i*t->numChans+c] = 1e-3*(double)(pos+i);
+    if( sampsPerChanRead )
+        *sampsPerChanRead = (int32)n;
+    return 0;
+}
+
+// Raw samples are the index since the start of the task, modulo 2^16.
+int32 DAQmxReadBinaryI16(TaskHandle taskHandle, int32 numSampsPerChan, float64 timeout, bool32 fillMode, int16 readArray[], uInt32 arraySizeInSamps, int32 *sampsPerChanRead, bool32 *reserved)
+{
+    SimTask *t=GetTask(taskHandle);
+    uInt64  pos,n,i;
+    int32   error;
+    int     c;
+
+    if( sampsPerChanRead )
+        *sampsPerChanRead = 0;
+    if( !t )
+        return SimDAQmxErrInvalidTask;
+    if( (error=ReadWait(t,taskHandle,numSampsPerChan,timeout,arraySizeInSamps,&pos,&n))!=0 )
+        return error;
+    for(c=0;c<t->numChans;++c)
+        for(i=0;i<n;++i)
+            readArray[fillMode==DAQmx_Val_GroupByChannel ? c*n+i : i*t->numChans+c] = (int16)(uInt16)(pos+i);
+    if( sampsPerChanRead )
+        *sampsPerChanRead = (int32)n;
+    return 0;
+}
+
+int32 DAQmxWriteAnalogF64(TaskHandle taskHandle, int32 numSampsPerChan, bool32 autoStart, float64 timeout, bool32 dataLayout, const float64 writeArray[], int32 *sampsPerChanWritten, bool32 *reserved)
+{
+    SimTask *t=GetTask(taskHandle);
+
+    if( sampsPerChanWritten )
+        *sampsPerChanWritten = 0;
+    if( !t )
+        return SimDAQmxErrInvalidTask;
+    t->transferred += (uInt64)numSampsPerChan;
+    if( autoStart && !atomic_load(&t->running) )
+        DAQmxStartTask(taskHandle);
+    if( sampsPerChanWritten )
+        *sampsPerChanWritten = numSampsPerChan;
+    return 0;
+}
+
+int32 DAQmxWriteBinaryI16(TaskHandle taskHandle, int32 numSampsPerChan, bool32 autoStart, float64 timeout, bool32 dataLayout, const int16 writeArray[], int32 *sampsPerChanWritten, bool32 *reserved)
+{
+    return DAQmxWriteAnalogF64(taskHandle,numSampsPerChan,autoStart,timeout,dataLayout,NULL,sampsPerChanWritten,reserved);
+}
+
+int32 DAQmxGetReadAvailSampPerChan(TaskHandle taskHandle, uInt32 *data)
+{
+    SimTask *t=GetTask(taskHandle);
+
+    Query();
+    if( !t )
+        return SimDAQmxErrInvalidTask;
+    *data = (uInt32)(Elapsed(t)-t->transferred);
+    return 0;
+}
+
+int32 DAQmxGetReadTotalSampPerChanAcquired(TaskHandle taskHandle, uInt64 *data)
+{
+    SimTask *t=GetTask(taskHandle);
+
+    Query();
+    if( !t )
+        return SimDAQmxErrInvalidTask;
+    *data = Elapsed(t);
+    return 0;
+}
+
+int32 DAQmxGetWriteTotalSampPerChanGenerated(TaskHandle taskHandle, uInt64 *data)
+{
+    SimTask *t=GetTask(taskHandle);
+
+    Query();
+    if( !t )
+        return SimDAQmxErrInvalidTask;
+    *data = Elapsed(t);
+    return 0;
+}
+
+int32 DAQmxGetReadCurrReadPos(TaskHandle taskHandle, uInt64 *data)
+{
+    SimTask *t=GetTask(taskHandle);
+
+    Query();
+    if( !t )
+        return SimDAQmxErrInvalidTask;
+    *data = t->transferred;
+    return 0;
+}
+
+int32 DAQmxSetReadRelativeTo(TaskHandle taskHandle, int32 data)
+{
+    SimTask *t=GetTask(taskHandle);
+
+    Query();
+    if( !t )
+        return SimDAQmxErrInvalidTask;
+    t->relativeTo = data;
+    return 0;
+}
+
+int32 DAQmxSetReadOffset(TaskHandle taskHandle, int32 data)
+{
+    SimTask *t=GetTask(taskHandle);
+
+    Query();
+    if( !t )
+        return SimDAQmxErrInvalidTask;
+    t->offset = data;
+    return 0;
+}
+
+int32 DAQmxGetBufInputBufSize(TaskHandle taskHandle, uInt32 *data)
+{
+    SimTask *t=GetTask(taskHandle);
+
+    Query();
+    if( !t )
+        return SimDAQmxErrInvalidTask;
+    *data = (uInt32)t->bufferSize;
+    return 0;
+}
+
+int32 DAQmxGetTaskNumChans(TaskHandle taskHandle, uInt32 *data)
+{
+    SimTask *t=GetTask(taskHandle);
+
+    Query();
+    if( !t )
+        return SimDAQmxErrInvalidTask;
+    *data = (uInt32)t->numChans;
+    return 0;
+}
+
+/*********************************************/
+// Fault injection
+/*********************************************/
+int32 SimDAQmxInjectFault(TaskHandle taskHandle, int32 error)
+{
+    SimTask *t=GetTask(taskHandle);
+
+    if( !t )
+        return SimDAQmxErrInvalidTask;
+    if( error==SimDAQmxErrOverwritten )
+        t->lostTo = Elapsed(t);
+    else
+        t->fault = error;
+    if( error==SimDAQmxErrOnboardOverflow && t->done )
+        t->done(taskHandle,error,t->doneData);
+    return 0;
+}
@@ -0,0 +1,80 @@
+/*********************************************************************
+*
+* Task helper:
+*    SimDAQmx.h
+*
+* Description:
+*    Simulated NI-DAQmx driver for the Tasks benchmarks. SimDAQmx.c
+*    implements the part of the NI-DAQmx C API that the helpers in
+*    this directory call, so they can be timed and tested on a
+*    computer without the driver or any devices. Link it instead of
+*    the NI-DAQmx library, with the real NIDAQmx.h.
+*
+*    The simulated system has numChassis CompactDAQ chassis with
+*    modulesPerChassis C Series modules each, named cDAQ1, cDAQ1Mod1
+*    and so on, and numPlugIn PXI Express devices named PXI1Slot2,
+*    PXI1Slot3 and so on. Every driver call that queries a device or
+*    task property busy-waits for queryLatency seconds, like the round
+*    trip into the real driver, and is counted.
+*
+*    Calling SimDAQmxSetSystem again replaces the devices, as if
+*    hardware had been added or removed.
+*
+*    Tasks with analog voltage channels and a sample clock can be
+*    started, read, written and stopped. Samples become available at
+*    the configured rate from the start of the task, and a read that
+*    falls further behind than the buffer size fails with the DAQmx
+*    overwrite error, as it would on hardware. EveryN callbacks are
+*    called on a separate thread per task. Each sample read is
+*    1e-3 times its index since the start of the task, or the index
+*    itself as a wrapping 16 bit code when read with
+*    DAQmxReadBinaryI16, so a reader can check which samples it got. A start trigger on the ai/StartTrigger
+*    of another simulated task starts the task with that task.
+*
+*    SimDAQmxInjectFault makes a task's reads fail as after a fault on
+*    hardware. For SimDAQmxErrOverwritten all samples acquired so far
+*    are lost, as if the reader had stalled, and reads fail until the
+*    read position is moved past them or the task is restarted. For
+*    SimDAQmxErrOnboardOverflow reads fail until the task is
+*    restarted, DAQmxIsTaskDone reports the task done, and its Done
+*    callback, if any, is called with the error on the calling
+*    thread. Any other error is returned by the next read only.
+*
+*********************************************************************/
+
+#ifndef SIMDAQMX_H
+#define SIMDAQMX_H
+
+#include <NIDAQmx.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SimDAQmxErrDeviceNotFound   -200220     // as DAQmxErrorInvalidDeviceID
+#define SimDAQmxErrInvalidTask      -200088     // as DAQmxErrorInvalidTask
+#define SimDAQmxErrOutOfMemory      -50352      // as DAQmxErrorPALMemoryFull
+#define SimDAQmxErrTimeout          -200284     // as DAQmxErrorSamplesNotYetAvailable
+#define SimDAQmxErrOverwritten      -200279     // as DAQmxErrorSamplesNoLongerAvailable
+#define SimDAQmxErrOnboardOverflow  -200361     // onboard device memory overflow
+
+typedef struct SimDAQmxSystem {
+    int         numChassis;
+    int         modulesPerChassis;
+    int         numPlugIn;
+    double      queryLatency;   // seconds per property query
+} SimDAQmxSystem;
+
+void      SimDAQmxSetSystem(const SimDAQmxSystem *system);
+
+// Number of property queries since the last reset.
+long long SimDAQmxQueryCount(void);
+void      SimDAQmxResetQueryCount(void);
+
+int32     SimDAQmxInjectFault(TaskHandle taskHandle, int32 error);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
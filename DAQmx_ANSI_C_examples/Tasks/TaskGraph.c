@@ -0,0 +1,356 @@
+/*********************************************************************
+*
+* Task helper:
+*    TaskGraph.c
+*
+* Description:
+*    Implementation of the task dependency graph. See TaskGraph.h for
+*    the calling conventions.
+*
+*    The start order is a depth-first post-order over the dependents:
+*    a task is appended only after every task that depends on it.
+*    Meeting a task that is still being visited means the
+*    dependencies form a cycle, which no start order can satisfy.
+*
+*********************************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+#include "TaskGraph.h"
+#include "DevTopology.h"
+#include "../Processing/StreamTime.h"
+#include "../Processing/StreamThread.h"
+
+#define DAQmxErrChk(functionCall) if( DAQmxFailed(error=(functionCall)) ) goto Error; else
+
+#define NAME_LEN    64
+#define TERM_LEN    256
+
+#define PhaseConfigure  0
+#define PhaseCommit     1
+
+typedef struct Dependency {
+    int                 dependent;
+    int                 source;
+    char                terminal[TERM_LEN];
+    int                 kind;
+} Dependency;
+
+typedef struct Node {
+    char                name[NAME_LEN];
+    TaskGraphConfigure  configure;
+    void                *configureData;
+    TaskHandle          task;
+    int                 started;
+    int                 mark;           // 0 unvisited, 1 visiting, 2 ordered
+    int32               error;
+    TaskGraphTimes      times;
+} Node;
+
+typedef struct PhaseArg {
+    TaskGraph           *graph;
+    Node                *node;
+    int                 phase;
+} PhaseArg;
+
+struct TaskGraph {
+    Node                *nodes;
+    int                 numNodes;
+    int                 maxNodes;
+    Dependency          *deps;
+    int                 numDeps;
+    int                 maxDeps;
+    int                 *order;         // start order, node indices
+    double              t0;
+    double              armed;
+};
+
+static int FindNode(const TaskGraph *g, const char name[])
+{
+    int i;
+
+    for(i=0;i<g->numNodes;++i)
+        if( strcmp(g->nodes[i].name,name)==0 )
+            return i;
+    return -1;
+}
+
+int TaskGraphCreate(TaskGraph **graph)
+{
+    *graph = (TaskGraph*)calloc(1,sizeof(TaskGraph));
+    return *graph ? 0 : TaskGraphErrOutOfMemory;
+}
+
+static void ClearTasks(TaskGraph *g)
+{
+    int i;
+
+    TaskGraphStop(g);
+    for(i=0;i<g->numNodes;++i)
+        if( g->nodes[i].task ) {
+            DAQmxClearTask(g->nodes[i].task);
+            g->nodes[i].task = 0;
+        }
+}
+
+void TaskGraphClear(TaskGraph *graph)
+{
+    if( !graph )
+        return;
+    ClearTasks(graph);
+    free(graph->nodes);
+    free(graph->deps);
+    free(graph->order);
+    free(graph);
+}
+
+int TaskGraphAddTask(TaskGraph *graph, const char name[], TaskGraphConfigure configure, void *configureData)
+{
+    Node    *n;
+
+    if( !name || !name[0] || strlen(name)>=NAME_LEN || !configure || FindNode(graph,name)>=0 )
+        return TaskGraphErrInvalidArg;
+    if( graph->numNodes==graph->maxNodes ) {
+        int     max=graph->maxNodes ? 2*graph->maxNodes : 8;
+        Node    *nodes=(Node*)realloc(graph->nodes,max*sizeof(Node));
+        int     *order=(int*)realloc(graph->order,max*sizeof(int));
+
+        if( nodes )
+            graph->nodes = nodes;
+        if( order )
+            graph->order = order;
+        if( !nodes || !order )
+            return TaskGraphErrOutOfMemory;
+        graph->maxNodes = max;
+    }
+    n = &graph->nodes[graph->numNodes++];
+    memset(n,0,sizeof(Node));
+    strcpy(n->name,name);
+    n->configure = configure;
+    n->configureData = configureData;
+    graph->order[graph->numNodes-1] = graph->numNodes-1;
+    return 0;
+}
+
+int TaskGraphAddDependency(TaskGraph *graph, const char dependent[], const char source[], const char terminal[], int kind)
+{
+    int         d=FindNode(graph,dependent),s=FindNode(graph,source);
+    Dependency  *dep;
+
+    if( d<0 || s<0 || d==s || kind<TaskGraphStartTrigger || kind>TaskGraphStartOrder )
+        return TaskGraphErrInvalidArg;
+    if( kind!=TaskGraphStartOrder && (!terminal || !terminal[0] || strlen(terminal)>=TERM_LEN-NAME_LEN) )
+        return TaskGraphErrInvalidArg;
+    if( graph->numDeps==graph->maxDeps ) {
+        int         max=graph->maxDeps ? 2*graph->maxDeps : 8;
+        Dependency  *deps=(Dependency*)realloc(graph->deps,max*sizeof(Dependency));
+
+        if( !deps )
+            return TaskGraphErrOutOfMemory;
+        graph->deps = deps;
+        graph->maxDeps = max;
+    }
+    dep = &graph->deps[graph->numDeps++];
+    dep->dependent = d;
+    dep->source = s;
+    dep->kind = kind;
+    strcpy(dep->terminal,kind!=TaskGraphStartOrder ? terminal : "");
+    return 0;
+}
+
+// Appends every dependent of node i, then i. Returns nonzero on a cycle.
+static int Visit(TaskGraph *g, int i, int *count)
+{
+    int k;
+
+    if( g->nodes[i].mark==2 )
+        return 0;
+    if( g->nodes[i].mark==1 )
+        return 1;
+    g->nodes[i].mark = 1;
+    for(k=0;k<g->numDeps;++k)
+        if( g->deps[k].source==i && Visit(g,g->deps[k].dependent,count) )
+            return 1;
+    g->nodes[i].mark = 2;
+    g->nodes[i].times.startIndex = *count;
+    g->order[(*count)++] = i;
+    return 0;
+}
+
+static int StartOrder(TaskGraph *g)
+{
+    int i,count=0;
+
+    for(i=0;i<g->numNodes;++i)
+        g->nodes[i].mark = 0;
+    for(i=0;i<g->numNodes;++i)
+        if( Visit(g,i,&count) )
+            return TaskGraphErrCycle;
+    return 0;
+}
+
+static void RunPhase(PhaseArg *a)
+{
+    Node    *n=a->node;
+    int32   error=0;
+
+    if( a->phase==PhaseConfigure ) {
+        n->times.configureStart = StreamTimeNow()-a->graph->t0;
+        DAQmxErrChk (DAQmxCreateTask(n->name,&n->task));
+        DAQmxErrChk (n->configure(n->task,n->configureData));
+        n->times.configureEnd = StreamTimeNow()-a->graph->t0;
+    }
+    else {
+        n->times.commitStart = StreamTimeNow()-a->graph->t0;
+        DAQmxErrChk (DAQmxTaskControl(n->task,DAQmx_Val_Task_Verify));
+        DAQmxErrChk (DAQmxTaskControl(n->task,DAQmx_Val_Task_Commit));
+        n->times.commitEnd = StreamTimeNow()-a->graph->t0;
+    }
+
+Error:
+    n->error = error;
+}
+
+static STREAM_THREAD_PROC(PhaseThread,arg)
+{
+    RunPhase((PhaseArg*)arg);
+    return 0;
+}
+
+// Runs one phase for every node, on one thread per node if parallel.
+// Returns the first error in node order.
+static int32 RunPhaseAll(TaskGraph *g, int phase, int parallel)
+{
+    PhaseArg        *args=(PhaseArg*)malloc(g->numNodes*sizeof(PhaseArg));
+    StreamThread    *threads=(StreamThread*)malloc(g->numNodes*sizeof(StreamThread));
+    int             *running=(int*)calloc(g->numNodes,sizeof(int));
+    int32           error=0;
+    int             i;
+
+    if( !args || !threads || !running ) {
+        error = TaskGraphErrOutOfMemory;
+        goto Error;
+    }
+    for(i=0;i<g->numNodes;++i) {
+        args[i].graph = g;
+        args[i].node = &g->nodes[i];
+        args[i].phase = phase;
+        g->nodes[i].error = 0;
+        if( parallel && StreamThreadCreate(&threads[i],PhaseThread,&args[i])==0 )
+            running[i] = 1;
+        else
+            RunPhase(&args[i]);
+    }
+    for(i=0;i<g->numNodes;++i) {
+        if( running[i] )
+            StreamThreadJoin(threads[i]);
+        if( DAQmxFailed(g->nodes[i].error) && !error )
+            error = g->nodes[i].error;
+    }
+
+Error:
+    free(args);
+    free(threads);
+    free(running);
+    return error;
+}
+
+static int32 Route(TaskGraph *g, const Dependency *dep)
+{
+    int32       error=0;
+    TaskHandle  task=g->nodes[dep->dependent].task;
+    char        terminal[TERM_LEN];
+
+    if( dep->kind==TaskGraphStartOrder )
+        return 0;
+    DAQmxErrChk (DevTopologyTaskTerminal(g->nodes[dep->source].task,dep->terminal,terminal,sizeof(terminal)));
+    if( dep->kind==TaskGraphStartTrigger ) {
+        DAQmxErrChk (DAQmxCfgDigEdgeStartTrig(task,terminal,DAQmx_Val_Rising));
+    }
+    else {
+        DAQmxErrChk (DAQmxSetSampClkSrc(task,terminal));
+    }
+
+Error:
+    return error;
+}
+
+int32 TaskGraphArm(TaskGraph *graph, int parallel)
+{
+    int32   error=0;
+    int     i;
+
+    if( graph->numNodes==0 )
+        return TaskGraphErrInvalidArg;
+    ClearTasks(graph);
+    graph->t0 = StreamTimeNow();
+    graph->armed = 0.0;
+    error = StartOrder(graph);
+    if( error )
+        return error;
+
+    /*********************************************/
+    // DAQmx Configure Code
+    /*********************************************/
+    DAQmxErrChk (RunPhaseAll(graph,PhaseConfigure,parallel));
+    for(i=0;i<graph->numDeps;++i)
+        DAQmxErrChk (Route(graph,&graph->deps[i]));
+    DAQmxErrChk (RunPhaseAll(graph,PhaseCommit,parallel));
+
+    /*********************************************/
+    // DAQmx Start Code
+    /*********************************************/
+    for(i=0;i<graph->numNodes;++i) {
+        Node *n=&graph->nodes[graph->order[i]];
+
+        DAQmxErrChk (DAQmxStartTask(n->task));
+        n->started = 1;
+        n->times.started = StreamTimeNow()-graph->t0;
+    }
+    graph->armed = StreamTimeNow()-graph->t0;
+    return 0;
+
+Error:
+    ClearTasks(graph);
+    return error;
+}
+
+void TaskGraphStop(TaskGraph *graph)
+{
+    int i;
+
+    /*********************************************/
+    // DAQmx Stop Code
+    /*********************************************/
+    for(i=graph->numNodes-1;i>=0;--i) {
+        Node *n=&graph->nodes[graph->order[i]];
+
+        if( n->started ) {
+            DAQmxStopTask(n->task);
+            n->started = 0;
+        }
+    }
+}
+
+TaskHandle TaskGraphGetTask(const TaskGraph *graph, const char name[])
+{
+    int i=FindNode(graph,name);
+
+    return i>=0 ? graph->nodes[i].task : 0;
+}
+
+int TaskGraphNumTasks(const TaskGraph *graph)
+{
+    return graph->numNodes;
+}
+
+void TaskGraphGetTimes(const TaskGraph *graph, int index, TaskGraphTimes *times)
+{
+    *times = graph->nodes[index].times;
+    times->name = graph->nodes[index].name;
+}
+
+double TaskGraphTimeToArmed(const TaskGraph *graph)
+{
+    return graph->armed;
+}
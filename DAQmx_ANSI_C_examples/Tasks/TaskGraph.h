@@ -0,0 +1,100 @@
+/*********************************************************************
+*
+* Task helper:
+*    TaskGraph.h
+*
+* Description:
+*    Configures, commits and starts a set of synchronized tasks from a
+*    declaration of which task triggers or clocks which. ContinuousAI.c
+*    and SynchAI-AO.c hard-code that the slave starts before the
+*    master. A TaskGraph derives that order from the dependencies: a
+*    task that takes its start trigger or sample clock from another is
+*    started before it, so it cannot miss the first edge.
+*
+*    Each task is described by a name and a configure function that
+*    creates its channels and timing. Dependencies are added by name.
+*    TaskGraphArm then runs in four phases:
+*
+*      1. Create each task and call its configure function.
+*      2. Route each dependency: look up the source terminal with its
+*         device prefix and set it as the start trigger or sample
+*         clock source of the dependent task.
+*      3. Verify and commit each task (DAQmxTaskControl).
+*      4. Start the tasks in dependency order.
+*
+*    Phases 1 and 3 take most of the time with many devices and run
+*    on one thread per task when parallel is set. The driver takes
+*    concurrent calls on different tasks. Phase 2 is quick and serial.
+*    The time each task entered and left each phase is kept, so the
+*    timeline of a parallel and a serial start can be compared.
+*
+*    A graph must only be used from one thread at a time.
+*
+*********************************************************************/
+
+#ifndef TASKGRAPH_H
+#define TASKGRAPH_H
+
+#include <NIDAQmx.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define TaskGraphErrInvalidArg      -1
+#define TaskGraphErrOutOfMemory     -2
+#define TaskGraphErrThread          -3
+#define TaskGraphErrCycle           -4
+
+// How a task depends on its source.
+#define TaskGraphStartTrigger       0   // DAQmxCfgDigEdgeStartTrig on the source terminal
+#define TaskGraphSampleClock        1   // DAQmxSetSampClkSrc to the source terminal
+#define TaskGraphStartOrder         2   // no routing, only start before the source
+
+// Called in phase 1 on a new task, to create its channels and timing.
+typedef int32 (*TaskGraphConfigure)(TaskHandle taskHandle, void *configureData);
+
+typedef struct TaskGraphTimes {
+    const char  *name;
+    // Seconds from the call to TaskGraphArm.
+    double      configureStart;
+    double      configureEnd;
+    double      commitStart;
+    double      commitEnd;
+    double      started;
+    int         startIndex;     // position in the start order
+} TaskGraphTimes;
+
+typedef struct TaskGraph TaskGraph;
+
+int  TaskGraphCreate(TaskGraph **graph);
+
+// Stops and clears every task.
+void TaskGraphClear(TaskGraph *graph);
+
+int  TaskGraphAddTask(TaskGraph *graph, const char name[], TaskGraphConfigure configure, void *configureData);
+
+// terminal is the source task's terminal without device prefix,
+// e.g. "ai/StartTrigger" or "ai/SampleClock". It is ignored for
+// TaskGraphStartOrder.
+int  TaskGraphAddDependency(TaskGraph *graph, const char dependent[], const char source[], const char terminal[], int kind);
+
+// Runs the four phases. On error, tasks already created are cleared.
+int32 TaskGraphArm(TaskGraph *graph, int parallel);
+
+// Stops the tasks in reverse start order, sources first.
+void TaskGraphStop(TaskGraph *graph);
+
+TaskHandle TaskGraphGetTask(const TaskGraph *graph, const char name[]);
+
+int    TaskGraphNumTasks(const TaskGraph *graph);
+void   TaskGraphGetTimes(const TaskGraph *graph, int index, TaskGraphTimes *times);
+
+// Seconds from the call to TaskGraphArm until the last task started.
+double TaskGraphTimeToArmed(const TaskGraph *graph);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
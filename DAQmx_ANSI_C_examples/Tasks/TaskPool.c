@@ -0,0 +1,280 @@
+/*********************************************************************
+*
+* Task helper:
+*    TaskPool.c
+*
+* Description:
+*    Implementation of the committed AO task pool. See TaskPool.h for
+*    the calling conventions.
+*
+*    Most devices have a single AO timing engine, so two pooled tasks
+*    on the same device cannot both be reserved. Idle tasks that block
+*    a check out are unreserved, which keeps their configuration but
+*    releases the hardware.
+*
+*    Entries never move, as the caller holds pointers to them. A slot
+*    whose task could not be configured is left empty (task 0) and is
+*    the first to be filled again.
+*
+*********************************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+#include "TaskPool.h"
+#include "../Processing/StreamTime.h"
+
+#define DAQmxErrChk(functionCall) if( DAQmxFailed(error=(functionCall)) ) goto Error; else
+
+struct TaskPoolEntry {
+    TaskPoolConfig  cfg;
+    TaskHandle      task;
+    uInt32          numChans;
+    int             committed;
+    int             inUse;
+    int             path;
+    double          checkOutStart;
+    double          startLatency;   // negative until the task has been started
+    long long       lastUsed;
+};
+
+struct TaskPool {
+    int             maxTasks;
+    int             numTasks;
+    TaskPoolEntry   *entries;
+    long long       useCount;
+    TaskPoolLatency latency[TaskPoolNumPaths];
+};
+
+static int ConfigEqual(const TaskPoolConfig *a, const TaskPoolConfig *b)
+{
+    return strcmp(a->physicalChannel,b->physicalChannel)==0 &&
+           a->minVal==b->minVal && a->maxVal==b->maxVal &&
+           a->rate==b->rate && a->sampsPerChan==b->sampsPerChan &&
+           strcmp(a->triggerSource,b->triggerSource)==0 &&
+           a->triggerEdge==b->triggerEdge && !a->retriggerable==!b->retriggerable;
+}
+
+// True if both channel lists start on the same device, e.g. "Dev1/ao0"
+// and "/Dev1/ao1".
+static int SameDevice(const char a[], const char b[])
+{
+    if( *a=='/' ) ++a;
+    if( *b=='/' ) ++b;
+    while( *a && *a!='/' && *a==*b ) {
+        ++a;
+        ++b;
+    }
+    return (*a=='/' || *a=='\0') && (*b=='/' || *b=='\0');
+}
+
+static int32 ReleaseConflicting(TaskPool *pool, const TaskPoolConfig *config, const TaskPoolEntry *keep)
+{
+    int32   error=0;
+    int     i;
+
+    for(i=0;i<pool->numTasks;++i) {
+        TaskPoolEntry *e=&pool->entries[i];
+
+        if( e==keep || e->inUse || !e->committed || !SameDevice(e->cfg.physicalChannel,config->physicalChannel) )
+            continue;
+        DAQmxErrChk (DAQmxTaskControl(e->task,DAQmx_Val_Task_Unreserve));
+        e->committed = 0;
+    }
+
+Error:
+    return error;
+}
+
+static int32 ConfigureTask(TaskPoolEntry *e, const TaskPoolConfig *config)
+{
+    int32   error=0;
+
+    e->cfg = *config;
+    DAQmxErrChk (DAQmxCreateTask("",&e->task));
+    DAQmxErrChk (DAQmxCreateAOVoltageChan(e->task,config->physicalChannel,"",config->minVal,config->maxVal,DAQmx_Val_Volts,NULL));
+    DAQmxErrChk (DAQmxCfgSampClkTiming(e->task,"",config->rate,DAQmx_Val_Rising,DAQmx_Val_FiniteSamps,config->sampsPerChan));
+    if( config->triggerSource[0] ) {
+        DAQmxErrChk (DAQmxCfgDigEdgeStartTrig(e->task,config->triggerSource,config->triggerEdge));
+        DAQmxErrChk (DAQmxSetStartTrigRetriggerable(e->task,config->retriggerable));
+    }
+    DAQmxErrChk (DAQmxGetTaskNumChans(e->task,&e->numChans));
+    DAQmxErrChk (DAQmxTaskControl(e->task,DAQmx_Val_Task_Commit));
+    e->committed = 1;
+    return 0;
+
+Error:
+    if( e->task ) {
+        DAQmxClearTask(e->task);
+        e->task = 0;
+    }
+    return error;
+}
+
+int TaskPoolCreate(int maxTasks, TaskPool **pool)
+{
+    TaskPool    *p;
+    int         k;
+
+    *pool = NULL;
+    if( maxTasks<1 )
+        return TaskPoolErrInvalidArg;
+    p = (TaskPool*)calloc(1,sizeof(TaskPool));
+    if( !p )
+        return TaskPoolErrOutOfMemory;
+    p->entries = (TaskPoolEntry*)calloc(maxTasks,sizeof(TaskPoolEntry));
+    if( !p->entries ) {
+        free(p);
+        return TaskPoolErrOutOfMemory;
+    }
+    p->maxTasks = maxTasks;
+    for(k=0;k<TaskPoolNumPaths;++k)
+        p->latency[k].min = 1e30;
+    *pool = p;
+    return 0;
+}
+
+void TaskPoolClear(TaskPool *pool)
+{
+    int i;
+
+    if( !pool )
+        return;
+    for(i=0;i<pool->numTasks;++i) {
+        if( !pool->entries[i].task )
+            continue;
+        /*********************************************/
+        // DAQmx Stop Code
+        /*********************************************/
+        DAQmxStopTask(pool->entries[i].task);
+        DAQmxClearTask(pool->entries[i].task);
+    }
+    free(pool->entries);
+    free(pool);
+}
+
+int32 TaskPoolCheckOut(TaskPool *pool, const TaskPoolConfig *config, TaskPoolEntry **entry)
+{
+    int32           error=0;
+    double          t0=StreamTimeNow();
+    TaskPoolEntry   *e=NULL;
+    int             i,lru=-1,empty=-1;
+
+    *entry = NULL;
+    for(i=0;i<pool->numTasks;++i) {
+        TaskPoolEntry *c=&pool->entries[i];
+
+        if( !c->task ) {
+            if( empty<0 )
+                empty = i;
+            continue;
+        }
+        if( c->inUse )
+            continue;
+        if( ConfigEqual(&c->cfg,config) ) {
+            e = c;
+            break;
+        }
+        if( lru<0 || c->lastUsed<pool->entries[lru].lastUsed )
+            lru = i;
+    }
+
+    if( e ) {
+        if( e->committed )
+            e->path = TaskPoolPathWarm;
+        else {
+            DAQmxErrChk (ReleaseConflicting(pool,config,e));
+            DAQmxErrChk (DAQmxTaskControl(e->task,DAQmx_Val_Task_Commit));
+            e->committed = 1;
+            e->path = TaskPoolPathRecommit;
+        }
+    }
+    else {
+        if( empty>=0 )
+            e = &pool->entries[empty];
+        else if( pool->numTasks<pool->maxTasks )
+            e = &pool->entries[pool->numTasks++];
+        else if( lru>=0 ) {
+            // Evict the least recently used idle task.
+            e = &pool->entries[lru];
+            DAQmxClearTask(e->task);
+        }
+        else
+            return TaskPoolErrFull;
+        memset(e,0,sizeof(TaskPoolEntry));
+        error = ReleaseConflicting(pool,config,e);
+        if( !DAQmxFailed(error) )
+            error = ConfigureTask(e,config);
+        if( DAQmxFailed(error) ) {
+            // Leave the slot empty; ConfigureTask has cleared the task.
+            memset(e,0,sizeof(TaskPoolEntry));
+            return error;
+        }
+        e->path = TaskPoolPathCold;
+    }
+    e->inUse = 1;
+    e->checkOutStart = t0;
+    e->startLatency = -1.0;
+    *entry = e;
+
+Error:
+    return error;
+}
+
+int32 TaskPoolWriteAndStart(TaskPoolEntry *entry, const float64 data[])
+{
+    int32           error=0;
+    int32           written;
+
+    /*********************************************/
+    // DAQmx Write Code
+    /*********************************************/
+    DAQmxErrChk (DAQmxSetWriteRelativeTo(entry->task,DAQmx_Val_FirstSample));
+    DAQmxErrChk (DAQmxSetWriteOffset(entry->task,0));
+    DAQmxErrChk (DAQmxWriteAnalogF64(entry->task,(int32)entry->cfg.sampsPerChan,0,10.0,DAQmx_Val_GroupByChannel,data,&written,NULL));
+
+    /*********************************************/
+    // DAQmx Start Code
+    /*********************************************/
+    DAQmxErrChk (DAQmxStartTask(entry->task));
+
+    entry->startLatency = StreamTimeNow()-entry->checkOutStart;
+
+Error:
+    return error;
+}
+
+int32 TaskPoolCheckIn(TaskPool *pool, TaskPoolEntry *entry)
+{
+    int32           error=0;
+    TaskPoolLatency *lat=&pool->latency[entry->path];
+
+    if( entry->startLatency>=0.0 ) {
+        ++lat->count;
+        lat->total += entry->startLatency;
+        lat->min = entry->startLatency<lat->min ? entry->startLatency : lat->min;
+        lat->max = entry->startLatency>lat->max ? entry->startLatency : lat->max;
+    }
+
+    /*********************************************/
+    // DAQmx Stop Code
+    /*********************************************/
+    // Stopping a committed task leaves it committed and reserved.
+    error = DAQmxStopTask(entry->task);
+    entry->inUse = 0;
+    entry->lastUsed = ++pool->useCount;
+    return error;
+}
+
+TaskHandle TaskPoolGetTask(const TaskPoolEntry *entry)
+{
+    return entry->task;
+}
+
+void TaskPoolGetLatency(const TaskPool *pool, int path, TaskPoolLatency *latency)
+{
+    memset(latency,0,sizeof(TaskPoolLatency));
+    if( path>=0 && path<TaskPoolNumPaths )
+        *latency = pool->latency[path];
+    if( latency->count==0 )
+        latency->min = 0.0;
+}
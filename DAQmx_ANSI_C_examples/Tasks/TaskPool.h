@@ -0,0 +1,91 @@
+/*********************************************************************
+*
+* Task helper:
+*    TaskPool.h
+*
+* Description:
+*    Pool of analog output tasks that are kept configured, verified,
+*    reserved and committed between uses. A task is looked up by its
+*    channel, timing and trigger configuration. Switching the output
+*    waveform then only costs rewriting the buffer and starting the
+*    task, rather than the full DAQmxCreateTask ... DAQmxStartTask
+*    sequence of MultVoltUpdates-IntClk-Retrig.c.
+*
+*    TaskPoolCheckIn stops the task. A committed task returns to the
+*    committed state when stopped, so it stays reserved for the next
+*    check out. When a new configuration needs a channel that an idle
+*    pooled task holds, that task is unreserved and kept verified. It
+*    is committed again the next time it is checked out.
+*
+*    Check out latency is recorded separately for the three paths:
+*    warm (committed), recommit (verified) and cold (created).
+*
+*    A pool must only be used from one thread at a time.
+*
+*********************************************************************/
+
+#ifndef TASKPOOL_H
+#define TASKPOOL_H
+
+#include <NIDAQmx.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define TaskPoolErrInvalidArg   -1
+#define TaskPoolErrOutOfMemory  -2
+#define TaskPoolErrFull         -3
+
+#define TaskPoolPathWarm        0
+#define TaskPoolPathRecommit    1
+#define TaskPoolPathCold        2
+#define TaskPoolNumPaths        3
+
+typedef struct TaskPoolConfig {
+    char        physicalChannel[256];
+    float64     minVal;
+    float64     maxVal;
+    float64     rate;
+    uInt64      sampsPerChan;
+    char        triggerSource[256];     // empty for no start trigger
+    int32       triggerEdge;
+    bool32      retriggerable;
+} TaskPoolConfig;
+
+typedef struct TaskPoolLatency {
+    long long   count;
+    double      total;      // seconds
+    double      min;
+    double      max;
+} TaskPoolLatency;
+
+typedef struct TaskPool TaskPool;
+typedef struct TaskPoolEntry TaskPoolEntry;
+
+int  TaskPoolCreate(int maxTasks, TaskPool **pool);
+
+// Stops and clears every pooled task.
+void TaskPoolClear(TaskPool *pool);
+
+// Returns a committed, stopped task for config. error receives any
+// DAQmx error code.
+int32 TaskPoolCheckOut(TaskPool *pool, const TaskPoolConfig *config, TaskPoolEntry **entry);
+
+// Rewrites the output buffer from its first sample and starts the task.
+// data holds sampsPerChan samples for each channel, GroupByChannel.
+int32 TaskPoolWriteAndStart(TaskPoolEntry *entry, const float64 data[]);
+
+int32 TaskPoolCheckIn(TaskPool *pool, TaskPoolEntry *entry);
+
+TaskHandle TaskPoolGetTask(const TaskPoolEntry *entry);
+
+// Latency from the start of TaskPoolCheckOut to the return of
+// TaskPoolWriteAndStart, for each check out path.
+void TaskPoolGetLatency(const TaskPool *pool, int path, TaskPoolLatency *latency);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif